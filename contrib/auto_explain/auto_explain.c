@@ -30,6 +30,7 @@ static bool auto_explain_log_buffers = false;
 static bool auto_explain_log_wal = false;
 static bool auto_explain_log_triggers = false;
 static bool auto_explain_log_timing = true;
+static bool auto_explain_log_timing_sampled = false;
 static bool auto_explain_log_settings = false;
 static int	auto_explain_log_format = EXPLAIN_FORMAT_TEXT;
 static int	auto_explain_log_level = LOG;
@@ -217,6 +218,17 @@ _PG_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("auto_explain.log_timing_sampled",
+							 "Time only a sample of plan node calls.",
+							 "The time of the remaining calls is estimated from the sample.",
+							 &auto_explain_log_timing_sampled,
+							 false,
+							 PGC_SUSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomRealVariable("auto_explain.sample_rate",
 							 "Fraction of queries to process.",
 							 NULL,
@@ -287,7 +299,11 @@ explain_ExecutorStart(QueryDesc *queryDesc, int eflags)
 		if (auto_explain_log_analyze && (eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
 		{
 			if (auto_explain_log_timing)
+			{
 				queryDesc->instrument_options |= INSTRUMENT_TIMER;
+				if (auto_explain_log_timing_sampled)
+					queryDesc->instrument_options |= INSTRUMENT_TIMER_SAMPLED;
+			}
 			else
 				queryDesc->instrument_options |= INSTRUMENT_ROWS;
 			if (auto_explain_log_buffers)
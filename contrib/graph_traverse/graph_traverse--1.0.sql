@@ -0,0 +1,29 @@
+/* contrib/graph_traverse/graph_traverse--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION graph_traverse" to load this file. \quit
+
+CREATE FUNCTION graph_khop(
+    edges regclass,
+    from_column name,
+    to_column name,
+    start bigint,
+    max_depth integer,
+    OUT vertex bigint,
+    OUT depth integer
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT STABLE PARALLEL SAFE;
+
+CREATE FUNCTION graph_shortest_path(
+    edges regclass,
+    from_column name,
+    to_column name,
+    source bigint,
+    target bigint,
+    max_depth integer DEFAULT 32
+)
+RETURNS bigint[]
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT STABLE PARALLEL SAFE;
@@ -0,0 +1,46 @@
+CREATE EXTENSION graph_traverse;
+
+-- a chain 1->2->3->4->5 with a shortcut 1->4, a cycle back to 1, and an
+-- unconnected edge 6->7
+CREATE TABLE edges (src bigint, dst bigint);
+INSERT INTO edges VALUES (1, 2), (2, 3), (3, 4), (4, 5), (1, 4), (5, 1), (6, 7);
+CREATE INDEX edges_src ON edges (src);
+CREATE INDEX edges_dst ON edges (dst);
+
+SELECT * FROM graph_khop('edges', 'src', 'dst', 1, 2) ORDER BY depth, vertex;
+SELECT count(*) AS vertices, max(depth) AS max_depth
+  FROM graph_khop('edges', 'src', 'dst', 1, 10);
+SELECT * FROM graph_khop('edges', 'src', 'dst', 42, 3);
+
+SELECT graph_shortest_path('edges', 'src', 'dst', 1, 5);
+SELECT graph_shortest_path('edges', 'src', 'dst', 5, 3);
+SELECT graph_shortest_path('edges', 'src', 'dst', 5, 3, 2);
+SELECT graph_shortest_path('edges', 'src', 'dst', 1, 7);
+SELECT graph_shortest_path('edges', 'src', 'dst', 3, 3);
+
+-- integer columns work too, but shortest paths need both indexes
+CREATE TABLE edges2 (a integer, b integer);
+INSERT INTO edges2 VALUES (1, 2), (2, 3);
+CREATE INDEX edges2_a ON edges2 (a);
+SELECT * FROM graph_khop('edges2', 'a', 'b', 1, 5) ORDER BY depth, vertex;
+SELECT graph_shortest_path('edges2', 'a', 'b', 1, 3);
+
+-- errors
+SELECT * FROM graph_khop('edges', 'src', 'nosuch', 1, 2);
+SELECT * FROM graph_khop('edges', 'src', 'dst', 1, -1);
+
+-- row-level security can't be enforced, so tables subject to it are refused
+CREATE ROLE regress_graph_user;
+GRANT SELECT ON edges TO regress_graph_user;
+ALTER TABLE edges ENABLE ROW LEVEL SECURITY;
+CREATE POLICY edges_low ON edges USING (src < 3);
+SET ROLE regress_graph_user;
+SELECT * FROM graph_khop('edges', 'src', 'dst', 1, 2);
+SELECT graph_shortest_path('edges', 'src', 'dst', 1, 5);
+RESET ROLE;
+-- the table owner is not subject to the policy
+SELECT count(*) FROM graph_khop('edges', 'src', 'dst', 1, 10);
+
+DROP TABLE edges, edges2;
+DROP ROLE regress_graph_user;
+DROP EXTENSION graph_traverse;
@@ -56,6 +56,9 @@
 
 #define AUTOPREWARM_FILE "autoprewarm.blocks"
 
+/* Number of blocks to prefetch ahead of the one being read */
+#define AUTOPREWARM_PREFETCH_DISTANCE	32
+
 /* Metadata for each block we dump. */
 typedef struct BlockInfoRecord
 {
@@ -438,6 +441,7 @@ autoprewarm_database_main(Datum main_arg)
 	BlockNumber nblocks = 0;
 	BlockInfoRecord *old_blk = NULL;
 	dsm_segment *seg;
+	int			prefetch_pos;
 
 	/* Establish signal handlers; once that's done, unblock signals. */
 	pqsignal(SIGTERM, die);
@@ -453,6 +457,7 @@ autoprewarm_database_main(Datum main_arg)
 	BackgroundWorkerInitializeConnectionByOid(apw_state->database, InvalidOid, 0);
 	block_info = (BlockInfoRecord *) dsm_segment_address(seg);
 	pos = apw_state->prewarm_start_idx;
+	prefetch_pos = pos;
 
 	/*
 	 * Loop until we run out of blocks to prewarm or until we run out of free
@@ -536,6 +541,31 @@ autoprewarm_database_main(Datum main_arg)
 			continue;
 		}
 
+#ifdef USE_PREFETCH
+
+		/*
+		 * Ask the kernel to start reading the next few blocks of the same
+		 * fork, so that the reads below don't wait for each block in turn.
+		 * The records are sorted, so those blocks follow this one.
+		 */
+		if (prefetch_pos < pos)
+			prefetch_pos = pos;
+		while (prefetch_pos < apw_state->prewarm_stop_idx &&
+			   prefetch_pos < pos + AUTOPREWARM_PREFETCH_DISTANCE)
+		{
+			BlockInfoRecord *pblk = &block_info[prefetch_pos];
+
+			if (pblk->database != blk->database ||
+				pblk->tablespace != blk->tablespace ||
+				pblk->filenode != blk->filenode ||
+				pblk->forknum != blk->forknum)
+				break;
+			if (pblk->blocknum < nblocks)
+				PrefetchBuffer(rel, pblk->forknum, pblk->blocknum);
+			prefetch_pos++;
+		}
+#endif
+
 		/* Prewarm buffer. */
 		buf = ReadBufferExtended(rel, blk->forknum, blk->blocknum, RBM_NORMAL,
 								 NULL);
@@ -19,6 +19,7 @@
 #include "fmgr.h"
 #include "miscadmin.h"
 #include "storage/bufmgr.h"
+#include "storage/read_stream.h"
 #include "storage/smgr.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -36,8 +37,28 @@ typedef enum
 	PREWARM_BUFFER
 } PrewarmType;
 
+typedef struct PrewarmStreamState
+{
+	BlockNumber next_block;
+	BlockNumber last_block;
+} PrewarmStreamState;
+
 static PGAlignedBlock blockbuffer;
 
+/*
+ * Read stream callback for buffer mode: return the blocks of the requested
+ * range in order.
+ */
+static BlockNumber
+prewarm_stream_next_block(ReadStream *stream, void *callback_private_data)
+{
+	PrewarmStreamState *p = callback_private_data;
+
+	if (p->next_block > p->last_block)
+		return InvalidBlockNumber;
+	return p->next_block++;
+}
+
 /*
  * pg_prewarm(regclass, mode text, fork text,
  *			  first_block int8, last_block int8)
@@ -184,18 +205,34 @@ pg_prewarm(PG_FUNCTION_ARGS)
 	}
 	else if (ptype == PREWARM_BUFFER)
 	{
+		PrewarmStreamState p;
+		ReadStream *stream;
+		Buffer		buf;
+
 		/*
-		 * In buffer mode, we actually pull the data into shared_buffers.
+		 * In buffer mode, we actually pull the data into shared_buffers.  A
+		 * read stream lets the reads of upcoming blocks overlap with ours.
 		 */
-		for (block = first_block; block <= last_block; ++block)
+		p.next_block = first_block;
+		p.last_block = last_block;
+		stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE,
+											NULL,
+											rel,
+											forkNumber,
+											prewarm_stream_next_block,
+											&p);
+
+		for (;;)
 		{
-			Buffer		buf;
-
 			CHECK_FOR_INTERRUPTS();
-			buf = ReadBufferExtended(rel, forkNumber, block, RBM_NORMAL, NULL);
+			buf = read_stream_next_buffer(stream);
+			if (!BufferIsValid(buf))
+				break;
 			ReleaseBuffer(buf);
 			++blocks_done;
 		}
+
+		read_stream_end(stream);
 	}
 
 	/* Close relation, release lock. */
@@ -0,0 +1,33 @@
+/* contrib/pg_session_history/pg_session_history--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION pg_session_history" to load this file. \quit
+
+CREATE FUNCTION pg_session_history(
+    OUT sample_time timestamp with time zone,
+    OUT pid integer,
+    OUT backend_type text,
+    OUT datid oid,
+    OUT usesysid oid,
+    OUT state text,
+    OUT wait_event_type text,
+    OUT wait_event text,
+    OUT queryid bigint
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT VOLATILE PARALLEL SAFE;
+
+CREATE FUNCTION pg_session_history_reset()
+RETURNS void
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT VOLATILE PARALLEL SAFE;
+
+CREATE VIEW pg_session_history AS
+  SELECT * FROM pg_session_history();
+
+REVOKE ALL ON pg_session_history FROM PUBLIC;
+GRANT SELECT ON pg_session_history TO pg_read_all_stats;
+
+REVOKE ALL ON FUNCTION pg_session_history() FROM PUBLIC;
+REVOKE ALL ON FUNCTION pg_session_history_reset() FROM PUBLIC;
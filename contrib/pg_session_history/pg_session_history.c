@@ -0,0 +1,472 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_session_history.c
+ *		Periodically sample the activity of all backends into a ring buffer.
+ *
+ *		A background worker wakes up every sample_interval and records, for
+ *		each process that is doing something, its wait event, state and
+ *		query identifier.  The samples go into a fixed-size ring buffer in
+ *		shared memory, so that the recent history of where time was spent
+ *		can be examined after the fact with the pg_session_history view,
+ *		without polling pg_stat_activity.
+ *
+ *		Idle client backends, and other processes waiting in their main
+ *		loop for something to do (wait events of class Activity), are not
+ *		sampled.
+ *
+ *	Copyright (c) 2021, PostgreSQL Global Development Group
+ *
+ *	IDENTIFICATION
+ *		contrib/pg_session_history/pg_session_history.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/procarray.h"
+#include "storage/procsignal.h"
+#include "storage/shmem.h"
+#include "utils/backend_status.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+#include "utils/wait_event.h"
+
+PG_MODULE_MAGIC;
+
+#define UINT32_ACCESS_ONCE(var)		 ((uint32)(*((volatile uint32 *)&(var))))
+
+/* One sample of one backend */
+typedef struct SessionSample
+{
+	TimestampTz sample_time;
+	int			pid;
+	BackendType backend_type;
+	BackendState state;
+	Oid			datid;
+	Oid			userid;
+	uint32		wait_event_info;
+	uint64		queryid;
+} SessionSample;
+
+/* Shared state: the ring buffer and its position */
+typedef struct SessionHistoryState
+{
+	LWLock	   *lock;			/* protects everything below */
+	uint64		nwritten;		/* samples written since startup or reset */
+	SessionSample samples[FLEXIBLE_ARRAY_MEMBER];	/* max_samples entries */
+} SessionHistoryState;
+
+void		_PG_init(void);
+void		_PG_fini(void);
+void		pg_session_history_main(Datum main_arg);
+
+PG_FUNCTION_INFO_V1(pg_session_history);
+PG_FUNCTION_INFO_V1(pg_session_history_reset);
+
+static Size psh_memsize(void);
+static void psh_shmem_startup(void);
+static void psh_take_sample(MemoryContext samplecxt);
+static const char *psh_state_name(BackendState state);
+
+/* Saved hook value in case of unload */
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+/* Pointer to shared-memory state */
+static SessionHistoryState *psh = NULL;
+
+/* GUC variables */
+static int	psh_sample_interval;	/* in msec */
+static int	psh_max_samples;	/* size of the ring buffer */
+
+/*
+ * Module load callback
+ */
+void
+_PG_init(void)
+{
+	BackgroundWorker worker;
+
+	/*
+	 * In order to create our shared memory area, we have to be loaded via
+	 * shared_preload_libraries.  If not, fall out without hooking into any
+	 * of the main system.
+	 */
+	if (!process_shared_preload_libraries_in_progress)
+		return;
+
+	DefineCustomIntVariable("pg_session_history.sample_interval",
+							"Sets the interval between samples of backend activity.",
+							NULL,
+							&psh_sample_interval,
+							1000,
+							10,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("pg_session_history.max_samples",
+							"Sets the number of samples kept in shared memory.",
+							NULL,
+							&psh_max_samples,
+							100000,
+							1000,
+							10000000,
+							PGC_POSTMASTER,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	EmitWarningsOnPlaceholders("pg_session_history");
+
+	RequestAddinShmemSpace(psh_memsize());
+	RequestNamedLWLockTranche("pg_session_history", 1);
+
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = psh_shmem_startup;
+
+	/* Register the sampler */
+	MemSet(&worker, 0, sizeof(BackgroundWorker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+	worker.bgw_restart_time = 10;
+	strcpy(worker.bgw_library_name, "pg_session_history");
+	strcpy(worker.bgw_function_name, "pg_session_history_main");
+	strcpy(worker.bgw_name, "session history sampler");
+	strcpy(worker.bgw_type, "session history sampler");
+	RegisterBackgroundWorker(&worker);
+}
+
+/*
+ * Module unload callback
+ */
+void
+_PG_fini(void)
+{
+	/* Uninstall hooks. */
+	shmem_startup_hook = prev_shmem_startup_hook;
+}
+
+/*
+ * Estimate shared memory space needed.
+ */
+static Size
+psh_memsize(void)
+{
+	return add_size(offsetof(SessionHistoryState, samples),
+					mul_size(psh_max_samples, sizeof(SessionSample)));
+}
+
+/*
+ * shmem_startup hook: allocate or attach to shared memory.
+ */
+static void
+psh_shmem_startup(void)
+{
+	bool		found;
+
+	if (prev_shmem_startup_hook)
+		prev_shmem_startup_hook();
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	psh = ShmemInitStruct("pg_session_history", psh_memsize(), &found);
+	if (!found)
+	{
+		psh->lock = &(GetNamedLWLockTranche("pg_session_history"))->lock;
+		psh->nwritten = 0;
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+/*
+ * Main entry point for the sampler process.
+ */
+void
+pg_session_history_main(Datum main_arg)
+{
+	MemoryContext samplecxt;
+
+	/* Establish signal handlers; once that's done, unblock signals. */
+	pqsignal(SIGTERM, SignalHandlerForShutdownRequest);
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGUSR1, procsignal_sigusr1_handler);
+	BackgroundWorkerUnblockSignals();
+
+	samplecxt = AllocSetContextCreate(TopMemoryContext,
+									  "session history sample",
+									  ALLOCSET_DEFAULT_SIZES);
+
+	while (!ShutdownRequestPending)
+	{
+		/* In case of a SIGHUP, just reload the configuration. */
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		psh_take_sample(samplecxt);
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 psh_sample_interval,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * Record one sample of every process that is doing something.
+ *
+ * The backend status array is copied first, and the samples are only then
+ * added to the ring buffer, so that the exclusive lock is held briefly.
+ */
+static void
+psh_take_sample(MemoryContext samplecxt)
+{
+	MemoryContext oldcxt;
+	TimestampTz now = GetCurrentTimestamp();
+	SessionSample *samples;
+	int			nbackends;
+	int			nsamples = 0;
+
+	oldcxt = MemoryContextSwitchTo(samplecxt);
+
+	/* Get a fresh copy of the backend status array */
+	pgstat_clear_snapshot();
+	nbackends = pgstat_fetch_stat_numbackends();
+	samples = (SessionSample *) palloc(Max(nbackends, 1) * sizeof(SessionSample));
+
+	for (int beid = 1; beid <= nbackends; beid++)
+	{
+		LocalPgBackendStatus *local_beentry;
+		PgBackendStatus *beentry;
+		PGPROC	   *proc;
+		uint32		wait_event_info = 0;
+		SessionSample *sample;
+
+		local_beentry = pgstat_fetch_stat_local_beentry(beid);
+		if (local_beentry == NULL)
+			continue;
+		beentry = &local_beentry->backendStatus;
+
+		if (beentry->st_procpid <= 0 || beentry->st_procpid == MyProcPid)
+			continue;
+		if (beentry->st_state == STATE_IDLE)
+			continue;
+
+		proc = BackendPidGetProc(beentry->st_procpid);
+		if (proc == NULL && beentry->st_backendType != B_BACKEND)
+			proc = AuxiliaryPidGetProc(beentry->st_procpid);
+		if (proc != NULL)
+			wait_event_info = UINT32_ACCESS_ONCE(proc->wait_event_info);
+
+		/* Skip processes idling in their main loop */
+		if ((wait_event_info & 0xFF000000) == PG_WAIT_ACTIVITY)
+			continue;
+
+		sample = &samples[nsamples++];
+		sample->sample_time = now;
+		sample->pid = beentry->st_procpid;
+		sample->backend_type = beentry->st_backendType;
+		sample->state = beentry->st_state;
+		sample->datid = beentry->st_databaseid;
+		sample->userid = beentry->st_userid;
+		sample->wait_event_info = wait_event_info;
+		sample->queryid = beentry->st_queryid;
+	}
+
+	if (nsamples > 0)
+	{
+		LWLockAcquire(psh->lock, LW_EXCLUSIVE);
+		for (int i = 0; i < nsamples; i++)
+		{
+			psh->samples[psh->nwritten % psh_max_samples] = samples[i];
+			psh->nwritten++;
+		}
+		LWLockRelease(psh->lock);
+	}
+
+	pgstat_clear_snapshot();
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextReset(samplecxt);
+}
+
+/*
+ * Translate a BackendState into the name pg_stat_activity uses for it.
+ */
+static const char *
+psh_state_name(BackendState state)
+{
+	switch (state)
+	{
+		case STATE_IDLE:
+			return "idle";
+		case STATE_RUNNING:
+			return "active";
+		case STATE_IDLEINTRANSACTION:
+			return "idle in transaction";
+		case STATE_FASTPATH:
+			return "fastpath function call";
+		case STATE_IDLEINTRANSACTION_ABORTED:
+			return "idle in transaction (aborted)";
+		case STATE_DISABLED:
+			return "disabled";
+		case STATE_UNDEFINED:
+			break;
+	}
+	return NULL;
+}
+
+/* Number of output arguments (columns) for pg_session_history */
+#define PG_SESSION_HISTORY_COLS	9
+
+/*
+ * Return the samples currently in the ring buffer, oldest first.
+ */
+Datum
+pg_session_history(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	SessionSample *samples;
+	uint64		first;
+	uint64		last;
+	int			nsamples = 0;
+
+	if (!psh)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_session_history must be loaded via shared_preload_libraries")));
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	/* Copy the samples out, so as not to hold the lock while formatting */
+	samples = (SessionSample *) palloc(mul_size(psh_max_samples,
+												sizeof(SessionSample)));
+
+	LWLockAcquire(psh->lock, LW_SHARED);
+	last = psh->nwritten;
+	first = (last > (uint64) psh_max_samples) ? last - psh_max_samples : 0;
+	for (uint64 n = first; n < last; n++)
+		samples[nsamples++] = psh->samples[n % psh_max_samples];
+	LWLockRelease(psh->lock);
+
+	for (int i = 0; i < nsamples; i++)
+	{
+		SessionSample *sample = &samples[i];
+		Datum		values[PG_SESSION_HISTORY_COLS];
+		bool		nulls[PG_SESSION_HISTORY_COLS];
+		const char *state;
+		int			j = 0;
+
+		memset(values, 0, sizeof(values));
+		memset(nulls, 0, sizeof(nulls));
+
+		values[j++] = TimestampTzGetDatum(sample->sample_time);
+		values[j++] = Int32GetDatum(sample->pid);
+		values[j++] = CStringGetTextDatum(GetBackendTypeDesc(sample->backend_type));
+
+		if (OidIsValid(sample->datid))
+			values[j++] = ObjectIdGetDatum(sample->datid);
+		else
+			nulls[j++] = true;
+
+		if (OidIsValid(sample->userid))
+			values[j++] = ObjectIdGetDatum(sample->userid);
+		else
+			nulls[j++] = true;
+
+		state = psh_state_name(sample->state);
+		if (state)
+			values[j++] = CStringGetTextDatum(state);
+		else
+			nulls[j++] = true;
+
+		if (sample->wait_event_info != 0)
+		{
+			values[j++] = CStringGetTextDatum(pgstat_get_wait_event_type(sample->wait_event_info));
+			values[j++] = CStringGetTextDatum(pgstat_get_wait_event(sample->wait_event_info));
+		}
+		else
+		{
+			nulls[j++] = true;
+			nulls[j++] = true;
+		}
+
+		if (sample->queryid != 0)
+			values[j++] = Int64GetDatumFast((int64) sample->queryid);
+		else
+			nulls[j++] = true;
+
+		Assert(j == PG_SESSION_HISTORY_COLS);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	pfree(samples);
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
+/*
+ * Discard all samples.
+ */
+Datum
+pg_session_history_reset(PG_FUNCTION_ARGS)
+{
+	if (!psh)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_session_history must be loaded via shared_preload_libraries")));
+
+	LWLockAcquire(psh->lock, LW_EXCLUSIVE);
+	psh->nwritten = 0;
+	LWLockRelease(psh->lock);
+
+	PG_RETURN_VOID();
+}
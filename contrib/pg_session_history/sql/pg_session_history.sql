@@ -0,0 +1,12 @@
+CREATE EXTENSION pg_session_history;
+
+SELECT pg_session_history_reset();
+SELECT count(*) >= 0 AS ok FROM pg_session_history;
+
+-- our own session runs a query while waiting, so it should show up
+SELECT pg_sleep(0.5);
+SELECT count(*) > 0 AS ok FROM pg_session_history
+  WHERE pid = pg_backend_pid() AND state = 'active'
+    AND wait_event_type = 'Timeout' AND wait_event = 'PgSleep';
+
+DROP EXTENSION pg_session_history;
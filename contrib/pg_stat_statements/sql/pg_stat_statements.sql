@@ -385,4 +385,16 @@ END;
 $$ LANGUAGE plpgsql;
 SELECT query, toplevel, plans, calls FROM pg_stat_statements WHERE query LIKE '%DELETE%' ORDER BY query COLLATE "C", toplevel;
 
+--
+-- execution time histogram
+--
+SELECT pg_stat_statements_reset();
+SELECT 1 AS histogram_test;
+SELECT 2 AS histogram_test;
+SELECT 3 AS histogram_test;
+SELECT array_length(exec_time_histogram, 1) AS buckets,
+       (SELECT sum(n) FROM unnest(exec_time_histogram) n) = calls AS sums_to_calls,
+       calls
+  FROM pg_stat_statements WHERE query = 'SELECT $1 AS histogram_test';
+
 DROP EXTENSION pg_stat_statements;
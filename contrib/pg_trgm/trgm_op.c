@@ -163,6 +163,17 @@ comp_trgm(const void *a, const void *b)
 	return CMPTRGM(a, b);
 }
 
+/*
+ * Sorting trigram arrays is a large part of the cost of generating them, so
+ * use a sort specialized for them rather than qsort() with comp_trgm.
+ */
+#define ST_SORT trigram_qsort
+#define ST_ELEMENT_TYPE_VOID
+#define ST_COMPARE(a, b) CMPTRGM(a, b)
+#define ST_SCOPE static
+#define ST_DEFINE
+#include "lib/sort_template.h"
+
 /*
  * Finds first word in string, returns pointer to the word,
  * endword points to the character after word
@@ -374,7 +385,7 @@ generate_trgm(char *str, int slen)
 	 */
 	if (len > 1)
 	{
-		qsort((void *) GETARR(trg), len, sizeof(trgm), comp_trgm);
+		trigram_qsort(GETARR(trg), len, sizeof(trgm));
 		len = qunique(GETARR(trg), len, sizeof(trgm), comp_trgm);
 	}
 
@@ -439,6 +450,13 @@ comp_ptrgm(const void *v1, const void *v2)
 		return 1;
 }
 
+#define ST_SORT pos_trgm_qsort
+#define ST_ELEMENT_TYPE pos_trgm
+#define ST_COMPARE(a, b) comp_ptrgm(a, b)
+#define ST_SCOPE static
+#define ST_DEFINE
+#include "lib/sort_template.h"
+
 /*
  * Iterative search function which calculates maximum similarity with word in
  * the string. But maximum similarity is calculated only if check_only == false.
@@ -650,7 +668,7 @@ calc_word_similarity(char *str1, int slen1, char *str2, int slen2,
 
 	ptrg = make_positional_trgm(trg1, len1, trg2, len2);
 	len = len1 + len2;
-	qsort(ptrg, len, sizeof(pos_trgm), comp_ptrgm);
+	pos_trgm_qsort(ptrg, len);
 
 	pfree(trg1);
 	pfree(trg2);
@@ -922,7 +940,7 @@ generate_wildcard_trgm(const char *str, int slen)
 	 */
 	if (len > 1)
 	{
-		qsort((void *) GETARR(trg), len, sizeof(trgm), comp_trgm);
+		trigram_qsort(GETARR(trg), len, sizeof(trgm));
 		len = qunique(GETARR(trg), len, sizeof(trgm), comp_trgm);
 	}
 
@@ -170,6 +170,30 @@ commit;
 select * from pg_visibility_map('copyfreeze');
 select * from pg_check_frozen('copyfreeze');
 
+-- vacuum_freeze_eager freezes pages that VACUUM modifies anyway.  Use temp
+-- tables, so that only this session's snapshots hold back the xmin horizon.
+create temp table vac_eager (a int);
+insert into vac_eager select generate_series(1, 100);
+vacuum vac_eager;
+select * from pg_visibility_map('vac_eager');
+set vacuum_freeze_eager = on;
+-- an all-visible page that needs no pruning is left alone
+vacuum vac_eager;
+select * from pg_visibility_map('vac_eager');
+-- but once there's something to prune, the whole page is frozen
+update vac_eager set a = a where a = 1;
+vacuum vac_eager;
+select * from pg_visibility_map('vac_eager');
+select * from pg_check_frozen('vac_eager');
+-- likewise for a page that is set all-visible for the first time
+create temp table vac_eager_new (a int);
+insert into vac_eager_new select generate_series(1, 100);
+vacuum vac_eager_new;
+select * from pg_visibility_map('vac_eager_new');
+reset vacuum_freeze_eager;
+drop table vac_eager;
+drop table vac_eager_new;
+
 -- cleanup
 drop table test_partitioned;
 drop view test_view;
@@ -0,0 +1,35 @@
+/* contrib/pg_walsummary/pg_walsummary--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION pg_walsummary" to load this file. \quit
+
+CREATE FUNCTION pg_walsummary_list(
+    OUT start_lsn pg_lsn,
+    OUT end_lsn pg_lsn,
+    OUT nentries bigint
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT VOLATILE PARALLEL SAFE;
+
+CREATE FUNCTION pg_walsummary_blocks(
+    IN start_lsn pg_lsn,
+    IN end_lsn pg_lsn,
+    OUT reltablespace oid,
+    OUT reldatabase oid,
+    OUT relfilenode oid,
+    OUT relforknumber smallint,
+    OUT relblocknumber bigint
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT VOLATILE PARALLEL SAFE;
+
+CREATE FUNCTION pg_walsummary_remove(upto_lsn pg_lsn)
+RETURNS integer
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT VOLATILE PARALLEL UNSAFE;
+
+REVOKE ALL ON FUNCTION pg_walsummary_list() FROM PUBLIC;
+REVOKE ALL ON FUNCTION pg_walsummary_blocks(pg_lsn, pg_lsn) FROM PUBLIC;
+REVOKE ALL ON FUNCTION pg_walsummary_remove(pg_lsn) FROM PUBLIC;
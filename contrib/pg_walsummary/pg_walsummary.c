@@ -0,0 +1,923 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_walsummary.c
+ *		Summarize which relation blocks are modified by WAL.
+ *
+ *		A background worker reads the WAL as it is flushed and remembers
+ *		which blocks each record touches.  Whenever it reaches a checkpoint
+ *		record, it writes the set of blocks modified since the previous
+ *		summary to a file in pg_walsummary/, named after the range of WAL it
+ *		covers.  Tools that need to know which blocks changed between two
+ *		LSNs, such as an incremental backup or a rewind, can then read the
+ *		compact summaries through pg_walsummary_blocks() instead of decoding
+ *		all the WAL in between, or reading every data file.
+ *
+ *		Besides individual blocks, a summary can record that a relation fork
+ *		was created or truncated (blkno is InvalidBlockNumber), or that a
+ *		whole database directory was created or dropped (relNode is
+ *		InvalidOid).  A consumer must treat everything in such a fork or
+ *		database as modified.
+ *
+ *	Copyright (c) 2021, PostgreSQL Global Development Group
+ *
+ *	IDENTIFICATION
+ *		contrib/pg_walsummary/pg_walsummary.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "access/rmgr.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogreader.h"
+#include "access/xlogutils.h"
+#include "catalog/pg_control.h"
+#include "catalog/storage_xlog.h"
+#include "commands/dbcommands_xlog.h"
+#include "common/hashfn.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "port/pg_crc32c.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/fd.h"
+#include "storage/latch.h"
+#include "storage/procsignal.h"
+#include "tcop/tcopprot.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/pg_lsn.h"
+
+PG_MODULE_MAGIC;
+
+#define WALSUMMARY_DIR			"pg_walsummary"
+#define WALSUMMARY_MAGIC		0x57534D31	/* "WSM1" */
+
+/* Length of a summary file name: start and end LSN, then ".summary" */
+#define WALSUMMARY_FNAME_LEN	(32 + 8)
+
+/*
+ * Write out a summary early if it grows this large, to bound the memory
+ * the worker needs between checkpoints.
+ */
+#define WALSUMMARY_MAX_ENTRIES	(1024 * 1024)
+
+/* How long to sleep when we have caught up with the flushed WAL */
+#define WALSUMMARY_NAPTIME_MS	500
+
+/* One modified block, fork or database */
+typedef struct WalSummaryEntry
+{
+	RelFileNode rnode;			/* relNode is InvalidOid for a database */
+	ForkNumber	forknum;		/* InvalidForkNumber for a database */
+	BlockNumber blkno;			/* InvalidBlockNumber for a whole fork */
+} WalSummaryEntry;
+
+/* Header of a summary file; the sorted entries follow */
+typedef struct WalSummaryFileHeader
+{
+	uint32		magic;			/* WALSUMMARY_MAGIC */
+	uint32		nentries;		/* number of entries */
+	XLogRecPtr	start_lsn;		/* first byte of WAL covered */
+	XLogRecPtr	end_lsn;		/* first byte of WAL not covered */
+	pg_crc32c	crc;			/* CRC of the entries */
+} WalSummaryFileHeader;
+
+/* A summary file found in the directory */
+typedef struct WalSummaryFile
+{
+	XLogRecPtr	start_lsn;
+	XLogRecPtr	end_lsn;
+} WalSummaryFile;
+
+/* Hash table entry for collecting or deduplicating entries */
+typedef struct WalSummaryHashEntry
+{
+	WalSummaryEntry key;
+	char		status;			/* hash entry status */
+} WalSummaryHashEntry;
+
+#define SH_PREFIX		blockhash
+#define SH_ELEMENT_TYPE WalSummaryHashEntry
+#define SH_KEY_TYPE		WalSummaryEntry
+#define SH_KEY			key
+#define SH_HASH_KEY(tb, key) \
+	hash_bytes((const unsigned char *) &(key), sizeof(WalSummaryEntry))
+#define SH_EQUAL(tb, a, b) \
+	(memcmp(&(a), &(b), sizeof(WalSummaryEntry)) == 0)
+#define SH_SCOPE		static inline
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+void		_PG_init(void);
+void		pg_walsummary_main(Datum main_arg);
+
+PG_FUNCTION_INFO_V1(pg_walsummary_list);
+PG_FUNCTION_INFO_V1(pg_walsummary_blocks);
+PG_FUNCTION_INFO_V1(pg_walsummary_remove);
+
+static bool walsummary_read_page(XLogReaderState *reader);
+static bool walsummary_process_record(XLogReaderState *reader,
+									  blockhash_hash *blocks);
+static void walsummary_add(blockhash_hash *blocks, const RelFileNode *rnode,
+						   ForkNumber forknum, BlockNumber blkno);
+static void walsummary_write(blockhash_hash *blocks, XLogRecPtr start_lsn,
+							 XLogRecPtr end_lsn);
+static List *walsummary_get_files(void);
+static WalSummaryEntry *walsummary_read_file(WalSummaryFile *file,
+											 bool read_entries,
+											 uint32 *nentries);
+static WalSummaryEntry *walsummary_sorted_entries(blockhash_hash *blocks,
+												  uint32 *nentries);
+static void walsummary_file_path(char *path, XLogRecPtr start_lsn,
+								 XLogRecPtr end_lsn);
+static int	walsummary_file_cmp(const ListCell *a, const ListCell *b);
+static int	walsummary_entry_cmp(const void *a, const void *b);
+static Tuplestorestate *walsummary_init_srf(FunctionCallInfo fcinfo,
+											TupleDesc *tupdesc);
+
+/*
+ * Module load callback
+ */
+void
+_PG_init(void)
+{
+	BackgroundWorker worker;
+
+	/*
+	 * The summarizer runs as a background worker, which can only be
+	 * registered while loading shared_preload_libraries.  The SQL functions
+	 * work on existing summaries regardless.
+	 */
+	if (!process_shared_preload_libraries_in_progress)
+		return;
+
+	MemSet(&worker, 0, sizeof(BackgroundWorker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_ConsistentState;
+	worker.bgw_restart_time = 10;
+	strcpy(worker.bgw_library_name, "pg_walsummary");
+	strcpy(worker.bgw_function_name, "pg_walsummary_main");
+	strcpy(worker.bgw_name, "WAL summarizer");
+	strcpy(worker.bgw_type, "WAL summarizer");
+	RegisterBackgroundWorker(&worker);
+}
+
+/*
+ * Main entry point for the summarizer process.
+ */
+void
+pg_walsummary_main(Datum main_arg)
+{
+	MemoryContext summarycxt;
+	XLogReaderState *reader;
+	blockhash_hash *blocks;
+	XLogRecPtr	start_lsn = InvalidXLogRecPtr;
+	XLogRecPtr	read_lsn;
+	ListCell   *lc;
+
+	/* Establish signal handlers; once that's done, unblock signals. */
+	pqsignal(SIGTERM, die);
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGUSR1, procsignal_sigusr1_handler);
+	BackgroundWorkerUnblockSignals();
+
+	if (MakePGDirectory(WALSUMMARY_DIR) < 0 && errno != EEXIST)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create directory \"%s\": %m",
+						WALSUMMARY_DIR)));
+
+	/* Continue where the newest summary left off, if any */
+	foreach(lc, walsummary_get_files())
+	{
+		WalSummaryFile *file = (WalSummaryFile *) lfirst(lc);
+
+		start_lsn = Max(start_lsn, file->end_lsn);
+	}
+
+	if (!XLogRecPtrIsInvalid(start_lsn))
+	{
+		XLogSegNo	segno;
+
+		XLByteToSeg(start_lsn, segno, wal_segment_size);
+		if (segno <= XLogGetLastRemovedSegno())
+		{
+			ereport(LOG,
+					(errmsg("WAL needed to continue summarizing from %X/%X has already been removed",
+							LSN_FORMAT_ARGS(start_lsn)),
+					 errdetail("WAL summaries will not cover the range from %X/%X to the latest checkpoint.",
+							   LSN_FORMAT_ARGS(start_lsn))));
+			start_lsn = InvalidXLogRecPtr;
+		}
+	}
+
+	/* Otherwise start at the latest checkpoint's redo point */
+	if (XLogRecPtrIsInvalid(start_lsn))
+		start_lsn = GetRedoRecPtr();
+
+	/*
+	 * The end of a summary may fall on a page boundary, but the reader must
+	 * be positioned on the record itself, just past the page header.
+	 */
+	read_lsn = start_lsn;
+	if (read_lsn % XLOG_BLCKSZ == 0)
+	{
+		if (XLogSegmentOffset(read_lsn, wal_segment_size) == 0)
+			read_lsn += SizeOfXLogLongPHD;
+		else
+			read_lsn += SizeOfXLogShortPHD;
+	}
+
+	reader = XLogReaderAllocate(wal_segment_size, NULL, wal_segment_close);
+	if (!reader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+	XLogBeginRead(reader, read_lsn);
+
+	ereport(DEBUG1,
+			(errmsg_internal("WAL summarizer starting at %X/%X",
+							 LSN_FORMAT_ARGS(start_lsn))));
+
+	summarycxt = AllocSetContextCreate(TopMemoryContext,
+									   "WAL summary",
+									   ALLOCSET_DEFAULT_SIZES);
+	blocks = blockhash_create(summarycxt, 1024, NULL);
+
+	for (;;)
+	{
+		XLogRecord *record;
+		char	   *errormsg = NULL;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		while (XLogReadRecord(reader, &record, &errormsg) == XLREAD_NEED_DATA)
+		{
+			if (!walsummary_read_page(reader))
+				break;
+		}
+
+		if (record == NULL)
+		{
+			if (errormsg)
+				ereport(ERROR,
+						(errmsg("could not read WAL at %X/%X: %s",
+								LSN_FORMAT_ARGS(reader->EndRecPtr), errormsg)));
+			else
+				ereport(ERROR,
+						(errmsg("could not read WAL at %X/%X",
+								LSN_FORMAT_ARGS(reader->EndRecPtr))));
+		}
+
+		if (walsummary_process_record(reader, blocks) ||
+			blocks->members >= WALSUMMARY_MAX_ENTRIES)
+		{
+			walsummary_write(blocks, start_lsn, reader->EndRecPtr);
+			start_lsn = reader->EndRecPtr;
+
+			MemoryContextReset(summarycxt);
+			blocks = blockhash_create(summarycxt, 1024, NULL);
+		}
+	}
+}
+
+/*
+ * Page read callback.
+ *
+ * read_local_xlog_page() polls for new WAL every millisecond, which would
+ * keep an otherwise idle server busy, so wait on our latch with a longer
+ * timeout until the requested data has been flushed (or replayed).
+ */
+static bool
+walsummary_read_page(XLogReaderState *reader)
+{
+	XLogRecPtr	loc = reader->readPagePtr + reader->reqLen;
+
+	for (;;)
+	{
+		XLogRecPtr	available;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (!RecoveryInProgress())
+			available = GetFlushRecPtr();
+		else
+			available = GetXLogReplayRecPtr(NULL);
+		if (loc <= available)
+			break;
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 WALSUMMARY_NAPTIME_MS,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+	}
+
+	return read_local_xlog_page(reader);
+}
+
+/*
+ * Add the blocks modified by one WAL record to the summary.
+ *
+ * Returns true if the record is a checkpoint, so that the current summary
+ * should be written out.
+ */
+static bool
+walsummary_process_record(XLogReaderState *reader, blockhash_hash *blocks)
+{
+	uint8		info = XLogRecGetInfo(reader) & ~XLR_INFO_MASK;
+
+	for (int block_id = 0; block_id <= XLogRecMaxBlockId(reader); block_id++)
+	{
+		RelFileNode rnode;
+		ForkNumber	forknum;
+		BlockNumber blkno;
+
+		if (!XLogRecGetBlockTag(reader, block_id, &rnode, &forknum, &blkno))
+			continue;
+		walsummary_add(blocks, &rnode, forknum, blkno);
+	}
+
+	/*
+	 * Records that change the size of a fork, or the contents of a whole
+	 * database directory, without referencing individual blocks.
+	 */
+	switch (XLogRecGetRmid(reader))
+	{
+		case RM_SMGR_ID:
+			if (info == XLOG_SMGR_CREATE)
+			{
+				xl_smgr_create *xlrec = (xl_smgr_create *) XLogRecGetData(reader);
+
+				walsummary_add(blocks, &xlrec->rnode, xlrec->forkNum,
+							   InvalidBlockNumber);
+			}
+			else if (info == XLOG_SMGR_TRUNCATE)
+			{
+				xl_smgr_truncate *xlrec = (xl_smgr_truncate *) XLogRecGetData(reader);
+
+				if (xlrec->flags & SMGR_TRUNCATE_HEAP)
+					walsummary_add(blocks, &xlrec->rnode, MAIN_FORKNUM,
+								   InvalidBlockNumber);
+				if (xlrec->flags & SMGR_TRUNCATE_FSM)
+					walsummary_add(blocks, &xlrec->rnode, FSM_FORKNUM,
+								   InvalidBlockNumber);
+				if (xlrec->flags & SMGR_TRUNCATE_VM)
+					walsummary_add(blocks, &xlrec->rnode, VISIBILITYMAP_FORKNUM,
+								   InvalidBlockNumber);
+			}
+			break;
+
+		case RM_DBASE_ID:
+			if (info == XLOG_DBASE_CREATE)
+			{
+				xl_dbase_create_rec *xlrec = (xl_dbase_create_rec *) XLogRecGetData(reader);
+				RelFileNode rnode;
+
+				rnode.spcNode = xlrec->tablespace_id;
+				rnode.dbNode = xlrec->db_id;
+				rnode.relNode = InvalidOid;
+				walsummary_add(blocks, &rnode, InvalidForkNumber,
+							   InvalidBlockNumber);
+			}
+			else if (info == XLOG_DBASE_DROP)
+			{
+				xl_dbase_drop_rec *xlrec = (xl_dbase_drop_rec *) XLogRecGetData(reader);
+
+				for (int i = 0; i < xlrec->ntablespaces; i++)
+				{
+					RelFileNode rnode;
+
+					rnode.spcNode = xlrec->tablespace_ids[i];
+					rnode.dbNode = xlrec->db_id;
+					rnode.relNode = InvalidOid;
+					walsummary_add(blocks, &rnode, InvalidForkNumber,
+								   InvalidBlockNumber);
+				}
+			}
+			break;
+
+		case RM_XLOG_ID:
+			if (info == XLOG_CHECKPOINT_SHUTDOWN ||
+				info == XLOG_CHECKPOINT_ONLINE)
+				return true;
+			break;
+	}
+
+	return false;
+}
+
+/*
+ * Remember that a block, fork or database was modified.
+ */
+static void
+walsummary_add(blockhash_hash *blocks, const RelFileNode *rnode,
+			   ForkNumber forknum, BlockNumber blkno)
+{
+	WalSummaryEntry key;
+	bool		found;
+
+	/* Zero the whole key, since it is hashed and compared as bytes */
+	memset(&key, 0, sizeof(key));
+	key.rnode = *rnode;
+	key.forknum = forknum;
+	key.blkno = blkno;
+
+	(void) blockhash_insert(blocks, key, &found);
+}
+
+/*
+ * Write the summary of the WAL between start_lsn and end_lsn to disk.
+ *
+ * The file is written under a temporary name and renamed into place, so
+ * that readers only ever see complete summaries.
+ */
+static void
+walsummary_write(blockhash_hash *blocks, XLogRecPtr start_lsn,
+				 XLogRecPtr end_lsn)
+{
+	char		path[MAXPGPATH];
+	char		tmppath[MAXPGPATH];
+	WalSummaryFileHeader hdr;
+	WalSummaryEntry *entries;
+	uint32		nentries;
+	size_t		len;
+	int			fd;
+
+	entries = walsummary_sorted_entries(blocks, &nentries);
+	len = sizeof(WalSummaryEntry) * nentries;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = WALSUMMARY_MAGIC;
+	hdr.nentries = nentries;
+	hdr.start_lsn = start_lsn;
+	hdr.end_lsn = end_lsn;
+	INIT_CRC32C(hdr.crc);
+	COMP_CRC32C(hdr.crc, entries, len);
+	FIN_CRC32C(hdr.crc);
+
+	walsummary_file_path(path, start_lsn, end_lsn);
+	snprintf(tmppath, MAXPGPATH, "%s.tmp", path);
+
+	fd = OpenTransientFile(tmppath, O_RDWR | O_CREAT | O_TRUNC | PG_BINARY);
+	if (fd < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create file \"%s\": %m", tmppath)));
+
+	errno = 0;
+	if (write(fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+		(len > 0 && write(fd, entries, len) != len))
+	{
+		/* if write didn't set errno, assume problem is no disk space */
+		if (errno == 0)
+			errno = ENOSPC;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m", tmppath)));
+	}
+
+	if (pg_fsync(fd) != 0)
+		ereport(data_sync_elevel(ERROR),
+				(errcode_for_file_access(),
+				 errmsg("could not fsync file \"%s\": %m", tmppath)));
+
+	if (CloseTransientFile(fd) != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not close file \"%s\": %m", tmppath)));
+
+	(void) durable_rename(tmppath, path, ERROR);
+
+	ereport(DEBUG1,
+			(errmsg_internal("wrote WAL summary from %X/%X to %X/%X with %u entries",
+							 LSN_FORMAT_ARGS(start_lsn),
+							 LSN_FORMAT_ARGS(end_lsn), nentries)));
+
+	pfree(entries);
+}
+
+/*
+ * Return a list of all summary files, ordered by start LSN.
+ */
+static List *
+walsummary_get_files(void)
+{
+	List	   *result = NIL;
+	DIR		   *dir;
+	struct dirent *de;
+
+	dir = AllocateDir(WALSUMMARY_DIR);
+	if (dir == NULL && errno == ENOENT)
+		return NIL;
+
+	while ((de = ReadDir(dir, WALSUMMARY_DIR)) != NULL)
+	{
+		WalSummaryFile *file;
+		uint32		start_hi,
+					start_lo,
+					end_hi,
+					end_lo;
+
+		if (strlen(de->d_name) != WALSUMMARY_FNAME_LEN ||
+			strspn(de->d_name, "0123456789ABCDEF") != 32 ||
+			strcmp(de->d_name + 32, ".summary") != 0)
+			continue;
+
+		if (sscanf(de->d_name, "%08X%08X%08X%08X",
+				   &start_hi, &start_lo, &end_hi, &end_lo) != 4)
+			continue;
+
+		file = (WalSummaryFile *) palloc(sizeof(WalSummaryFile));
+		file->start_lsn = ((uint64) start_hi) << 32 | start_lo;
+		file->end_lsn = ((uint64) end_hi) << 32 | end_lo;
+		result = lappend(result, file);
+	}
+	FreeDir(dir);
+
+	list_sort(result, walsummary_file_cmp);
+
+	return result;
+}
+
+/*
+ * Read a summary file, verifying its header and checksum.
+ *
+ * Returns the entries, or NULL if read_entries is false.  The number of
+ * entries is returned in *nentries either way.
+ */
+static WalSummaryEntry *
+walsummary_read_file(WalSummaryFile *file, bool read_entries,
+					 uint32 *nentries)
+{
+	char		path[MAXPGPATH];
+	WalSummaryFileHeader hdr;
+	WalSummaryEntry *entries = NULL;
+	int			fd;
+	int			r;
+
+	walsummary_file_path(path, file->start_lsn, file->end_lsn);
+
+	fd = OpenTransientFile(path, O_RDONLY | PG_BINARY);
+	if (fd < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", path)));
+
+	r = read(fd, &hdr, sizeof(hdr));
+	if (r != sizeof(hdr))
+	{
+		if (r < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m", path)));
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("could not read file \"%s\": read %d of %zu",
+							path, r, sizeof(hdr))));
+	}
+
+	if (hdr.magic != WALSUMMARY_MAGIC ||
+		hdr.start_lsn != file->start_lsn ||
+		hdr.end_lsn != file->end_lsn)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid WAL summary file \"%s\"", path)));
+
+	if (read_entries)
+	{
+		size_t		len = sizeof(WalSummaryEntry) * hdr.nentries;
+		pg_crc32c	crc;
+
+		entries = (WalSummaryEntry *) palloc_extended(Max(len, 1),
+													  MCXT_ALLOC_HUGE);
+		r = read(fd, entries, len);
+		if (r != len)
+		{
+			if (r < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read file \"%s\": %m", path)));
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("could not read file \"%s\": read %d of %zu",
+								path, r, len)));
+		}
+
+		INIT_CRC32C(crc);
+		COMP_CRC32C(crc, entries, len);
+		FIN_CRC32C(crc);
+		if (!EQ_CRC32C(crc, hdr.crc))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("calculated CRC checksum does not match value stored in file \"%s\"",
+							path)));
+	}
+
+	if (CloseTransientFile(fd) != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not close file \"%s\": %m", path)));
+
+	*nentries = hdr.nentries;
+	return entries;
+}
+
+/*
+ * Return the contents of a hash table as a sorted array.
+ */
+static WalSummaryEntry *
+walsummary_sorted_entries(blockhash_hash *blocks, uint32 *nentries)
+{
+	WalSummaryEntry *entries;
+	blockhash_iterator it;
+	WalSummaryHashEntry *entry;
+	uint32		n = 0;
+
+	entries = (WalSummaryEntry *)
+		palloc_extended(sizeof(WalSummaryEntry) * Max(blocks->members, 1),
+						MCXT_ALLOC_HUGE);
+
+	blockhash_start_iterate(blocks, &it);
+	while ((entry = blockhash_iterate(blocks, &it)) != NULL)
+		entries[n++] = entry->key;
+
+	qsort(entries, n, sizeof(WalSummaryEntry), walsummary_entry_cmp);
+
+	*nentries = n;
+	return entries;
+}
+
+/*
+ * Construct the path of the summary file for a range of WAL.
+ */
+static void
+walsummary_file_path(char *path, XLogRecPtr start_lsn, XLogRecPtr end_lsn)
+{
+	snprintf(path, MAXPGPATH, WALSUMMARY_DIR "/%08X%08X%08X%08X.summary",
+			 LSN_FORMAT_ARGS(start_lsn), LSN_FORMAT_ARGS(end_lsn));
+}
+
+/*
+ * list_sort comparator for WalSummaryFiles
+ */
+static int
+walsummary_file_cmp(const ListCell *a, const ListCell *b)
+{
+	WalSummaryFile *fa = (WalSummaryFile *) lfirst(a);
+	WalSummaryFile *fb = (WalSummaryFile *) lfirst(b);
+
+	if (fa->start_lsn != fb->start_lsn)
+		return (fa->start_lsn < fb->start_lsn) ? -1 : 1;
+	if (fa->end_lsn != fb->end_lsn)
+		return (fa->end_lsn < fb->end_lsn) ? -1 : 1;
+	return 0;
+}
+
+/*
+ * qsort comparator for WalSummaryEntries: by relation, then fork, then block
+ */
+static int
+walsummary_entry_cmp(const void *a, const void *b)
+{
+	const WalSummaryEntry *ea = (const WalSummaryEntry *) a;
+	const WalSummaryEntry *eb = (const WalSummaryEntry *) b;
+
+	if (ea->rnode.spcNode != eb->rnode.spcNode)
+		return (ea->rnode.spcNode < eb->rnode.spcNode) ? -1 : 1;
+	if (ea->rnode.dbNode != eb->rnode.dbNode)
+		return (ea->rnode.dbNode < eb->rnode.dbNode) ? -1 : 1;
+	if (ea->rnode.relNode != eb->rnode.relNode)
+		return (ea->rnode.relNode < eb->rnode.relNode) ? -1 : 1;
+	if (ea->forknum != eb->forknum)
+		return (ea->forknum < eb->forknum) ? -1 : 1;
+	if (ea->blkno != eb->blkno)
+		return (ea->blkno < eb->blkno) ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Set up a materialized set-returning function call.
+ */
+static Tuplestorestate *
+walsummary_init_srf(FunctionCallInfo fcinfo, TupleDesc *tupdesc)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = *tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return tupstore;
+}
+
+/* Number of output arguments (columns) for pg_walsummary_list */
+#define PG_WALSUMMARY_LIST_COLS		3
+
+/*
+ * List the available summaries.
+ */
+Datum
+pg_walsummary_list(PG_FUNCTION_ARGS)
+{
+	Tuplestorestate *tupstore;
+	TupleDesc	tupdesc;
+	ListCell   *lc;
+
+	tupstore = walsummary_init_srf(fcinfo, &tupdesc);
+
+	foreach(lc, walsummary_get_files())
+	{
+		WalSummaryFile *file = (WalSummaryFile *) lfirst(lc);
+		Datum		values[PG_WALSUMMARY_LIST_COLS];
+		bool		nulls[PG_WALSUMMARY_LIST_COLS];
+		uint32		nentries;
+
+		(void) walsummary_read_file(file, false, &nentries);
+
+		memset(nulls, 0, sizeof(nulls));
+		values[0] = LSNGetDatum(file->start_lsn);
+		values[1] = LSNGetDatum(file->end_lsn);
+		values[2] = Int64GetDatum((int64) nentries);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
+/* Number of output arguments (columns) for pg_walsummary_blocks */
+#define PG_WALSUMMARY_BLOCKS_COLS	5
+
+/*
+ * Return the blocks modified between two LSNs, according to the summaries.
+ *
+ * Summaries are not split, so the result can include blocks that were only
+ * modified slightly before or after the requested range.  It is an error if
+ * the summaries do not cover the whole range.
+ */
+Datum
+pg_walsummary_blocks(PG_FUNCTION_ARGS)
+{
+	XLogRecPtr	start_lsn = PG_GETARG_LSN(0);
+	XLogRecPtr	end_lsn = PG_GETARG_LSN(1);
+	XLogRecPtr	covered = start_lsn;
+	Tuplestorestate *tupstore;
+	TupleDesc	tupdesc;
+	blockhash_hash *blocks;
+	WalSummaryEntry *entries;
+	uint32		nentries;
+	ListCell   *lc;
+
+	if (start_lsn > end_lsn)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("WAL start location must be less than or equal to end location")));
+
+	tupstore = walsummary_init_srf(fcinfo, &tupdesc);
+
+	if (start_lsn == end_lsn)
+	{
+		tuplestore_donestoring(tupstore);
+		return (Datum) 0;
+	}
+
+	/* Merge all summaries overlapping the range, checking for gaps */
+	blocks = blockhash_create(CurrentMemoryContext, 1024, NULL);
+	foreach(lc, walsummary_get_files())
+	{
+		WalSummaryFile *file = (WalSummaryFile *) lfirst(lc);
+
+		if (file->end_lsn <= covered)
+			continue;
+		if (file->start_lsn > covered)
+			break;
+
+		entries = walsummary_read_file(file, true, &nentries);
+		for (uint32 i = 0; i < nentries; i++)
+		{
+			bool		found;
+
+			(void) blockhash_insert(blocks, entries[i], &found);
+		}
+		pfree(entries);
+
+		covered = file->end_lsn;
+		if (covered >= end_lsn)
+			break;
+	}
+
+	if (covered < end_lsn)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("WAL summaries do not cover the range from %X/%X to %X/%X",
+						LSN_FORMAT_ARGS(start_lsn), LSN_FORMAT_ARGS(end_lsn)),
+				 errdetail("No summary is available for WAL starting at %X/%X.",
+						   LSN_FORMAT_ARGS(covered)),
+				 errhint("Summaries are written at each checkpoint by the WAL summarizer.")));
+
+	entries = walsummary_sorted_entries(blocks, &nentries);
+	for (uint32 i = 0; i < nentries; i++)
+	{
+		WalSummaryEntry *entry = &entries[i];
+		Datum		values[PG_WALSUMMARY_BLOCKS_COLS];
+		bool		nulls[PG_WALSUMMARY_BLOCKS_COLS];
+
+		memset(values, 0, sizeof(values));
+		memset(nulls, 0, sizeof(nulls));
+
+		values[0] = ObjectIdGetDatum(entry->rnode.spcNode);
+		values[1] = ObjectIdGetDatum(entry->rnode.dbNode);
+		if (OidIsValid(entry->rnode.relNode))
+			values[2] = ObjectIdGetDatum(entry->rnode.relNode);
+		else
+			nulls[2] = true;
+		if (entry->forknum != InvalidForkNumber)
+			values[3] = Int16GetDatum((int16) entry->forknum);
+		else
+			nulls[3] = true;
+		if (entry->blkno != InvalidBlockNumber)
+			values[4] = Int64GetDatum((int64) entry->blkno);
+		else
+			nulls[4] = true;
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
+/*
+ * Remove the summaries that end at or before the given LSN.
+ *
+ * Returns the number of files removed.
+ */
+Datum
+pg_walsummary_remove(PG_FUNCTION_ARGS)
+{
+	XLogRecPtr	upto = PG_GETARG_LSN(0);
+	int32		nremoved = 0;
+	ListCell   *lc;
+
+	foreach(lc, walsummary_get_files())
+	{
+		WalSummaryFile *file = (WalSummaryFile *) lfirst(lc);
+		char		path[MAXPGPATH];
+
+		if (file->end_lsn > upto)
+			continue;
+
+		walsummary_file_path(path, file->start_lsn, file->end_lsn);
+		if (unlink(path) != 0 && errno != ENOENT)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not remove file \"%s\": %m", path)));
+		nremoved++;
+	}
+
+	PG_RETURN_INT32(nremoved);
+}
@@ -0,0 +1,46 @@
+CREATE EXTENSION pg_walsummary;
+
+CREATE TABLE walsummary_test (a int);
+CREATE TEMP TABLE lsns AS SELECT pg_current_wal_insert_lsn() AS start_lsn;
+INSERT INTO walsummary_test SELECT generate_series(1, 1000);
+ALTER TABLE lsns ADD COLUMN end_lsn pg_lsn;
+UPDATE lsns SET end_lsn = pg_current_wal_insert_lsn();
+CHECKPOINT;
+
+-- wait for the summarizer to write a summary covering the inserts
+DO $$
+BEGIN
+  FOR i IN 1..600 LOOP
+    EXIT WHEN EXISTS (SELECT 1 FROM pg_walsummary_list() s, lsns
+                      WHERE s.end_lsn >= lsns.end_lsn);
+    PERFORM pg_sleep(0.1);
+  END LOOP;
+END
+$$;
+
+-- every block of the table was modified by the inserts
+SELECT count(*) = pg_relation_size('walsummary_test') /
+       current_setting('block_size')::int AS ok
+  FROM pg_walsummary_blocks((SELECT start_lsn FROM lsns),
+                            (SELECT end_lsn FROM lsns))
+ WHERE relfilenode = pg_relation_filenode('walsummary_test')
+   AND relforknumber = 0 AND relblocknumber IS NOT NULL;
+
+-- summaries are contiguous
+SELECT count(*) AS gaps
+  FROM (SELECT start_lsn, lag(end_lsn) OVER (ORDER BY start_lsn) AS prev_end
+          FROM pg_walsummary_list()) s
+ WHERE start_lsn <> prev_end;
+
+-- nothing to return for an empty range
+SELECT count(*) FROM pg_walsummary_blocks('0/1', '0/1');
+
+\set VERBOSITY terse
+SELECT * FROM pg_walsummary_blocks('0/2', '0/1');
+SELECT * FROM pg_walsummary_blocks('0/1', '0/2');
+\set VERBOSITY default
+
+SELECT pg_walsummary_remove('0/1');
+
+DROP TABLE walsummary_test;
+DROP EXTENSION pg_walsummary;
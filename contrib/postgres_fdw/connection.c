@@ -100,6 +100,7 @@ static void pgfdw_subxact_callback(SubXactEvent event,
 								   void *arg);
 static void pgfdw_inval_callback(Datum arg, int cacheid, uint32 hashvalue);
 static void pgfdw_reject_incomplete_xact_state_change(ConnCacheEntry *entry);
+static void pgfdw_wait_while_busy(PGconn *conn, const char *query);
 static bool pgfdw_cancel_query(PGconn *conn);
 static bool pgfdw_exec_cleanup_query(PGconn *conn, const char *query,
 									 bool ignore_errors);
@@ -201,9 +202,11 @@ GetConnection(UserMapping *user, bool will_prep_stmt, PgFdwConnState **state)
 	 */
 	PG_TRY();
 	{
-		/* Process a pending asynchronous request if any. */
+		/* Process a pending asynchronous request or fetch if any. */
 		if (entry->state.pendingAreq)
 			process_pending_request(entry->state.pendingAreq);
+		if (entry->state.pendingFetch)
+			process_pending_fetch(entry->state.pendingFetch);
 		/* Start a new transaction or subtransaction if needed. */
 		begin_remote_xact(entry);
 	}
@@ -684,9 +687,11 @@ GetPrepStmtNumber(PGconn *conn)
 PGresult *
 pgfdw_exec_query(PGconn *conn, const char *query, PgFdwConnState *state)
 {
-	/* First, process a pending asynchronous request, if any. */
+	/* First, process a pending asynchronous request or fetch, if any. */
 	if (state && state->pendingAreq)
 		process_pending_request(state->pendingAreq);
+	if (state && state->pendingFetch)
+		process_pending_fetch(state->pendingFetch);
 
 	/*
 	 * Submit a query.  Since we don't use non-blocking mode, this also can
@@ -721,27 +726,7 @@ pgfdw_get_result(PGconn *conn, const char *query)
 		{
 			PGresult   *res;
 
-			while (PQisBusy(conn))
-			{
-				int			wc;
-
-				/* Sleep until there's something to do */
-				wc = WaitLatchOrSocket(MyLatch,
-									   WL_LATCH_SET | WL_SOCKET_READABLE |
-									   WL_EXIT_ON_PM_DEATH,
-									   PQsocket(conn),
-									   -1L, PG_WAIT_EXTENSION);
-				ResetLatch(MyLatch);
-
-				CHECK_FOR_INTERRUPTS();
-
-				/* Data available in socket? */
-				if (wc & WL_SOCKET_READABLE)
-				{
-					if (!PQconsumeInput(conn))
-						pgfdw_report_error(ERROR, NULL, conn, false, query);
-				}
-			}
+			pgfdw_wait_while_busy(conn, query);
 
 			res = PQgetResult(conn);
 			if (res == NULL)
@@ -761,6 +746,81 @@ pgfdw_get_result(PGconn *conn, const char *query)
 	return last_res;
 }
 
+/*
+ * Wait for the response to a COPY FROM STDIN command sent by a prior
+ * asynchronous execution function call.
+ *
+ * This returns the PGRES_COPY_IN result once the remote server is ready to
+ * accept data, or else the error that prevented it.  pgfdw_get_result()
+ * can't be used for this, since PQgetResult() doesn't return NULL until the
+ * copy is over.
+ *
+ * Caller is responsible for the error handling on the result.
+ */
+PGresult *
+pgfdw_get_copy_in_result(PGconn *conn, const char *query)
+{
+	PGresult   *volatile res = NULL;
+
+	/* In what follows, do not leak any PGresults on an error. */
+	PG_TRY();
+	{
+		pgfdw_wait_while_busy(conn, query);
+
+		res = PQgetResult(conn);
+		if (PQresultStatus(res) != PGRES_COPY_IN)
+		{
+			PGresult   *rest;
+
+			/* Absorb any further results, leaving the connection idle */
+			rest = pgfdw_get_result(conn, query);
+			if (res == NULL)
+				res = rest;
+			else
+				PQclear(rest);
+		}
+	}
+	PG_CATCH();
+	{
+		PQclear(res);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	return res;
+}
+
+/*
+ * Wait until a result can be read from the connection without blocking.
+ *
+ * This function offers quick responsiveness by checking for any interruptions.
+ */
+static void
+pgfdw_wait_while_busy(PGconn *conn, const char *query)
+{
+	while (PQisBusy(conn))
+	{
+		int			wc;
+
+		/* Sleep until there's something to do */
+		wc = WaitLatchOrSocket(MyLatch,
+							   WL_LATCH_SET | WL_SOCKET_READABLE |
+							   WL_EXIT_ON_PM_DEATH,
+							   PQsocket(conn),
+							   -1L, PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* Data available in socket? */
+		if (wc & WL_SOCKET_READABLE)
+		{
+			if (!PQconsumeInput(conn))
+				pgfdw_report_error(ERROR, NULL, conn, false, query);
+		}
+	}
+}
+
 /*
  * Report an error we got from the remote server.
  *
@@ -117,6 +117,7 @@ typedef struct deparse_expr_cxt
 static bool foreign_expr_walker(Node *node,
 								foreign_glob_cxt *glob_cxt,
 								foreign_loc_cxt *outer_cxt);
+static bool partial_agg_ok(Aggref *agg);
 static char *deparse_type_name(Oid type_oid, int32 typemod);
 
 /*
@@ -705,8 +706,14 @@ foreign_expr_walker(Node *node,
 				if (!IS_UPPER_REL(glob_cxt->foreignrel))
 					return false;
 
-				/* Only non-split aggregates are pushable. */
-				if (agg->aggsplit != AGGSPLIT_SIMPLE)
+				/*
+				 * Only non-split aggregates are pushable, except that the
+				 * partial aggregation step can be sent when the remote
+				 * aggregate's result is the transition state we need.
+				 */
+				if (agg->aggsplit != AGGSPLIT_SIMPLE &&
+					!(agg->aggsplit == AGGSPLIT_INITIAL_SERIAL &&
+					  partial_agg_ok(agg)))
 					return false;
 
 				/* As usual, it must be shippable. */
@@ -910,6 +917,40 @@ is_foreign_param(PlannerInfo *root,
 	return false;
 }
 
+/*
+ * Can the partial aggregation step of the given aggregate be done by running
+ * the aggregate itself on the remote server?
+ *
+ * That's the case if the aggregate has no final function, so that its result
+ * is its transition state, and a combine function to merge the states
+ * returned by different servers or partitions.  count(), sum() of integers
+ * and floats, min() and max() qualify, but for instance avg() doesn't.
+ */
+static bool
+partial_agg_ok(Aggref *agg)
+{
+	HeapTuple	tuple;
+	Form_pg_aggregate aggform;
+	bool		result;
+
+	/* The planner doesn't split aggregates needing DISTINCT or ORDER BY */
+	Assert(agg->aggdistinct == NIL && agg->aggorder == NIL);
+
+	tuple = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(agg->aggfnoid));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for aggregate %u", agg->aggfnoid);
+	aggform = (Form_pg_aggregate) GETSTRUCT(tuple);
+
+	result = (aggform->aggkind == AGGKIND_NORMAL &&
+			  !OidIsValid(aggform->aggfinalfn) &&
+			  OidIsValid(aggform->aggcombinefn) &&
+			  agg->aggtranstype != INTERNALOID);
+
+	ReleaseSysCache(tuple);
+
+	return result;
+}
+
 /*
  * Convert type OID + typmod info into a type name we can ship to the remote
  * server.  Someplace else had better have verified that this type name is
@@ -1816,6 +1857,43 @@ rebuildInsertSql(StringInfo buf, char *orig_query,
 	appendStringInfoString(buf, orig_query + values_end_len);
 }
 
+/*
+ * deparse remote COPY FROM STDIN statement
+ *
+ * This is an alternative to the INSERT statement built by deparseInsertSql,
+ * used for batch inserts when the INSERT has no ON CONFLICT or RETURNING
+ * clause.  The rows are to be sent in text format, with the columns
+ * listed in targetAttrs.
+ */
+void
+deparseCopyFromSql(StringInfo buf, RangeTblEntry *rte,
+				   Index rtindex, Relation rel,
+				   List *targetAttrs)
+{
+	bool		first;
+	ListCell   *lc;
+
+	Assert(targetAttrs != NIL);
+
+	appendStringInfoString(buf, "COPY ");
+	deparseRelation(buf, rel);
+	appendStringInfoChar(buf, '(');
+
+	first = true;
+	foreach(lc, targetAttrs)
+	{
+		int			attnum = lfirst_int(lc);
+
+		if (!first)
+			appendStringInfoString(buf, ", ");
+		first = false;
+
+		deparseColumnRef(buf, rtindex, attnum, rte, false);
+	}
+
+	appendStringInfoString(buf, ") FROM STDIN");
+}
+
 /*
  * deparse remote UPDATE statement
  *
@@ -3046,8 +3124,12 @@ deparseAggref(Aggref *node, deparse_expr_cxt *context)
 	StringInfo	buf = context->buf;
 	bool		use_variadic;
 
-	/* Only basic, non-split aggregation accepted. */
-	Assert(node->aggsplit == AGGSPLIT_SIMPLE);
+	/*
+	 * Only basic, non-split aggregation accepted, or partial aggregation of
+	 * aggregates for which that's the same thing; see partial_agg_ok().
+	 */
+	Assert(node->aggsplit == AGGSPLIT_SIMPLE ||
+		   node->aggsplit == AGGSPLIT_INITIAL_SERIAL);
 
 	/* Check if need to print VARIADIC (cf. ruleutils.c) */
 	use_variadic = node->aggvariadic;
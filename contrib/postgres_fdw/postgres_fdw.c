@@ -60,6 +60,9 @@ PG_MODULE_MAGIC;
 /* If no remote estimates, assume a sort costs 20% extra */
 #define DEFAULT_FDW_SORT_MULTIPLIER 1.2
 
+/* Amount of COPY data to collect before passing it to libpq */
+#define COPY_DATA_CHUNK_SIZE 65536
+
 /*
  * Indexes of FDW-private information stored in fdw_private lists.
  *
@@ -75,6 +78,8 @@ enum FdwScanPrivateIndex
 	FdwScanPrivateRetrievedAttrs,
 	/* Integer representing the desired fetch_size */
 	FdwScanPrivateFetchSize,
+	/* Boolean flag showing whether to fetch ahead (as an Integer node) */
+	FdwScanPrivateFetchAhead,
 
 	/*
 	 * String describing join i.e. names of relations being joined and types
@@ -166,8 +171,15 @@ typedef struct PgFdwScanState
 	/* for asynchronous execution */
 	bool		async_capable; 	/* engage asynchronous-capable logic? */
 
+	/* for fetching ahead in synchronous mode */
+	bool		fetch_ahead;	/* send next FETCH before it's needed? */
+	bool		prefetch_ready; /* is a collected batch waiting for us? */
+	HeapTuple  *prefetch_tuples;	/* array of tuples in that batch */
+	int			prefetch_num_tuples;	/* # of tuples in array */
+
 	/* working memory contexts */
 	MemoryContext batch_cxt;	/* context holding current batch of tuples */
+	MemoryContext prefetch_cxt; /* context holding collected next batch */
 	MemoryContext temp_cxt;		/* context for per-tuple temporary data */
 
 	int			fetch_size;		/* number of tuples per fetch */
@@ -192,6 +204,7 @@ typedef struct PgFdwModifyState
 	List	   *target_attrs;	/* list of target attribute numbers */
 	int			values_end;		/* length up to the end of VALUES */
 	int			batch_size;		/* value of FDW option "batch_size" */
+	char	   *copy_query;		/* COPY command to use for batches, or NULL */
 	bool		has_returning;	/* is there a RETURNING clause? */
 	List	   *retrieved_attrs;	/* attr numbers retrieved by RETURNING */
 
@@ -455,6 +468,9 @@ static bool ec_member_matches_foreign(PlannerInfo *root, RelOptInfo *rel,
 									  void *arg);
 static void create_cursor(ForeignScanState *node);
 static void fetch_more_data(ForeignScanState *node);
+static int	fetch_next_batch(ForeignScanState *node, MemoryContext cxt,
+							 HeapTuple **tuples);
+static void fetch_more_data_ahead(ForeignScanState *node);
 static void close_cursor(PGconn *conn, unsigned int cursor_number,
 						 PgFdwConnState *conn_state);
 static PgFdwModifyState *create_foreign_modify(EState *estate,
@@ -482,6 +498,12 @@ static void store_returning_result(PgFdwModifyState *fmstate,
 								   TupleTableSlot *slot, PGresult *res);
 static void finish_foreign_modify(PgFdwModifyState *fmstate);
 static void deallocate_query(PgFdwModifyState *fmstate);
+static void setup_foreign_copy(PgFdwModifyState *fmstate,
+							   RangeTblEntry *rte, Index rtindex,
+							   bool doNothing);
+static int	execute_foreign_copy(PgFdwModifyState *fmstate,
+								 TupleTableSlot **slots, int numSlots);
+static void append_copy_text_value(StringInfo buf, const char *value);
 static List *build_remote_returning(Index rtindex, Relation rel,
 									List *returningList);
 static void rebuild_fdw_scan_tlist(ForeignScan *fscan, List *tlist);
@@ -547,6 +569,7 @@ static void merge_fdw_options(PgFdwRelationInfo *fpinfo,
 							  const PgFdwRelationInfo *fpinfo_o,
 							  const PgFdwRelationInfo *fpinfo_i);
 static int get_batch_size_option(Relation rel);
+static bool get_batch_with_copy_option(Relation rel);
 
 
 /*
@@ -648,8 +671,8 @@ postgresGetForeignRelSize(PlannerInfo *root,
 
 	/*
 	 * Extract user-settable option values.  Note that per-table settings of
-	 * use_remote_estimate, fetch_size and async_capable override per-server
-	 * settings of them, respectively.
+	 * use_remote_estimate, fetch_size, async_capable and fetch_ahead override
+	 * per-server settings of them, respectively.
 	 */
 	fpinfo->use_remote_estimate = false;
 	fpinfo->fdw_startup_cost = DEFAULT_FDW_STARTUP_COST;
@@ -657,6 +680,7 @@ postgresGetForeignRelSize(PlannerInfo *root,
 	fpinfo->shippable_extensions = NIL;
 	fpinfo->fetch_size = 100;
 	fpinfo->async_capable = false;
+	fpinfo->fetch_ahead = false;
 
 	apply_server_options(fpinfo);
 	apply_table_options(fpinfo);
@@ -1416,9 +1440,10 @@ postgresGetForeignPlan(PlannerInfo *root,
 	 * Build the fdw_private list that will be available to the executor.
 	 * Items in the list must match order in enum FdwScanPrivateIndex.
 	 */
-	fdw_private = list_make3(makeString(sql.data),
+	fdw_private = list_make4(makeString(sql.data),
 							 retrieved_attrs,
-							 makeInteger(fpinfo->fetch_size));
+							 makeInteger(fpinfo->fetch_size),
+							 makeInteger(fpinfo->fetch_ahead));
 	if (IS_JOIN_REL(foreignrel) || IS_UPPER_REL(foreignrel))
 		fdw_private = lappend(fdw_private,
 							  makeString(fpinfo->relation_name));
@@ -1503,11 +1528,17 @@ postgresBeginForeignScan(ForeignScanState *node, int eflags)
 												 FdwScanPrivateRetrievedAttrs);
 	fsstate->fetch_size = intVal(list_nth(fsplan->fdw_private,
 										  FdwScanPrivateFetchSize));
+	fsstate->fetch_ahead = intVal(list_nth(fsplan->fdw_private,
+										   FdwScanPrivateFetchAhead));
 
 	/* Create contexts for batches of tuples and per-tuple temp workspace. */
 	fsstate->batch_cxt = AllocSetContextCreate(estate->es_query_cxt,
 											   "postgres_fdw tuple data",
 											   ALLOCSET_DEFAULT_SIZES);
+	if (fsstate->fetch_ahead)
+		fsstate->prefetch_cxt = AllocSetContextCreate(estate->es_query_cxt,
+													  "postgres_fdw prefetched tuple data",
+													  ALLOCSET_DEFAULT_SIZES);
 	fsstate->temp_cxt = AllocSetContextCreate(estate->es_query_cxt,
 											  "postgres_fdw temporary data",
 											  ALLOCSET_SMALL_SIZES);
@@ -1607,6 +1638,14 @@ postgresReScanForeignScan(ForeignScanState *node)
 	if (!fsstate->cursor_exists)
 		return;
 
+	/*
+	 * Collect the result of a FETCH sent ahead, if any, so that fetch_ct_2
+	 * reflects how far the cursor has actually advanced.  The batch itself
+	 * is discarded below.
+	 */
+	if (fsstate->conn_state->pendingFetch == node)
+		process_pending_fetch(node);
+
 	/*
 	 * If any internal parameters affecting this node have changed, we'd
 	 * better destroy and recreate the cursor.  Otherwise, rewinding it should
@@ -1646,6 +1685,7 @@ postgresReScanForeignScan(ForeignScanState *node)
 	fsstate->next_tuple = 0;
 	fsstate->fetch_ct_2 = 0;
 	fsstate->eof_reached = false;
+	fsstate->prefetch_ready = false;
 }
 
 /*
@@ -1893,6 +1933,12 @@ postgresBeginForeignModify(ModifyTableState *mtstate,
 									has_returning,
 									retrieved_attrs);
 
+	/* See if batches of rows can be inserted using COPY. */
+	if (mtstate->operation == CMD_INSERT)
+		setup_foreign_copy(fmstate, rte, resultRelInfo->ri_RangeTableIndex,
+						   ((ModifyTable *) mtstate->ps.plan)->onConflictAction ==
+						   ONCONFLICT_NOTHING);
+
 	resultRelInfo->ri_FdwState = fmstate;
 }
 
@@ -2171,6 +2217,9 @@ postgresBeginForeignInsert(ModifyTableState *mtstate,
 									retrieved_attrs != NIL,
 									retrieved_attrs);
 
+	/* See if batches of rows can be inserted using COPY. */
+	setup_foreign_copy(fmstate, rte, resultRelation, doNothing);
+
 	/*
 	 * If the given resultRelInfo already has PgFdwModifyState set, it means
 	 * the foreign table is an UPDATE subplan result rel; in which case, store
@@ -3631,9 +3680,11 @@ create_cursor(ForeignScanState *node)
 	StringInfoData buf;
 	PGresult   *res;
 
-	/* First, process a pending asynchronous request, if any. */
+	/* First, process a pending asynchronous request or fetch, if any. */
 	if (fsstate->conn_state->pendingAreq)
 		process_pending_request(fsstate->conn_state->pendingAreq);
+	if (fsstate->conn_state->pendingFetch)
+		process_pending_fetch(fsstate->conn_state->pendingFetch);
 
 	/*
 	 * Construct array of query parameter values in text format.  We do the
@@ -3688,6 +3739,7 @@ create_cursor(ForeignScanState *node)
 	fsstate->next_tuple = 0;
 	fsstate->fetch_ct_2 = 0;
 	fsstate->eof_reached = false;
+	fsstate->prefetch_ready = false;
 
 	/* Clean up */
 	pfree(buf.data);
@@ -3698,24 +3750,70 @@ create_cursor(ForeignScanState *node)
  */
 static void
 fetch_more_data(ForeignScanState *node)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+
+	if (fsstate->prefetch_ready)
+	{
+		MemoryContext cxt = fsstate->batch_cxt;
+
+		/*
+		 * Somebody else needed the connection while our FETCH was in flight,
+		 * so process_pending_fetch() has already collected the batch.  Just
+		 * switch over to it.
+		 */
+		fsstate->batch_cxt = fsstate->prefetch_cxt;
+		fsstate->prefetch_cxt = cxt;
+		MemoryContextReset(cxt);
+
+		fsstate->tuples = fsstate->prefetch_tuples;
+		fsstate->num_tuples = fsstate->prefetch_num_tuples;
+		fsstate->prefetch_ready = false;
+	}
+	else
+	{
+		/*
+		 * We'll store the tuples in the batch_cxt.  First, flush the previous
+		 * batch.
+		 */
+		fsstate->tuples = NULL;
+		MemoryContextReset(fsstate->batch_cxt);
+		fsstate->num_tuples = fetch_next_batch(node, fsstate->batch_cxt,
+											   &fsstate->tuples);
+	}
+	fsstate->next_tuple = 0;
+
+	/* Must be EOF if we didn't get as many tuples as we asked for. */
+	fsstate->eof_reached = (fsstate->num_tuples < fsstate->fetch_size);
+
+	/* Have the remote server produce the next batch while we use this one. */
+	if (fsstate->fetch_ahead && !fsstate->async_capable &&
+		!fsstate->eof_reached)
+		fetch_more_data_ahead(node);
+}
+
+/*
+ * Get the result of a FETCH on the node's cursor, and convert the rows into
+ * an array of HeapTuples allocated in cxt.  Returns the number of rows.
+ *
+ * If a FETCH has already been sent for the node, asynchronously or by
+ * fetch_more_data_ahead, we collect its result; otherwise we run one now.
+ */
+static int
+fetch_next_batch(ForeignScanState *node, MemoryContext cxt,
+				 HeapTuple **tuples)
 {
 	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
 	PGresult   *volatile res = NULL;
 	MemoryContext oldcontext;
+	int			numrows;
 
-	/*
-	 * We'll store the tuples in the batch_cxt.  First, flush the previous
-	 * batch.
-	 */
-	fsstate->tuples = NULL;
-	MemoryContextReset(fsstate->batch_cxt);
-	oldcontext = MemoryContextSwitchTo(fsstate->batch_cxt);
+	oldcontext = MemoryContextSwitchTo(cxt);
 
 	/* PGresult must be released before leaving this function. */
 	PG_TRY();
 	{
 		PGconn	   *conn = fsstate->conn;
-		int			numrows;
 		int			i;
 
 		if (fsstate->async_capable)
@@ -3734,6 +3832,19 @@ fetch_more_data(ForeignScanState *node)
 			/* Reset per-connection state */
 			fsstate->conn_state->pendingAreq = NULL;
 		}
+		else if (fsstate->conn_state->pendingFetch == node)
+		{
+			/*
+			 * The query was already sent by fetch_more_data_ahead.  Likewise,
+			 * just fetch the result.
+			 */
+			fsstate->conn_state->pendingFetch = NULL;
+
+			res = pgfdw_get_result(conn, fsstate->query);
+			/* On error, report the original query, not the FETCH. */
+			if (PQresultStatus(res) != PGRES_TUPLES_OK)
+				pgfdw_report_error(ERROR, res, conn, false, fsstate->query);
+		}
 		else
 		{
 			char		sql[64];
@@ -3750,15 +3861,13 @@ fetch_more_data(ForeignScanState *node)
 
 		/* Convert the data into HeapTuples */
 		numrows = PQntuples(res);
-		fsstate->tuples = (HeapTuple *) palloc0(numrows * sizeof(HeapTuple));
-		fsstate->num_tuples = numrows;
-		fsstate->next_tuple = 0;
+		*tuples = (HeapTuple *) palloc0(numrows * sizeof(HeapTuple));
 
 		for (i = 0; i < numrows; i++)
 		{
 			Assert(IsA(node->ss.ps.plan, ForeignScan));
 
-			fsstate->tuples[i] =
+			(*tuples)[i] =
 				make_tuple_from_result_row(res, i,
 										   fsstate->rel,
 										   fsstate->attinmeta,
@@ -3770,9 +3879,6 @@ fetch_more_data(ForeignScanState *node)
 		/* Update fetch_ct_2 */
 		if (fsstate->fetch_ct_2 < 2)
 			fsstate->fetch_ct_2++;
-
-		/* Must be EOF if we didn't get as many tuples as we asked for. */
-		fsstate->eof_reached = (numrows < fsstate->fetch_size);
 	}
 	PG_FINALLY();
 	{
@@ -3782,6 +3888,61 @@ fetch_more_data(ForeignScanState *node)
 	PG_END_TRY();
 
 	MemoryContextSwitchTo(oldcontext);
+
+	return numrows;
+}
+
+/*
+ * Send a FETCH for the node's next batch without waiting for the result, so
+ * that the remote server can produce it and ship it while the executor is
+ * still consuming the current batch.  fetch_more_data collects it.
+ *
+ * The connection can have only one command in flight.  If another scan is
+ * already using it that way, we don't bother: the next batch will then simply
+ * be fetched synchronously.
+ */
+static void
+fetch_more_data_ahead(ForeignScanState *node)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+	char		sql[64];
+
+	Assert(fsstate->cursor_exists);
+	Assert(!fsstate->prefetch_ready);
+
+	if (fsstate->conn_state->pendingAreq || fsstate->conn_state->pendingFetch)
+		return;
+
+	/* We will send this query, but not wait for the response. */
+	snprintf(sql, sizeof(sql), "FETCH %d FROM c%u",
+			 fsstate->fetch_size, fsstate->cursor_number);
+
+	if (!PQsendQuery(fsstate->conn, sql))
+		pgfdw_report_error(ERROR, NULL, fsstate->conn, false, fsstate->query);
+
+	/* Remember that the fetch is in process */
+	fsstate->conn_state->pendingFetch = node;
+}
+
+/*
+ * Collect the result of a FETCH sent by fetch_more_data_ahead, because the
+ * connection is needed for something else.  The rows are kept aside until
+ * the node has finished with its current batch.
+ */
+void
+process_pending_fetch(ForeignScanState *node)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+
+	/* The fetch should be currently in-process */
+	Assert(fsstate->conn_state->pendingFetch == node);
+	Assert(!fsstate->prefetch_ready);
+
+	MemoryContextReset(fsstate->prefetch_cxt);
+	fsstate->prefetch_num_tuples = fetch_next_batch(node,
+													fsstate->prefetch_cxt,
+													&fsstate->prefetch_tuples);
+	fsstate->prefetch_ready = true;
 }
 
 /*
@@ -3998,9 +4159,19 @@ execute_foreign_modify(EState *estate,
 		   operation == CMD_UPDATE ||
 		   operation == CMD_DELETE);
 
-	/* First, process a pending asynchronous request, if any. */
+	/* First, process a pending asynchronous request or fetch, if any. */
 	if (fmstate->conn_state->pendingAreq)
 		process_pending_request(fmstate->conn_state->pendingAreq);
+	if (fmstate->conn_state->pendingFetch)
+		process_pending_fetch(fmstate->conn_state->pendingFetch);
+
+	/* Send a batch of rows to insert with COPY, if we can */
+	if (operation == CMD_INSERT && fmstate->copy_query && *numSlots > 1)
+	{
+		n_rows = execute_foreign_copy(fmstate, slots, *numSlots);
+		*numSlots = n_rows;
+		return (n_rows > 0) ? slots : NULL;
+	}
 
 	/*
 	 * If the existing query was deparsed and prepared for a different number
@@ -4092,6 +4263,182 @@ execute_foreign_modify(EState *estate,
 	return (n_rows > 0) ? slots : NULL;
 }
 
+/*
+ * setup_foreign_copy
+ *		Arrange for batches of rows of a foreign insert to be sent using
+ *		COPY FROM STDIN, if the table is configured for that and COPY can do
+ *		what the INSERT statement does
+ *
+ * COPY has no counterpart of ON CONFLICT or RETURNING, and can't insert rows
+ * consisting only of default values.
+ */
+static void
+setup_foreign_copy(PgFdwModifyState *fmstate, RangeTblEntry *rte,
+				   Index rtindex, bool doNothing)
+{
+	StringInfoData sql;
+
+	if (fmstate->batch_size <= 1 || doNothing || fmstate->has_returning ||
+		fmstate->target_attrs == NIL ||
+		!get_batch_with_copy_option(fmstate->rel))
+		return;
+
+	initStringInfo(&sql);
+	deparseCopyFromSql(&sql, rte, rtindex, fmstate->rel, fmstate->target_attrs);
+	fmstate->copy_query = sql.data;
+}
+
+/*
+ * execute_foreign_copy
+ *		Insert a batch of rows using the COPY command set up by
+ *		setup_foreign_copy, and return the number of rows inserted
+ *
+ * Unlike a multi-row INSERT, this doesn't make the remote server parse and
+ * plan a statement with a parameter for every value in the batch.
+ */
+static int
+execute_foreign_copy(PgFdwModifyState *fmstate,
+					 TupleTableSlot **slots, int numSlots)
+{
+	PGconn	   *conn = fmstate->conn;
+	PGresult   *res;
+	int			n_rows;
+
+	if (!PQsendQuery(conn, fmstate->copy_query))
+		pgfdw_report_error(ERROR, NULL, conn, false, fmstate->copy_query);
+
+	/*
+	 * Wait for the remote server to get ready for the data.
+	 *
+	 * We don't use a PG_TRY block here, so be careful not to throw error
+	 * without releasing the PGresult.
+	 */
+	res = pgfdw_get_copy_in_result(conn, fmstate->copy_query);
+	if (PQresultStatus(res) != PGRES_COPY_IN)
+		pgfdw_report_error(ERROR, res, conn, true, fmstate->copy_query);
+	PQclear(res);
+
+	/*
+	 * Until the copy is ended, the connection can't be used for anything
+	 * else, not even for aborting the remote transaction.  So if we fail to
+	 * convert or send the rows, make sure to end the copy before propagating
+	 * the error.
+	 */
+	PG_TRY();
+	{
+		MemoryContext oldcontext;
+		StringInfoData buf;
+		int			nestlevel;
+		int			i;
+
+		oldcontext = MemoryContextSwitchTo(fmstate->temp_cxt);
+		initStringInfo(&buf);
+		nestlevel = set_transmission_modes();
+
+		for (i = 0; i < numSlots; i++)
+		{
+			ListCell   *lc;
+			int			j = 0;
+
+			foreach(lc, fmstate->target_attrs)
+			{
+				int			attnum = lfirst_int(lc);
+				Datum		value;
+				bool		isnull;
+
+				if (j > 0)
+					appendStringInfoChar(&buf, '\t');
+
+				value = slot_getattr(slots[i], attnum, &isnull);
+				if (isnull)
+					appendStringInfoString(&buf, "\\N");
+				else
+					append_copy_text_value(&buf,
+										   OutputFunctionCall(&fmstate->p_flinfo[j],
+															  value));
+				j++;
+			}
+			appendStringInfoChar(&buf, '\n');
+
+			if (buf.len >= COPY_DATA_CHUNK_SIZE || i == numSlots - 1)
+			{
+				if (PQputCopyData(conn, buf.data, buf.len) <= 0)
+					pgfdw_report_error(ERROR, NULL, conn, false,
+									   fmstate->copy_query);
+				resetStringInfo(&buf);
+			}
+		}
+
+		reset_transmission_modes(nestlevel);
+		MemoryContextSwitchTo(oldcontext);
+	}
+	PG_CATCH();
+	{
+		(void) PQputCopyEnd(conn, "aborted because of local error");
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	if (PQputCopyEnd(conn, NULL) <= 0)
+		pgfdw_report_error(ERROR, NULL, conn, false, fmstate->copy_query);
+
+	/*
+	 * Get the result, and check for success.
+	 *
+	 * We don't use a PG_TRY block here, so be careful not to throw error
+	 * without releasing the PGresult.
+	 */
+	res = pgfdw_get_result(conn, fmstate->copy_query);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pgfdw_report_error(ERROR, res, conn, true, fmstate->copy_query);
+	n_rows = atoi(PQcmdTuples(res));
+	PQclear(res);
+
+	MemoryContextReset(fmstate->temp_cxt);
+
+	return n_rows;
+}
+
+/*
+ * Append a column value to a row of COPY data in text format, escaping the
+ * characters that would otherwise be taken as delimiters or escapes.
+ */
+static void
+append_copy_text_value(StringInfo buf, const char *value)
+{
+	const char *start = value;
+	const char *p;
+
+	for (p = value; *p; p++)
+	{
+		char		c;
+
+		switch (*p)
+		{
+			case '\\':
+				c = '\\';
+				break;
+			case '\n':
+				c = 'n';
+				break;
+			case '\r':
+				c = 'r';
+				break;
+			case '\t':
+				c = 't';
+				break;
+			default:
+				continue;
+		}
+
+		appendBinaryStringInfo(buf, start, p - start);
+		appendStringInfoChar(buf, '\\');
+		appendStringInfoChar(buf, c);
+		start = p + 1;
+	}
+	appendBinaryStringInfo(buf, start, p - start);
+}
+
 /*
  * prepare_foreign_modify
  *		Establish a prepared statement for execution of INSERT/UPDATE/DELETE
@@ -4441,9 +4788,11 @@ execute_dml_stmt(ForeignScanState *node)
 	int			numParams = dmstate->numParams;
 	const char **values = dmstate->param_values;
 
-	/* First, process a pending asynchronous request, if any. */
+	/* First, process a pending asynchronous request or fetch, if any. */
 	if (dmstate->conn_state->pendingAreq)
 		process_pending_request(dmstate->conn_state->pendingAreq);
+	if (dmstate->conn_state->pendingFetch)
+		process_pending_fetch(dmstate->conn_state->pendingFetch);
 
 	/*
 	 * Construct array of query parameter values in text format.
@@ -5753,6 +6102,8 @@ apply_server_options(PgFdwRelationInfo *fpinfo)
 			fpinfo->fetch_size = strtol(defGetString(def), NULL, 10);
 		else if (strcmp(def->defname, "async_capable") == 0)
 			fpinfo->async_capable = defGetBoolean(def);
+		else if (strcmp(def->defname, "fetch_ahead") == 0)
+			fpinfo->fetch_ahead = defGetBoolean(def);
 	}
 }
 
@@ -5776,6 +6127,8 @@ apply_table_options(PgFdwRelationInfo *fpinfo)
 			fpinfo->fetch_size = strtol(defGetString(def), NULL, 10);
 		else if (strcmp(def->defname, "async_capable") == 0)
 			fpinfo->async_capable = defGetBoolean(def);
+		else if (strcmp(def->defname, "fetch_ahead") == 0)
+			fpinfo->fetch_ahead = defGetBoolean(def);
 	}
 }
 
@@ -5811,6 +6164,7 @@ merge_fdw_options(PgFdwRelationInfo *fpinfo,
 	fpinfo->use_remote_estimate = fpinfo_o->use_remote_estimate;
 	fpinfo->fetch_size = fpinfo_o->fetch_size;
 	fpinfo->async_capable = fpinfo_o->async_capable;
+	fpinfo->fetch_ahead = fpinfo_o->fetch_ahead;
 
 	/* Merge the table level options from either side of the join. */
 	if (fpinfo_i)
@@ -5839,6 +6193,10 @@ merge_fdw_options(PgFdwRelationInfo *fpinfo,
 		 */
 		fpinfo->async_capable = fpinfo_o->async_capable ||
 			fpinfo_i->async_capable;
+
+		/* Likewise for fetching ahead. */
+		fpinfo->fetch_ahead = fpinfo_o->fetch_ahead ||
+			fpinfo_i->fetch_ahead;
 	}
 }
 
@@ -6240,6 +6598,7 @@ postgresGetForeignUpperPaths(PlannerInfo *root, UpperRelationKind stage,
 
 	/* Ignore stages we don't support; and skip any duplicate calls. */
 	if ((stage != UPPERREL_GROUP_AGG &&
+		 stage != UPPERREL_PARTIAL_GROUP_AGG &&
 		 stage != UPPERREL_ORDERED &&
 		 stage != UPPERREL_FINAL) ||
 		output_rel->fdw_private)
@@ -6253,6 +6612,7 @@ postgresGetForeignUpperPaths(PlannerInfo *root, UpperRelationKind stage,
 	switch (stage)
 	{
 		case UPPERREL_GROUP_AGG:
+		case UPPERREL_PARTIAL_GROUP_AGG:
 			add_foreign_grouping_paths(root, input_rel, output_rel,
 									   (GroupPathExtraData *) extra);
 			break;
@@ -6275,6 +6635,12 @@ postgresGetForeignUpperPaths(PlannerInfo *root, UpperRelationKind stage,
  *
  * Given input_rel represents the underlying scan.  The paths are added to the
  * given grouped_rel.
+ *
+ * This is also used for the partially grouped relation of a partition when
+ * partitionwise aggregation can't complete the groups within partitions.
+ * Then the remote server computes the aggregates' transition states, which
+ * foreign_expr_walker() allows only for aggregates whose ordinary result is
+ * that state, and the groups are finalized locally.
  */
 static void
 add_foreign_grouping_paths(PlannerInfo *root, RelOptInfo *input_rel,
@@ -6295,8 +6661,10 @@ add_foreign_grouping_paths(PlannerInfo *root, RelOptInfo *input_rel,
 		!root->hasHavingQual)
 		return;
 
-	Assert(extra->patype == PARTITIONWISE_AGGREGATE_NONE ||
-		   extra->patype == PARTITIONWISE_AGGREGATE_FULL);
+	Assert(fpinfo->stage == UPPERREL_PARTIAL_GROUP_AGG ?
+		   extra->patype == PARTITIONWISE_AGGREGATE_PARTIAL :
+		   (extra->patype == PARTITIONWISE_AGGREGATE_NONE ||
+			extra->patype == PARTITIONWISE_AGGREGATE_FULL));
 
 	/* save the input_rel as outerrel in fpinfo */
 	fpinfo->outerrel = input_rel;
@@ -6314,9 +6682,12 @@ add_foreign_grouping_paths(PlannerInfo *root, RelOptInfo *input_rel,
 	 * Assess if it is safe to push down aggregation and grouping.
 	 *
 	 * Use HAVING qual from extra. In case of child partition, it will have
-	 * translated Vars.
+	 * translated Vars.  The HAVING qual can only be checked once the groups
+	 * are complete, so it doesn't apply to partial aggregation.
 	 */
-	if (!foreign_grouping_ok(root, grouped_rel, extra->havingQual))
+	if (!foreign_grouping_ok(root, grouped_rel,
+							 fpinfo->stage == UPPERREL_PARTIAL_GROUP_AGG ?
+							 NULL : extra->havingQual))
 		return;
 
 	/*
@@ -6904,6 +7275,10 @@ fetch_more_data_begin(AsyncRequest *areq)
 
 	Assert(!fsstate->conn_state->pendingAreq);
 
+	/* A synchronous scan may have a FETCH in flight on the connection. */
+	if (fsstate->conn_state->pendingFetch)
+		process_pending_fetch(fsstate->conn_state->pendingFetch);
+
 	/* Create the cursor synchronously. */
 	if (!fsstate->cursor_exists)
 		create_cursor(node);
@@ -7277,3 +7652,38 @@ get_batch_size_option(Relation rel)
 
 	return batch_size;
 }
+
+/*
+ * Determine whether batches of rows inserted into a given foreign table are
+ * to be sent using COPY.  The option specified for a table has precedence.
+ */
+static bool
+get_batch_with_copy_option(Relation rel)
+{
+	Oid			foreigntableid = RelationGetRelid(rel);
+	ForeignTable *table;
+	ForeignServer *server;
+	List	   *options;
+	ListCell   *lc;
+
+	/*
+	 * Load options for table and server. We append server options after
+	 * table options, because table options take precedence.
+	 */
+	table = GetForeignTable(foreigntableid);
+	server = GetForeignServer(table->serverid);
+
+	options = NIL;
+	options = list_concat(options, table->options);
+	options = list_concat(options, server->options);
+
+	foreach(lc, options)
+	{
+		DefElem    *def = (DefElem *) lfirst(lc);
+
+		if (strcmp(def->defname, "batch_with_copy") == 0)
+			return defGetBoolean(def);
+	}
+
+	return false;
+}
@@ -2673,6 +2673,12 @@ SELECT a, count(t1) FROM pagg_tab t1 GROUP BY a HAVING avg(b) < 22 ORDER BY 1;
 EXPLAIN (COSTS OFF)
 SELECT b, avg(a), max(a), count(*) FROM pagg_tab GROUP BY b HAVING sum(a) < 700 ORDER BY 1;
 
+-- Partial aggregates can be computed remotely when the aggregate's result
+-- is its transition state
+EXPLAIN (VERBOSE, COSTS OFF)
+SELECT b, max(a), count(*) FROM pagg_tab GROUP BY b HAVING sum(a) < 700 ORDER BY 1;
+SELECT b, max(a), count(*) FROM pagg_tab GROUP BY b HAVING sum(a) < 700 ORDER BY 1;
+
 -- ===================================================================
 -- access rights and superuser
 -- ===================================================================
@@ -3047,6 +3053,32 @@ SELECT tableoid::regclass, * FROM batch_cp_upd_test;
 -- Clean up
 DROP TABLE batch_table, batch_cp_upd_test CASCADE;
 
+-- Use COPY to send the batches
+CREATE TABLE batch_table ( x int, t text );
+CREATE FOREIGN TABLE ftable ( x int, t text ) SERVER loopback
+  OPTIONS ( table_name 'batch_table', batch_size '10', batch_with_copy 'true' );
+INSERT INTO ftable SELECT i, 'row ' || i FROM generate_series(1, 25) i;
+-- values that must be escaped in COPY's text format, and nulls
+INSERT INTO ftable VALUES
+  (26, E'tab\there'), (27, E'new\nline'), (28, E'back\\slash'), (29, NULL), (30, '\N');
+-- a single row is still sent with the prepared INSERT
+INSERT INTO ftable VALUES (31, 'single');
+SELECT count(*), count(t), sum(x) FROM batch_table;
+
+SELECT v.x, b.t IS NOT DISTINCT FROM v.t AS same
+FROM (VALUES (26, E'tab\there'), (27, E'new\nline'), (28, E'back\\slash'),
+             (29, NULL), (30, '\N')) v(x, t)
+  LEFT JOIN batch_table b ON b.x = v.x
+ORDER BY v.x;
+
+-- COPY can't do RETURNING, so this uses INSERT
+INSERT INTO ftable VALUES (32, 'a'), (33, 'b') RETURNING *;
+
+SELECT count(*) FROM batch_table;
+
+DROP FOREIGN TABLE ftable;
+DROP TABLE batch_table;
+
 -- ===================================================================
 -- test asynchronous execution
 -- ===================================================================
@@ -3241,3 +3273,48 @@ DROP TABLE join_tbl;
 
 ALTER SERVER loopback OPTIONS (DROP async_capable);
 ALTER SERVER loopback2 OPTIONS (DROP async_capable);
+
+-- ===================================================================
+-- test fetch_ahead
+-- ===================================================================
+
+CREATE TABLE fetch_ahead_tbl AS
+  SELECT i AS a, i % 10 AS b FROM generate_series(1, 1000) i;
+CREATE FOREIGN TABLE ft_fetch_ahead (a int, b int) SERVER loopback
+  OPTIONS (table_name 'fetch_ahead_tbl', fetch_size '7', fetch_ahead 'true');
+
+-- random() keeps the aggregates local, so that every row is fetched
+SELECT count(*), sum(a) FROM ft_fetch_ahead WHERE random() >= 0;
+
+-- Two scans share the connection, so each must collect the other's FETCH
+-- before sending its own
+SET enable_hashjoin TO false;
+SET enable_mergejoin TO false;
+SET enable_material TO false;
+SELECT count(*), count(t2.a), sum(t2.a)
+FROM ft_fetch_ahead t1 LEFT JOIN ft_fetch_ahead t2
+  ON t1.a = t2.a AND random() >= 0
+WHERE t1.a <= 20;
+
+SET enable_nestloop TO false;
+RESET enable_mergejoin;
+SELECT count(*), count(t2.a), sum(t2.a)
+FROM ft_fetch_ahead t1 LEFT JOIN ft_fetch_ahead t2
+  ON t1.a = t2.a AND random() >= 0;
+
+RESET enable_nestloop;
+SET enable_mergejoin TO false;
+-- The semi join rescans the inner scan before it is finished, with a FETCH
+-- still in flight
+SELECT x FROM (VALUES (1), (2), (3)) v(x)
+WHERE EXISTS (SELECT 1 FROM ft_fetch_ahead t
+              WHERE t.b + (random() * 0)::int = v.x)
+ORDER BY x;
+
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+RESET enable_material;
+
+-- Clean up
+DROP FOREIGN TABLE ft_fetch_ahead;
+DROP TABLE fetch_ahead_tbl;
@@ -19,6 +19,7 @@
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "tcop/pquery.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
@@ -40,6 +41,11 @@ static void printtup_destroy(DestReceiver *self);
  *
  * NOTE: finfo is the lookup info for either typoutput or typsend, whichever
  * we are using for this column.
+ *
+ * sendlen is set for binary-format columns whose send function is known to
+ * just emit the datum as a 1-, 2-, 4- or 8-byte integer in network byte
+ * order.  printtup() writes those directly, saving the function call and
+ * the palloc'd bytea it would return.
  * ----------------
  */
 typedef struct
@@ -48,6 +54,7 @@ typedef struct
 	Oid			typsend;		/* Oid for the type's binary output fn */
 	bool		typisvarlena;	/* is it varlena (ie possibly toastable)? */
 	int16		format;			/* format code for this column */
+	int16		sendlen;		/* if > 0, binary output is inlined */
 	FmgrInfo	finfo;			/* Precomputed call info for output fn */
 } PrinttupAttrInfo;
 
@@ -243,6 +250,39 @@ SendRowDescriptionMessage(StringInfo buf, TupleDesc typeinfo,
 	pq_endmessage_reuse(buf);
 }
 
+/*
+ * Get the number of bytes written by a send function that printtup() knows
+ * how to inline, or 0 if it's not one of those.
+ *
+ * These must match what the functions themselves do: boolsend() sends a
+ * single 0 or 1 byte, and the rest send their argument's bit pattern with
+ * pq_sendint16/32/64 (pq_sendfloat4/8 amount to the same thing).
+ */
+static int16
+printtup_inline_sendlen(Oid typsend)
+{
+	switch (typsend)
+	{
+		case F_BOOLSEND:
+			return 1;
+		case F_INT2SEND:
+			return 2;
+		case F_INT4SEND:
+		case F_OIDSEND:
+		case F_FLOAT4SEND:
+		case F_DATE_SEND:
+			return 4;
+		case F_INT8SEND:
+		case F_FLOAT8SEND:
+		case F_TIME_SEND:
+		case F_TIMESTAMP_SEND:
+		case F_TIMESTAMPTZ_SEND:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
 /*
  * Get the lookup info that printtup() needs
  */
@@ -285,6 +325,7 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 									&thisState->typsend,
 									&thisState->typisvarlena);
 			fmgr_info(thisState->typsend, &thisState->finfo);
+			thisState->sendlen = printtup_inline_sendlen(thisState->typsend);
 		}
 		else
 			ereport(ERROR,
@@ -357,6 +398,26 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 			outputstr = OutputFunctionCall(&thisState->finfo, attr);
 			pq_sendcountedtext(buf, outputstr, strlen(outputstr), false);
 		}
+		else if (thisState->sendlen > 0)
+		{
+			/* Binary output of a fixed-width type, done inline */
+			pq_sendint32(buf, thisState->sendlen);
+			switch (thisState->sendlen)
+			{
+				case 1:
+					pq_sendbyte(buf, DatumGetBool(attr) ? 1 : 0);
+					break;
+				case 2:
+					pq_sendint16(buf, DatumGetInt16(attr));
+					break;
+				case 4:
+					pq_sendint32(buf, DatumGetInt32(attr));
+					break;
+				case 8:
+					pq_sendint64(buf, DatumGetInt64(attr));
+					break;
+			}
+		}
 		else
 		{
 			/* Binary output */
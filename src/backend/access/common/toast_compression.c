@@ -247,6 +247,44 @@ lz4_decompress_datum_slice(const struct varlena *value, int32 slicelength)
 #endif
 }
 
+/*
+ * Return the maximum amount of stored LZ4-compressed data, including the
+ * compression header, that may be needed to decompress the first
+ * 'slicelimit' bytes of a value of 'rawsize' bytes, but no more than
+ * 'total_compressed_size'.  This lets a slice of an external value be
+ * fetched without reading all of its chunks.
+ *
+ * Each LZ4 sequence costs at most one byte of input per byte of output, plus
+ * one length byte per 255 literal bytes and a few bytes of token and offset.
+ * The sequence that crosses the end of the slice may however carry a long
+ * match length, encoded with one byte per 255 bytes of the match, so allow
+ * for a match spanning the whole value as well.
+ *
+ * Decoding from an input that stops in the middle of a sequence needs
+ * LZ4_decompress_safe_partial() from lz4 1.9.4 or later; with older
+ * libraries we need the whole value.
+ */
+int32
+lz4_maximum_compressed_size(int32 slicelimit, int32 rawsize,
+							int32 total_compressed_size)
+{
+#ifndef USE_LZ4
+	return total_compressed_size;
+#else
+	int64		compressed_size;
+
+	if (LZ4_versionNumber() < 10904)
+		return total_compressed_size;
+
+	/* Use int64 here to prevent overflow during calculation. */
+	compressed_size = (int64) slicelimit + slicelimit / 255 + 16;
+	compressed_size += rawsize / 255 + 16;
+	compressed_size += VARHDRSZ_COMPRESSED - VARHDRSZ;
+
+	return (int32) Min(compressed_size, total_compressed_size);
+#endif
+}
+
 /*
  * Extract compression ID from a varlena.
  *
@@ -3,7 +3,8 @@
  * ginfast.c
  *	  Fast insert routines for the Postgres inverted index access method.
  *	  Pending entries are stored in linear list of pages.  Later on
- *	  (typically during VACUUM), ginInsertCleanup() will be invoked to
+ *	  (typically during VACUUM, or by an autovacuum work item requested
+ *	  once the list gets too long), ginInsertCleanup() will be invoked to
  *	  transfer pending entries into the regular index structure.  This
  *	  wins because bulk insertion is much more efficient than retail.
  *
@@ -41,6 +42,13 @@ int			gin_pending_list_limit = 0;
 #define GIN_PAGE_FREESIZE \
 	( BLCKSZ - MAXALIGN(SizeOfPageHeaderData) - MAXALIGN(sizeof(GinPageOpaqueData)) )
 
+/*
+ * Once the pending list exceeds the cleanup size, its cleanup is normally
+ * left to autovacuum.  If it grows beyond this multiple of the cleanup size
+ * anyway, the inserter does it synchronously.
+ */
+#define GIN_PENDING_LIST_HARD_FACTOR	4
+
 typedef struct KeyArray
 {
 	Datum	   *keys;			/* expansible array */
@@ -214,9 +222,13 @@ makeSublist(Relation index, IndexTuple *tuples, int32 ntuples,
  *
  * Function guarantees that all these tuples will be inserted consecutively,
  * preserving order
+ *
+ * heapRel is the index's table, used to tell whether autovacuum may clean up
+ * the pending list.
  */
 void
-ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
+ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector,
+					   Relation heapRel)
 {
 	Relation	index = ginstate->index;
 	Buffer		metabuffer;
@@ -227,6 +239,7 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	ginxlogUpdateMeta data;
 	bool		separateList = false;
 	bool		needCleanup = false;
+	bool		mustCleanup = false;
 	int			cleanupSize;
 	bool		needWal;
 
@@ -449,17 +462,40 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	cleanupSize = GinGetPendingListCleanupSize(index);
 	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 1024L)
 		needCleanup = true;
+	if (metadata->nPendingPages * GIN_PAGE_FREESIZE >
+		GIN_PENDING_LIST_HARD_FACTOR * cleanupSize * 1024L)
+		mustCleanup = true;
 
 	UnlockReleaseBuffer(metabuffer);
 
 	END_CRIT_SECTION();
 
+	if (!needCleanup)
+		return;
+
+	/*
+	 * Rather than making this unlucky inserter pay for merging the whole
+	 * pending list, hand the job to autovacuum if we can.  The list keeps
+	 * growing until a worker gets around to it, so fall back to cleaning it
+	 * up ourselves if it has become much longer than the limit, which means
+	 * autovacuum isn't keeping up.  Temporary indexes can't be processed by
+	 * autovacuum at all, and we don't impose autovacuum activity on a table
+	 * for which it has been disabled.
+	 */
+	if (!mustCleanup &&
+		!RelationUsesLocalBuffers(index) &&
+		AutoVacuumingActive() &&
+		RelationGetAutovacuumEnabled(heapRel) &&
+		AutoVacuumRequestWork(AVW_GINCleanPendingList,
+							  RelationGetRelid(index),
+							  InvalidBlockNumber))
+		return;
+
 	/*
 	 * Since it could contend with concurrent cleanup process we cleanup
 	 * pending list not forcibly.
 	 */
-	if (needCleanup)
-		ginInsertCleanup(ginstate, false, true, false, NULL);
+	ginInsertCleanup(ginstate, false, true, false, NULL);
 }
 
 /*
@@ -17,6 +17,7 @@
 
 #include "access/hash.h"
 #include "access/hash_xlog.h"
+#include "access/tableam.h"
 #include "miscadmin.h"
 #include "storage/buf_internals.h"
 #include "storage/lwlock.h"
@@ -25,15 +26,25 @@
 
 static void _hash_vacuum_one_page(Relation rel, Relation hrel,
 								  Buffer metabuf, Buffer buf);
+static void _hash_bottomup_delete(Relation rel, Relation hrel,
+								  Buffer metabuf, Buffer buf,
+								  uint32 hashkey, Size itemsz);
+static void _hash_delete_items(Relation rel, Buffer metabuf, Buffer buf,
+							   OffsetNumber *deletable, int ndeletable,
+							   TransactionId latestRemovedXid);
 
 /*
  *	_hash_doinsert() -- Handle insertion of a single index tuple.
  *
  *		This routine is called by the public interface routines, hashbuild
  *		and hashinsert.  By here, itup is completely filled in.
+ *
+ *		indexUnchanged is the executor's hint that itup is a new version of
+ *		a row whose indexed value was not changed by an UPDATE.
  */
 void
-_hash_doinsert(Relation rel, IndexTuple itup, Relation heapRel)
+_hash_doinsert(Relation rel, IndexTuple itup, Relation heapRel,
+			   bool indexUnchanged)
 {
 	Buffer		buf = InvalidBuffer;
 	Buffer		bucket_buf;
@@ -144,6 +155,24 @@ restart_insert:
 			}
 		}
 
+		/*
+		 * If we're inserting a duplicate caused by an UPDATE that didn't
+		 * change the indexed value, the page is likely full of older
+		 * versions of the same row.  Ask the table AM whether some of them
+		 * can go before adding another overflow page to the bucket.  Only do
+		 * this on the primary bucket page, so that it's attempted at most
+		 * once per insertion: checking heap tuples is expensive, and a long
+		 * chain of full overflow pages would otherwise be checked page by
+		 * page on every insert.
+		 */
+		if (indexUnchanged && buf == bucket_buf && IsBufferCleanupOK(buf))
+		{
+			_hash_bottomup_delete(rel, heapRel, metabuf, buf, hashkey, itemsz);
+
+			if (PageGetFreeSpace(page) >= itemsz)
+				break;			/* OK, now we have enough space */
+		}
+
 		/*
 		 * no space on this page; check for an overflow page
 		 */
@@ -342,8 +371,6 @@ _hash_vacuum_one_page(Relation rel, Relation hrel, Buffer metabuf, Buffer buf)
 	OffsetNumber offnum,
 				maxoff;
 	Page		page = BufferGetPage(buf);
-	HashPageOpaque pageopaque;
-	HashMetaPage metap;
 
 	/* Scan each tuple in page to see if it is marked as LP_DEAD */
 	maxoff = PageGetMaxOffsetNumber(page);
@@ -365,68 +392,178 @@ _hash_vacuum_one_page(Relation rel, Relation hrel, Buffer metabuf, Buffer buf)
 			index_compute_xid_horizon_for_tuples(rel, hrel, buf,
 												 deletable, ndeletable);
 
-		/*
-		 * Write-lock the meta page so that we can decrement tuple count.
-		 */
-		LockBuffer(metabuf, BUFFER_LOCK_EXCLUSIVE);
+		_hash_delete_items(rel, metabuf, buf, deletable, ndeletable,
+						   latestRemovedXid);
+	}
+}
 
-		/* No ereport(ERROR) until changes are logged */
-		START_CRIT_SECTION();
+/*
+ * _hash_bottomup_delete - try to delete old versions of duplicates.
+ *
+ * Called when the page has no room for a new index tuple that the executor
+ * says is a new version of an existing row.  Tuples with the same hash key as
+ * the new one are likely to be older versions of that row, which means that
+ * they are worth checking even though nobody has marked them LP_DEAD yet.
+ * We hand all tuples on the page to the table AM, marking those as
+ * promising, and let it decide how much checking is worthwhile, as nbtree's
+ * bottom-up deletion does.  Caller must hold a cleanup lock on the page.
+ */
+static void
+_hash_bottomup_delete(Relation rel, Relation hrel, Buffer metabuf,
+					  Buffer buf, uint32 hashkey, Size itemsz)
+{
+	Page		page = BufferGetPage(buf);
+	TM_IndexDeleteOp delstate;
+	OffsetNumber deletable[MaxIndexTuplesPerPage];
+	bool		isdeletable[MaxIndexTuplesPerPage + 1];
+	int			ndeletable = 0;
+	int			npromising = 0;
+	OffsetNumber offnum,
+				maxoff;
+	TransactionId latestRemovedXid;
 
-		PageIndexMultiDelete(page, deletable, ndeletable);
+	maxoff = PageGetMaxOffsetNumber(page);
+	if (maxoff < FirstOffsetNumber)
+		return;
 
-		/*
-		 * Mark the page as not containing any LP_DEAD items. This is not
-		 * certainly true (there might be some that have recently been marked,
-		 * but weren't included in our target-item list), but it will almost
-		 * always be true and it doesn't seem worth an additional page scan to
-		 * check it. Remember that LH_PAGE_HAS_DEAD_TUPLES is only a hint
-		 * anyway.
-		 */
-		pageopaque = (HashPageOpaque) PageGetSpecialPointer(page);
-		pageopaque->hasho_flag &= ~LH_PAGE_HAS_DEAD_TUPLES;
+	delstate.bottomup = true;
+	delstate.bottomupfreespace = Max(BLCKSZ / 16, itemsz + sizeof(ItemIdData));
+	delstate.ndeltids = 0;
+	delstate.deltids = palloc(maxoff * sizeof(TM_IndexDelete));
+	delstate.status = palloc(maxoff * sizeof(TM_IndexStatus));
 
-		metap = HashPageGetMeta(BufferGetPage(metabuf));
-		metap->hashm_ntuples -= ndeletable;
+	for (offnum = FirstOffsetNumber;
+		 offnum <= maxoff;
+		 offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		IndexTuple	itup = (IndexTuple) PageGetItem(page, itemid);
+		TM_IndexDelete *odeltid = &delstate.deltids[delstate.ndeltids];
+		TM_IndexStatus *ostatus = &delstate.status[delstate.ndeltids];
+
+		odeltid->tid = itup->t_tid;
+		odeltid->id = delstate.ndeltids;
+		ostatus->idxoffnum = offnum;
+		ostatus->knowndeletable = false;
+		ostatus->promising = (_hash_get_indextuple_hashkey(itup) == hashkey);
+		ostatus->freespace = ItemIdGetLength(itemid) + sizeof(ItemIdData);
+
+		if (ostatus->promising)
+			npromising++;
+		delstate.ndeltids++;
+	}
 
-		MarkBufferDirty(buf);
-		MarkBufferDirty(metabuf);
+	/* Without any duplicates, this isn't a version churn problem */
+	if (npromising == 0)
+	{
+		pfree(delstate.deltids);
+		pfree(delstate.status);
+		return;
+	}
 
-		/* XLOG stuff */
-		if (RelationNeedsWAL(rel))
-		{
-			xl_hash_vacuum_one_page xlrec;
-			XLogRecPtr	recptr;
+	latestRemovedXid = table_index_delete_tuples(hrel, &delstate);
 
-			xlrec.latestRemovedXid = latestRemovedXid;
-			xlrec.ntuples = ndeletable;
+	/* The table AM may have reordered and shrunk the array */
+	memset(isdeletable, 0, sizeof(isdeletable));
+	for (int i = 0; i < delstate.ndeltids; i++)
+	{
+		TM_IndexStatus *dstatus = delstate.status + delstate.deltids[i].id;
 
-			XLogBeginInsert();
-			XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
-			XLogRegisterData((char *) &xlrec, SizeOfHashVacuumOnePage);
+		if (dstatus->knowndeletable)
+			isdeletable[dstatus->idxoffnum] = true;
+	}
+	for (offnum = FirstOffsetNumber;
+		 offnum <= maxoff;
+		 offnum = OffsetNumberNext(offnum))
+	{
+		if (isdeletable[offnum])
+			deletable[ndeletable++] = offnum;
+	}
 
-			/*
-			 * We need the target-offsets array whether or not we store the
-			 * whole buffer, to allow us to find the latestRemovedXid on a
-			 * standby server.
-			 */
-			XLogRegisterData((char *) deletable,
-							 ndeletable * sizeof(OffsetNumber));
+	pfree(delstate.deltids);
+	pfree(delstate.status);
 
-			XLogRegisterBuffer(1, metabuf, REGBUF_STANDARD);
+	if (ndeletable > 0)
+		_hash_delete_items(rel, metabuf, buf, deletable, ndeletable,
+						   latestRemovedXid);
+}
 
-			recptr = XLogInsert(RM_HASH_ID, XLOG_HASH_VACUUM_ONE_PAGE);
+/*
+ * _hash_delete_items - delete the given items from a bucket page.
+ *
+ * deletable must be in ascending order.  Caller must hold a cleanup lock on
+ * the page.
+ */
+static void
+_hash_delete_items(Relation rel, Buffer metabuf, Buffer buf,
+				   OffsetNumber *deletable, int ndeletable,
+				   TransactionId latestRemovedXid)
+{
+	Page		page = BufferGetPage(buf);
+	HashPageOpaque pageopaque;
+	HashMetaPage metap;
 
-			PageSetLSN(BufferGetPage(buf), recptr);
-			PageSetLSN(BufferGetPage(metabuf), recptr);
-		}
+	/*
+	 * Write-lock the meta page so that we can decrement tuple count.
+	 */
+	LockBuffer(metabuf, BUFFER_LOCK_EXCLUSIVE);
+
+	/* No ereport(ERROR) until changes are logged */
+	START_CRIT_SECTION();
+
+	PageIndexMultiDelete(page, deletable, ndeletable);
+
+	/*
+	 * Mark the page as not containing any LP_DEAD items. This is not
+	 * certainly true (there might be some that have recently been marked,
+	 * but weren't included in our target-item list), but it will almost
+	 * always be true and it doesn't seem worth an additional page scan to
+	 * check it. Remember that LH_PAGE_HAS_DEAD_TUPLES is only a hint
+	 * anyway.
+	 */
+	pageopaque = (HashPageOpaque) PageGetSpecialPointer(page);
+	pageopaque->hasho_flag &= ~LH_PAGE_HAS_DEAD_TUPLES;
+
+	metap = HashPageGetMeta(BufferGetPage(metabuf));
+	metap->hashm_ntuples -= ndeletable;
+
+	MarkBufferDirty(buf);
+	MarkBufferDirty(metabuf);
 
-		END_CRIT_SECTION();
+	/* XLOG stuff */
+	if (RelationNeedsWAL(rel))
+	{
+		xl_hash_vacuum_one_page xlrec;
+		XLogRecPtr	recptr;
+
+		xlrec.latestRemovedXid = latestRemovedXid;
+		xlrec.ntuples = ndeletable;
+
+		XLogBeginInsert();
+		XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
+		XLogRegisterData((char *) &xlrec, SizeOfHashVacuumOnePage);
 
 		/*
-		 * Releasing write lock on meta page as we have updated the tuple
-		 * count.
+		 * We need the target-offsets array whether or not we store the
+		 * whole buffer, to allow us to find the latestRemovedXid on a
+		 * standby server.
 		 */
-		LockBuffer(metabuf, BUFFER_LOCK_UNLOCK);
+		XLogRegisterData((char *) deletable,
+						 ndeletable * sizeof(OffsetNumber));
+
+		XLogRegisterBuffer(1, metabuf, REGBUF_STANDARD);
+
+		recptr = XLogInsert(RM_HASH_ID, XLOG_HASH_VACUUM_ONE_PAGE);
+
+		PageSetLSN(BufferGetPage(buf), recptr);
+		PageSetLSN(BufferGetPage(metabuf), recptr);
 	}
+
+	END_CRIT_SECTION();
+
+	/*
+	 * Releasing write lock on meta page as we have updated the tuple
+	 * count.
+	 */
+	LockBuffer(metabuf, BUFFER_LOCK_UNLOCK);
 }
@@ -379,6 +379,7 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 	OffsetNumber lineoff;
 	ItemId		lpp;
 	bool		all_visible;
+	bool		vm_all_visible = false;
 
 	Assert(page < scan->rs_nblocks);
 
@@ -412,6 +413,17 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 	 */
 	heap_page_prune_opt(scan->rs_base.rs_rd, buffer);
 
+	/*
+	 * In hot standby we can't trust the page-level all-visible flag (see
+	 * below), but the visibility map can be trusted, as index-only scans do.
+	 * Look it up before locking the page, since it might need I/O.  The
+	 * visibility map buffer stays pinned from page to page, so this costs
+	 * little when the pages are covered by the same map page.
+	 */
+	if (snapshot->takenDuringRecovery)
+		vm_all_visible = VM_ALL_VISIBLE(scan->rs_base.rs_rd, page,
+										&scan->rs_vmbuffer);
+
 	/*
 	 * We must hold share lock on the buffer content while examining tuple
 	 * visibility.  Afterwards, however, the tuples we have found to be
@@ -442,9 +454,19 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 	 * the page-level flag can be trusted in the same way, because it might
 	 * get propagated somehow without being explicitly WAL-logged, e.g. via a
 	 * full page write. Until we can prove that beyond doubt, let's check each
-	 * tuple for visibility the hard way.
+	 * tuple for visibility the hard way, unless the visibility map says the
+	 * page is all-visible.  Replay of the record that set the map bit has
+	 * resolved conflicts with any snapshot that might not see all the tuples.
+	 *
+	 * The map bit was read without the page lock, so it may have been
+	 * cleared, and the page modified, since.  Redo clears the page-level
+	 * flag while holding the page's exclusive lock, so also requiring the
+	 * flag, which we now read under the lock, closes that race.
 	 */
-	all_visible = PageIsAllVisible(dp) && !snapshot->takenDuringRecovery;
+	if (snapshot->takenDuringRecovery)
+		all_visible = vm_all_visible && PageIsAllVisible(dp);
+	else
+		all_visible = PageIsAllVisible(dp);
 
 	for (lineoff = FirstOffsetNumber, lpp = PageGetItemId(dp, lineoff);
 		 lineoff <= lines;
@@ -1209,6 +1231,7 @@ heap_beginscan(Relation relation, Snapshot snapshot,
 	scan->rs_base.rs_flags = flags;
 	scan->rs_base.rs_parallel = parallel_scan;
 	scan->rs_strategy = NULL;	/* set in initscan */
+	scan->rs_vmbuffer = InvalidBuffer;
 
 	/*
 	 * Disable page-at-a-time mode if it's not a MVCC-safe snapshot.
@@ -1315,6 +1338,8 @@ heap_endscan(TableScanDesc sscan)
 	 */
 	if (BufferIsValid(scan->rs_cbuf))
 		ReleaseBuffer(scan->rs_cbuf);
+	if (BufferIsValid(scan->rs_vmbuffer))
+		ReleaseBuffer(scan->rs_vmbuffer);
 
 	/*
 	 * decrement relation reference count and free scan descriptor storage
@@ -3213,11 +3238,13 @@ simple_heap_delete(Relation relation, ItemPointer tid)
 TM_Result
 heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 			CommandId cid, Snapshot crosscheck, bool wait,
-			TM_FailureData *tmfd, LockTupleMode *lockmode)
+			TM_FailureData *tmfd, LockTupleMode *lockmode,
+			TU_UpdateIndexes *update_indexes)
 {
 	TM_Result	result;
 	TransactionId xid = GetCurrentTransactionId();
 	Bitmapset  *hot_attrs;
+	Bitmapset  *sum_attrs;
 	Bitmapset  *key_attrs;
 	Bitmapset  *id_attrs;
 	Bitmapset  *interesting_attrs;
@@ -3240,6 +3267,7 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	bool		have_tuple_lock = false;
 	bool		iscombo;
 	bool		use_hot_update = false;
+	bool		summarized_update = false;
 	bool		hot_attrs_checked = false;
 	bool		key_intact;
 	bool		all_visible_cleared = false;
@@ -3255,6 +3283,9 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 
 	Assert(ItemPointerIsValid(otid));
 
+	/* No index updates are needed unless we succeed, see below */
+	*update_indexes = TU_None;
+
 	/*
 	 * Forbid this during a parallel operation, lest it allocate a combo CID.
 	 * Other workers might need that combo CID for visibility checks, and we
@@ -3276,12 +3307,17 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	 * caches the data so this is usually pretty cheap.
 	 *
 	 * We also need columns used by the replica identity and columns that are
-	 * considered the "key" of rows in the table.
+	 * considered the "key" of rows in the table.  Columns used only by
+	 * summarizing indexes don't block HOT updates, but we need to know
+	 * whether they changed so that those indexes can be updated.
 	 *
 	 * Note that we get copies of each bitmap, so we need not worry about
 	 * relcache flush happening midway through.
 	 */
-	hot_attrs = RelationGetIndexAttrBitmap(relation, INDEX_ATTR_BITMAP_ALL);
+	hot_attrs = RelationGetIndexAttrBitmap(relation,
+										   INDEX_ATTR_BITMAP_HOT_BLOCKING);
+	sum_attrs = RelationGetIndexAttrBitmap(relation,
+										   INDEX_ATTR_BITMAP_SUMMARIZED);
 	key_attrs = RelationGetIndexAttrBitmap(relation, INDEX_ATTR_BITMAP_KEY);
 	id_attrs = RelationGetIndexAttrBitmap(relation,
 										  INDEX_ATTR_BITMAP_IDENTITY_KEY);
@@ -3306,6 +3342,7 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	if (!PageIsFull(page))
 	{
 		interesting_attrs = bms_add_members(interesting_attrs, hot_attrs);
+		interesting_attrs = bms_add_members(interesting_attrs, sum_attrs);
 		hot_attrs_checked = true;
 	}
 	interesting_attrs = bms_add_members(interesting_attrs, key_attrs);
@@ -3606,6 +3643,7 @@ l2:
 		if (vmbuffer != InvalidBuffer)
 			ReleaseBuffer(vmbuffer);
 		bms_free(hot_attrs);
+		bms_free(sum_attrs);
 		bms_free(key_attrs);
 		bms_free(id_attrs);
 		bms_free(modified_attrs);
@@ -3915,9 +3953,16 @@ l2:
 		 * to do a HOT update.  Check if any of the index columns have been
 		 * changed. If the page was already full, we may have skipped checking
 		 * for index columns, and also can't do a HOT update.
+		 *
+		 * If only columns of summarizing indexes changed, the update can
+		 * still be HOT, but those indexes need new entries.
 		 */
 		if (hot_attrs_checked && !bms_overlap(modified_attrs, hot_attrs))
+		{
 			use_hot_update = true;
+			if (bms_overlap(modified_attrs, sum_attrs))
+				summarized_update = true;
+		}
 	}
 	else
 	{
@@ -4065,6 +4110,17 @@ l2:
 
 	pgstat_count_heap_update(relation, use_hot_update);
 
+	/*
+	 * Tell the caller which indexes need new entries: none for a HOT update,
+	 * unless it changed columns of summarizing indexes.
+	 */
+	if (!use_hot_update)
+		*update_indexes = TU_All;
+	else if (summarized_update)
+		*update_indexes = TU_Summarizing;
+	else
+		*update_indexes = TU_None;
+
 	/*
 	 * If heaptup is a private copy, release it.  Don't forget to copy t_self
 	 * back to the caller's image, too.
@@ -4079,6 +4135,7 @@ l2:
 		heap_freetuple(old_key_tuple);
 
 	bms_free(hot_attrs);
+	bms_free(sum_attrs);
 	bms_free(key_attrs);
 	bms_free(id_attrs);
 	bms_free(modified_attrs);
@@ -4199,10 +4256,11 @@ HeapDetermineModifiedColumns(Relation relation, Bitmapset *interesting_cols,
  * This routine may be used to update a tuple when concurrent updates of
  * the target tuple are not expected (for example, because we have a lock
  * on the relation associated with the tuple).  Any failure is reported
- * via ereport().
+ * via ereport().  *update_indexes is set as for heap_update().
  */
 void
-simple_heap_update(Relation relation, ItemPointer otid, HeapTuple tup)
+simple_heap_update(Relation relation, ItemPointer otid, HeapTuple tup,
+				   TU_UpdateIndexes *update_indexes)
 {
 	TM_Result	result;
 	TM_FailureData tmfd;
@@ -4211,7 +4269,7 @@ simple_heap_update(Relation relation, ItemPointer otid, HeapTuple tup)
 	result = heap_update(relation, otid, tup,
 						 GetCurrentCommandId(true), InvalidSnapshot,
 						 true /* wait for commit */ ,
-						 &tmfd, &lockmode);
+						 &tmfd, &lockmode, update_indexes);
 	switch (result)
 	{
 		case TM_SelfModified:
@@ -86,10 +86,11 @@
  * We use a special-purpose raw_heap_insert function instead, which
  * is optimized for bulk inserting a lot of tuples, knowing that we have
  * exclusive access to the heap.  raw_heap_insert builds new pages in
- * local storage.  When a page is full, or at the end of the process,
- * we insert it to WAL as a single record and then write it to disk
- * directly through smgr.  Note, however, that any data sent to the new
- * heap's TOAST table will go through the normal bufmgr.
+ * local storage.  Full pages are collected in a small array, and when
+ * that is full, or at the end of the process, we insert them to WAL as a
+ * single record and then write them to disk directly through smgr.  Note,
+ * however, that any data sent to the new heap's TOAST table will go through
+ * the normal bufmgr.
  *
  *
  * Portions Copyright (c) 1996-2021, PostgreSQL Global Development Group
@@ -125,6 +126,12 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
+/*
+ * Number of completed pages collected before they are WAL-logged and
+ * written out together.  This is as many as fit in one WAL record.
+ */
+#define REWRITE_BUFFER_PAGES	XLR_MAX_BLOCK_ID
+
 /*
  * State associated with a rewrite operation. This is opaque to the user
  * of the rewrite facility.
@@ -133,6 +140,8 @@ typedef struct RewriteStateData
 {
 	Relation	rs_old_rel;		/* source heap */
 	Relation	rs_new_rel;		/* destination heap */
+	char	   *rs_pages;		/* space for REWRITE_BUFFER_PAGES pages */
+	int			rs_npending;	/* # of completed pages not yet written */
 	Page		rs_buffer;		/* page currently being built */
 	BlockNumber rs_blockno;		/* block where page will go */
 	bool		rs_buffer_valid;	/* T if any tuples in buffer */
@@ -214,6 +223,7 @@ typedef struct RewriteMappingDataEntry
 
 /* prototypes for internal functions */
 static void raw_heap_insert(RewriteState state, HeapTuple tup);
+static void raw_heap_flush_pages(RewriteState state);
 
 /* internal logical remapping prototypes */
 static void logical_begin_heap_rewrite(RewriteState state);
@@ -256,7 +266,9 @@ begin_heap_rewrite(Relation old_heap, Relation new_heap, TransactionId oldest_xm
 
 	state->rs_old_rel = old_heap;
 	state->rs_new_rel = new_heap;
-	state->rs_buffer = (Page) palloc(BLCKSZ);
+	state->rs_pages = palloc(BLCKSZ * REWRITE_BUFFER_PAGES);
+	state->rs_npending = 0;
+	state->rs_buffer = (Page) state->rs_pages;
 	/* new_heap needn't be empty, just locked */
 	state->rs_blockno = RelationGetNumberOfBlocks(new_heap);
 	state->rs_buffer_valid = false;
@@ -314,22 +326,14 @@ end_heap_rewrite(RewriteState state)
 		raw_heap_insert(state, unresolved->tuple);
 	}
 
-	/* Write the last page, if any */
+	/* Write the last page, if any, along with any other pending pages */
 	if (state->rs_buffer_valid)
 	{
-		if (RelationNeedsWAL(state->rs_new_rel))
-			log_newpage(&state->rs_new_rel->rd_node,
-						MAIN_FORKNUM,
-						state->rs_blockno,
-						state->rs_buffer,
-						true);
-
-		PageSetChecksumInplace(state->rs_buffer, state->rs_blockno);
-
-		RelationOpenSmgr(state->rs_new_rel);
-		smgrextend(state->rs_new_rel->rd_smgr, MAIN_FORKNUM, state->rs_blockno,
-				   (char *) state->rs_buffer, true);
+		state->rs_npending++;
+		state->rs_blockno++;
+		state->rs_buffer_valid = false;
 	}
+	raw_heap_flush_pages(state);
 
 	/*
 	 * When we WAL-logged rel pages, we must nonetheless fsync them.  The
@@ -677,33 +681,21 @@ raw_heap_insert(RewriteState state, HeapTuple tup)
 		if (len + saveFreeSpace > pageFreeSpace)
 		{
 			/*
-			 * Doesn't fit, so write out the existing page.  It always
+			 * Doesn't fit, so finish the existing page and start building
+			 * the next one in the following slot of the array, writing out
+			 * the whole array first if it's full.  The finished page always
 			 * contains a tuple.  Hence, unlike RelationGetBufferForTuple(),
 			 * enforce saveFreeSpace unconditionally.
 			 */
-
-			/* XLOG stuff */
-			if (RelationNeedsWAL(state->rs_new_rel))
-				log_newpage(&state->rs_new_rel->rd_node,
-							MAIN_FORKNUM,
-							state->rs_blockno,
-							page,
-							true);
-
-			/*
-			 * Now write the page. We say skipFsync = true because there's no
-			 * need for smgr to schedule an fsync for this write; we'll do it
-			 * ourselves in end_heap_rewrite.
-			 */
-			RelationOpenSmgr(state->rs_new_rel);
-
-			PageSetChecksumInplace(page, state->rs_blockno);
-
-			smgrextend(state->rs_new_rel->rd_smgr, MAIN_FORKNUM,
-					   state->rs_blockno, (char *) page, true);
-
+			state->rs_npending++;
 			state->rs_blockno++;
 			state->rs_buffer_valid = false;
+
+			if (state->rs_npending >= REWRITE_BUFFER_PAGES)
+				raw_heap_flush_pages(state);
+
+			page = state->rs_buffer =
+				(Page) (state->rs_pages + state->rs_npending * BLCKSZ);
 		}
 	}
 
@@ -743,6 +735,54 @@ raw_heap_insert(RewriteState state, HeapTuple tup)
 		heap_freetuple(heaptup);
 }
 
+/*
+ * Write out the completed pages collected by raw_heap_insert.
+ *
+ * The pending pages belong at the blocks just before state->rs_blockno.
+ * They are WAL-logged in a single record, then written directly through
+ * smgr.
+ */
+static void
+raw_heap_flush_pages(RewriteState state)
+{
+	BlockNumber blknos[REWRITE_BUFFER_PAGES];
+	Page		pages[REWRITE_BUFFER_PAGES];
+	int			npages = state->rs_npending;
+	int			i;
+
+	if (npages == 0)
+		return;
+
+	for (i = 0; i < npages; i++)
+	{
+		blknos[i] = state->rs_blockno - npages + i;
+		pages[i] = (Page) (state->rs_pages + i * BLCKSZ);
+	}
+
+	/* XLOG stuff */
+	if (RelationNeedsWAL(state->rs_new_rel))
+		log_newpages(&state->rs_new_rel->rd_node, MAIN_FORKNUM, npages,
+					 blknos, pages, true);
+
+	/*
+	 * Now write the pages. We say skipFsync = true because there's no need
+	 * for smgr to schedule an fsync for this write; we'll do it ourselves in
+	 * end_heap_rewrite.
+	 */
+	RelationOpenSmgr(state->rs_new_rel);
+
+	for (i = 0; i < npages; i++)
+	{
+		PageSetChecksumInplace(pages[i], blknos[i]);
+
+		smgrextend(state->rs_new_rel->rd_smgr, MAIN_FORKNUM,
+				   blknos[i], (char *) pages[i], true);
+	}
+
+	state->rs_npending = 0;
+	state->rs_buffer = (Page) state->rs_pages;
+}
+
 /* ------------------------------------------------------------------------
  * Logical rewrite support
  *
@@ -75,6 +75,7 @@
 #include "storage/bufmgr.h"
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
+#include "storage/read_stream.h"
 #include "tcop/tcopprot.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
@@ -187,6 +188,16 @@ typedef struct LVDeadTuples
 														 * ItemPointerData */
 } LVDeadTuples;
 
+/*
+ * Iterator over the distinct heap blocks in an LVDeadTuples array, used to
+ * drive the read stream of the second heap pass.
+ */
+typedef struct LVDeadTuplesBlockIter
+{
+	LVDeadTuples *dead_tuples;
+	int			next;			/* index of first entry not yet returned */
+} LVDeadTuplesBlockIter;
+
 /* The dead tuple space consists of LVDeadTuples and dead tuple TIDs */
 #define SizeOfDeadTuples(cnt) \
 	add_size(offsetof(LVDeadTuples, itemptrs), \
@@ -351,6 +362,8 @@ typedef struct LVRelState
 	BlockNumber tupcount_pages; /* pages whose tuples we counted */
 	BlockNumber pages_removed;	/* pages remove by truncation */
 	BlockNumber lpdead_item_pages;	/* # pages with LP_DEAD items */
+	BlockNumber frozen_pages;	/* # pages with tuples we froze */
+	BlockNumber eager_frozen_pages; /* # of those frozen ahead of FreezeLimit */
 	BlockNumber nonempty_pages; /* actually, last nonempty page + 1 */
 	bool		lock_waiter_detected;
 
@@ -410,6 +423,8 @@ static void lazy_scan_prune(LVRelState *vacrel, Buffer buf,
 static void lazy_vacuum(LVRelState *vacrel, bool onecall);
 static bool lazy_vacuum_all_indexes(LVRelState *vacrel);
 static void lazy_vacuum_heap_rel(LVRelState *vacrel);
+static BlockNumber lazy_vacuum_heap_next_block(ReadStream *stream,
+											   void *callback_private_data);
 static int	lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno,
 								  Buffer buffer, int tupindex, Buffer *vmbuffer);
 static bool lazy_check_needs_freeze(Buffer buf, bool *hastup,
@@ -446,7 +461,6 @@ static void lazy_space_alloc(LVRelState *vacrel, int nworkers,
 							 BlockNumber relblocks);
 static void lazy_space_free(LVRelState *vacrel);
 static bool lazy_tid_reaped(ItemPointer itemptr, void *state);
-static int	vac_cmp_itemptr(const void *left, const void *right);
 static bool heap_page_is_all_visible(LVRelState *vacrel, Buffer buf,
 									 TransactionId *visibility_cutoff_xid, bool *all_frozen);
 static int	compute_parallel_vacuum_workers(LVRelState *vacrel,
@@ -755,6 +769,9 @@ heap_vacuum_rel(Relation rel, VacuumParams *params,
 							 vacrel->rel_pages,
 							 vacrel->pinskipped_pages,
 							 vacrel->frozenskipped_pages);
+			appendStringInfo(&buf, _("frozen: %u pages frozen, %u of them eagerly\n"),
+							 vacrel->frozen_pages,
+							 vacrel->eager_frozen_pages);
 			appendStringInfo(&buf,
 							 _("tuples: %lld removed, %lld remain, %lld are dead but not yet removable, oldest xmin: %u\n"),
 							 (long long) vacrel->tuples_deleted,
@@ -915,6 +932,8 @@ lazy_scan_heap(LVRelState *vacrel, VacuumParams *params, bool aggressive)
 	vacrel->tupcount_pages = 0;
 	vacrel->pages_removed = 0;
 	vacrel->lpdead_item_pages = 0;
+	vacrel->frozen_pages = 0;
+	vacrel->eager_frozen_pages = 0;
 	vacrel->nonempty_pages = 0;
 	vacrel->lock_waiter_detected = false;
 
@@ -1621,6 +1640,14 @@ lazy_scan_heap(LVRelState *vacrel, VacuumParams *params, bool aggressive)
 									"%u frozen pages.\n",
 									vacrel->frozenskipped_pages),
 					 vacrel->frozenskipped_pages);
+	appendStringInfo(&buf, ngettext("Froze tuples in %u page, ",
+									"Froze tuples in %u pages, ",
+									vacrel->frozen_pages),
+					 vacrel->frozen_pages);
+	appendStringInfo(&buf, ngettext("%u page eagerly.\n",
+									"%u pages eagerly.\n",
+									vacrel->eager_frozen_pages),
+					 vacrel->eager_frozen_pages);
 	appendStringInfo(&buf, _("%s."), pg_rusage_show(&ru0));
 
 	ereport(elevel,
@@ -1673,6 +1700,7 @@ lazy_scan_prune(LVRelState *vacrel,
 				num_tuples,
 				live_tuples;
 	int			nfrozen;
+	TransactionId freeze_cutoff_xid;
 	OffsetNumber deadoffsets[MaxHeapTuplesPerPage];
 	xl_heap_freeze_tuple frozen[MaxHeapTuplesPerPage];
 
@@ -1710,6 +1738,7 @@ retry:
 	prunestate->all_frozen = true;
 	prunestate->visibility_cutoff_xid = InvalidTransactionId;
 	nfrozen = 0;
+	freeze_cutoff_xid = vacrel->FreezeLimit;
 
 	for (offnum = FirstOffsetNumber;
 		 offnum <= maxoff;
@@ -1896,6 +1925,73 @@ retry:
 			prunestate->all_frozen = false;
 	}
 
+	/*
+	 * If the page is all-visible but won't be all-frozen, and we are going to
+	 * dirty it anyway, consider freezing every tuple on it now rather than
+	 * waiting for them to reach FreezeLimit.  The page is dirtied when we
+	 * prune or freeze something, or when our caller sets it all-visible for
+	 * the first time.  Freezing it at this point costs little more than the
+	 * WAL record, whereas leaving it all-visible but unfrozen means that a
+	 * future aggressive vacuum has to read and rewrite it again, usually
+	 * together with every other such page of the table.
+	 *
+	 * The page can only be marked all-frozen if all of its tuples can be
+	 * frozen, so this is all or nothing.  We don't attempt it for pages with
+	 * MultiXact xmax values, since freezing those can require creating new
+	 * MultiXacts that would be wasted if we then gave up.
+	 */
+	if (vacuum_freeze_eager && prunestate->all_visible &&
+		!prunestate->all_frozen &&
+		(nfrozen > 0 || tuples_deleted > 0 || !PageIsAllVisible(page)))
+	{
+		xl_heap_freeze_tuple eager[MaxHeapTuplesPerPage];
+		int			neager = 0;
+		bool		all_frozen = true;
+
+		for (offnum = FirstOffsetNumber;
+			 offnum <= maxoff;
+			 offnum = OffsetNumberNext(offnum))
+		{
+			HeapTupleHeader htup;
+			bool		tuple_totally_frozen;
+
+			itemid = PageGetItemId(page, offnum);
+			if (!ItemIdIsNormal(itemid))
+				continue;
+
+			htup = (HeapTupleHeader) PageGetItem(page, itemid);
+			if (htup->t_infomask & HEAP_XMAX_IS_MULTI)
+			{
+				all_frozen = false;
+				break;
+			}
+
+			if (heap_prepare_freeze_tuple(htup,
+										  vacrel->relfrozenxid,
+										  vacrel->relminmxid,
+										  vacrel->OldestXmin,
+										  vacrel->MultiXactCutoff,
+										  &eager[neager],
+										  &tuple_totally_frozen))
+				eager[neager++].offset = offnum;
+
+			if (!tuple_totally_frozen)
+			{
+				all_frozen = false;
+				break;
+			}
+		}
+
+		if (all_frozen && neager > 0)
+		{
+			memcpy(frozen, eager, neager * sizeof(xl_heap_freeze_tuple));
+			nfrozen = neager;
+			freeze_cutoff_xid = vacrel->OldestXmin;
+			prunestate->all_frozen = true;
+			vacrel->eager_frozen_pages++;
+		}
+	}
+
 	/*
 	 * We have now divided every item on the page into either an LP_DEAD item
 	 * that will need to be vacuumed in indexes later, or a LP_NORMAL tuple
@@ -1915,6 +2011,8 @@ retry:
 	{
 		Assert(prunestate->hastup);
 
+		vacrel->frozen_pages++;
+
 		/*
 		 * At least one tuple with storage needs to be frozen -- execute that
 		 * now.
@@ -1943,7 +2041,7 @@ retry:
 		{
 			XLogRecPtr	recptr;
 
-			recptr = log_heap_freeze(vacrel->rel, buf, vacrel->FreezeLimit,
+			recptr = log_heap_freeze(vacrel->rel, buf, freeze_cutoff_xid,
 									 frozen, nfrozen);
 			PageSetLSN(page, recptr);
 		}
@@ -2265,6 +2363,8 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 	PGRUsage	ru0;
 	Buffer		vmbuffer = InvalidBuffer;
 	LVSavedErrInfo saved_err_info;
+	ReadStream *stream;
+	LVDeadTuplesBlockIter iter;
 
 	Assert(vacrel->do_index_vacuuming);
 	Assert(vacrel->do_index_cleanup);
@@ -2282,6 +2382,20 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 	pg_rusage_init(&ru0);
 	vacuumed_pages = 0;
 
+	/*
+	 * The blocks to visit are known in advance from the dead tuple array, so
+	 * use a read stream to have them prefetched while we work on earlier
+	 * ones.
+	 */
+	iter.dead_tuples = vacrel->dead_tuples;
+	iter.next = 0;
+	stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE,
+										vacrel->bstrategy,
+										vacrel->rel,
+										MAIN_FORKNUM,
+										lazy_vacuum_heap_next_block,
+										&iter);
+
 	tupindex = 0;
 	while (tupindex < vacrel->dead_tuples->num_tuples)
 	{
@@ -2294,8 +2408,8 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 
 		tblk = ItemPointerGetBlockNumber(&vacrel->dead_tuples->itemptrs[tupindex]);
 		vacrel->blkno = tblk;
-		buf = ReadBufferExtended(vacrel->rel, MAIN_FORKNUM, tblk, RBM_NORMAL,
-								 vacrel->bstrategy);
+		buf = read_stream_next_buffer(stream);
+		Assert(BufferIsValid(buf) && BufferGetBlockNumber(buf) == tblk);
 		LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
 		tupindex = lazy_vacuum_heap_page(vacrel, tblk, buf, tupindex,
 										 &vmbuffer);
@@ -2309,6 +2423,8 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 		vacuumed_pages++;
 	}
 
+	read_stream_end(stream);
+
 	/* Clear the block number information */
 	vacrel->blkno = InvalidBlockNumber;
 
@@ -2335,6 +2451,31 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 	restore_vacuum_error_info(vacrel, &saved_err_info);
 }
 
+/*
+ * Read stream callback for lazy_vacuum_heap_rel(): returns each heap block
+ * that has entries in the dead tuple array, once, in array order.
+ */
+static BlockNumber
+lazy_vacuum_heap_next_block(ReadStream *stream, void *callback_private_data)
+{
+	LVDeadTuplesBlockIter *iter = (LVDeadTuplesBlockIter *) callback_private_data;
+	LVDeadTuples *dead_tuples = iter->dead_tuples;
+	int		   *next = &iter->next;
+	BlockNumber blkno;
+
+	if (*next >= dead_tuples->num_tuples)
+		return InvalidBlockNumber;
+
+	blkno = ItemPointerGetBlockNumber(&dead_tuples->itemptrs[*next]);
+	do
+	{
+		(*next)++;
+	} while (*next < dead_tuples->num_tuples &&
+			 ItemPointerGetBlockNumber(&dead_tuples->itemptrs[*next]) == blkno);
+
+	return blkno;
+}
+
 /*
  *	lazy_vacuum_heap_page() -- free page's LP_DEAD items listed in the
  *						  vacrel->dead_tuples array.
@@ -3412,7 +3553,7 @@ compute_max_dead_tuples(BlockNumber relblocks, bool hasindex)
 	{
 		maxtuples = MAXDEADTUPLES(vac_work_mem * 1024L);
 		maxtuples = Min(maxtuples, INT_MAX);
-		maxtuples = Min(maxtuples, MAXDEADTUPLES(MaxAllocSize));
+		maxtuples = Min(maxtuples, MAXDEADTUPLES(MaxAllocHugeSize));
 
 		/* curious coding here to ensure the multiplication can't overflow */
 		if ((BlockNumber) (maxtuples / LAZY_ALLOC_TUPLES) > relblocks)
@@ -3470,7 +3611,8 @@ lazy_space_alloc(LVRelState *vacrel, int nworkers, BlockNumber nblocks)
 
 	maxtuples = compute_max_dead_tuples(nblocks, vacrel->nindexes > 0);
 
-	dead_tuples = (LVDeadTuples *) palloc(SizeOfDeadTuples(maxtuples));
+	dead_tuples = (LVDeadTuples *) palloc_extended(SizeOfDeadTuples(maxtuples),
+												   MCXT_ALLOC_HUGE);
 	dead_tuples->num_tuples = 0;
 	dead_tuples->max_tuples = (int) maxtuples;
 
@@ -3504,61 +3646,47 @@ static bool
 lazy_tid_reaped(ItemPointer itemptr, void *state)
 {
 	LVDeadTuples *dead_tuples = (LVDeadTuples *) state;
+	ItemPointer itemptrs = dead_tuples->itemptrs;
 	int64		litem,
 				ritem,
 				item;
-	ItemPointer res;
+	int			lo,
+				hi;
 
-	litem = itemptr_encode(&dead_tuples->itemptrs[0]);
-	ritem = itemptr_encode(&dead_tuples->itemptrs[dead_tuples->num_tuples - 1]);
+	litem = itemptr_encode(&itemptrs[0]);
+	ritem = itemptr_encode(&itemptrs[dead_tuples->num_tuples - 1]);
 	item = itemptr_encode(itemptr);
 
 	/*
-	 * Doing a simple bound check before bsearch() is useful to avoid the
-	 * extra cost of bsearch(), especially if dead tuples on the heap are
-	 * concentrated in a certain range.  Since this function is called for
-	 * every index tuple, it pays to be really fast.
+	 * Doing a simple bound check before the binary search is useful to avoid
+	 * its extra cost, especially if dead tuples on the heap are concentrated
+	 * in a certain range.  Since this function is called for every index
+	 * tuple, it pays to be really fast.
 	 */
 	if (item < litem || item > ritem)
 		return false;
 
-	res = (ItemPointer) bsearch((void *) itemptr,
-								(void *) dead_tuples->itemptrs,
-								dead_tuples->num_tuples,
-								sizeof(ItemPointerData),
-								vac_cmp_itemptr);
-
-	return (res != NULL);
-}
-
-/*
- * Comparator routines for use with qsort() and bsearch().
- */
-static int
-vac_cmp_itemptr(const void *left, const void *right)
-{
-	BlockNumber lblk,
-				rblk;
-	OffsetNumber loff,
-				roff;
-
-	lblk = ItemPointerGetBlockNumber((ItemPointer) left);
-	rblk = ItemPointerGetBlockNumber((ItemPointer) right);
-
-	if (lblk < rblk)
-		return -1;
-	if (lblk > rblk)
-		return 1;
-
-	loff = ItemPointerGetOffsetNumber((ItemPointer) left);
-	roff = ItemPointerGetOffsetNumber((ItemPointer) right);
+	/*
+	 * Binary search on the int64 encoding of the TIDs.  This is much cheaper
+	 * than bsearch(), which would call a comparator through a function
+	 * pointer and extract block and offset numbers for every probe.
+	 */
+	lo = 0;
+	hi = dead_tuples->num_tuples - 1;
+	while (lo <= hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+		int64		miditem = itemptr_encode(&itemptrs[mid]);
 
-	if (loff < roff)
-		return -1;
-	if (loff > roff)
-		return 1;
+		if (miditem < item)
+			lo = mid + 1;
+		else if (miditem > item)
+			hi = mid - 1;
+		else
+			return true;
+	}
 
-	return 0;
+	return false;
 }
 
 /*
@@ -37,7 +37,24 @@
 #include "utils/memutils.h"
 #include "utils/snapmgr.h"
 
+/*
+ * What we keep in rel->rd_amcache.  Besides a copy of the metapage, we
+ * remember the shared buffer the root page was last found in, so that the
+ * next descent can usually pin it with ReadRecentBuffer() instead of going
+ * through the buffer mapping table.  The root page is touched by every
+ * index search, which makes its BufMappingLock partition one of the hottest
+ * locks in a read-mostly workload.  The metapage copy must come first, as
+ * rd_amcache is also accessed as a plain BTMetaPageData pointer.
+ */
+typedef struct BTMetaCacheData
+{
+	BTMetaPageData btc_meta;
+	Buffer		btc_rootbuf;	/* recent buffer of btm_fastroot, or
+								 * InvalidBuffer */
+} BTMetaCacheData;
+
 static BTMetaPageData *_bt_getmeta(Relation rel, Buffer metabuf);
+static void _bt_cachemeta(Relation rel, BTMetaPageData *metad);
 static void _bt_log_reuse_page(Relation rel, BlockNumber blkno,
 							   FullTransactionId safexid);
 static void _bt_delitems_delete(Relation rel, Buffer buf,
@@ -171,6 +188,24 @@ _bt_getmeta(Relation rel, Buffer metabuf)
 	return metad;
 }
 
+/*
+ *	_bt_cachemeta() -- Save a copy of the metapage data in the relcache.
+ *
+ *		Any previously cached data must have been released already.
+ */
+static void
+_bt_cachemeta(Relation rel, BTMetaPageData *metad)
+{
+	BTMetaCacheData *cache;
+
+	Assert(rel->rd_amcache == NULL);
+
+	cache = MemoryContextAlloc(rel->rd_indexcxt, sizeof(BTMetaCacheData));
+	memcpy(&cache->btc_meta, metad, sizeof(BTMetaPageData));
+	cache->btc_rootbuf = InvalidBuffer;
+	rel->rd_amcache = cache;
+}
+
 /*
  * _bt_vacuum_needs_cleanup() -- Checks if index needs cleanup
  *
@@ -357,7 +392,9 @@ _bt_getroot(Relation rel, int access)
 	 */
 	if (rel->rd_amcache != NULL)
 	{
-		metad = (BTMetaPageData *) rel->rd_amcache;
+		BTMetaCacheData *cache = (BTMetaCacheData *) rel->rd_amcache;
+
+		metad = &cache->btc_meta;
 		/* We shouldn't have cached it if any of these fail */
 		Assert(metad->btm_magic == BTREE_MAGIC);
 		Assert(metad->btm_version >= BTREE_MIN_VERSION);
@@ -370,7 +407,25 @@ _bt_getroot(Relation rel, int access)
 		Assert(rootblkno != P_NONE);
 		rootlevel = metad->btm_fastlevel;
 
-		rootbuf = _bt_getbuf(rel, rootblkno, BT_READ);
+		/*
+		 * If we know which buffer held the root page last time, try to pin
+		 * it directly, avoiding a buffer mapping lookup.  This fails if the
+		 * buffer has been evicted in the meantime, in which case we fall
+		 * back to a regular read and remember the new buffer.
+		 */
+		if (BufferIsValid(cache->btc_rootbuf) &&
+			ReadRecentBuffer(rel->rd_node, MAIN_FORKNUM, rootblkno,
+							 cache->btc_rootbuf))
+		{
+			rootbuf = cache->btc_rootbuf;
+			_bt_lockbuf(rel, rootbuf, BT_READ);
+			_bt_checkpage(rel, rootbuf);
+		}
+		else
+		{
+			rootbuf = _bt_getbuf(rel, rootblkno, BT_READ);
+			cache->btc_rootbuf = rootbuf;
+		}
 		rootpage = BufferGetPage(rootbuf);
 		rootopaque = (BTPageOpaque) PageGetSpecialPointer(rootpage);
 
@@ -520,9 +575,7 @@ _bt_getroot(Relation rel, int access)
 		/*
 		 * Cache the metapage data for next time
 		 */
-		rel->rd_amcache = MemoryContextAlloc(rel->rd_indexcxt,
-											 sizeof(BTMetaPageData));
-		memcpy(rel->rd_amcache, metad, sizeof(BTMetaPageData));
+		_bt_cachemeta(rel, metad);
 
 		/*
 		 * We are done with the metapage; arrange to release it via first
@@ -694,9 +747,7 @@ _bt_getrootheight(Relation rel)
 		/*
 		 * Cache the metapage data for next time
 		 */
-		rel->rd_amcache = MemoryContextAlloc(rel->rd_indexcxt,
-											 sizeof(BTMetaPageData));
-		memcpy(rel->rd_amcache, metad, sizeof(BTMetaPageData));
+		_bt_cachemeta(rel, metad);
 		_bt_relbuf(rel, metabuf);
 	}
 
@@ -767,9 +818,7 @@ _bt_metaversion(Relation rel, bool *heapkeyspace, bool *allequalimage)
 		 * from version 2 to version 3, both of which are !heapkeyspace
 		 * versions.
 		 */
-		rel->rd_amcache = MemoryContextAlloc(rel->rd_indexcxt,
-											 sizeof(BTMetaPageData));
-		memcpy(rel->rd_amcache, metad, sizeof(BTMetaPageData));
+		_bt_cachemeta(rel, metad);
 		_bt_relbuf(rel, metabuf);
 	}
 
@@ -22,6 +22,7 @@
 #include "access/nbtxlog.h"
 #include "access/relscan.h"
 #include "access/xlog.h"
+#include "catalog/catalog.h"
 #include "commands/progress.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
@@ -36,6 +37,7 @@
 #include "utils/builtins.h"
 #include "utils/index_selfuncs.h"
 #include "utils/memutils.h"
+#include "utils/spccache.h"
 
 
 /*
@@ -77,6 +79,8 @@ typedef struct BTParallelScanDescData
 typedef struct BTParallelScanDescData *BTParallelScanDesc;
 
 
+static void _bt_prefetch_heap(IndexScanDesc scan, ScanDirection dir);
+static void _bt_prefetch_block(IndexScanDesc scan, BlockNumber blkno);
 static void btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 						 IndexBulkDeleteCallback callback, void *callback_state,
 						 BTCycleId cycleid);
@@ -113,6 +117,7 @@ bthandler(PG_FUNCTION_ARGS)
 	amroutine->amcanparallel = true;
 	amroutine->amcaninclude = true;
 	amroutine->amusemaintenanceworkmem = false;
+	amroutine->amsummarizing = false;
 	amroutine->amparallelvacuumoptions =
 		VACUUM_OPTION_PARALLEL_BULKDEL | VACUUM_OPTION_PARALLEL_COND_CLEANUP;
 	amroutine->amkeytype = InvalidOid;
@@ -270,13 +275,108 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 
 		/* If we have a tuple, return it ... */
 		if (res)
+		{
+			if (so->prefetchDistance > 0)
+				_bt_prefetch_heap(scan, dir);
 			break;
+		}
 		/* ... otherwise see if we have more array keys to deal with */
 	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
 
 	return res;
 }
 
+/*
+ * _bt_prefetch_heap() -- prefetch the heap blocks of upcoming items
+ *
+ * A plain index scan fetches heap tuples one at a time, in index order.  On
+ * a poorly correlated index each fetch is a random read that the kernel
+ * cannot anticipate, so the scan spends most of its time waiting for I/O.
+ * _bt_readpage() has already collected all the matching items of the
+ * current leaf page, so we can issue prefetches for the heap blocks of the
+ * next few of them, the same way bitmap heap scans do.  The items are still
+ * returned in their original order.
+ */
+static void
+_bt_prefetch_heap(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	int			itemIndex = so->currPos.itemIndex;
+
+	/*
+	 * Forget what we did on the previous page.  The block of the current
+	 * item is about to be read anyway, so there's no point prefetching it if
+	 * a later item points into it too.
+	 */
+	if (so->prefetchPage != so->currPos.currPage)
+	{
+		so->prefetchPage = so->currPos.currPage;
+		so->prefetchItem = itemIndex;
+		for (int i = 0; i < BT_PREFETCH_RECENT; i++)
+			so->prefetchRecent[i] = InvalidBlockNumber;
+		so->prefetchRecent[0] =
+			ItemPointerGetBlockNumber(&so->currPos.items[itemIndex].heapTid);
+		so->prefetchNext = 1;
+	}
+
+	if (ScanDirectionIsForward(dir))
+	{
+		int			last = Min(itemIndex + so->prefetchDistance,
+							   so->currPos.lastItem);
+
+		/* The current item is about to be fetched anyway */
+		if (so->prefetchItem <= itemIndex)
+			so->prefetchItem = itemIndex + 1;
+
+		for (; so->prefetchItem <= last; so->prefetchItem++)
+		{
+			BlockNumber blkno;
+
+			blkno = ItemPointerGetBlockNumber(&so->currPos.items[so->prefetchItem].heapTid);
+			_bt_prefetch_block(scan, blkno);
+		}
+	}
+	else
+	{
+		int			first = Max(itemIndex - so->prefetchDistance,
+								so->currPos.firstItem);
+
+		if (so->prefetchItem >= itemIndex)
+			so->prefetchItem = itemIndex - 1;
+
+		for (; so->prefetchItem >= first; so->prefetchItem--)
+		{
+			BlockNumber blkno;
+
+			blkno = ItemPointerGetBlockNumber(&so->currPos.items[so->prefetchItem].heapTid);
+			_bt_prefetch_block(scan, blkno);
+		}
+	}
+}
+
+/*
+ * _bt_prefetch_block() -- prefetch one heap block, unless done recently
+ *
+ * Heap tuples that are close together in the index often share a heap block
+ * even on a poorly correlated index, and issuing the same advice again only
+ * costs a buffer mapping lookup and a system call.
+ */
+static void
+_bt_prefetch_block(IndexScanDesc scan, BlockNumber blkno)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+
+	for (int i = 0; i < BT_PREFETCH_RECENT; i++)
+	{
+		if (so->prefetchRecent[i] == blkno)
+			return;
+	}
+
+	PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+	so->prefetchRecent[so->prefetchNext] = blkno;
+	so->prefetchNext = (so->prefetchNext + 1) % BT_PREFETCH_RECENT;
+}
+
 /*
  * btgetbitmap() -- gets all matching tuples, and adds them to a bitmap
  */
@@ -367,6 +467,9 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
+	so->prefetchDistance = -1;	/* set in btrescan */
+	so->prefetchPage = InvalidBlockNumber;
+
 	/*
 	 * We don't know yet whether the scan will be index-only, so we do not
 	 * allocate the tuple workspace arrays until btrescan.  However, we set up
@@ -405,6 +508,35 @@ btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 	BTScanPosUnpinIfPinned(so->markPos);
 	BTScanPosInvalidate(so->markPos);
 
+	/*
+	 * Decide whether to prefetch heap blocks, the first time through.  We
+	 * know by now whether the scan is index-only, in which case heap fetches
+	 * should be rare.  Catalog scans don't prefetch, to keep the tablespace
+	 * lookup from recursing into the catalogs.
+	 *
+	 * With the default effective_io_concurrency of 1, storage is assumed to
+	 * gain nothing from concurrent requests, so prefetching only one item
+	 * ahead would just add system calls to every heap fetch.  We prefetch
+	 * only when asked for more than that.
+	 */
+	if (so->prefetchDistance < 0)
+	{
+		so->prefetchDistance = 0;
+#ifdef USE_PREFETCH
+		if (scan->heapRelation != NULL && !scan->xs_want_itup &&
+			!IsCatalogRelation(scan->heapRelation))
+		{
+			int			io_concurrency;
+
+			io_concurrency =
+				get_tablespace_io_concurrency(scan->heapRelation->rd_rel->reltablespace);
+			if (io_concurrency > 1)
+				so->prefetchDistance = io_concurrency;
+		}
+#endif
+	}
+	so->prefetchPage = InvalidBlockNumber;
+
 	/*
 	 * Allocate tuple workspace arrays, if needed for an index-only scan and
 	 * not already done in a previous rescan call.  To save on palloc
@@ -556,6 +688,8 @@ btrestrpos(IndexScanDesc scan)
 			if (so->currTuples)
 				memcpy(so->currTuples, so->markTuples,
 					   so->markPos.nextTupleOffset);
+			/* currPos.items changed, so start prefetching afresh */
+			so->prefetchPage = InvalidBlockNumber;
 		}
 		else
 			BTScanPosInvalidate(so->currPos);
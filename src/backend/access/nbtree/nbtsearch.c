@@ -26,6 +26,8 @@
 
 static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
 static OffsetNumber _bt_binsrch(Relation rel, BTScanInsert key, Buffer buf);
+static int32 _bt_compare_prefix(Relation rel, BTScanInsert key, Page page,
+								OffsetNumber offnum, int *prefixatts);
 static int	_bt_binsrch_posting(BTScanInsert key, Page page,
 								OffsetNumber offnum);
 static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir,
@@ -350,6 +352,8 @@ _bt_binsrch(Relation rel,
 				high;
 	int32		result,
 				cmpval;
+	int			lowprefix = 0,
+				highprefix = 0;
 
 	page = BufferGetPage(buf);
 	opaque = (BTPageOpaque) PageGetSpecialPointer(page);
@@ -383,6 +387,13 @@ _bt_binsrch(Relation rel,
 	 * 'low' are <= scan key, all slots at or after 'high' are > scan key.
 	 *
 	 * We can fall out when high == low.
+	 *
+	 * lowprefix and highprefix are the number of leading key attributes that
+	 * the scan key was found to be equal to in the tuples that last moved
+	 * 'low' and 'high'.  Every tuple between those two has the same values
+	 * for the smaller of those numbers of attributes, so comparisons can skip
+	 * them.  On indexes whose leading columns have few distinct values, this
+	 * saves most of the comparator calls of the search.
 	 */
 	high++;						/* establish the loop invariant for high */
 
@@ -391,15 +402,22 @@ _bt_binsrch(Relation rel,
 	while (high > low)
 	{
 		OffsetNumber mid = low + ((high - low) / 2);
+		int			prefix = Min(lowprefix, highprefix);
 
 		/* We have low <= mid < high, so mid points at a real slot */
 
-		result = _bt_compare(rel, key, page, mid);
+		result = _bt_compare_prefix(rel, key, page, mid, &prefix);
 
 		if (result >= cmpval)
+		{
 			low = mid + 1;
+			lowprefix = prefix;
+		}
 		else
+		{
 			high = mid;
+			highprefix = prefix;
+		}
 	}
 
 	/*
@@ -454,6 +472,8 @@ _bt_binsrch_insert(Relation rel, BTInsertState insertstate)
 				stricthigh;
 	int32		result,
 				cmpval;
+	int			lowprefix = 0,
+				highprefix = 0;
 
 	page = BufferGetPage(insertstate->buf);
 	opaque = (BTPageOpaque) PageGetSpecialPointer(page);
@@ -493,6 +513,9 @@ _bt_binsrch_insert(Relation rel, BTInsertState insertstate)
 	 * at or after 'high' are >= scan key.  'stricthigh' is > scan key, and is
 	 * maintained to save additional search effort for caller.
 	 *
+	 * lowprefix and highprefix let us skip over leading attributes known to
+	 * be equal, as in _bt_binsrch().
+	 *
 	 * We can fall out when high == low.
 	 */
 	if (!insertstate->bounds_valid)
@@ -504,16 +527,21 @@ _bt_binsrch_insert(Relation rel, BTInsertState insertstate)
 	while (high > low)
 	{
 		OffsetNumber mid = low + ((high - low) / 2);
+		int			prefix = Min(lowprefix, highprefix);
 
 		/* We have low <= mid < high, so mid points at a real slot */
 
-		result = _bt_compare(rel, key, page, mid);
+		result = _bt_compare_prefix(rel, key, page, mid, &prefix);
 
 		if (result >= cmpval)
+		{
 			low = mid + 1;
+			lowprefix = prefix;
+		}
 		else
 		{
 			high = mid;
+			highprefix = prefix;
 			if (result != 0)
 				stricthigh = high;
 		}
@@ -645,6 +673,26 @@ _bt_compare(Relation rel,
 			BTScanInsert key,
 			Page page,
 			OffsetNumber offnum)
+{
+	int			prefixatts = 0;
+
+	return _bt_compare_prefix(rel, key, page, offnum, &prefixatts);
+}
+
+/*
+ *	_bt_compare_prefix() -- _bt_compare(), skipping known-equal attributes.
+ *
+ * On entry, *prefixatts is the number of leading key attributes that the
+ * caller already knows the tuple at offnum to be equal to the scankey in;
+ * those are not compared again.  On exit, it is set to the number of leading
+ * key attributes that were found to be equal.
+ */
+static int32
+_bt_compare_prefix(Relation rel,
+				   BTScanInsert key,
+				   Page page,
+				   OffsetNumber offnum,
+				   int *prefixatts)
 {
 	TupleDesc	itupdesc = RelationGetDescr(rel);
 	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
@@ -664,7 +712,10 @@ _bt_compare(Relation rel,
 	 * --- see NOTE above.
 	 */
 	if (!P_ISLEAF(opaque) && offnum == P_FIRSTDATAKEY(opaque))
+	{
+		*prefixatts = 0;
 		return 1;
+	}
 
 	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
 	ntupatts = BTreeTupleGetNAtts(itup, rel);
@@ -684,8 +735,8 @@ _bt_compare(Relation rel,
 	ncmpkey = Min(ntupatts, key->keysz);
 	Assert(key->heapkeyspace || ncmpkey == key->keysz);
 	Assert(!BTreeTupleIsPosting(itup) || key->allequalimage);
-	scankey = key->scankeys;
-	for (int i = 1; i <= ncmpkey; i++)
+	scankey = key->scankeys + *prefixatts;
+	for (int i = *prefixatts + 1; i <= ncmpkey; i++)
 	{
 		Datum		datum;
 		bool		isNull;
@@ -729,10 +780,14 @@ _bt_compare(Relation rel,
 
 		/* if the keys are unequal, return the difference */
 		if (result != 0)
+		{
+			*prefixatts = i - 1;
 			return result;
+		}
 
 		scankey++;
 	}
+	*prefixatts = Max(*prefixatts, ncmpkey);
 
 	/*
 	 * All non-truncated attributes (other than heap TID) were found to be
@@ -1546,6 +1601,13 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 	 */
 	so->currPos.currPage = BufferGetBlockNumber(so->currPos.buf);
 
+	/*
+	 * currPos.items is about to be refilled, so forget what we prefetched for
+	 * the old contents.  Comparing block numbers isn't enough, as the same
+	 * page can be read again, e.g. for the next set of array keys.
+	 */
+	so->prefetchPage = InvalidBlockNumber;
+
 	/*
 	 * We save the LSN of the page as we read it, so that we know whether it
 	 * safe to apply LP_DEAD hints to the page later.  This allows us to drop
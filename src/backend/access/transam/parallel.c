@@ -101,6 +101,9 @@ typedef struct FixedParallelState
 
 	/* Maximum XactLastRecEnd of any worker. */
 	XLogRecPtr	last_xlog_end;
+
+	/* Should workers that haven't started up yet exit at once? */
+	bool		skip_startup;
 } FixedParallelState;
 
 /*
@@ -331,6 +334,7 @@ InitializeParallelDSM(ParallelContext *pcxt)
 	fps->serializable_xact_handle = ShareSerializableXact();
 	SpinLockInit(&fps->mutex);
 	fps->last_xlog_end = 0;
+	fps->skip_startup = false;
 	shm_toc_insert(pcxt->toc, PARALLEL_KEY_FIXED, fps);
 
 	/* We can skip the rest of this if we're not budgeting for any workers. */
@@ -482,6 +486,7 @@ ReinitializeParallelDSM(ParallelContext *pcxt)
 	/* Reset a few bits of fixed parallel state to a clean state. */
 	fps = shm_toc_lookup(pcxt->toc, PARALLEL_KEY_FIXED, false);
 	fps->last_xlog_end = 0;
+	fps->skip_startup = false;
 
 	/* Recreate error queues (if they exist). */
 	if (pcxt->nworkers > 0)
@@ -736,6 +741,36 @@ WaitForParallelWorkersToAttach(ParallelContext *pcxt)
 	}
 }
 
+/*
+ * Tell workers that haven't started up yet that they won't be needed.
+ *
+ * The caller must be sure that a worker which has not yet begun the parallel
+ * operation would find no work left to do, for example because the leader has
+ * seen the end of a parallel scan.  Such a worker exits as soon as it has
+ * attached to its error queue, rather than first restoring the leader's
+ * state and connecting to the database, which is most of the cost of
+ * starting a worker; so the leader doesn't have to wait for all that when a
+ * short parallel query finishes before its workers get going.  Workers that
+ * are already past that point carry on as usual.
+ *
+ * Only callers that know it's OK for a launched worker to do nothing at all
+ * should use this; for example, a parallel index build waits for every
+ * worker to report in.
+ */
+void
+SkipUnstartedParallelWorkers(ParallelContext *pcxt)
+{
+	FixedParallelState *fps;
+
+	if (pcxt->nworkers_launched == 0)
+		return;
+
+	fps = shm_toc_lookup(pcxt->toc, PARALLEL_KEY_FIXED, false);
+	SpinLockAcquire(&fps->mutex);
+	fps->skip_startup = true;
+	SpinLockRelease(&fps->mutex);
+}
+
 /*
  * Wait for all workers to finish computing.
  *
@@ -1334,6 +1369,19 @@ ParallelWorkerMain(Datum main_arg)
 	pq_sendint32(&msgbuf, (int32) MyCancelKey);
 	pq_endmessage(&msgbuf);
 
+	/*
+	 * If the leader has already decided that it can do without us, just
+	 * report a clean exit; see SkipUnstartedParallelWorkers.
+	 */
+	SpinLockAcquire(&fps->mutex);
+	if (fps->skip_startup)
+	{
+		SpinLockRelease(&fps->mutex);
+		pq_putmessage('X', NULL, 0);
+		return;
+	}
+	SpinLockRelease(&fps->mutex);
+
 	/*
 	 * Hooray! Primary initialization is complete.  Now, we need to set up our
 	 * backend-local state to match the original backend.
@@ -31,6 +31,7 @@
 #include "access/slru.h"
 #include "access/subtrans.h"
 #include "access/transam.h"
+#include "access/xlog.h"
 #include "pg_trace.h"
 #include "utils/snapmgr.h"
 
@@ -62,6 +63,31 @@ static SlruCtlData SubTransCtlData;
 
 #define SubTransCtl  (&SubTransCtlData)
 
+/* GUC variable */
+int			subtransaction_buffers = 32;
+
+/*
+ * Backend-local cache of SubTransGetTopmostTransaction() results.
+ *
+ * Once a snapshot has overflowed, every visibility check against a tuple
+ * written by a subtransaction walks pg_subtrans, taking SubtransSLRULock and
+ * possibly reading pages from disk.  Scans usually meet the same few XIDs
+ * over and over, so a small direct-mapped cache avoids most of those walks.
+ * An entry is only trusted while TransactionXmin is the same as when it was
+ * filled: within that window the answer cannot change, and XIDs cannot have
+ * wrapped around.
+ */
+#define SUBTRANS_TOPMOST_CACHE_SIZE 256
+
+typedef struct SubTransTopmostCacheEntry
+{
+	TransactionId xid;
+	TransactionId topxid;
+	TransactionId xmin;			/* TransactionXmin when the entry was filled */
+} SubTransTopmostCacheEntry;
+
+static SubTransTopmostCacheEntry topmostCache[SUBTRANS_TOPMOST_CACHE_SIZE];
+
 
 static int	ZeroSUBTRANSPage(int pageno);
 static bool SubTransPagePrecedes(int page1, int page2);
@@ -151,10 +177,16 @@ SubTransGetTopmostTransaction(TransactionId xid)
 {
 	TransactionId parentXid = xid,
 				previousXid = xid;
+	SubTransTopmostCacheEntry *entry;
 
 	/* Can't ask about stuff that might not be around anymore */
 	Assert(TransactionIdFollowsOrEquals(xid, TransactionXmin));
 
+	entry = &topmostCache[xid % SUBTRANS_TOPMOST_CACHE_SIZE];
+	if (entry->xid == xid && entry->xmin == TransactionXmin &&
+		TransactionIdIsValid(xid))
+		return entry->topxid;
+
 	while (TransactionIdIsValid(parentXid))
 	{
 		previousXid = parentXid;
@@ -174,6 +206,18 @@ SubTransGetTopmostTransaction(TransactionId xid)
 
 	Assert(TransactionIdIsValid(previousXid));
 
+	/*
+	 * During recovery, parent links are recorded only once the assignment
+	 * record has been replayed, so an answer could still change; don't cache
+	 * it.
+	 */
+	if (!RecoveryInProgress())
+	{
+		entry->xid = xid;
+		entry->topxid = previousXid;
+		entry->xmin = TransactionXmin;
+	}
+
 	return previousXid;
 }
 
@@ -184,14 +228,14 @@ SubTransGetTopmostTransaction(TransactionId xid)
 Size
 SUBTRANSShmemSize(void)
 {
-	return SimpleLruShmemSize(NUM_SUBTRANS_BUFFERS, 0);
+	return SimpleLruShmemSize(subtransaction_buffers, 0);
 }
 
 void
 SUBTRANSShmemInit(void)
 {
 	SubTransCtl->PagePrecedes = SubTransPagePrecedes;
-	SimpleLruInit(SubTransCtl, "Subtrans", NUM_SUBTRANS_BUFFERS, 0,
+	SimpleLruInit(SubTransCtl, "Subtrans", subtransaction_buffers, 0,
 				  SubtransSLRULock, "pg_subtrans",
 				  LWTRANCHE_SUBTRANS_BUFFER, SYNC_HANDLER_NONE);
 	SlruPagePrecedesUnitTests(SubTransCtl, SUBTRANS_XACTS_PER_PAGE);
@@ -942,6 +942,32 @@ static struct xllist
 	uint32		total_len;		/* total data bytes in chain */
 }			records;
 
+/*
+ * Copies of the state data of the transactions most recently prepared by
+ * this backend.  A transaction manager often issues COMMIT PREPARED on the
+ * same connection soon after PREPARE TRANSACTION; with this cache, that
+ * doesn't have to read the PREPARE record back from WAL.  Entries are
+ * matched on both XID and PREPARE record location, so a stale entry can
+ * never be mistaken for another transaction's state.  Only small state data
+ * is cached, and the oldest entry is replaced when the cache is full.
+ */
+#define TWOPHASE_CACHE_ENTRIES		8
+#define TWOPHASE_CACHE_MAX_LEN		8192
+
+typedef struct TwoPhaseCacheEntry
+{
+	TransactionId xid;
+	XLogRecPtr	prepare_start_lsn;
+	uint32		len;
+	char	   *data;			/* allocated in TopMemoryContext */
+} TwoPhaseCacheEntry;
+
+static TwoPhaseCacheEntry TwoPhaseStateCache[TWOPHASE_CACHE_ENTRIES];
+static int	TwoPhaseStateCacheNext = 0;
+
+static void TwoPhaseCacheRemember(GlobalTransaction gxact);
+static char *TwoPhaseCacheLookup(TransactionId xid, XLogRecPtr lsn);
+
 
 /*
  * Append a block of data to records data structure.
@@ -1163,6 +1189,9 @@ EndPrepare(GlobalTransaction gxact)
 
 	END_CRIT_SECTION();
 
+	/* Keep a copy of the state data for a later COMMIT PREPARED */
+	TwoPhaseCacheRemember(gxact);
+
 	/*
 	 * Wait for synchronous replication, if required.
 	 *
@@ -1175,6 +1204,81 @@ EndPrepare(GlobalTransaction gxact)
 	records.num_chunks = 0;
 }
 
+/*
+ * TwoPhaseCacheRemember
+ *		Save a copy of the just-written state data in TwoPhaseStateCache.
+ *
+ * The transaction is already prepared at this point, so we must not throw
+ * an error; if we can't get the memory, we just don't cache the data.
+ */
+static void
+TwoPhaseCacheRemember(GlobalTransaction gxact)
+{
+	TwoPhaseCacheEntry *entry;
+	StateFileChunk *record;
+	char	   *data;
+	uint32		len = 0;
+
+	if (records.total_len > TWOPHASE_CACHE_MAX_LEN)
+		return;
+
+	data = MemoryContextAllocExtended(TopMemoryContext, records.total_len,
+									  MCXT_ALLOC_NO_OOM);
+	if (data == NULL)
+		return;
+
+	for (record = records.head; record != NULL; record = record->next)
+	{
+		memcpy(data + len, record->data, record->len);
+		len += record->len;
+	}
+	Assert(len == records.total_len);
+
+	entry = &TwoPhaseStateCache[TwoPhaseStateCacheNext];
+	TwoPhaseStateCacheNext = (TwoPhaseStateCacheNext + 1) % TWOPHASE_CACHE_ENTRIES;
+
+	if (entry->data != NULL)
+		pfree(entry->data);
+	entry->xid = gxact->xid;
+	entry->prepare_start_lsn = gxact->prepare_start_lsn;
+	entry->len = len;
+	entry->data = data;
+}
+
+/*
+ * TwoPhaseCacheLookup
+ *		Look for cached state data of the transaction prepared at lsn.
+ *
+ * If found, the entry is removed from the cache and a palloc'd copy of the
+ * data is returned.  Otherwise returns NULL.
+ */
+static char *
+TwoPhaseCacheLookup(TransactionId xid, XLogRecPtr lsn)
+{
+	int			i;
+
+	for (i = 0; i < TWOPHASE_CACHE_ENTRIES; i++)
+	{
+		TwoPhaseCacheEntry *entry = &TwoPhaseStateCache[i];
+		char	   *buf;
+
+		if (entry->data == NULL ||
+			!TransactionIdEquals(entry->xid, xid) ||
+			entry->prepare_start_lsn != lsn)
+			continue;
+
+		buf = palloc(entry->len);
+		memcpy(buf, entry->data, entry->len);
+
+		pfree(entry->data);
+		entry->data = NULL;
+
+		return buf;
+	}
+
+	return NULL;
+}
+
 /*
  * Register a 2PC record to be written to state file.
  */
@@ -1435,12 +1539,17 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
 	/*
 	 * Read and validate 2PC state data. State data will typically be stored
 	 * in WAL files if the LSN is after the last checkpoint record, or moved
-	 * to disk if for some reason they have lived for a long time.
+	 * to disk if for some reason they have lived for a long time.  If this
+	 * backend prepared the transaction itself, we may still have a copy.
 	 */
-	if (gxact->ondisk)
-		buf = ReadTwoPhaseFile(xid, false);
-	else
-		XlogReadTwoPhaseData(gxact->prepare_start_lsn, &buf, NULL);
+	buf = TwoPhaseCacheLookup(xid, gxact->prepare_start_lsn);
+	if (buf == NULL)
+	{
+		if (gxact->ondisk)
+			buf = ReadTwoPhaseFile(xid, false);
+		else
+			XlogReadTwoPhaseData(gxact->prepare_start_lsn, &buf, NULL);
+	}
 
 
 	/*
@@ -836,6 +836,9 @@ SetCurrentStatementStartTimestamp(void)
 		stmtStartTimestamp = GetCurrentTimestamp();
 	else
 		Assert(stmtStartTimestamp != 0);
+
+	/* catcache entries accessed by this statement are stamped with this */
+	SetCatCacheClock(stmtStartTimestamp);
 }
 
 /*
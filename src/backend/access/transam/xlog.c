@@ -99,7 +99,7 @@ char	   *XLogArchiveCommand = NULL;
 bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
-bool		wal_compression = false;
+int			wal_compression = WAL_COMPRESSION_NONE;
 char	   *wal_consistency_checking_string = NULL;
 bool	   *wal_consistency_checking = NULL;
 bool		wal_init_zero = true;
@@ -107,7 +107,7 @@ bool		wal_recycle = true;
 bool		log_checkpoints = false;
 int			sync_method = DEFAULT_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_MINIMAL;
-int			CommitDelay = 0;	/* precommit delay in microseconds */
+int			CommitDelay = 0;	/* precommit delay in microseconds, or -1 */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
 int			wal_retrieve_retry_interval = 5000;
 int			max_slot_wal_keep_size_mb = -1;
@@ -118,14 +118,17 @@ bool		track_wal_io_timing = false;
 bool		XLOG_DEBUG = false;
 #endif
 
+/* Upper limit for commit_delay, also applied to its automatic setting */
+#define MAX_COMMIT_DELAY	100000
+
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Number of WAL insertion locks to use (wal_insert_locks).  A higher value
+ * allows more insertions to happen concurrently, but adds some CPU overhead
+ * to flushing the WAL, which needs to iterate all the locks.
  */
-#define NUM_XLOGINSERT_LOCKS  8
+int			NumXLogInsertLocks = 8;
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -616,6 +619,13 @@ typedef struct XLogCtlData
 	pg_time_t	lastSegSwitchTime;
 	XLogRecPtr	lastSegSwitchLSN;
 
+	/*
+	 * Moving average of the time XLogFlush() spends writing and flushing WAL,
+	 * in microseconds, used to size the delay when commit_delay is -1.
+	 * Protected by WALWriteLock.
+	 */
+	uint64		avgFlushTime;
+
 	/*
 	 * Protected by info_lck and WALWriteLock (you must hold either lock to
 	 * read it, but both to update)
@@ -822,6 +832,23 @@ static XLogSegNo openLogSegNo = 0;
 static int	readFile = -1;
 static XLogSource readSource = XLOG_FROM_ANY;
 
+/*
+ * When replaying WAL from files, we ask the kernel to read the segment ahead
+ * of us in chunks of XLOG_READ_AHEAD_SIZE, so that each pg_pread() of a WAL
+ * page doesn't have to wait for the disk.  readAheadEnd is the segment offset
+ * up to which read-ahead has been requested in the file identified by
+ * readAheadTLI, readAheadSource and readAheadSegNo.  The same segment number
+ * can be read from several files, of different timelines or from pg_wal and
+ * the archive, and read-ahead requested for one of them says nothing about
+ * the others.
+ */
+#define XLOG_READ_AHEAD_SIZE	(1024 * 1024)
+
+static TimeLineID readAheadTLI = 0;
+static XLogSource readAheadSource = XLOG_FROM_ANY;
+static XLogSegNo readAheadSegNo = 0;
+static uint32 readAheadEnd = 0;
+
 /*
  * Keeps track of which source we're currently reading from. This is
  * different from readSource in that this is always set, even when we don't
@@ -914,6 +941,7 @@ static int	XLogFileReadAnyTLI(XLogSegNo segno, int emode, XLogSource source);
 static bool XLogPageRead(XLogReaderState *state,
 						 bool fetching_ckpt, int emode, bool randAccess,
 						 bool nowait);
+static void XLogFileReadAhead(XLogSegNo segno, uint32 pageoff);
 static bool WaitForWALToBecomeAvailable(XLogRecPtr RecPtr, bool randAccess,
 										bool fetching_ckpt,
 										XLogRecPtr tliRecPtr,
@@ -1043,7 +1071,7 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
 	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * determined by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1685,7 +1713,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProc->pgprocno % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProc->pgprocno % NumXLogInsertLocks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1703,7 +1731,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % NumXLogInsertLocks;
 	}
 }
 
@@ -1721,7 +1749,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < NumXLogInsertLocks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1747,7 +1775,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < NumXLogInsertLocks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1775,8 +1803,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-						&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[NumXLogInsertLocks - 1].l.lock,
+						&WALInsertLocks[NumXLogInsertLocks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1843,7 +1871,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -2928,6 +2956,8 @@ XLogFlush(XLogRecPtr record)
 	for (;;)
 	{
 		XLogRecPtr	insertpos;
+		instr_time	flush_start;
+		int			delay;
 
 		/* read LogwrtResult and update local state */
 		SpinLockAcquire(&XLogCtl->info_lck);
@@ -2977,13 +3007,23 @@ XLogFlush(XLogRecPtr record)
 		 * followers; this can significantly improve transaction throughput,
 		 * at the risk of increasing transaction latency.
 		 *
+		 * With commit_delay = -1, the delay is half of the recent average
+		 * flush time: the slower the flushes, the more backends are likely
+		 * to pile up behind us meanwhile, and the more worthwhile it is to
+		 * wait for them.
+		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
+		if (CommitDelay >= 0)
+			delay = CommitDelay;
+		else
+			delay = (int) Min(XLogCtl->avgFlushTime / 2, MAX_COMMIT_DELAY);
+
+		if (delay > 0 && enableFsync &&
 			MinimumActiveBackends(CommitSiblings))
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -3002,8 +3042,24 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
+		if (CommitDelay < 0)
+			INSTR_TIME_SET_CURRENT(flush_start);
+
 		XLogWrite(WriteRqst, false);
 
+		if (CommitDelay < 0)
+		{
+			instr_time	flush_time;
+
+			INSTR_TIME_SET_CURRENT(flush_time);
+			INSTR_TIME_SUBTRACT(flush_time, flush_start);
+
+			/* exponential moving average, giving each flush a weight of 1/8 */
+			XLogCtl->avgFlushTime = XLogCtl->avgFlushTime -
+				XLogCtl->avgFlushTime / 8 +
+				INSTR_TIME_GET_MICROSEC(flush_time) / 8;
+		}
+
 		LWLockRelease(WALWriteLock);
 		/* done */
 		break;
@@ -5116,7 +5172,7 @@ XLOGShmemSize(void)
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NumXLogInsertLocks + 1));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(XLogRecPtr), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -5206,9 +5262,9 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) % sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * NumXLogInsertLocks;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
@@ -8609,7 +8665,7 @@ GetLastImportantRecPtr(void)
 	XLogRecPtr	res = InvalidXLogRecPtr;
 	int			i;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		XLogRecPtr	last_important;
 
@@ -10531,10 +10587,18 @@ static int
 get_sync_bit(int method)
 {
 	int			o_direct_flag = 0;
+	int			io_direct_flag = 0;
+
+	/*
+	 * If io_direct asks for it, always use O_DIRECT, whatever the sync
+	 * method, except in walreceiver (see below).
+	 */
+	if ((io_direct_flags & IO_DIRECT_WAL) && !AmWalReceiverProcess())
+		io_direct_flag = PG_O_DIRECT;
 
 	/* If fsync is disabled, never open in sync mode */
 	if (!enableFsync)
-		return 0;
+		return io_direct_flag;
 
 	/*
 	 * Optimize writes by bypassing kernel cache with O_DIRECT when using
@@ -10552,6 +10616,7 @@ get_sync_bit(int method)
 	 */
 	if (!XLogIsNeeded() && !AmWalReceiverProcess())
 		o_direct_flag = PG_O_DIRECT;
+	o_direct_flag |= io_direct_flag;
 
 	switch (method)
 	{
@@ -10564,7 +10629,7 @@ get_sync_bit(int method)
 		case SYNC_METHOD_FSYNC:
 		case SYNC_METHOD_FSYNC_WRITETHROUGH:
 		case SYNC_METHOD_FDATASYNC:
-			return 0;
+			return io_direct_flag;
 #ifdef OPEN_SYNC_FLAG
 		case SYNC_METHOD_OPEN:
 			return OPEN_SYNC_FLAG | o_direct_flag;
@@ -12111,6 +12176,41 @@ CancelBackup(void)
 	}
 }
 
+/*
+ * Ask the kernel to read ahead in the currently open WAL segment, which we
+ * are about to read at offset pageoff.  A new chunk is requested once we
+ * have consumed half of the previous one, so reads stay ahead of replay.
+ */
+static void
+XLogFileReadAhead(XLogSegNo segno, uint32 pageoff)
+{
+#if defined(USE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+	/*
+	 * Start over after switching files, or after jumping past the window or
+	 * back before it
+	 */
+	if (curFileTLI != readAheadTLI || readSource != readAheadSource ||
+		segno != readAheadSegNo || pageoff >= readAheadEnd ||
+		readAheadEnd - pageoff > XLOG_READ_AHEAD_SIZE)
+	{
+		readAheadTLI = curFileTLI;
+		readAheadSource = readSource;
+		readAheadSegNo = segno;
+		readAheadEnd = pageoff;
+	}
+
+	if (readAheadEnd - pageoff < XLOG_READ_AHEAD_SIZE / 2 &&
+		readAheadEnd < wal_segment_size)
+	{
+		uint32		len = Min(XLOG_READ_AHEAD_SIZE,
+							  wal_segment_size - readAheadEnd);
+
+		(void) posix_fadvise(readFile, readAheadEnd, len, POSIX_FADV_WILLNEED);
+		readAheadEnd += len;
+	}
+#endif
+}
+
 /*
  * Read the XLOG page containing RecPtr into readBuf (if not read already).
  * Returns number of bytes read, if the page is read successfully, or -1
@@ -12229,6 +12329,14 @@ retry:
 	else
 		readLen = XLOG_BLCKSZ;
 
+	/*
+	 * Streamed WAL has just been written by the walreceiver and is most
+	 * likely still cached, but WAL restored from the archive or found in
+	 * pg_wal generally has to come from disk.
+	 */
+	if (readSource != XLOG_FROM_STREAM)
+		XLogFileReadAhead(state->seg.ws_segno, targetPageOff);
+
 	pgstat_report_wait_start(WAIT_EVENT_WAL_READ);
 	r = pg_pread(readFile, readBuf, XLOG_BLCKSZ, (off_t) targetPageOff);
 	if (r != XLOG_BLCKSZ)
@@ -12745,6 +12853,9 @@ WaitForWALToBecomeAvailable(XLogRecPtr RecPtr, bool randAccess,
 						streaming_reply_sent = true;
 					}
 
+					/* Do any background tasks that might benefit us later. */
+					KnownAssignedTransactionIdsIdleMaintenance();
+
 					/*
 					 * Wait for more WAL to arrive. Time out after 5 seconds
 					 * to react to a trigger file promptly and to check if the
@@ -71,7 +71,7 @@
 #define XLOGPREFETCHER_SAMPLE_DISTANCE 0x40000
 
 /* GUCs */
-bool		recovery_prefetch = false;
+bool		recovery_prefetch = DEFAULT_RECOVERY_PREFETCH;
 bool		recovery_prefetch_fpw = false;
 
 int			XLogPrefetchReconfigureCount;
@@ -86,7 +86,8 @@ CatalogIndexInsert(CatalogIndexState indstate, HeapTuple heapTuple)
 	/*
 	 * HOT update does not require index inserts. But with asserts enabled we
 	 * want to check that it'd be legal to currently insert into the
-	 * table/index.
+	 * table/index.  (System catalogs have no summarizing indexes, so a HOT
+	 * update never needs any index inserts here.)
 	 */
 #ifndef USE_ASSERT_CHECKING
 	if (HeapTupleIsHeapOnly(heapTuple))
@@ -301,12 +302,13 @@ void
 CatalogTupleUpdate(Relation heapRel, ItemPointer otid, HeapTuple tup)
 {
 	CatalogIndexState indstate;
+	TU_UpdateIndexes updateIndexes = TU_All;
 
 	CatalogTupleCheckConstraints(heapRel, tup);
 
 	indstate = CatalogOpenIndexes(heapRel);
 
-	simple_heap_update(heapRel, otid, tup);
+	simple_heap_update(heapRel, otid, tup, &updateIndexes);
 
 	CatalogIndexInsert(indstate, tup);
 	CatalogCloseIndexes(indstate);
@@ -324,9 +326,11 @@ void
 CatalogTupleUpdateWithInfo(Relation heapRel, ItemPointer otid, HeapTuple tup,
 						   CatalogIndexState indstate)
 {
+	TU_UpdateIndexes updateIndexes = TU_All;
+
 	CatalogTupleCheckConstraints(heapRel, tup);
 
-	simple_heap_update(heapRel, otid, tup);
+	simple_heap_update(heapRel, otid, tup, &updateIndexes);
 
 	CatalogIndexInsert(indstate, tup);
 }
@@ -37,6 +37,9 @@
 /* GUC variables */
 int			wal_skip_threshold = 2048;	/* in kilobytes */
 
+/* Number of blocks RelationCopyStorage() reads per smgrreadv() call */
+#define COPY_STORAGE_BATCH_BLOCKS	16
+
 /*
  * We keep a list of all relations (represented as RelFileNode values)
  * that have been created or deleted in the current transaction.  When
@@ -408,14 +411,24 @@ void
 RelationCopyStorage(SMgrRelation src, SMgrRelation dst,
 					ForkNumber forkNum, char relpersistence)
 {
-	PGAlignedBlock buf;
-	Page		page;
+	void	   *bufspace;
+	PGAlignedBlock *bufs;
+	char	   *bufptrs[COPY_STORAGE_BATCH_BLOCKS];
 	bool		use_wal;
 	bool		copying_initfork;
 	BlockNumber nblocks;
 	BlockNumber blkno;
+	int			i;
 
-	page = (Page) buf.data;
+	/*
+	 * Read the source in batches of consecutive blocks, so that smgrreadv
+	 * can fetch each batch with a single system call.  The buffers are too
+	 * large to keep on the stack, and are aligned in case of direct I/O.
+	 */
+	bufspace = palloc(BLCKSZ * COPY_STORAGE_BATCH_BLOCKS + PG_IO_ALIGN_SIZE);
+	bufs = (PGAlignedBlock *) TYPEALIGN(PG_IO_ALIGN_SIZE, bufspace);
+	for (i = 0; i < COPY_STORAGE_BATCH_BLOCKS; i++)
+		bufptrs[i] = bufs[i].data;
 
 	/*
 	 * The init fork for an unlogged relation in many respects has to be
@@ -438,10 +451,17 @@ RelationCopyStorage(SMgrRelation src, SMgrRelation dst,
 
 	for (blkno = 0; blkno < nblocks; blkno++)
 	{
+		Page		page;
+
 		/* If we got a cancel signal during the copy of the data, quit */
 		CHECK_FOR_INTERRUPTS();
 
-		smgrread(src, forkNum, blkno, buf.data);
+		/* Read the next batch when we have used up the current one */
+		i = blkno % COPY_STORAGE_BATCH_BLOCKS;
+		if (i == 0)
+			smgrreadv(src, forkNum, blkno, bufptrs,
+					  Min(nblocks - blkno, COPY_STORAGE_BATCH_BLOCKS));
+		page = (Page) bufptrs[i];
 
 		if (!PageIsVerifiedExtended(page, blkno,
 									PIV_LOG_WARNING | PIV_REPORT_STAT))
@@ -468,9 +488,11 @@ RelationCopyStorage(SMgrRelation src, SMgrRelation dst,
 		 * need for smgr to schedule an fsync for this write; we'll do it
 		 * ourselves below.
 		 */
-		smgrextend(dst, forkNum, blkno, buf.data, true);
+		smgrextend(dst, forkNum, blkno, (char *) page, true);
 	}
 
+	pfree(bufspace);
+
 	/*
 	 * When we WAL-logged rel pages, we must nonetheless fsync them.  The
 	 * reason is that since we're copying outside shared buffers, a CHECKPOINT
@@ -835,7 +835,8 @@ CREATE VIEW pg_stat_activity AS
             s.backend_xmin,
             S.queryid,
             S.query,
-            S.backend_type
+            S.backend_type,
+            S.allocated_bytes
     FROM pg_stat_get_activity(NULL) AS S
         LEFT JOIN pg_database AS D ON (S.datid = D.oid)
         LEFT JOIN pg_authid AS U ON (S.usesysid = U.oid);
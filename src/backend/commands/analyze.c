@@ -40,6 +40,7 @@
 #include "commands/vacuum.h"
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "lib/hyperloglog.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "parser/parse_oper.h"
@@ -66,6 +67,7 @@
 #include "utils/spccache.h"
 #include "utils/syscache.h"
 #include "utils/timestamp.h"
+#include "utils/typcache.h"
 
 
 /* Per-index data for ANALYZE */
@@ -77,6 +79,31 @@ typedef struct AnlIndexData
 	int			attr_cnt;
 } AnlIndexData;
 
+/*
+ * Per-column state for counting distinct values in every live row that
+ * acquire_sample_rows visits, not just those that end up in the sample.
+ */
+typedef struct AnlDistinctCounter
+{
+	VacAttrStats *stats;		/* column being counted */
+	FmgrInfo   *hashfn;			/* hash function of the column's type */
+	hyperLogLogState hll;		/* distinct hashes seen so far */
+	double		nvalues;		/* # of non-null values added */
+} AnlDistinctCounter;
+
+/*
+ * Register width for the distinct counters.  4096 one-byte registers give a
+ * standard error of about 1.6%.
+ */
+#define ANL_DISTINCT_HLL_BWIDTH		12
+
+/*
+ * At most this many rows per sample row are fed to the distinct counters.
+ * That bounds the hashing to a few times the cost of sorting the sample
+ * in compute_scalar_stats(), whatever the number of rows per block.
+ */
+#define ANL_DISTINCT_ROWS_PER_SAMPLE_ROW	10
+
 
 /* Default statistics target (GUC parameter) */
 int			default_statistics_target = 100;
@@ -84,6 +111,9 @@ int			default_statistics_target = 100;
 /* A few variables that don't seem worth passing around as parameters */
 static MemoryContext anl_context = NULL;
 static BufferAccessStrategy vac_strategy;
+static AnlDistinctCounter *anl_counters = NULL;
+static int	anl_ncounters = 0;
+static double anl_counter_rows_left = 0;
 
 
 static void do_analyze_rel(Relation onerel,
@@ -103,6 +133,18 @@ static int	compare_rows(const void *a, const void *b);
 static int	acquire_inherited_sample_rows(Relation onerel, int elevel,
 										  HeapTuple *rows, int targrows,
 										  double *totalrows, double *totaldeadrows);
+static void setup_distinct_counters(VacAttrStats **vacattrstats, int attr_cnt,
+									int targrows);
+static void count_distinct_values(TupleTableSlot *slot);
+static void finish_distinct_counters(void);
+static void compute_distinct_stats(VacAttrStatsP stats,
+								   AnalyzeAttrFetchFunc fetchfunc,
+								   int samplerows,
+								   double totalrows);
+static void compute_scalar_stats(VacAttrStatsP stats,
+								 AnalyzeAttrFetchFunc fetchfunc,
+								 int samplerows,
+								 double totalrows);
 static void update_attstats(Oid relid, bool inh,
 							int natts, VacAttrStats **vacattrstats);
 static Datum std_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull);
@@ -134,6 +176,9 @@ analyze_rel(Oid relid, RangeVar *relation,
 
 	/* Set up static variables */
 	vac_strategy = bstrategy;
+	/* ... and forget any distinct counters left over by a failed ANALYZE */
+	anl_counters = NULL;
+	anl_ncounters = 0;
 
 	/*
 	 * Check for user-requested abort.
@@ -520,9 +565,18 @@ do_analyze_rel(Relation onerel, VacuumParams *params,
 												rows, targrows,
 												&totalrows, &totaldeadrows);
 	else
+	{
+		/*
+		 * When sampling a plain table, count distinct column values in all
+		 * the rows we visit as well; see compute_distinct_stats().
+		 */
+		if (acquirefunc == acquire_sample_rows)
+			setup_distinct_counters(vacattrstats, attr_cnt, targrows);
 		numrows = (*acquirefunc) (onerel, elevel,
 								  rows, targrows,
 								  &totalrows, &totaldeadrows);
+		finish_distinct_counters();
+	}
 
 	/*
 	 * Compute the statistics.  Temporary results during the calculations for
@@ -1265,6 +1319,9 @@ acquire_sample_rows(Relation onerel, int elevel,
 
 		while (table_scan_analyze_next_tuple(scan, OldestXmin, &liverows, &deadrows, slot))
 		{
+			if (anl_counters != NULL)
+				count_distinct_values(slot);
+
 			/*
 			 * The first targrows sample rows are simply copied into the
 			 * reservoir. Then we start replacing tuples in the sample until
@@ -1359,6 +1416,135 @@ acquire_sample_rows(Relation onerel, int elevel,
 	return numrows;
 }
 
+/*
+ * setup_distinct_counters -- prepare to count distinct values while sampling
+ *
+ * The sample is only a few hundred rows per unit of statistics target, but
+ * acquire_sample_rows reads every live row on the blocks it picks, which on
+ * a big table is usually many times more.  The number of distinct values
+ * among all those rows is a lower bound for the whole table that does not
+ * rely on the sample-based estimator's assumptions about how the values are
+ * distributed, so for each column whose type can be hashed we feed those
+ * rows into a HyperLogLog counter.  Only columns whose statistics are
+ * computed by compute_distinct_stats() or compute_scalar_stats(), which use
+ * the result, are counted, and only up to ANL_DISTINCT_ROWS_PER_SAMPLE_ROW
+ * rows per sample row; any subset of the rows still gives a lower bound.
+ *
+ * The counters are kept in anl_context, and acquire_sample_rows only uses
+ * them when anl_counters is set; finish_distinct_counters() resets it.
+ */
+static void
+setup_distinct_counters(VacAttrStats **vacattrstats, int attr_cnt,
+						int targrows)
+{
+	int			i;
+
+	anl_counters = (AnlDistinctCounter *)
+		palloc(attr_cnt * sizeof(AnlDistinctCounter));
+	anl_ncounters = 0;
+
+	for (i = 0; i < attr_cnt; i++)
+	{
+		VacAttrStats *stats = vacattrstats[i];
+		TypeCacheEntry *typentry;
+		AnlDistinctCounter *counter;
+
+		if (stats->compute_stats != compute_distinct_stats &&
+			stats->compute_stats != compute_scalar_stats)
+			continue;
+
+		typentry = lookup_type_cache(stats->attrtypid,
+									 TYPECACHE_HASH_PROC_FINFO);
+		if (!OidIsValid(typentry->hash_proc_finfo.fn_oid))
+			continue;
+
+		counter = &anl_counters[anl_ncounters++];
+		counter->stats = stats;
+		counter->hashfn = &typentry->hash_proc_finfo;
+		initHyperLogLog(&counter->hll, ANL_DISTINCT_HLL_BWIDTH);
+		counter->nvalues = 0;
+	}
+
+	if (anl_ncounters == 0)
+	{
+		pfree(anl_counters);
+		anl_counters = NULL;
+	}
+
+	anl_counter_rows_left = (double) targrows * ANL_DISTINCT_ROWS_PER_SAMPLE_ROW;
+}
+
+/*
+ * count_distinct_values -- add one live row to the distinct counters
+ *
+ * Out-of-line and compressed values are skipped rather than detoasted, which
+ * would cost far more than the rest of the sampling; leaving them out only
+ * makes the lower bound weaker.
+ */
+static void
+count_distinct_values(TupleTableSlot *slot)
+{
+	int			i;
+
+	if (anl_counter_rows_left <= 0)
+		return;
+	anl_counter_rows_left -= 1;
+
+	for (i = 0; i < anl_ncounters; i++)
+	{
+		AnlDistinctCounter *counter = &anl_counters[i];
+		VacAttrStats *stats = counter->stats;
+		Datum		value;
+		bool		isnull;
+		uint32		hash;
+
+		value = slot_getattr(slot, stats->tupattnum, &isnull);
+		if (isnull)
+			continue;
+
+		if (stats->attrtype->typlen == -1 &&
+			VARATT_IS_EXTENDED(DatumGetPointer(value)) &&
+			!VARATT_IS_SHORT(DatumGetPointer(value)))
+			continue;
+
+		hash = DatumGetUInt32(FunctionCall1Coll(counter->hashfn,
+												stats->attrcollid,
+												value));
+		addHyperLogLog(&counter->hll, hash);
+		counter->nvalues += 1;
+	}
+}
+
+/*
+ * finish_distinct_counters -- store the counts into the VacAttrStats structs
+ *
+ * The HyperLogLog estimate is discounted by three standard errors, so that
+ * it can safely be treated as a lower bound.
+ */
+static void
+finish_distinct_counters(void)
+{
+	double		discount = 1.0 - 3 * 1.04 / sqrt(1 << ANL_DISTINCT_HLL_BWIDTH);
+	int			i;
+
+	for (i = 0; i < anl_ncounters; i++)
+	{
+		AnlDistinctCounter *counter = &anl_counters[i];
+		double		seendistinct;
+
+		seendistinct = floor(estimateHyperLogLog(&counter->hll) * discount);
+		if (seendistinct > counter->nvalues)
+			seendistinct = counter->nvalues;
+		counter->stats->seendistinct = seendistinct;
+		freeHyperLogLog(&counter->hll);
+	}
+
+	if (anl_counters != NULL)
+		pfree(anl_counters);
+	anl_counters = NULL;
+	anl_ncounters = 0;
+}
+
 /*
  * qsort comparator for sorting rows[] array
  */
@@ -1848,14 +2034,6 @@ static void compute_trivial_stats(VacAttrStatsP stats,
 								  AnalyzeAttrFetchFunc fetchfunc,
 								  int samplerows,
 								  double totalrows);
-static void compute_distinct_stats(VacAttrStatsP stats,
-								   AnalyzeAttrFetchFunc fetchfunc,
-								   int samplerows,
-								   double totalrows);
-static void compute_scalar_stats(VacAttrStatsP stats,
-								 AnalyzeAttrFetchFunc fetchfunc,
-								 int samplerows,
-								 double totalrows);
 static int	compare_scalars(const void *a, const void *b, void *arg);
 static int	compare_mcvs(const void *a, const void *b);
 static int	analyze_mcv_list(int *mcv_counts,
@@ -2219,6 +2397,13 @@ compute_distinct_stats(VacAttrStatsP stats,
 			 * not what we're dealing with.)
 			 */
 			stats->stadistinct = track_cnt;
+
+			/*
+			 * But if we saw more values than that while sampling, the column
+			 * evidently isn't one of those.
+			 */
+			if (stats->stadistinct < stats->seendistinct)
+				stats->stadistinct = stats->seendistinct;
 		}
 		else
 		{
@@ -2258,6 +2443,15 @@ compute_distinct_stats(VacAttrStatsP stats,
 			else
 				stadistinct = 0;
 
+			/*
+			 * The estimator tends to go badly wrong for skewed distributions
+			 * on large tables, where the sample is a tiny fraction of the
+			 * rows.  We can at least be sure there are as many distinct
+			 * values as we saw in the rows visited while sampling.
+			 */
+			if (stadistinct < stats->seendistinct)
+				stadistinct = stats->seendistinct;
+
 			/* Clamp to sane range in case of roundoff error */
 			if (stadistinct < d)
 				stadistinct = d;
@@ -2588,6 +2782,13 @@ compute_scalar_stats(VacAttrStatsP stats,
 			 * assume that that's not what we're dealing with.)
 			 */
 			stats->stadistinct = ndistinct;
+
+			/*
+			 * But if we saw more values than that while sampling, the column
+			 * evidently isn't one of those.
+			 */
+			if (stats->stadistinct < stats->seendistinct)
+				stats->stadistinct = stats->seendistinct;
 		}
 		else
 		{
@@ -2623,6 +2824,10 @@ compute_scalar_stats(VacAttrStatsP stats,
 			else
 				stadistinct = 0;
 
+			/* Don't go below what we saw while sampling; see above */
+			if (stadistinct < stats->seendistinct)
+				stadistinct = stats->seendistinct;
+
 			/* Clamp to sane range in case of roundoff error */
 			if (stadistinct < d)
 				stadistinct = d;
@@ -73,11 +73,14 @@
  *	  Finally, after we are out of the transaction altogether, we check if
  *	  we need to signal listening backends.  In SignalBackends() we scan the
  *	  list of listening backends and send a PROCSIG_NOTIFY_INTERRUPT signal
- *	  to every listening backend (we don't know which backend is listening on
- *	  which channel so we must signal them all). We can exclude backends that
- *	  are already up to date, though, and we can also exclude backends that
- *	  are in other databases (unless they are way behind and should be kicked
- *	  to make them advance their pointers).  We don't bother with a
+ *	  to every listening backend that might be interested.  Each listener
+ *	  advertises a small bitmask of hashed channel names in shared memory,
+ *	  so we can exclude backends that are certainly not listening on any of
+ *	  the channels we notified; hash collisions just cause an unneeded
+ *	  signal.  We can also exclude backends that are already up to date, and
+ *	  backends that are in other databases.  A backend excluded by database
+ *	  or channel is still kicked if it is way behind, to make it advance its
+ *	  pointer so that the queue tail can move.  We don't bother with a
  *	  self-signal either, but just process the queue directly.
  *
  * 5. Upon receipt of a PROCSIG_NOTIFY_INTERRUPT signal, the signal handler
@@ -107,7 +110,7 @@
  * frontend during startup.)  The above design guarantees that notifies from
  * other backends will never be missed by ignoring self-notifies.
  *
- * The amount of shared memory used for notify management (NUM_NOTIFY_BUFFERS)
+ * The amount of shared memory used for notify management (notify_buffers)
  * can be varied without affecting anything but performance.  The maximum
  * amount of notification data that can be queued at one time is determined
  * by slru.c's wraparound limit; see QUEUE_MAX_PAGE below.
@@ -225,7 +228,7 @@ typedef struct QueuePosition
  *
  * Resist the temptation to make this really large.  While that would save
  * work in some places, it would add cost in others.  In particular, this
- * should likely be less than NUM_NOTIFY_BUFFERS, to ensure that backends
+ * should likely be less than notify_buffers, to ensure that backends
  * catch up before the pages they'll need to read fall out of SLRU cache.
  */
 #define QUEUE_CLEANUP_DELAY 4
@@ -239,6 +242,7 @@ typedef struct QueueBackendStatus
 	Oid			dboid;			/* backend's database OID, or InvalidOid */
 	BackendId	nextListener;	/* id of next listener, or InvalidBackendId */
 	QueuePosition pos;			/* backend has read queue up to here */
+	uint64		channels;		/* hash bits of channels listened on */
 } QueueBackendStatus;
 
 /*
@@ -294,6 +298,14 @@ static AsyncQueueControl *asyncQueueControl;
 #define QUEUE_BACKEND_DBOID(i)		(asyncQueueControl->backend[i].dboid)
 #define QUEUE_NEXT_LISTENER(i)		(asyncQueueControl->backend[i].nextListener)
 #define QUEUE_BACKEND_POS(i)		(asyncQueueControl->backend[i].pos)
+#define QUEUE_BACKEND_CHANNELS(i)	(asyncQueueControl->backend[i].channels)
+
+/*
+ * Map a channel name to its bit in QueueBackendStatus.channels.
+ */
+#define CHANNEL_HASH_BIT(channel) \
+	(UINT64CONST(1) << (hash_bytes((const unsigned char *) (channel), \
+								   strlen(channel)) % 64))
 
 /*
  * The SLRU buffer area through which we access the notification queue
@@ -429,11 +441,15 @@ static bool amRegisteredListener = false;
 /* has this backend sent notifications in the current transaction? */
 static bool backendHasSentNotifications = false;
 
+/* Hash bits of the channels we have notified since the last SignalBackends */
+static uint64 notifiedChannels = 0;
+
 /* have we advanced to a page that's a multiple of QUEUE_CLEANUP_DELAY? */
 static bool backendTryAdvanceTail = false;
 
-/* GUC parameter */
+/* GUC parameters */
 bool		Trace_notify = false;
+int			notify_buffers = 8;
 
 /* local function prototypes */
 static int	asyncQueuePageDiff(int p, int q);
@@ -445,6 +461,8 @@ static void Exec_ListenCommit(const char *channel);
 static void Exec_UnlistenCommit(const char *channel);
 static void Exec_UnlistenAllCommit(void);
 static bool IsListeningOn(const char *channel);
+static void asyncQueueAddChannel(const char *channel);
+static void asyncQueueUpdateChannels(void);
 static void asyncQueueUnregister(void);
 static bool asyncQueueIsFull(void);
 static bool asyncQueueAdvance(volatile QueuePosition *position, int entryLength);
@@ -514,7 +532,7 @@ AsyncShmemSize(void)
 	size = mul_size(MaxBackends + 1, sizeof(QueueBackendStatus));
 	size = add_size(size, offsetof(AsyncQueueControl, backend));
 
-	size = add_size(size, SimpleLruShmemSize(NUM_NOTIFY_BUFFERS, 0));
+	size = add_size(size, SimpleLruShmemSize(notify_buffers, 0));
 
 	return size;
 }
@@ -555,6 +573,7 @@ AsyncShmemInit(void)
 			QUEUE_BACKEND_DBOID(i) = InvalidOid;
 			QUEUE_NEXT_LISTENER(i) = InvalidBackendId;
 			SET_QUEUE_POS(QUEUE_BACKEND_POS(i), 0, 0);
+			QUEUE_BACKEND_CHANNELS(i) = 0;
 		}
 	}
 
@@ -562,7 +581,7 @@ AsyncShmemInit(void)
 	 * Set up SLRU management of the pg_notify data.
 	 */
 	NotifyCtl->PagePrecedes = asyncQueuePagePrecedes;
-	SimpleLruInit(NotifyCtl, "Notify", NUM_NOTIFY_BUFFERS, 0,
+	SimpleLruInit(NotifyCtl, "Notify", notify_buffers, 0,
 				  NotifySLRULock, "pg_notify", LWTRANCHE_NOTIFY_BUFFER,
 				  SYNC_HANDLER_NONE);
 
@@ -906,6 +925,7 @@ PreCommit_Notify(void)
 			{
 				case LISTEN_LISTEN:
 					Exec_ListenPreCommit();
+					asyncQueueAddChannel(actrec->channel);
 					break;
 				case LISTEN_UNLISTEN:
 					/* there is no Exec_UnlistenPreCommit() */
@@ -952,6 +972,13 @@ PreCommit_Notify(void)
 		/* Now push the notifications into the queue */
 		backendHasSentNotifications = true;
 
+		foreach(p, pendingNotifies->events)
+		{
+			Notification *n = (Notification *) lfirst(p);
+
+			notifiedChannels |= CHANNEL_HASH_BIT(n->data);
+		}
+
 		nextNotify = list_head(pendingNotifies->events);
 		while (nextNotify != NULL)
 		{
@@ -1026,6 +1053,8 @@ AtCommit_Notify(void)
 	/* If no longer listening to anything, get out of listener array */
 	if (amRegisteredListener && listenChannels == NIL)
 		asyncQueueUnregister();
+	else if (pendingActions != NULL)
+		asyncQueueUpdateChannels();
 
 	/* And clean up */
 	ClearPendingActionsAndNotifies();
@@ -1098,6 +1127,7 @@ Exec_ListenPreCommit(void)
 	QUEUE_BACKEND_POS(MyBackendId) = max;
 	QUEUE_BACKEND_PID(MyBackendId) = MyProcPid;
 	QUEUE_BACKEND_DBOID(MyBackendId) = MyDatabaseId;
+	QUEUE_BACKEND_CHANNELS(MyBackendId) = 0;
 	/* Insert backend into list of listeners at correct position */
 	if (prevListener > 0)
 	{
@@ -1301,6 +1331,52 @@ IsListeningOn(const char *channel)
 	return false;
 }
 
+/*
+ * Advertise that we may be listening on the given channel, so that
+ * SignalBackends will wake us up for notifications on it.
+ *
+ * This is done at PreCommit time, before our LISTEN becomes visible, so that
+ * no transaction committing after ours can fail to signal us.  If we abort,
+ * the extra bit just causes some unneeded signals until the next
+ * asyncQueueUpdateChannels.
+ */
+static void
+asyncQueueAddChannel(const char *channel)
+{
+	uint64		bit = CHANNEL_HASH_BIT(channel);
+
+	Assert(amRegisteredListener);
+
+	LWLockAcquire(NotifyQueueLock, LW_EXCLUSIVE);
+	QUEUE_BACKEND_CHANNELS(MyBackendId) |= bit;
+	LWLockRelease(NotifyQueueLock);
+}
+
+/*
+ * Recompute our advertised channel bits from listenChannels, dropping any
+ * bits belonging to channels we are no longer listening on.
+ */
+static void
+asyncQueueUpdateChannels(void)
+{
+	uint64		channels = 0;
+	ListCell   *p;
+
+	if (!amRegisteredListener)
+		return;
+
+	foreach(p, listenChannels)
+	{
+		char	   *lchan = (char *) lfirst(p);
+
+		channels |= CHANNEL_HASH_BIT(lchan);
+	}
+
+	LWLockAcquire(NotifyQueueLock, LW_EXCLUSIVE);
+	QUEUE_BACKEND_CHANNELS(MyBackendId) = channels;
+	LWLockRelease(NotifyQueueLock);
+}
+
 /*
  * Remove our entry from the listeners array when we are no longer listening
  * on any channel.  NB: must not fail if we're already not listening.
@@ -1320,6 +1396,7 @@ asyncQueueUnregister(void)
 	/* Mark our entry as invalid */
 	QUEUE_BACKEND_PID(MyBackendId) = InvalidPid;
 	QUEUE_BACKEND_DBOID(MyBackendId) = InvalidOid;
+	QUEUE_BACKEND_CHANNELS(MyBackendId) = 0;
 	/* and remove it from the list */
 	if (QUEUE_FIRST_LISTENER == MyBackendId)
 		QUEUE_FIRST_LISTENER = QUEUE_NEXT_LISTENER(MyBackendId);
@@ -1675,6 +1752,9 @@ SignalBackends(void)
 	int32	   *pids;
 	BackendId  *ids;
 	int			count;
+	uint64		channels = notifiedChannels;
+
+	notifiedChannels = 0;
 
 	/*
 	 * Identify backends that we need to signal.  We don't want to send
@@ -1699,11 +1779,13 @@ SignalBackends(void)
 		if (pid == MyProcPid)
 			continue;			/* never signal self */
 		pos = QUEUE_BACKEND_POS(i);
-		if (QUEUE_BACKEND_DBOID(i) == MyDatabaseId)
+		if (QUEUE_BACKEND_DBOID(i) == MyDatabaseId &&
+			(QUEUE_BACKEND_CHANNELS(i) & channels) != 0)
 		{
 			/*
-			 * Always signal listeners in our own database, unless they're
-			 * already caught up (unlikely, but possible).
+			 * Always signal listeners in our own database that might be
+			 * listening on one of our channels, unless they're already
+			 * caught up (unlikely, but possible).
 			 */
 			if (QUEUE_POS_EQUAL(pos, QUEUE_HEAD))
 				continue;
@@ -1711,8 +1793,8 @@ SignalBackends(void)
 		else
 		{
 			/*
-			 * Listeners in other databases should be signaled only if they
-			 * are far behind.
+			 * Listeners in other databases, or not listening on any of our
+			 * channels, should be signaled only if they are far behind.
 			 */
 			if (asyncQueuePageDiff(QUEUE_POS_PAGE(QUEUE_HEAD),
 								   QUEUE_POS_PAGE(pos)) < QUEUE_CLEANUP_DELAY)
@@ -21,6 +21,7 @@
 #include "postgres.h"
 
 #include <ctype.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
 
@@ -70,8 +71,13 @@
  */
 #define MAX_BUFFERED_BYTES		65535
 
-/* Trim the list of buffers back down to this number after flushing */
-#define MAX_PARTITION_BUFFERS	32
+/*
+ * Trim the list of buffers after flushing until their estimated memory use
+ * is no more than this.  A buffer with few slots in use takes roughly 25kB,
+ * so this allows a few hundred partitions to keep their buffers, while a
+ * buffer with all its slots in use can take well over 1MB for wide rows.
+ */
+#define MAX_PARTITION_BUFFER_BYTES	(16 * 1024 * 1024)
 
 /* Stores multi-insert data related to a single relation in CopyFrom. */
 typedef struct CopyMultiInsertBuffer
@@ -80,6 +86,7 @@ typedef struct CopyMultiInsertBuffer
 	ResultRelInfo *resultRelInfo;	/* ResultRelInfo for 'relid' */
 	BulkInsertState bistate;	/* BulkInsertState for this rel */
 	int			nused;			/* number of 'slots' containing tuples */
+	Size		memUsed;		/* estimated memory used by this buffer */
 	uint64		linenos[MAX_BUFFERED_TUPLES];	/* Line # of tuple in copy
 												 * stream */
 } CopyMultiInsertBuffer;
@@ -94,6 +101,7 @@ typedef struct CopyMultiInsertInfo
 	List	   *multiInsertBuffers; /* List of tracked CopyMultiInsertBuffers */
 	int			bufferedTuples; /* number of tuples buffered over all buffers */
 	int			bufferedBytes;	/* number of bytes from all buffered tuples */
+	Size		bufferMemory;	/* estimated memory used by all buffers */
 	CopyFromState cstate;		/* Copy state for this CopyMultiInsertInfo */
 	EState	   *estate;			/* Executor state used for COPY */
 	CommandId	mycid;			/* Command Id used for COPY */
@@ -222,6 +230,12 @@ CopyMultiInsertBufferInit(ResultRelInfo *rri)
 	buffer->bistate = GetBulkInsertState();
 	buffer->nused = 0;
 
+	/*
+	 * Account for the buffer itself and, roughly, for the bulk insert state's
+	 * buffer access strategy, which is opaque to us.
+	 */
+	buffer->memUsed = sizeof(CopyMultiInsertBuffer) + 8 * 1024;
+
 	return buffer;
 }
 
@@ -240,6 +254,7 @@ CopyMultiInsertInfoSetupBuffer(CopyMultiInsertInfo *miinfo,
 	rri->ri_CopyMultiInsertBuffer = buffer;
 	/* Record that we're tracking this buffer */
 	miinfo->multiInsertBuffers = lappend(miinfo->multiInsertBuffers, buffer);
+	miinfo->bufferMemory += buffer->memUsed;
 }
 
 /*
@@ -256,6 +271,7 @@ CopyMultiInsertInfoInit(CopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 	miinfo->multiInsertBuffers = NIL;
 	miinfo->bufferedTuples = 0;
 	miinfo->bufferedBytes = 0;
+	miinfo->bufferMemory = 0;
 	miinfo->cstate = cstate;
 	miinfo->estate = estate;
 	miinfo->mycid = mycid;
@@ -344,7 +360,7 @@ CopyMultiInsertBufferFlush(CopyMultiInsertInfo *miinfo,
 			recheckIndexes =
 				ExecInsertIndexTuples(resultRelInfo,
 									  buffer->slots[i], estate, false, false,
-									  NULL, NIL);
+									  NULL, NIL, false);
 			ExecARInsertTriggers(estate, resultRelInfo,
 								 slots[i], recheckIndexes,
 								 cstate->transition_capture);
@@ -394,6 +410,8 @@ CopyMultiInsertBufferCleanup(CopyMultiInsertInfo *miinfo,
 
 	FreeBulkInsertState(buffer->bistate);
 
+	miinfo->bufferMemory -= buffer->memUsed;
+
 	/* Since we only create slots on demand, just drop the non-null ones. */
 	for (i = 0; i < MAX_BUFFERED_TUPLES && buffer->slots[i] != NULL; i++)
 		ExecDropSingleTupleTableSlot(buffer->slots[i]);
@@ -408,7 +426,7 @@ CopyMultiInsertBufferCleanup(CopyMultiInsertInfo *miinfo,
  * Write out all stored tuples in all buffers out to the tables.
  *
  * Once flushed we also trim the tracked buffers list down to size by removing
- * the buffers created earliest first.
+ * the buffers that have gone unused the longest first.
  *
  * Callers should pass 'curr_rri' as the ResultRelInfo that's currently being
  * used.  When cleaning up old buffers we'll never remove the one for
@@ -418,24 +436,45 @@ static inline void
 CopyMultiInsertInfoFlush(CopyMultiInsertInfo *miinfo, ResultRelInfo *curr_rri)
 {
 	ListCell   *lc;
+	List	   *idle = NIL;
+	List	   *active = NIL;
 
+	/*
+	 * Flush the buffers that have tuples, and move them, along with the one
+	 * for 'curr_rri', to the end of the list.  The list thus stays ordered
+	 * by how many flushes ago each buffer was last used.
+	 */
 	foreach(lc, miinfo->multiInsertBuffers)
 	{
 		CopyMultiInsertBuffer *buffer = (CopyMultiInsertBuffer *) lfirst(lc);
 
-		CopyMultiInsertBufferFlush(miinfo, buffer);
+		if (buffer->nused > 0 || buffer->resultRelInfo == curr_rri)
+		{
+			CopyMultiInsertBufferFlush(miinfo, buffer);
+			active = lappend(active, buffer);
+		}
+		else
+			idle = lappend(idle, buffer);
 	}
 
+	list_free(miinfo->multiInsertBuffers);
+	miinfo->multiInsertBuffers = list_concat(idle, active);
+	list_free(active);
+
 	miinfo->bufferedTuples = 0;
 	miinfo->bufferedBytes = 0;
 
 	/*
-	 * Trim the list of tracked buffers down if it exceeds the limit.  Here we
-	 * remove buffers starting with the ones we created first.  It seems less
-	 * likely that these older ones will be needed than the ones that were
-	 * just created.
+	 * Trim the list of tracked buffers down if they use too much memory.
+	 * Limiting memory rather than the number of buffers lets loads into
+	 * tables with many small partitions keep inserting in batches, even when
+	 * the input is spread over more partitions than would fit in a fixed
+	 * number of buffers.  We remove the buffers that have gone unused for the
+	 * most flushes first; the ones just used seem the most likely to be
+	 * needed again.
 	 */
-	while (list_length(miinfo->multiInsertBuffers) > MAX_PARTITION_BUFFERS)
+	while (miinfo->bufferMemory > MAX_PARTITION_BUFFER_BYTES &&
+		   list_length(miinfo->multiInsertBuffers) > 1)
 	{
 		CopyMultiInsertBuffer *buffer;
 
@@ -475,9 +514,6 @@ CopyMultiInsertInfoCleanup(CopyMultiInsertInfo *miinfo)
  * Get the next TupleTableSlot that the next tuple should be stored in.
  *
  * Callers must ensure that the buffer is not full.
- *
- * Note: 'miinfo' is unused but has been included for consistency with the
- * other functions in this area.
  */
 static inline TupleTableSlot *
 CopyMultiInsertInfoNextFreeSlot(CopyMultiInsertInfo *miinfo,
@@ -490,7 +526,16 @@ CopyMultiInsertInfoNextFreeSlot(CopyMultiInsertInfo *miinfo,
 	Assert(nused < MAX_BUFFERED_TUPLES);
 
 	if (buffer->slots[nused] == NULL)
-		buffer->slots[nused] = table_slot_create(rri->ri_RelationDesc, NULL);
+	{
+		TupleTableSlot *slot = table_slot_create(rri->ri_RelationDesc, NULL);
+		Size		slotsize;
+
+		slotsize = slot->tts_ops->base_slot_size +
+			slot->tts_tupleDescriptor->natts * (sizeof(Datum) + sizeof(bool));
+		buffer->memUsed += slotsize;
+		miinfo->bufferMemory += slotsize;
+		buffer->slots[nused] = slot;
+	}
 	return buffer->slots[nused];
 }
 
@@ -1101,7 +1146,8 @@ CopyFrom(CopyFromState cstate)
 																   false,
 																   false,
 																   NULL,
-																   NIL);
+																   NIL,
+																   false);
 					}
 
 					/* AFTER ROW INSERT Triggers */
@@ -1531,6 +1577,17 @@ BeginCopyFrom(ParseState *pstate,
 						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
 						 errmsg("\"%s\" is a directory", cstate->filename)));
 
+#if defined(USE_POSIX_FADVISE) && defined(POSIX_FADV_SEQUENTIAL)
+
+			/*
+			 * We'll read the file from start to end, so tell the kernel.  This
+			 * is only a read-ahead hint; it doesn't change how the file is
+			 * read or parsed.  Failure is harmless, so ignore the result.
+			 */
+			(void) posix_fadvise(fileno(cstate->copy_file), 0, 0,
+								 POSIX_FADV_SEQUENTIAL);
+#endif
+
 			progress_vals[2] = st.st_size;
 		}
 	}
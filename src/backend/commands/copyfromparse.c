@@ -72,6 +72,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
@@ -1058,6 +1059,13 @@ CopyReadLineText(CopyFromState cstate)
 	char		quotec = '\0';
 	char		escapec = '\0';
 
+	/* vectors of the characters that need special processing */
+	Vector8		nl_vec = vector8_broadcast('\n');
+	Vector8		cr_vec = vector8_broadcast('\r');
+	Vector8		bs_vec = vector8_broadcast('\\');
+	Vector8		quote_vec = nl_vec;
+	Vector8		escape_vec = nl_vec;
+
 	if (cstate->opts.csv_mode)
 	{
 		quotec = cstate->opts.quote[0];
@@ -1065,6 +1073,9 @@ CopyReadLineText(CopyFromState cstate)
 		/* ignore special escape processing if it's the same as quotec */
 		if (quotec == escapec)
 			escapec = '\0';
+
+		quote_vec = vector8_broadcast(quotec);
+		escape_vec = vector8_broadcast(escapec);
 	}
 
 	/*
@@ -1136,6 +1147,51 @@ CopyReadLineText(CopyFromState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Most characters need none of the processing below, so first skip
+		 * over any run of them in a tight loop.  Skipping at least one
+		 * character has the same effect on the state variables as processing
+		 * it normally would.  If that takes us to the end of the buffer, go
+		 * back to load more data.
+		 */
+		{
+			int			start_ptr = input_buf_ptr;
+
+			/* Skip whole vectors of them first, then single characters */
+			while (input_buf_ptr + (int) sizeof(Vector8) <= copy_buf_len)
+			{
+				Vector8		chunk;
+				Vector8		match;
+
+				vector8_load(&chunk, (const uint8 *) copy_input_buf + input_buf_ptr);
+				match = vector8_or(vector8_eq(chunk, nl_vec),
+								   vector8_eq(chunk, cr_vec));
+				match = vector8_or(match, vector8_eq(chunk, bs_vec));
+				match = vector8_or(match, vector8_eq(chunk, quote_vec));
+				match = vector8_or(match, vector8_eq(chunk, escape_vec));
+				if (vector8_is_highbit_set(match))
+					break;
+				input_buf_ptr += sizeof(Vector8);
+			}
+
+			while (input_buf_ptr < copy_buf_len)
+			{
+				c = copy_input_buf[input_buf_ptr];
+				if (c == '\n' || c == '\r' || c == '\\' ||
+					(cstate->opts.csv_mode && (c == quotec || c == escapec)))
+					break;
+				input_buf_ptr++;
+			}
+
+			if (input_buf_ptr > start_ptr)
+			{
+				first_char_in_line = false;
+				last_was_esc = false;
+				if (input_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = input_buf_ptr;
 		c = copy_input_buf[input_buf_ptr++];
@@ -1645,6 +1701,9 @@ CopyReadAttributesCSV(CopyFromState cstate)
 	char		delimc = cstate->opts.delim[0];
 	char		quotec = cstate->opts.quote[0];
 	char		escapec = cstate->opts.escape[0];
+	Vector8		delim_vec = vector8_broadcast(delimc);
+	Vector8		quote_vec = vector8_broadcast(quotec);
+	Vector8		escape_vec = vector8_broadcast(escapec);
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -1713,6 +1772,23 @@ CopyReadAttributesCSV(CopyFromState cstate)
 		{
 			char		c;
 
+			/*
+			 * Copy any leading run of characters that are neither delimiter
+			 * nor quote a vector at a time.
+			 */
+			while (cur_ptr + sizeof(Vector8) <= line_end_ptr)
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk, (const uint8 *) cur_ptr);
+				if (vector8_is_highbit_set(vector8_or(vector8_eq(chunk, delim_vec),
+													  vector8_eq(chunk, quote_vec))))
+					break;
+				memcpy(output_ptr, cur_ptr, sizeof(Vector8));
+				output_ptr += sizeof(Vector8);
+				cur_ptr += sizeof(Vector8);
+			}
+
 			/* Not in quote */
 			for (;;)
 			{
@@ -1736,6 +1812,20 @@ CopyReadAttributesCSV(CopyFromState cstate)
 				*output_ptr++ = c;
 			}
 
+			/* Likewise for characters that are neither escape nor quote */
+			while (cur_ptr + sizeof(Vector8) <= line_end_ptr)
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk, (const uint8 *) cur_ptr);
+				if (vector8_is_highbit_set(vector8_or(vector8_eq(chunk, escape_vec),
+													  vector8_eq(chunk, quote_vec))))
+					break;
+				memcpy(output_ptr, cur_ptr, sizeof(Vector8));
+				output_ptr += sizeof(Vector8);
+				cur_ptr += sizeof(Vector8);
+			}
+
 			/* In quote */
 			for (;;)
 			{
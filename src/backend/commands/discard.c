@@ -19,6 +19,7 @@
 #include "commands/discard.h"
 #include "commands/prepare.h"
 #include "commands/sequence.h"
+#include "tcop/tcopprot.h"
 #include "utils/guc.h"
 #include "utils/portal.h"
 
@@ -70,6 +71,7 @@ DiscardAll(bool isTopLevel)
 	SetPGVariable("session_authorization", NIL, false);
 	ResetAllOptions();
 	DropAllPreparedStatements();
+	DropUnnamedStatementCache();
 	Async_UnlistenAll();
 	LockReleaseAll(USER_LOCKMETHOD, true);
 	ResetPlanCache();
@@ -21,6 +21,7 @@
 #include "executor/nodeHash.h"
 #include "foreign/fdwapi.h"
 #include "jit/jit.h"
+#include "miscadmin.h"
 #include "nodes/extensible.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
@@ -28,11 +29,14 @@
 #include "parser/parsetree.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/bufmgr.h"
+#include "storage/procarray.h"
+#include "storage/procsignal.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
 #include "utils/guc_tables.h"
 #include "utils/json.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/ruleutils.h"
 #include "utils/snapmgr.h"
@@ -122,6 +126,8 @@ static const char *explain_get_index_name(Oid indexId);
 static void show_buffer_usage(ExplainState *es, const BufferUsage *usage,
 							  bool planning);
 static void show_wal_usage(ExplainState *es, const WalUsage *usage);
+static void show_memory_counters(ExplainState *es,
+								 const MemoryContextCounters *mem_counters);
 static void ExplainIndexScanDetails(Oid indexid, ScanDirection indexorderdir,
 									ExplainState *es);
 static void ExplainScanTarget(Scan *plan, ExplainState *es);
@@ -190,6 +196,8 @@ ExplainQuery(ParseState *pstate, ExplainStmt *stmt,
 			es->wal = defGetBoolean(opt);
 		else if (strcmp(opt->defname, "settings") == 0)
 			es->settings = defGetBoolean(opt);
+		else if (strcmp(opt->defname, "memory") == 0)
+			es->memory = defGetBoolean(opt);
 		else if (strcmp(opt->defname, "timing") == 0)
 		{
 			timing_set = true;
@@ -394,6 +402,22 @@ ExplainOneQuery(Query *query, int cursorOptions,
 					planduration;
 		BufferUsage bufusage_start,
 					bufusage;
+		MemoryContext planner_ctx = NULL;
+		MemoryContext saved_ctx = NULL;
+		MemoryContextCounters mem_counters;
+
+		/*
+		 * To measure the memory the planner uses, plan the query in a context
+		 * of its own.  The plan stays there, and goes away along with the
+		 * caller's context.
+		 */
+		if (es->memory)
+		{
+			planner_ctx = AllocSetContextCreate(CurrentMemoryContext,
+												"explain planner context",
+												ALLOCSET_DEFAULT_SIZES);
+			saved_ctx = MemoryContextSwitchTo(planner_ctx);
+		}
 
 		if (es->buffers)
 			bufusage_start = pgBufferUsage;
@@ -405,6 +429,12 @@ ExplainOneQuery(Query *query, int cursorOptions,
 		INSTR_TIME_SET_CURRENT(planduration);
 		INSTR_TIME_SUBTRACT(planduration, planstart);
 
+		if (es->memory)
+		{
+			MemoryContextSwitchTo(saved_ctx);
+			MemoryContextMemConsumed(planner_ctx, &mem_counters);
+		}
+
 		/* calc differences of buffer counters. */
 		if (es->buffers)
 		{
@@ -414,7 +444,8 @@ ExplainOneQuery(Query *query, int cursorOptions,
 
 		/* run it (if needed) and produce output */
 		ExplainOnePlan(plan, into, es, queryString, params, queryEnv,
-					   &planduration, (es->buffers ? &bufusage : NULL));
+					   &planduration, (es->buffers ? &bufusage : NULL),
+					   (es->memory ? &mem_counters : NULL));
 	}
 }
 
@@ -524,7 +555,8 @@ void
 ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 			   const char *queryString, ParamListInfo params,
 			   QueryEnvironment *queryEnv, const instr_time *planduration,
-			   const BufferUsage *bufusage)
+			   const BufferUsage *bufusage,
+			   const MemoryContextCounters *mem_counters)
 {
 	DestReceiver *dest;
 	QueryDesc  *queryDesc;
@@ -618,11 +650,28 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 		ExplainPropertyText("Query Identifier", buf, es);
 	}
 
-	/* Show buffer usage in planning */
-	if (bufusage)
+	/* Show buffer and memory usage in planning */
+	if (bufusage || mem_counters)
 	{
 		ExplainOpenGroup("Planning", "Planning", true, es);
-		show_buffer_usage(es, bufusage, true);
+
+		/*
+		 * show_buffer_usage() prints the text-format "Planning:" heading only
+		 * if it has something to show, but memory usage always has.
+		 */
+		if (mem_counters && es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			ExplainIndentText(es);
+			appendStringInfoString(es->str, "Planning:\n");
+			es->indent++;
+		}
+		if (bufusage)
+			show_buffer_usage(es, bufusage, mem_counters == NULL);
+		if (mem_counters)
+			show_memory_counters(es, mem_counters);
+		if (mem_counters && es->format == EXPLAIN_FORMAT_TEXT)
+			es->indent--;
+
 		ExplainCloseGroup("Planning", "Planning", true, es);
 	}
 
@@ -1731,6 +1780,14 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			break;
 	}
 
+	/*
+	 * Whether the node's expressions were JIT compiled, if JIT is in use.
+	 * Tied to es->costs for the same reason as the JIT summary: it depends
+	 * on build options, which must not show up in regression test output.
+	 */
+	if (es->verbose && es->costs && planstate->state->es_jit != NULL)
+		ExplainPropertyBool("JIT", plan->jit, es);
+
 	/* quals, sort keys, etc */
 	switch (nodeTag(plan))
 	{
@@ -1990,6 +2047,14 @@ ExplainNode(PlanState *planstate, List *ancestors,
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
 			break;
+		case T_WindowAgg:
+			show_upper_qual(plan->qual, "Filter", planstate, ancestors, es);
+			if (plan->qual)
+				show_instrumentation_count("Rows Removed by Filter", 1,
+										   planstate, es);
+			show_upper_qual(((WindowAgg *) plan)->runConditionOrig,
+							"Run Condition", planstate, ancestors, es);
+			break;
 		case T_Sort:
 			show_sort_keys(castNode(SortState, planstate), ancestors, es);
 			show_sort_info(castNode(SortState, planstate), es);
@@ -3026,7 +3091,9 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 	 * parallel-aware case, we need to consider all the results.  Each worker
 	 * may have seen a different subset of batches and we want to report the
 	 * highest memory usage across all batches.  We take the maxima of other
-	 * values too, for the same reasons as in ExecHashAccumInstrumentation.
+	 * values too, for the same reasons as in ExecHashAccumInstrumentation,
+	 * except that the Bloom filter counters are summed since each
+	 * participant checks its own outer tuples.
 	 */
 	if (hashstate->shared_info)
 	{
@@ -3047,6 +3114,11 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 											  worker_hi->nbatch_original);
 			hinstrument.space_peak = Max(hinstrument.space_peak,
 										 worker_hi->space_peak);
+			hinstrument.growth_disabled |= worker_hi->growth_disabled;
+			hinstrument.bloom_size = Max(hinstrument.bloom_size,
+										 worker_hi->bloom_size);
+			hinstrument.bloom_tested += worker_hi->bloom_tested;
+			hinstrument.bloom_rejected += worker_hi->bloom_rejected;
 		}
 	}
 
@@ -3087,6 +3159,50 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 							 hinstrument.nbuckets, hinstrument.nbatch,
 							 spacePeakKb);
 		}
+
+		/*
+		 * Report if skewed hash values made us give up on splitting batches,
+		 * since the memory usage reported above may then exceed the limit.
+		 */
+		if (hinstrument.growth_disabled)
+		{
+			if (es->format != EXPLAIN_FORMAT_TEXT)
+				ExplainPropertyBool("Batch Growth Disabled", true, es);
+			else
+			{
+				ExplainIndentText(es);
+				appendStringInfoString(es->str,
+									   "Batch Growth Disabled: skewed hash values\n");
+			}
+		}
+
+		/*
+		 * Report the Bloom filter, if one was built, and how many outer
+		 * tuples it let us skip.
+		 */
+		if (hinstrument.bloom_size > 0)
+		{
+			long		bloomSizeKb = (hinstrument.bloom_size + 1023) / 1024;
+
+			if (es->format != EXPLAIN_FORMAT_TEXT)
+			{
+				ExplainPropertyInteger("Bloom Filter Memory Usage", "kB",
+									   bloomSizeKb, es);
+				ExplainPropertyUInteger("Bloom Filter Checked Rows", NULL,
+										hinstrument.bloom_tested, es);
+				ExplainPropertyUInteger("Bloom Filter Rejected Rows", NULL,
+										hinstrument.bloom_rejected, es);
+			}
+			else
+			{
+				ExplainIndentText(es);
+				appendStringInfo(es->str,
+								 "Bloom Filter: Memory Usage: %ldkB  Checked: " UINT64_FORMAT "  Rejected: " UINT64_FORMAT "\n",
+								 bloomSizeKb,
+								 hinstrument.bloom_tested,
+								 hinstrument.bloom_rejected);
+			}
+		}
 	}
 }
 
@@ -3615,6 +3731,31 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 	}
 }
 
+/*
+ * Show memory usage details.
+ */
+static void
+show_memory_counters(ExplainState *es,
+					 const MemoryContextCounters *mem_counters)
+{
+	int64		memUsedkB = (mem_counters->totalspace -
+							 mem_counters->freespace + 1023) / 1024;
+	int64		memAllocatedkB = (mem_counters->totalspace + 1023) / 1024;
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainIndentText(es);
+		appendStringInfo(es->str,
+						 "Memory: used=" INT64_FORMAT "kB  allocated=" INT64_FORMAT "kB\n",
+						 memUsedkB, memAllocatedkB);
+	}
+	else
+	{
+		ExplainPropertyInteger("Memory Used", "kB", memUsedkB, es);
+		ExplainPropertyInteger("Memory Allocated", "kB", memAllocatedkB, es);
+	}
+}
+
 /*
  * Show WAL usage details.
  */
@@ -4921,3 +5062,245 @@ escape_yaml(StringInfo buf, const char *str)
 {
 	escape_json(buf, str);
 }
+
+/*
+ * Logging the plan of the running query
+ *
+ * pg_log_query_plan() signals a backend, which notices the request in
+ * CHECK_FOR_INTERRUPTS().  That might happen anywhere, including in the
+ * middle of a node's work where its state is not fit to be looked at, so
+ * instead of printing the plan right away we install a wrapper as the
+ * ExecProcNode callback of every node of the active query.  The first of
+ * them to be called logs the plan, between two tuple fetches, and each
+ * wrapper removes itself when it is next called.  Queries that nobody asks
+ * about pay nothing beyond remembering ActiveQueryDesc.
+ *
+ * The plan is printed with whatever instrumentation the query was started
+ * with, so row counts and times are only available if it runs under
+ * EXPLAIN ANALYZE, auto_explain.log_analyze or the like.
+ */
+
+/* Is a plan-logging wrapper waiting to fire? */
+static bool LogQueryPlanRequested = false;
+
+/* Instrumentation swapped out while logging the plan */
+typedef struct LogPlanSnapshot
+{
+	List	   *planstates;		/* nodes whose instrument we replaced */
+	List	   *instruments;	/* their original instrument pointers */
+} LogPlanSnapshot;
+
+static TupleTableSlot *ExecProcNodeLogPlan(PlanState *node);
+static bool ExplainInstallLogPlanWrapper(PlanState *planstate, void *context);
+static bool ExplainSnapshotInstrumentation(PlanState *planstate,
+										   LogPlanSnapshot *snap);
+static void LogQueryPlan(QueryDesc *queryDesc);
+
+/*
+ * HandleLogQueryPlanInterrupt
+ *		Handle receipt of an interrupt indicating logging of the plan of
+ *		the running query.
+ *
+ * All the actual work is deferred to ProcessLogQueryPlanInterrupt(),
+ * because we cannot safely emit a log message inside the signal handler.
+ */
+void
+HandleLogQueryPlanInterrupt(void)
+{
+	InterruptPending = true;
+	LogQueryPlanPending = true;
+	/* latch will be set by procsignal_sigusr1_handler */
+}
+
+/*
+ * ProcessLogQueryPlanInterrupt
+ *		Arrange for the plan of the running query to be logged.
+ *
+ * Called from CHECK_FOR_INTERRUPTS() when LogQueryPlanPending is set.
+ */
+void
+ProcessLogQueryPlanInterrupt(void)
+{
+	LogQueryPlanPending = false;
+
+	if (ActiveQueryDesc == NULL || ActiveQueryDesc->planstate == NULL)
+	{
+		ereport(LOG,
+				(errmsg("backend with PID %d is not running a query",
+						MyProcPid),
+				 errhidestmt(true)));
+		return;
+	}
+
+	ExplainInstallLogPlanWrapper(ActiveQueryDesc->planstate, NULL);
+	LogQueryPlanRequested = true;
+}
+
+/*
+ * Install ExecProcNodeLogPlan as the ExecProcNode callback of the given node
+ * and all nodes below it.
+ */
+static bool
+ExplainInstallLogPlanWrapper(PlanState *planstate, void *context)
+{
+	planstate->ExecProcNode = ExecProcNodeLogPlan;
+
+	return planstate_tree_walker(planstate, ExplainInstallLogPlanWrapper,
+								 context);
+}
+
+/*
+ * ExecProcNode wrapper that logs the plan of the active query, if that has
+ * not been done yet, then puts the regular callback back and calls it.
+ */
+static TupleTableSlot *
+ExecProcNodeLogPlan(PlanState *node)
+{
+	ExecSetExecProcNode(node, node->ExecProcNodeReal);
+
+	if (LogQueryPlanRequested)
+	{
+		LogQueryPlanRequested = false;
+		if (ActiveQueryDesc != NULL)
+			LogQueryPlan(ActiveQueryDesc);
+	}
+
+	return node->ExecProcNode(node);
+}
+
+/*
+ * Replace the instrumentation of the given node and all nodes below it with
+ * copies that look as if the current cycle had just ended, so that the
+ * regular EXPLAIN code prints what has been done so far.  Nodes that are in
+ * the middle of a call are charged for the time spent in it up to now.
+ */
+static bool
+ExplainSnapshotInstrumentation(PlanState *planstate, LogPlanSnapshot *snap)
+{
+	Instrumentation *instr = planstate->instrument;
+
+	if (instr != NULL)
+	{
+		Instrumentation *copy = palloc(sizeof(Instrumentation));
+
+		memcpy(copy, instr, sizeof(Instrumentation));
+		if (!INSTR_TIME_IS_ZERO(copy->starttime))
+		{
+			instr_time	now;
+
+			INSTR_TIME_SET_CURRENT(now);
+			INSTR_TIME_ACCUM_DIFF(copy->counter, now, copy->starttime);
+			INSTR_TIME_SET_ZERO(copy->starttime);
+
+			/* still working on its first tuple? */
+			if (!copy->running)
+			{
+				copy->running = true;
+				copy->firsttuple = INSTR_TIME_GET_DOUBLE(copy->counter);
+			}
+		}
+
+		snap->planstates = lappend(snap->planstates, planstate);
+		snap->instruments = lappend(snap->instruments, instr);
+		planstate->instrument = copy;
+	}
+
+	return planstate_tree_walker(planstate, ExplainSnapshotInstrumentation,
+								 snap);
+}
+
+/*
+ * Emit the plan of the given running query to the server log.
+ */
+static void
+LogQueryPlan(QueryDesc *queryDesc)
+{
+	LogPlanSnapshot snap = {NIL, NIL};
+	MemoryContext cxt;
+	MemoryContext oldcxt;
+	ExplainState *es;
+
+	cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"log query plan",
+								ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(cxt);
+
+	es = NewExplainState();
+	es->analyze = (queryDesc->instrument_options != 0);
+	es->timing = (queryDesc->instrument_options & INSTRUMENT_TIMER) != 0;
+	es->buffers = (queryDesc->instrument_options & INSTRUMENT_BUFFERS) != 0;
+	es->wal = (queryDesc->instrument_options & INSTRUMENT_WAL) != 0;
+	es->format = EXPLAIN_FORMAT_TEXT;
+
+	PG_TRY();
+	{
+		ExplainSnapshotInstrumentation(queryDesc->planstate, &snap);
+
+		ExplainBeginOutput(es);
+		ExplainQueryText(es, queryDesc);
+		ExplainPrintPlan(es, queryDesc);
+		ExplainEndOutput(es);
+
+		/* Remove last line break */
+		if (es->str->len > 0 && es->str->data[es->str->len - 1] == '\n')
+			es->str->data[--es->str->len] = '\0';
+
+		ereport(LOG,
+				(errmsg("query plan running on backend with PID %d is:\n%s",
+						MyProcPid, es->str->data),
+				 errhidestmt(true)));
+	}
+	PG_FINALLY();
+	{
+		ListCell   *lc1;
+		ListCell   *lc2;
+
+		forboth(lc1, snap.planstates, lc2, snap.instruments)
+			((PlanState *) lfirst(lc1))->instrument = lfirst(lc2);
+	}
+	PG_END_TRY();
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(cxt);
+}
+
+/*
+ * pg_log_query_plan
+ *		Signal a backend process to log the plan of the query it is running.
+ *
+ * Only superusers are allowed to do this, for the same reasons as for
+ * pg_log_backend_memory_contexts(); besides, the plan includes the query
+ * text and parameter values of another role's query.
+ */
+Datum
+pg_log_query_plan(PG_FUNCTION_ARGS)
+{
+	int			pid = PG_GETARG_INT32(0);
+	PGPROC	   *proc = BackendPidGetProc(pid);
+
+	if (proc == NULL)
+	{
+		/*
+		 * This is just a warning so a loop-through-resultset will not abort
+		 * if one backend terminated on its own during the run.
+		 */
+		ereport(WARNING,
+				(errmsg("PID %d is not a PostgreSQL server process", pid)));
+		PG_RETURN_BOOL(false);
+	}
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be a superuser to log the plan of a query")));
+
+	if (SendProcSignal(pid, PROCSIG_LOG_QUERY_PLAN, proc->backendId) < 0)
+	{
+		/* Again, just a warning to allow loops */
+		ereport(WARNING,
+				(errmsg("could not send signal to process %d: %m", pid)));
+		PG_RETURN_BOOL(false);
+	}
+
+	PG_RETURN_BOOL(true);
+}
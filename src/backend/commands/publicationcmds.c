@@ -45,7 +45,7 @@
 #include "utils/syscache.h"
 #include "utils/varlena.h"
 
-/* Same as MAXNUMMESSAGES in sinvaladt.c */
+/* Same as the minimum sinval queue size (MINNUMMESSAGES) in sinvaladt.c */
 #define MAX_RELCACHE_INVAL_MSGS 4096
 
 static List *OpenTableList(List *tables);
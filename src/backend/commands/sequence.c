@@ -107,6 +107,12 @@ static void init_params(ParseState *pstate, List *options, bool for_identity,
 						bool *need_seq_rewrite,
 						List **owned_by);
 static void do_setval(Oid relid, int64 next, bool iscalled);
+static int64 nextval_range_internal(Oid relid, bool check_permissions,
+									int64 nvalues);
+static uint64 seq_values_left(int64 value, int64 incby, int64 minv,
+							  int64 maxv);
+static void seq_limit_error(Relation seqrel, int64 incby, int64 minv,
+							int64 maxv) pg_attribute_noreturn();
 static void process_owned_by(Relation seqrel, List *owned_by, bool for_identity);
 
 
@@ -575,8 +581,91 @@ nextval_oid(PG_FUNCTION_ARGS)
 	PG_RETURN_INT64(nextval_internal(relid, true));
 }
 
+/*
+ * nextval_range(regclass, count) -- allocate "count" consecutive values
+ *
+ * Returns the first of them; the others follow it at the sequence's
+ * increment.  This lets a bulk load take a whole range of ids with one call,
+ * instead of calling nextval() for every row.  currval() and lastval() are
+ * left at the last value of the range.
+ */
+Datum
+nextval_range(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	int64		count = PG_GETARG_INT64(1);
+
+	if (count <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of sequence values to allocate must be positive")));
+
+	PG_RETURN_INT64(nextval_range_internal(relid, true, count));
+}
+
 int64
 nextval_internal(Oid relid, bool check_permissions)
+{
+	return nextval_range_internal(relid, check_permissions, 1);
+}
+
+/*
+ * Number of values the sequence can still return after "value" without
+ * cycling.  Computed in unsigned arithmetic, since the distance between the
+ * limits of a sequence may not fit in an int64.
+ */
+static uint64
+seq_values_left(int64 value, int64 incby, int64 minv, int64 maxv)
+{
+	if (incby > 0)
+	{
+		if (value >= maxv)
+			return 0;
+		return ((uint64) maxv - (uint64) value) / (uint64) incby;
+	}
+	else
+	{
+		if (value <= minv)
+			return 0;
+		return ((uint64) value - (uint64) minv) / ((uint64) 0 - (uint64) incby);
+	}
+}
+
+/*
+ * Report that a sequence ran out of values.
+ */
+static void
+seq_limit_error(Relation seqrel, int64 incby, int64 minv, int64 maxv)
+{
+	char		buf[100];
+
+	if (incby > 0)
+	{
+		snprintf(buf, sizeof(buf), INT64_FORMAT, maxv);
+		ereport(ERROR,
+				(errcode(ERRCODE_SEQUENCE_GENERATOR_LIMIT_EXCEEDED),
+				 errmsg("nextval: reached maximum value of sequence \"%s\" (%s)",
+						RelationGetRelationName(seqrel), buf)));
+	}
+	else
+	{
+		snprintf(buf, sizeof(buf), INT64_FORMAT, minv);
+		ereport(ERROR,
+				(errcode(ERRCODE_SEQUENCE_GENERATOR_LIMIT_EXCEEDED),
+				 errmsg("nextval: reached minimum value of sequence \"%s\" (%s)",
+						RelationGetRelationName(seqrel), buf)));
+	}
+}
+
+/*
+ * Allocate "nvalues" consecutive values of a sequence, returning the first.
+ *
+ * Values left in the backend-local cache are used if there are enough of
+ * them; otherwise they are thrown away, and at least nvalues values are
+ * fetched from the sequence, which must not need to cycle to provide them.
+ */
+static int64
+nextval_range_internal(Oid relid, bool check_permissions, int64 nvalues)
 {
 	SeqTable	elm;
 	Relation	seqrel;
@@ -594,11 +683,16 @@ nextval_internal(Oid relid, bool check_permissions)
 				fetch,
 				last;
 	int64		result,
+				end,
 				next,
-				rescnt = 0;
+				nsteps,
+				rescnt,
+				ncache;
 	bool		cycle;
 	bool		logit = false;
 
+	Assert(nvalues > 0);
+
 	/* open and lock sequence */
 	init_sequence(relid, &elm, &seqrel);
 
@@ -625,10 +719,16 @@ nextval_internal(Oid relid, bool check_permissions)
 	{
 		Assert(elm->last_valid);
 		Assert(elm->increment != 0);
-		elm->last += elm->increment;
-		relation_close(seqrel, NoLock);
-		last_used_seq = elm;
-		return elm->last;
+
+		/* cached numbers are consecutive, so we can use them for a range */
+		if ((elm->cached - elm->last) / elm->increment >= nvalues)
+		{
+			result = elm->last + elm->increment;
+			elm->last += nvalues * elm->increment;
+			relation_close(seqrel, NoLock);
+			last_used_seq = elm;
+			return result;
+		}
 	}
 
 	pgstuple = SearchSysCache1(SEQRELID, ObjectIdGetDatum(relid));
@@ -647,27 +747,56 @@ nextval_internal(Oid relid, bool check_permissions)
 	page = BufferGetPage(buf);
 
 	elm->increment = incby;
-	last = next = result = seq->last_value;
-	fetch = cache;
 	log = seq->log_cnt;
 
+	/*
+	 * Take the values of the range itself.  We compute where the range ends,
+	 * rather than step through it, since it may be large and we're holding
+	 * the buffer lock.  nsteps is the number of times the sequence advances.
+	 */
 	if (!seq->is_called)
 	{
-		rescnt++;				/* return last_value if not is_called */
-		fetch--;
+		result = seq->last_value;	/* return last_value if not is_called */
+		nsteps = nvalues - 1;
 	}
+	else
+	{
+		if (seq_values_left(seq->last_value, incby, minv, maxv) == 0)
+		{
+			if (!cycle)
+				seq_limit_error(seqrel, incby, minv, maxv);
+			result = (incby > 0) ? minv : maxv;
+		}
+		else
+			result = seq->last_value + incby;
+		nsteps = nvalues;
+	}
+
+	/* a range of values can't wrap around */
+	if (seq_values_left(result, incby, minv, maxv) < (uint64) (nvalues - 1))
+		seq_limit_error(seqrel, incby, minv, maxv);
+
+	/* this can't overflow, since the end of the range is within limits */
+	end = (int64) ((uint64) result + (uint64) (nvalues - 1) * (uint64) incby);
+	last = next = end;
+	rescnt = nvalues;
+
+	/* how many more values to fetch for the cache */
+	ncache = Max(cache, nvalues);
+	fetch = ncache - nvalues;
 
 	/*
 	 * Decide whether we should emit a WAL log record.  If so, force up the
 	 * fetch count to grab SEQ_LOG_VALS more values than we actually need to
-	 * cache.  (These will then be usable without logging.)
+	 * cache.  (These will then be usable without logging.)  The log count is
+	 * then that of the values beyond the range.
 	 *
 	 * If this is the first nextval after a checkpoint, we must force a new
 	 * WAL record to be written anyway, else replay starting from the
 	 * checkpoint would fail to advance the sequence past the logged values.
 	 * In this case we may as well fetch extra values.
 	 */
-	if (log < fetch || !seq->is_called)
+	if (log - fetch < nsteps || !seq->is_called)
 	{
 		/* forced log to satisfy local demand for values */
 		fetch = log = fetch + SEQ_LOG_VALS;
@@ -683,68 +812,38 @@ nextval_internal(Oid relid, bool check_permissions)
 			fetch = log = fetch + SEQ_LOG_VALS;
 			logit = true;
 		}
+		else
+			log -= nsteps;		/* the range used up that many logged values */
 	}
 
 	while (fetch)				/* try to fetch cache [+ log ] numbers */
 	{
 		/*
 		 * Check MAXVALUE for ascending sequences and MINVALUE for descending
-		 * sequences
+		 * sequences.  We have all the values asked for, so just stop
+		 * fetching at the limit; the next call will cycle or fail.
 		 */
 		if (incby > 0)
 		{
 			/* ascending sequence */
 			if ((maxv >= 0 && next > maxv - incby) ||
 				(maxv < 0 && next + incby > maxv))
-			{
-				if (rescnt > 0)
-					break;		/* stop fetching */
-				if (!cycle)
-				{
-					char		buf[100];
-
-					snprintf(buf, sizeof(buf), INT64_FORMAT, maxv);
-					ereport(ERROR,
-							(errcode(ERRCODE_SEQUENCE_GENERATOR_LIMIT_EXCEEDED),
-							 errmsg("nextval: reached maximum value of sequence \"%s\" (%s)",
-									RelationGetRelationName(seqrel), buf)));
-				}
-				next = minv;
-			}
-			else
-				next += incby;
+				break;			/* stop fetching */
 		}
 		else
 		{
 			/* descending sequence */
 			if ((minv < 0 && next < minv - incby) ||
 				(minv >= 0 && next + incby < minv))
-			{
-				if (rescnt > 0)
-					break;		/* stop fetching */
-				if (!cycle)
-				{
-					char		buf[100];
-
-					snprintf(buf, sizeof(buf), INT64_FORMAT, minv);
-					ereport(ERROR,
-							(errcode(ERRCODE_SEQUENCE_GENERATOR_LIMIT_EXCEEDED),
-							 errmsg("nextval: reached minimum value of sequence \"%s\" (%s)",
-									RelationGetRelationName(seqrel), buf)));
-				}
-				next = maxv;
-			}
-			else
-				next += incby;
+				break;			/* stop fetching */
 		}
+		next += incby;
 		fetch--;
-		if (rescnt < cache)
+		if (rescnt < ncache)
 		{
 			log--;
 			rescnt++;
 			last = next;
-			if (rescnt == 1)	/* if it's first result - */
-				result = next;	/* it's what to return */
 		}
 	}
 
@@ -752,7 +851,7 @@ nextval_internal(Oid relid, bool check_permissions)
 	Assert(log >= 0);
 
 	/* save info in local cache */
-	elm->last = result;			/* last returned number */
+	elm->last = end;			/* last returned number */
 	elm->cached = last;			/* last fetched number */
 	elm->last_valid = true;
 
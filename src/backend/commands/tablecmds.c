@@ -86,10 +86,13 @@
 #include "storage/lock.h"
 #include "storage/predicate.h"
 #include "storage/smgr.h"
+#include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
+#include "utils/expandeddatum.h"
 #include "utils/fmgroids.h"
+#include "utils/guc.h"
 #include "utils/inval.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
@@ -153,6 +156,14 @@ static List *on_commits = NIL;
 #define AT_PASS_MISC			10	/* other stuff */
 #define AT_NUM_PASSES			11
 
+/*
+ * When rewriting a table, rows are written to the new heap in batches with
+ * table_multi_insert.  A batch is flushed when it holds this many rows, or
+ * this many bytes of column data.
+ */
+#define REWRITE_MAX_BUFFERED_TUPLES	1000
+#define REWRITE_MAX_BUFFERED_BYTES	65535
+
 typedef struct AlteredTableInfo
 {
 	/* Information saved before any work commences: */
@@ -396,6 +407,8 @@ static void ATRewriteTables(AlterTableStmt *parsetree,
 							List **wqueue, LOCKMODE lockmode,
 							AlterTableUtilityContext *context);
 static void ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode);
+static Size ATRewriteSlotSize(TupleTableSlot *slot);
+static void ATValidatePartConstraintByQuery(AlteredTableInfo *tab);
 static AlteredTableInfo *ATGetQueueEntry(List **wqueue, Relation rel);
 static void ATSimplePermissions(Relation rel, int allowed_targets);
 static void ATWrongRelkindError(Relation rel, int allowed_targets);
@@ -5481,6 +5494,27 @@ ATRewriteTables(AlterTableStmt *parsetree, List **wqueue, LOCKMODE lockmode,
 		}
 		else
 		{
+			bool		check_constraints = false;
+			ListCell   *lc;
+
+			foreach(lc, tab->constraints)
+			{
+				if (((NewConstraint *) lfirst(lc))->contype == CONSTR_CHECK)
+					check_constraints = true;
+			}
+
+			/*
+			 * If the partition constraint is the only thing that needs a scan
+			 * of the table, check it with a query instead, which lets the
+			 * planner use an index on the partition key or a parallel scan.
+			 */
+			if (tab->partition_constraint != NULL &&
+				!check_constraints && !tab->verify_new_notnull)
+			{
+				ATValidatePartConstraintByQuery(tab);
+				tab->partition_constraint = NULL;
+			}
+
 			/*
 			 * If required, test the current data within the table against new
 			 * constraints generated by ALTER TABLE commands, but don't
@@ -5587,6 +5621,9 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 	BulkInsertState bistate;
 	int			ti_options;
 	ExprState  *partqualstate = NULL;
+	TupleTableSlot **bufslots = NULL;
+	int			nbuffered = 0;
+	Size		bufferedBytes = 0;
 
 	/*
 	 * Open the relation(s).  We have surely already locked the existing
@@ -5745,6 +5782,15 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 			newslot = NULL;
 		}
 
+		/*
+		 * When rewriting, rows are copied into an array of slots and written
+		 * out in batches, which is much cheaper than inserting them one at a
+		 * time.
+		 */
+		if (newrel)
+			bufslots = (TupleTableSlot **)
+				palloc0(sizeof(TupleTableSlot *) * REWRITE_MAX_BUFFERED_TUPLES);
+
 		/*
 		 * Any attributes that are dropped according to the new tuple
 		 * descriptor can be set to NULL. We precompute the list of dropped
@@ -5909,16 +5955,44 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 							 errtable(oldrel)));
 			}
 
-			/* Write the tuple out to the new relation */
+			/*
+			 * Queue the tuple for the new relation, and write out the batch
+			 * if it's full.
+			 */
 			if (newrel)
-				table_tuple_insert(newrel, insertslot, mycid,
-								   ti_options, bistate);
+			{
+				if (bufslots[nbuffered] == NULL)
+				{
+					MemoryContextSwitchTo(oldCxt);
+					bufslots[nbuffered] = table_slot_create(newrel, NULL);
+					MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+				}
+				ExecCopySlot(bufslots[nbuffered], insertslot);
+				bufferedBytes += ATRewriteSlotSize(insertslot);
+				nbuffered++;
+
+				if (nbuffered >= REWRITE_MAX_BUFFERED_TUPLES ||
+					bufferedBytes >= REWRITE_MAX_BUFFERED_BYTES)
+				{
+					table_multi_insert(newrel, bufslots, nbuffered, mycid,
+									   ti_options, bistate);
+					for (i = 0; i < nbuffered; i++)
+						ExecClearTuple(bufslots[i]);
+					nbuffered = 0;
+					bufferedBytes = 0;
+				}
+			}
 
 			ResetExprContext(econtext);
 
 			CHECK_FOR_INTERRUPTS();
 		}
 
+		/* Write out the last, partial batch */
+		if (nbuffered > 0)
+			table_multi_insert(newrel, bufslots, nbuffered, mycid,
+							   ti_options, bistate);
+
 		MemoryContextSwitchTo(oldCxt);
 		table_endscan(scan);
 		UnregisterSnapshot(snapshot);
@@ -5926,6 +6000,12 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 		ExecDropSingleTupleTableSlot(oldslot);
 		if (newslot)
 			ExecDropSingleTupleTableSlot(newslot);
+		if (bufslots)
+		{
+			for (i = 0; i < REWRITE_MAX_BUFFERED_TUPLES && bufslots[i] != NULL; i++)
+				ExecDropSingleTupleTableSlot(bufslots[i]);
+			pfree(bufslots);
+		}
 	}
 
 	FreeExecutorState(estate);
@@ -5941,6 +6021,165 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 	}
 }
 
+/*
+ * ATValidatePartConstraintByQuery: check a table's new partition constraint
+ *
+ * Instead of scanning the table in ATRewriteTable, plan and run the query
+ * "SELECT 1 FROM ONLY rel WHERE NOT (constraint) LIMIT 1", so that the
+ * planner can answer with an index scan on the partition key, or use a
+ * parallel scan for a large table.  NOT of a null constraint result is null,
+ * so rows are accepted exactly when ExecCheck would accept them.
+ *
+ * The query tree is built directly around the constraint expression, rather
+ * than deparsed and parsed again, so nothing depends on search_path or on the
+ * expression surviving a round trip through SQL.  It doesn't go through the
+ * rewriter either, so row level security doesn't hide any rows from it.
+ *
+ * Raises an error if a row violates the constraint.
+ */
+static void
+ATValidatePartConstraintByQuery(AlteredTableInfo *tab)
+{
+	Relation	rel;
+	ParseState *pstate;
+	ParseNamespaceItem *nsitem;
+	Query	   *query;
+	PlannedStmt *plan;
+	QueryDesc  *queryDesc;
+	bool		violated;
+	int			save_nestlevel;
+
+	rel = table_open(tab->relid, NoLock);
+
+	ereport(DEBUG1,
+			(errmsg_internal("verifying partition constraint of table \"%s\" with a query",
+							 RelationGetRelationName(rel))));
+
+	/*
+	 * Build the query.  The partition constraint refers to the table as
+	 * varno 1.  We hold a lock on the table already, and like the scan, the
+	 * query doesn't check for permissions on it.
+	 */
+	pstate = make_parsestate(NULL);
+	nsitem = addRangeTableEntryForRelation(pstate, rel, AccessShareLock,
+										   NULL, false, false);
+	nsitem->p_rte->requiredPerms = 0;
+
+	query = makeNode(Query);
+	query->commandType = CMD_SELECT;
+	query->querySource = QSRC_ORIGINAL;
+	query->canSetTag = true;
+	query->rtable = pstate->p_rtable;
+	query->jointree = makeFromExpr(list_make1(makeNode(RangeTblRef)),
+								   (Node *) makeBoolExpr(NOT_EXPR,
+														 list_make1(copyObject(tab->partition_constraint)),
+														 -1));
+	((RangeTblRef *) linitial(query->jointree->fromlist))->rtindex = 1;
+	query->targetList = list_make1(makeTargetEntry((Expr *) makeConst(INT4OID, -1, InvalidOid,
+																	   sizeof(int32),
+																	   Int32GetDatum(1),
+																	   false, true),
+												   1, NULL, false));
+	query->limitCount = (Node *) makeConst(INT8OID, -1, InvalidOid,
+										   sizeof(int64), Int64GetDatum(1),
+										   false, FLOAT8PASSBYVAL);
+	query->limitOption = LIMIT_OPTION_COUNT;
+	query->stmt_location = -1;
+	query->stmt_len = 0;
+
+	/*
+	 * The table's new partition bound is already in the catalogs, so
+	 * constraint exclusion could prove the query's qual false without
+	 * looking at the data.  Turn it off while we plan the query.
+	 */
+	save_nestlevel = NewGUCNestLevel();
+	(void) set_config_option("constraint_exclusion", "off",
+							 PGC_USERSET, PGC_S_SESSION,
+							 GUC_ACTION_SAVE, true, 0, false);
+
+	plan = pg_plan_query(query, NULL, CURSOR_OPT_PARALLEL_OK, NULL);
+
+	AtEOXact_GUC(true, save_nestlevel);
+
+	/*
+	 * Like ATRewriteTable, use the latest snapshot, so that rows committed
+	 * before we got our lock are checked too.
+	 */
+	PushActiveSnapshot(GetLatestSnapshot());
+	UpdateActiveSnapshotCommandId();
+
+	queryDesc = CreateQueryDesc(plan, "partition constraint check",
+								GetActiveSnapshot(), InvalidSnapshot,
+								None_Receiver, NULL, NULL, 0);
+	ExecutorStart(queryDesc, 0);
+	ExecutorRun(queryDesc, ForwardScanDirection, 1L, true);
+	violated = (queryDesc->estate->es_processed > 0);
+	ExecutorFinish(queryDesc);
+	ExecutorEnd(queryDesc);
+	FreeQueryDesc(queryDesc);
+
+	PopActiveSnapshot();
+	free_parsestate(pstate);
+
+	if (violated)
+	{
+		if (tab->validate_default)
+			ereport(ERROR,
+					(errcode(ERRCODE_CHECK_VIOLATION),
+					 errmsg("updated partition constraint for default partition \"%s\" would be violated by some row",
+							RelationGetRelationName(rel)),
+					 errtable(rel)));
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_CHECK_VIOLATION),
+					 errmsg("partition constraint of relation \"%s\" is violated by some row",
+							RelationGetRelationName(rel)),
+					 errtable(rel)));
+	}
+
+	table_close(rel, NoLock);
+}
+
+/*
+ * ATRewriteSlotSize: approximate size of the column data in a slot
+ *
+ * Used by ATRewriteTable to bound the memory used by a batch of rows.
+ * Expanded objects are counted at their flattened size, which is what the
+ * copy in the batch will take.
+ */
+static Size
+ATRewriteSlotSize(TupleTableSlot *slot)
+{
+	TupleDesc	tupdesc = slot->tts_tupleDescriptor;
+	Size		size = 0;
+	int			i;
+
+	slot_getallattrs(slot);
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+
+		if (slot->tts_isnull[i])
+			continue;
+		if (attr->attlen > 0)
+			size += attr->attlen;
+		else if (attr->attlen == -1)
+		{
+			Pointer		val = DatumGetPointer(slot->tts_values[i]);
+
+			if (VARATT_IS_EXTERNAL_EXPANDED(val))
+				size += EOH_get_flat_size(DatumGetEOHP(slot->tts_values[i]));
+			else
+				size += VARSIZE_ANY(val);
+		}
+		else
+			size += strlen(DatumGetCString(slot->tts_values[i])) + 1;
+	}
+
+	return size;
+}
+
 /*
  * ATGetQueueEntry: find or create an entry in the ALTER TABLE work queue
  */
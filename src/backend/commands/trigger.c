@@ -3534,11 +3534,15 @@ static void AfterTriggerExecute(EState *estate,
 								AfterTriggerEvent event,
 								ResultRelInfo *relInfo,
 								TriggerDesc *trigdesc,
+								int tgindx,
 								FmgrInfo *finfo,
 								Instrumentation *instr,
 								MemoryContext per_tuple_context,
 								TupleTableSlot *trig_tuple_slot1,
 								TupleTableSlot *trig_tuple_slot2);
+static inline bool AfterTriggerSlotHoldsRow(TupleTableSlot *slot,
+											ItemPointer tid);
+static void AfterTriggerClearSlots(ResultRelInfo *relInfo);
 static AfterTriggersTableData *GetAfterTriggersTableData(Oid relid,
 														 CmdType cmdType);
 static TupleTableSlot *GetAfterTriggersStoreSlot(AfterTriggersTableData *table,
@@ -3860,6 +3864,7 @@ afterTriggerDeleteHeadEventChunk(AfterTriggersQueryData *qs)
  *	event: event currently being fired.
  *	rel: open relation for event.
  *	trigdesc: working copy of rel's trigger info.
+ *	tgindx: index of the event's trigger in trigdesc.
  *	finfo: array of fmgr lookup cache entries (one per trigger in trigdesc).
  *	instr: array of EXPLAIN ANALYZE instrumentation nodes (one per trigger),
  *		or NULL if no instrumentation is wanted.
@@ -3872,7 +3877,7 @@ static void
 AfterTriggerExecute(EState *estate,
 					AfterTriggerEvent event,
 					ResultRelInfo *relInfo,
-					TriggerDesc *trigdesc,
+					TriggerDesc *trigdesc, int tgindx,
 					FmgrInfo *finfo, Instrumentation *instr,
 					MemoryContext per_tuple_context,
 					TupleTableSlot *trig_tuple_slot1,
@@ -3880,26 +3885,13 @@ AfterTriggerExecute(EState *estate,
 {
 	Relation	rel = relInfo->ri_RelationDesc;
 	AfterTriggerShared evtshared = GetTriggerSharedData(event);
-	Oid			tgoid = evtshared->ats_tgoid;
 	TriggerData LocTriggerData = {0};
 	HeapTuple	rettuple;
-	int			tgindx;
 	bool		should_free_trig = false;
 	bool		should_free_new = false;
 
-	/*
-	 * Locate trigger in trigdesc.
-	 */
-	for (tgindx = 0; tgindx < trigdesc->numtriggers; tgindx++)
-	{
-		if (trigdesc->triggers[tgindx].tgoid == tgoid)
-		{
-			LocTriggerData.tg_trigger = &(trigdesc->triggers[tgindx]);
-			break;
-		}
-	}
-	if (LocTriggerData.tg_trigger == NULL)
-		elog(ERROR, "could not find trigger %u", tgoid);
+	Assert(tgindx >= 0 && tgindx < trigdesc->numtriggers);
+	LocTriggerData.tg_trigger = &(trigdesc->triggers[tgindx]);
 
 	/*
 	 * If doing EXPLAIN ANALYZE, start charging time to this trigger. We want
@@ -3957,11 +3949,21 @@ AfterTriggerExecute(EState *estate,
 			break;
 
 		default:
+
+			/*
+			 * A row with several AFTER triggers has one event per trigger,
+			 * queued one after another.  afterTriggerInvokeEvents leaves the
+			 * row versions fetched for one event in the slots, so that the
+			 * following events for the same row needn't fetch them again.
+			 * The slots keep the buffer pinned, so the tuples can't move.
+			 */
 			if (ItemPointerIsValid(&(event->ate_ctid1)))
 			{
 				LocTriggerData.tg_trigslot = ExecGetTriggerOldSlot(estate, relInfo);
 
-				if (!table_tuple_fetch_row_version(rel, &(event->ate_ctid1),
+				if (!AfterTriggerSlotHoldsRow(LocTriggerData.tg_trigslot,
+											  &(event->ate_ctid1)) &&
+					!table_tuple_fetch_row_version(rel, &(event->ate_ctid1),
 												   SnapshotAny,
 												   LocTriggerData.tg_trigslot))
 					elog(ERROR, "failed to fetch tuple1 for AFTER trigger");
@@ -3980,7 +3982,9 @@ AfterTriggerExecute(EState *estate,
 			{
 				LocTriggerData.tg_newslot = ExecGetTriggerNewSlot(estate, relInfo);
 
-				if (!table_tuple_fetch_row_version(rel, &(event->ate_ctid2),
+				if (!AfterTriggerSlotHoldsRow(LocTriggerData.tg_newslot,
+											  &(event->ate_ctid2)) &&
+					!table_tuple_fetch_row_version(rel, &(event->ate_ctid2),
 												   SnapshotAny,
 												   LocTriggerData.tg_newslot))
 					elog(ERROR, "failed to fetch tuple2 for AFTER trigger");
@@ -4050,14 +4054,10 @@ AfterTriggerExecute(EState *estate,
 	if (should_free_new)
 		heap_freetuple(LocTriggerData.tg_newtuple);
 
-	/* don't clear slots' contents if foreign table */
-	if (trig_tuple_slot1 == NULL)
-	{
-		if (LocTriggerData.tg_trigslot)
-			ExecClearTuple(LocTriggerData.tg_trigslot);
-		if (LocTriggerData.tg_newslot)
-			ExecClearTuple(LocTriggerData.tg_newslot);
-	}
+	/*
+	 * The slots' contents are left alone, for the next event to reuse if it's
+	 * for the same row; afterTriggerInvokeEvents clears them.
+	 */
 
 	/*
 	 * If doing EXPLAIN ANALYZE, stop charging time to this trigger, and count
@@ -4068,6 +4068,33 @@ AfterTriggerExecute(EState *estate,
 }
 
 
+/*
+ * AfterTriggerSlotHoldsRow
+ *
+ * Does the given slot already hold the row version at tid, fetched for an
+ * earlier event?
+ */
+static inline bool
+AfterTriggerSlotHoldsRow(TupleTableSlot *slot, ItemPointer tid)
+{
+	return !TTS_EMPTY(slot) && ItemPointerEquals(&slot->tts_tid, tid);
+}
+
+/*
+ * AfterTriggerClearSlots
+ *
+ * Release the row versions that AfterTriggerExecute left in a result
+ * relation's trigger slots.
+ */
+static void
+AfterTriggerClearSlots(ResultRelInfo *relInfo)
+{
+	if (relInfo->ri_TrigOldSlot)
+		ExecClearTuple(relInfo->ri_TrigOldSlot);
+	if (relInfo->ri_TrigNewSlot)
+		ExecClearTuple(relInfo->ri_TrigNewSlot);
+}
+
 /*
  * afterTriggerMarkEvents()
  *
@@ -4183,6 +4210,8 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 	Instrumentation *instr = NULL;
 	TupleTableSlot *slot1 = NULL,
 			   *slot2 = NULL;
+	Oid			tgoid = InvalidOid;
+	int			tgindx = -1;
 
 	/* Make a local EState if need be */
 	if (estate == NULL)
@@ -4218,7 +4247,11 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 				 */
 				if (rel == NULL || RelationGetRelid(rel) != evtshared->ats_relid)
 				{
+					/* Tuples fetched before don't belong to our events */
+					if (rInfo != NULL)
+						AfterTriggerClearSlots(rInfo);
 					rInfo = ExecGetTriggerResultRel(estate, evtshared->ats_relid);
+					AfterTriggerClearSlots(rInfo);
 					rel = rInfo->ri_RelationDesc;
 					trigdesc = rInfo->ri_TrigDesc;
 					finfo = rInfo->ri_TrigFunctions;
@@ -4239,6 +4272,25 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 					if (trigdesc == NULL)	/* should not happen */
 						elog(ERROR, "relation %u has no triggers",
 							 evtshared->ats_relid);
+					tgoid = InvalidOid;
+				}
+
+				/*
+				 * Locate the trigger in trigdesc, unless it's the same one as
+				 * for the previous event.  Bulk operations typically queue
+				 * long runs of events for the same trigger, so this saves a
+				 * search of the trigger array per event.
+				 */
+				if (evtshared->ats_tgoid != tgoid)
+				{
+					tgoid = evtshared->ats_tgoid;
+					for (tgindx = 0; tgindx < trigdesc->numtriggers; tgindx++)
+					{
+						if (trigdesc->triggers[tgindx].tgoid == tgoid)
+							break;
+					}
+					if (tgindx >= trigdesc->numtriggers)
+						elog(ERROR, "could not find trigger %u", tgoid);
 				}
 
 				/*
@@ -4246,7 +4298,8 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 				 * still set, so recursive examinations of the event list
 				 * won't try to re-fire it.
 				 */
-				AfterTriggerExecute(estate, event, rInfo, trigdesc, finfo, instr,
+				AfterTriggerExecute(estate, event, rInfo, trigdesc, tgindx,
+									finfo, instr,
 									per_tuple_context, slot1, slot2);
 
 				/*
@@ -4278,6 +4331,8 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 				events->tailfree = chunk->freeptr;
 		}
 	}
+	if (rInfo != NULL)
+		AfterTriggerClearSlots(rInfo);
 	if (slot1 != NULL)
 	{
 		ExecDropSingleTupleTableSlot(slot1);
@@ -64,6 +64,7 @@ int			vacuum_multixact_freeze_min_age;
 int			vacuum_multixact_freeze_table_age;
 int			vacuum_failsafe_age;
 int			vacuum_multixact_failsafe_age;
+bool		vacuum_freeze_eager = false;
 
 
 /* A few variables that don't seem worth passing around as parameters */
@@ -58,6 +58,33 @@ typedef struct LastAttnumInfo
 	AttrNumber	last_scan;
 } LastAttnumInfo;
 
+/*
+ * A subexpression that occurs more than once among the expressions compiled
+ * into one ExprState, and is evaluated only once per execution.  'expr' is
+ * the occurrence that computes the value into 'value'/'isnull'; it must be
+ * one that is evaluated unconditionally.  Once it has been compiled, other
+ * occurrences compiled after it just read the saved value.
+ */
+typedef struct ExprCommonSubexpr
+{
+	Expr	   *expr;			/* the occurrence that computes the value */
+	bool		compiled;		/* have its steps been emitted yet? */
+	bool		compiling;		/* ... or are they being emitted now? */
+	Datum	   *value;			/* where the value is saved */
+	bool	   *isnull;
+} ExprCommonSubexpr;
+
+typedef struct CommonSubexprContext
+{
+	List	   *all;			/* all candidate subexpressions */
+	List	   *unconditional;	/* ... those evaluated on every execution */
+	bool		is_unconditional;	/* is the current position such? */
+	int			limit;			/* give up after this many candidates */
+} CommonSubexprContext;
+
+/* GUC parameter */
+int			expression_cse_limit = 64;
+
 static void ExecReadyExpr(ExprState *state);
 static void ExecInitExprRec(Expr *node, ExprState *state,
 							Datum *resv, bool *resnull);
@@ -65,6 +92,11 @@ static void ExecInitFunc(ExprEvalStep *scratch, Expr *node, List *args,
 						 Oid funcid, Oid inputcollid,
 						 ExprState *state);
 static void ExecInitExprSlots(ExprState *state, Node *node);
+static void ExecFindCommonSubexprs(ExprState *state, List *exprs);
+static bool common_subexpr_walker(Node *node, CommonSubexprContext *context);
+static bool common_subexpr_candidate_walker(Node *node, void *context);
+static bool ExecInitCommonSubexpr(Expr *node, ExprState *state,
+								  Datum *resv, bool *resnull);
 static void ExecPushExprSlots(ExprState *state, LastAttnumInfo *info);
 static bool get_last_attnums_walker(Node *node, LastAttnumInfo *info);
 static bool ExecComputeSlotInfo(ExprState *state, ExprEvalStep *op);
@@ -230,6 +262,9 @@ ExecInitQual(List *qual, PlanState *parent)
 	/* Insert EEOP_*_FETCHSOME steps as needed */
 	ExecInitExprSlots(state, (Node *) qual);
 
+	/* Arrange to evaluate repeated subexpressions only once */
+	ExecFindCommonSubexprs(state, qual);
+
 	/*
 	 * ExecQual() needs to return false for an expression returning NULL. That
 	 * allows us to short-circuit the evaluation the first time a NULL is
@@ -374,6 +409,16 @@ ExecBuildProjectionInfo(List *targetList,
 	/* Insert EEOP_*_FETCHSOME steps as needed */
 	ExecInitExprSlots(state, (Node *) targetList);
 
+	/* Arrange to evaluate repeated subexpressions only once */
+	{
+		List	   *exprs = NIL;
+
+		foreach(lc, targetList)
+			exprs = lappend(exprs, lfirst_node(TargetEntry, lc)->expr);
+		ExecFindCommonSubexprs(state, exprs);
+		list_free(exprs);
+	}
+
 	/* Now compile each tlist column */
 	foreach(lc, targetList)
 	{
@@ -856,6 +901,12 @@ ExecInitExprRec(Expr *node, ExprState *state,
 	scratch.resvalue = resv;
 	scratch.resnull = resnull;
 
+	/* Reuse or save the value of a repeated subexpression, if it's one */
+	if (state->cse_entries != NIL &&
+		(IsA(node, FuncExpr) || IsA(node, OpExpr)) &&
+		ExecInitCommonSubexpr(node, state, resv, resnull))
+		return;
+
 	/* cases should be ordered as they are in enum NodeTag */
 	switch (nodeTag(node))
 	{
@@ -2491,6 +2542,240 @@ ExecInitFunc(ExprEvalStep *scratch, Expr *node, List *args, Oid funcid,
 	}
 }
 
+/*
+ * Find subexpressions that occur more than once in 'exprs', which are about
+ * to be compiled one after the other into 'state', and record them in
+ * state->cse_entries so that ExecInitExprRec evaluates each only once.
+ *
+ * Only non-volatile, non-set-returning function and operator calls over
+ * Vars, Consts and Params qualify; their value can't change within one
+ * execution of the ExprState.  The occurrence that computes the value must be
+ * one that is always evaluated when anything after it is: that's the case at
+ * the top of each expression (projection columns are all evaluated; a qual
+ * clause is only reached if the clauses before it were), and within the
+ * arguments of such a call, since arguments are always evaluated before the
+ * call itself.  Occurrences under CASE, AND/OR, COALESCE and the like might
+ * be skipped, so they can use a saved value but not provide one.
+ *
+ * Matching the candidates costs time quadratic in their number, so we give
+ * up as soon as more than expression_cse_limit of them have been found.
+ */
+static void
+ExecFindCommonSubexprs(ExprState *state, List *exprs)
+{
+	CommonSubexprContext context;
+	bool		toomany = false;
+	ListCell   *lc;
+
+	if (expression_cse_limit <= 0)
+		return;
+
+	context.all = NIL;
+	context.unconditional = NIL;
+	context.limit = expression_cse_limit;
+
+	foreach(lc, exprs)
+	{
+		context.is_unconditional = true;
+		if (common_subexpr_walker((Node *) lfirst(lc), &context))
+		{
+			toomany = true;
+			break;
+		}
+	}
+
+	if (!toomany && list_length(context.all) > 1)
+	{
+		foreach(lc, context.unconditional)
+		{
+			Expr	   *expr = (Expr *) lfirst(lc);
+			ListCell   *lc2;
+			int			count = 0;
+			bool		seen = false;
+
+			/* An earlier equal occurrence will already provide the value */
+			foreach(lc2, state->cse_entries)
+			{
+				ExprCommonSubexpr *entry = (ExprCommonSubexpr *) lfirst(lc2);
+
+				if (equal(entry->expr, expr))
+				{
+					seen = true;
+					break;
+				}
+			}
+			if (seen)
+				continue;
+
+			foreach(lc2, context.all)
+			{
+				if (equal(lfirst(lc2), expr))
+					count++;
+			}
+
+			if (count > 1)
+			{
+				ExprCommonSubexpr *entry = palloc(sizeof(ExprCommonSubexpr));
+
+				entry->expr = expr;
+				entry->compiled = false;
+				entry->compiling = false;
+				entry->value = palloc(sizeof(Datum));
+				entry->isnull = palloc(sizeof(bool));
+				state->cse_entries = lappend(state->cse_entries, entry);
+			}
+		}
+	}
+
+	list_free(context.all);
+	list_free(context.unconditional);
+}
+
+/*
+ * Collect candidate subexpressions for ExecFindCommonSubexprs.
+ */
+static bool
+common_subexpr_walker(Node *node, CommonSubexprContext *context)
+{
+	bool		save_is_unconditional;
+
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, FuncExpr) || IsA(node, OpExpr))
+	{
+		if (!common_subexpr_candidate_walker(node, NULL) &&
+			!contain_volatile_functions(node) &&
+			!expression_returns_set(node))
+		{
+			context->all = lappend(context->all, node);
+			if (context->is_unconditional)
+				context->unconditional = lappend(context->unconditional, node);
+
+			/* abandon the search if there are too many candidates */
+			if (list_length(context->all) > context->limit)
+				return true;
+		}
+
+		/* arguments are always evaluated before the call */
+		return expression_tree_walker(node, common_subexpr_walker,
+									  (void *) context);
+	}
+
+	if (IsA(node, RelabelType))
+		return expression_tree_walker(node, common_subexpr_walker,
+									  (void *) context);
+
+	/* These are evaluated elsewhere, not by the steps of this ExprState */
+	if (IsA(node, Aggref) || IsA(node, WindowFunc) ||
+		IsA(node, GroupingFunc) || IsA(node, SubPlan) ||
+		IsA(node, AlternativeSubPlan))
+		return false;
+
+	/* Anything else might not evaluate all its inputs */
+	save_is_unconditional = context->is_unconditional;
+	context->is_unconditional = false;
+	if (expression_tree_walker(node, common_subexpr_walker,
+							   (void *) context))
+		return true;
+	context->is_unconditional = save_is_unconditional;
+
+	return false;
+}
+
+/*
+ * Does the expression contain anything other than function and operator
+ * calls over Vars, Consts and Params?  Other nodes may depend on state that
+ * differs between occurrences, such as CaseTestExpr.
+ */
+static bool
+common_subexpr_candidate_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+		case T_Const:
+		case T_Param:
+		case T_FuncExpr:
+		case T_OpExpr:
+		case T_RelabelType:
+			return expression_tree_walker(node,
+										  common_subexpr_candidate_walker,
+										  context);
+		default:
+			return true;
+	}
+}
+
+/*
+ * If 'node' is a repeated subexpression found by ExecFindCommonSubexprs,
+ * emit the steps to evaluate it into 'resv'/'resnull' and return true.
+ * Otherwise return false, and the caller compiles it normally.
+ */
+static bool
+ExecInitCommonSubexpr(Expr *node, ExprState *state,
+					  Datum *resv, bool *resnull)
+{
+	ExprEvalStep scratch = {0};
+	ExprCommonSubexpr *entry = NULL;
+	ListCell   *lc;
+
+	foreach(lc, state->cse_entries)
+	{
+		ExprCommonSubexpr *e = (ExprCommonSubexpr *) lfirst(lc);
+
+		if (e->compiled ? equal(e->expr, node) : (e->expr == node))
+		{
+			entry = e;
+			break;
+		}
+	}
+
+	/* Not a repeated subexpression, or we're now compiling it (see below) */
+	if (entry == NULL || entry->compiling)
+		return false;
+
+	if (!entry->compiled)
+	{
+		/*
+		 * This is the occurrence that computes the value.  Evaluate it into
+		 * the entry's workspace, marking it so that the recursive call
+		 * compiles it normally.
+		 */
+		entry->compiling = true;
+		ExecInitExprRec(node, state, entry->value, entry->isnull);
+		entry->compiling = false;
+		entry->compiled = true;
+
+		/*
+		 * Since the value will be read multiple times, force to R/O - but
+		 * only if it could be an expanded datum.
+		 */
+		if (get_typlen(exprType((Node *) node)) == -1)
+		{
+			scratch.opcode = EEOP_MAKE_READONLY;
+			scratch.resvalue = entry->value;
+			scratch.resnull = entry->isnull;
+			scratch.d.make_readonly.value = entry->value;
+			scratch.d.make_readonly.isnull = entry->isnull;
+			ExprEvalPushStep(state, &scratch);
+		}
+	}
+
+	/* Fetch the saved value, just like a CaseTestExpr */
+	scratch.opcode = EEOP_CASE_TESTVAL;
+	scratch.resvalue = resv;
+	scratch.resnull = resnull;
+	scratch.d.casetest.value = entry->value;
+	scratch.d.casetest.isnull = entry->isnull;
+	ExprEvalPushStep(state, &scratch);
+
+	return true;
+}
+
 /*
  * Add expression steps deforming the ExprState's inner/outer/scan slots
  * as much as required by the expression.
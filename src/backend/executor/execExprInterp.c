@@ -165,6 +165,8 @@ static Datum ExecJustScanVarVirt(ExprState *state, ExprContext *econtext, bool *
 static Datum ExecJustAssignInnerVarVirt(ExprState *state, ExprContext *econtext, bool *isnull);
 static Datum ExecJustAssignOuterVarVirt(ExprState *state, ExprContext *econtext, bool *isnull);
 static Datum ExecJustAssignScanVarVirt(ExprState *state, ExprContext *econtext, bool *isnull);
+static bool ExecIsScanVarOpConstQual(ExprState *state);
+static Datum ExecJustScanVarOpConstQual(ExprState *state, ExprContext *econtext, bool *isnull);
 
 /* execution helper functions */
 static pg_attribute_always_inline void ExecAggPlainTransByVal(AggState *aggstate,
@@ -356,6 +358,11 @@ ExecReadyInterpretedExpr(ExprState *state)
 			return;
 		}
 	}
+	else if (ExecIsScanVarOpConstQual(state))
+	{
+		state->evalfunc_private = (void *) ExecJustScanVarOpConstQual;
+		return;
+	}
 
 #if defined(EEO_USE_COMPUTED_GOTO)
 
@@ -2145,6 +2152,95 @@ ExecJustConst(ExprState *state, ExprContext *econtext, bool *isnull)
 	return op->d.constval.value;
 }
 
+/*
+ * Is this a qual consisting only of "scan Var op Const" clauses, each a call
+ * to a strict function without usage tracking?  Such filters are common
+ * enough, e.g. in OLTP lookups, to be worth a fast path.
+ *
+ * ExecInitQual() compiles each clause into SCAN_VAR and CONST steps that
+ * store straight into the function's arguments, followed by FUNCEXPR_STRICT
+ * and QUAL; one SCAN_FETCHSOME precedes them all.
+ */
+static bool
+ExecIsScanVarOpConstQual(ExprState *state)
+{
+	int			nclauses;
+
+	if (!(state->flags & EEO_FLAG_IS_QUAL) ||
+		state->steps_len < 6 ||
+		(state->steps_len - 2) % 4 != 0 ||
+		state->steps[0].opcode != EEOP_SCAN_FETCHSOME)
+		return false;
+
+	nclauses = (state->steps_len - 2) / 4;
+	for (int i = 0; i < nclauses; i++)
+	{
+		ExprEvalStep *varop = &state->steps[1 + i * 4];
+		ExprEvalStep *constop = varop + 1;
+		ExprEvalStep *funcop = varop + 2;
+		ExprEvalStep *qualop = varop + 3;
+		FunctionCallInfo fcinfo;
+
+		if (varop->opcode != EEOP_SCAN_VAR ||
+			constop->opcode != EEOP_CONST ||
+			funcop->opcode != EEOP_FUNCEXPR_STRICT ||
+			qualop->opcode != EEOP_QUAL ||
+			funcop->d.func.nargs != 2)
+			return false;
+
+		fcinfo = funcop->d.func.fcinfo_data;
+		if (varop->resvalue != &fcinfo->args[0].value ||
+			varop->resnull != &fcinfo->args[0].isnull ||
+			constop->resvalue != &fcinfo->args[1].value ||
+			constop->resnull != &fcinfo->args[1].isnull)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Evaluate a qual accepted by ExecIsScanVarOpConstQual, doing the work of
+ * its steps without the interpreter's dispatch.
+ */
+static Datum
+ExecJustScanVarOpConstQual(ExprState *state, ExprContext *econtext, bool *isnull)
+{
+	ExprEvalStep *op = &state->steps[0];
+	TupleTableSlot *scanslot = econtext->ecxt_scantuple;
+
+	CheckOpSlotCompatibility(op, scanslot);
+	slot_getsomeattrs(scanslot, op->d.fetch.last_var);
+
+	/* a qual's result is never null */
+	*isnull = false;
+
+	for (op++; op->opcode != EEOP_DONE; op += 4)
+	{
+		int			attnum = op[0].d.var.attnum;
+		FunctionCallInfo fcinfo = op[2].d.func.fcinfo_data;
+		Datum		d;
+
+		Assert(attnum >= 0 && attnum < scanslot->tts_nvalid);
+
+		/* strict function with a null argument yields null, i.e. false */
+		if (scanslot->tts_isnull[attnum] || op[1].d.constval.isnull)
+			return BoolGetDatum(false);
+
+		fcinfo->args[0].value = scanslot->tts_values[attnum];
+		fcinfo->args[0].isnull = false;
+		fcinfo->args[1].value = op[1].d.constval.value;
+		fcinfo->args[1].isnull = false;
+
+		fcinfo->isnull = false;
+		d = op[2].d.func.fn_addr(fcinfo);
+		if (fcinfo->isnull || !DatumGetBool(d))
+			return BoolGetDatum(false);
+	}
+
+	return BoolGetDatum(true);
+}
+
 /* implementation of ExecJust(Inner|Outer|Scan)VarVirt */
 static pg_attribute_always_inline Datum
 ExecJustVarVirtImpl(ExprState *state, TupleTableSlot *slot, bool *isnull)
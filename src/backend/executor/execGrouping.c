@@ -18,8 +18,10 @@
 #include "common/hashfn.h"
 #include "executor/executor.h"
 #include "miscadmin.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/pg_locale.h"
 
 static int	TupleHashTableMatch(struct tuplehash_hash *tb, const MinimalTuple tuple1, const MinimalTuple tuple2);
 static inline uint32 TupleHashTableHash_internal(struct tuplehash_hash *tb,
@@ -122,6 +124,66 @@ execTuplesHashPrepare(int numCols,
 	}
 }
 
+/*
+ * ExecHashKeyBytesOK
+ *		Can string keys under this collation be hashed by their bytes?
+ *
+ * Under a deterministic collation, hashtext() and hashname() just hash the
+ * bytes of the string, so an in-memory hash table may instead use the
+ * cheaper hash_bytes_fast() on those bytes, as long as every value that goes
+ * into or probes the table is hashed the same way.  Since text and name are
+ * hashed identically, cross-type lookups between them still work.
+ *
+ * Callers compute this once per key column and pass it to ExecHashKeyValue.
+ */
+bool
+ExecHashKeyBytesOK(Oid collation)
+{
+	if (!OidIsValid(collation))
+		return false;			/* let hashtext() complain, if it cares */
+	return lc_collate_is_c(collation) ||
+		get_collation_isdeterministic(collation);
+}
+
+/*
+ * ExecHashKeyValue
+ *		Compute the hash of one key column for an in-memory hash table.
+ *
+ * The result is only meaningful within the current query: it need not match
+ * the hash support function, so don't use it for anything stored on disk
+ * beyond the query's own temporary files.
+ */
+uint32
+ExecHashKeyValue(FmgrInfo *hashfunction, Oid collation, bool bytes_ok,
+				 Datum value)
+{
+	if (bytes_ok)
+	{
+		if (hashfunction->fn_oid == F_HASHTEXT)
+		{
+			text	   *key = DatumGetTextPP(value);
+			uint32		result;
+
+			result = hash_bytes_fast((unsigned char *) VARDATA_ANY(key),
+									 VARSIZE_ANY_EXHDR(key));
+
+			/* Avoid leaking memory for toasted inputs */
+			if ((Pointer) key != DatumGetPointer(value))
+				pfree(key);
+
+			return result;
+		}
+		if (hashfunction->fn_oid == F_HASHNAME)
+		{
+			char	   *key = NameStr(*DatumGetName(value));
+
+			return hash_bytes_fast((unsigned char *) key, strlen(key));
+		}
+	}
+
+	return DatumGetUInt32(FunctionCall1Coll(hashfunction, collation, value));
+}
+
 
 /*****************************************************************************
  *		Utility routines for all-in-memory hash tables
@@ -182,6 +244,9 @@ BuildTupleHashTableExt(PlanState *parent,
 	hashtable->keyColIdx = keyColIdx;
 	hashtable->tab_hash_funcs = hashfunctions;
 	hashtable->tab_collations = collations;
+	hashtable->tab_hash_bytes = (bool *) palloc(numCols * sizeof(bool));
+	for (int i = 0; i < numCols; i++)
+		hashtable->tab_hash_bytes[i] = ExecHashKeyBytesOK(collations[i]);
 	hashtable->tablecxt = tablecxt;
 	hashtable->tempcxt = tempcxt;
 	hashtable->entrysize = entrysize;
@@ -351,6 +416,16 @@ TupleHashTableHash(TupleHashTable hashtable, TupleTableSlot *slot)
 	return hash;
 }
 
+/*
+ * Prefetch the part of the hashtable where an entry with the given hash value
+ * would be found, in preparation for a later LookupTupleHashEntryHash().
+ */
+void
+TupleHashTablePrefetch(TupleHashTable hashtable, uint32 hash)
+{
+	tuplehash_prefetch_hash(hashtable->hashtab, hash);
+}
+
 /*
  * A variant of LookupTupleHashEntry for callers that have already computed
  * the hash value.
@@ -466,9 +541,10 @@ TupleHashTableHash_internal(struct tuplehash_hash *tb,
 		{
 			uint32		hkey;
 
-			hkey = DatumGetUInt32(FunctionCall1Coll(&hashfunctions[i],
-													hashtable->tab_collations[i],
-													attr));
+			hkey = ExecHashKeyValue(&hashfunctions[i],
+									hashtable->tab_collations[i],
+									hashtable->tab_hash_bytes[i],
+									attr);
 			hashkey ^= hkey;
 		}
 	}
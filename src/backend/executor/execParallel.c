@@ -758,15 +758,21 @@ ExecInitParallelPlan(PlanState *planstate, EState *estate,
 	shm_toc_insert(pcxt->toc, PARALLEL_KEY_PARAMLISTINFO, paramlistinfo_space);
 	SerializeParamList(estate->es_param_list_info, &paramlistinfo_space);
 
-	/* Allocate space for each worker's BufferUsage; no need to initialize. */
+	/*
+	 * Allocate space for each worker's BufferUsage.  It must be zeroed,
+	 * because a worker that is told it isn't needed exits without reporting
+	 * any (see SkipUnstartedParallelWorkers).
+	 */
 	bufusage_space = shm_toc_allocate(pcxt->toc,
 									  mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	memset(bufusage_space, 0, mul_size(sizeof(BufferUsage), pcxt->nworkers));
 	shm_toc_insert(pcxt->toc, PARALLEL_KEY_BUFFER_USAGE, bufusage_space);
 	pei->buffer_usage = bufusage_space;
 
 	/* Same for WalUsage. */
 	walusage_space = shm_toc_allocate(pcxt->toc,
 									  mul_size(sizeof(WalUsage), pcxt->nworkers));
+	memset(walusage_space, 0, mul_size(sizeof(WalUsage), pcxt->nworkers));
 	shm_toc_insert(pcxt->toc, PARALLEL_KEY_WAL_USAGE, walusage_space);
 	pei->wal_usage = walusage_space;
 
@@ -916,6 +922,10 @@ ExecParallelReinitialize(PlanState *planstate,
 	ExecSetParamPlanMulti(sendParams, GetPerTupleExprContext(estate));
 
 	ReinitializeParallelDSM(pei->pcxt);
+	memset(pei->buffer_usage, 0,
+		   mul_size(sizeof(BufferUsage), pei->pcxt->nworkers));
+	memset(pei->wal_usage, 0,
+		   mul_size(sizeof(WalUsage), pei->pcxt->nworkers));
 	pei->tqueue = ExecParallelSetupTupleQueues(pei->pcxt, true);
 	pei->reader = NULL;
 	pei->finished = false;
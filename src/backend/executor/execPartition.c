@@ -140,6 +140,14 @@ struct PartitionTupleRouting
  *		the index corresponds to the PartitionDispatch for it in its
  *		partition_dispatch_info array.  -1 indicates we've not yet allocated
  *		anything in PartitionTupleRouting for the partition.
+ *
+ * last_found_datum_index, last_found_count
+ *		The bound offset found by the most recent binary search of a list or
+ *		range partitioned table, and the number of consecutive tuples that
+ *		have mapped to it.  Once that count reaches
+ *		PARTITION_CACHED_FIND_THRESHOLD, get_partition_for_tuple() checks
+ *		whether the next tuple still fits the cached bound before falling back
+ *		to a binary search.
  *-----------------------
  */
 typedef struct PartitionDispatchData
@@ -150,9 +158,19 @@ typedef struct PartitionDispatchData
 	PartitionDesc partdesc;
 	TupleTableSlot *tupslot;
 	AttrMap    *tupmap;
+	int			last_found_datum_index;
+	int			last_found_count;
 	int			indexes[FLEXIBLE_ARRAY_MEMBER];
 }			PartitionDispatchData;
 
+/*
+ * Number of consecutive tuples that must map to the same bound before
+ * get_partition_for_tuple() starts rechecking that bound first.  Requiring a
+ * run keeps the extra comparisons from costing anything noticeable when the
+ * incoming tuples are spread across many partitions.
+ */
+#define PARTITION_CACHED_FIND_THRESHOLD	16
+
 
 static ResultRelInfo *ExecInitPartitionInfo(ModifyTableState *mtstate,
 											EState *estate, PartitionTupleRouting *proute,
@@ -1024,6 +1042,8 @@ ExecInitPartitionDispatchInfo(EState *estate,
 	pd->key = RelationGetPartitionKey(rel);
 	pd->keystate = NIL;
 	pd->partdesc = partdesc;
+	pd->last_found_datum_index = -1;
+	pd->last_found_count = 0;
 	if (parent_pd != NULL)
 	{
 		TupleDesc	tupdesc = RelationGetDescr(rel);
@@ -1234,6 +1254,13 @@ FormPartitionKeyDatum(PartitionDispatch pd,
  *		Finds partition of relation which accepts the partition key specified
  *		in values and isnull
  *
+ * For list and range partitioning, tuples often arrive in runs that all go to
+ * the same partition, for instance when loading time-series data into a
+ * table partitioned by date.  Once a run is long enough we check whether the
+ * tuple fits the bound found last time, which costs at most two comparisons,
+ * and only do the binary search if it doesn't.  Hash partitioning needs no
+ * such cache, as the partition is computed directly from the hash value.
+ *
  * Return value is index of the partition (>= 0 and < partdesc->nparts) if one
  * found or -1 if none found.
  */
@@ -1272,12 +1299,39 @@ get_partition_for_tuple(PartitionDispatch pd, Datum *values, bool *isnull)
 			{
 				bool		equal = false;
 
+				if (pd->last_found_count >= PARTITION_CACHED_FIND_THRESHOLD)
+				{
+					bound_offset = pd->last_found_datum_index;
+					Assert(bound_offset >= 0 && bound_offset < boundinfo->ndatums);
+
+					if (DatumGetInt32(FunctionCall2Coll(&key->partsupfunc[0],
+														key->partcollation[0],
+														boundinfo->datums[bound_offset][0],
+														values[0])) == 0)
+					{
+						part_index = boundinfo->indexes[bound_offset];
+						break;
+					}
+				}
+
 				bound_offset = partition_list_bsearch(key->partsupfunc,
 													  key->partcollation,
 													  boundinfo,
 													  values[0], &equal);
 				if (bound_offset >= 0 && equal)
+				{
 					part_index = boundinfo->indexes[bound_offset];
+
+					if (bound_offset == pd->last_found_datum_index)
+						pd->last_found_count++;
+					else
+					{
+						pd->last_found_datum_index = bound_offset;
+						pd->last_found_count = 1;
+					}
+				}
+				else
+					pd->last_found_count = 0;
 			}
 			break;
 
@@ -1302,6 +1356,41 @@ get_partition_for_tuple(PartitionDispatch pd, Datum *values, bool *isnull)
 
 				if (!range_partkey_has_null)
 				{
+					/*
+					 * If the last few tuples fell between the same pair of
+					 * bounds, see if this one does too.  The binary search
+					 * would return the greatest bound that is less than or
+					 * equal to the tuple, so the cached offset is the answer
+					 * exactly when that bound is <= the tuple and the next
+					 * one, if any, is > the tuple.  An offset of -1 stands
+					 * for "below the lowest bound".
+					 */
+					if (pd->last_found_count >= PARTITION_CACHED_FIND_THRESHOLD)
+					{
+						bound_offset = pd->last_found_datum_index;
+						Assert(bound_offset >= -1 &&
+							   bound_offset < boundinfo->ndatums);
+
+						if ((bound_offset < 0 ||
+							 partition_rbound_datum_cmp(key->partsupfunc,
+														key->partcollation,
+														boundinfo->datums[bound_offset],
+														boundinfo->kind[bound_offset],
+														values,
+														key->partnatts) <= 0) &&
+							(bound_offset + 1 >= boundinfo->ndatums ||
+							 partition_rbound_datum_cmp(key->partsupfunc,
+														key->partcollation,
+														boundinfo->datums[bound_offset + 1],
+														boundinfo->kind[bound_offset + 1],
+														values,
+														key->partnatts) > 0))
+						{
+							part_index = boundinfo->indexes[bound_offset + 1];
+							break;
+						}
+					}
+
 					bound_offset = partition_range_datum_bsearch(key->partsupfunc,
 																 key->partcollation,
 																 boundinfo,
@@ -1316,6 +1405,14 @@ get_partition_for_tuple(PartitionDispatch pd, Datum *values, bool *isnull)
 					 * actually exists one.
 					 */
 					part_index = boundinfo->indexes[bound_offset + 1];
+
+					if (bound_offset == pd->last_found_datum_index)
+						pd->last_found_count++;
+					else
+					{
+						pd->last_found_datum_index = bound_offset;
+						pd->last_found_count = 1;
+					}
 				}
 			}
 			break;
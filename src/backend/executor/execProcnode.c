@@ -970,6 +970,27 @@ ExecSetTupleBound(int64 tuples_needed, PlanState *child_node)
 
 		ExecSetTupleBound(tuples_needed, outerPlanState(child_node));
 	}
+	else if (IsA(child_node, NestLoopState) ||
+			 IsA(child_node, MergeJoinState) ||
+			 IsA(child_node, HashJoinState))
+	{
+		/*
+		 * In a left or full join, every outer row produces at least one join
+		 * row, so we need no more outer rows than the join must return.  That
+		 * lets "ORDER BY ... LIMIT n" over an order-preserving join do a
+		 * bounded sort of its outer input.  As with SubqueryScan, an
+		 * other-qual that might discard join rows means we must punt.
+		 *
+		 * A parallel-aware hash join may hand our outer rows over to other
+		 * processes through shared batch files, so don't try that case.
+		 */
+		JoinState  *jstate = (JoinState *) child_node;
+
+		if ((jstate->jointype == JOIN_LEFT || jstate->jointype == JOIN_FULL) &&
+			jstate->ps.qual == NULL &&
+			!child_node->plan->parallel_aware)
+			ExecSetTupleBound(tuples_needed, outerPlanState(child_node));
+	}
 
 	/*
 	 * In principle we could descend through any plan node type that is
@@ -929,6 +929,30 @@ slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 
 	tp = (char *) tup + tup->t_hoff;
 
+	/*
+	 * Fast path for the leading run of fixed-width attributes whose offsets
+	 * are already cached in the tupdesc.  If the tuple has no nulls, each of
+	 * them can be fetched straight from its cached offset, skipping the null
+	 * bitmap test and the alignment and varlena bookkeeping of the general
+	 * loop below.  The state left behind (attnum, off, !slow) is exactly what
+	 * the general loop would have produced, so it can just carry on.
+	 */
+	if (!hasnulls && !slow)
+	{
+		for (; attnum < natts; attnum++)
+		{
+			Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
+
+			if (thisatt->attcacheoff < 0 || thisatt->attlen <= 0)
+				break;
+
+			off = thisatt->attcacheoff;
+			values[attnum] = fetchatt(thisatt, tp + off);
+			isnull[attnum] = false;
+			off += thisatt->attlen;
+		}
+	}
+
 	for (; attnum < natts; attnum++)
 	{
 		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
@@ -22,6 +22,13 @@ static BufferUsage save_pgBufferUsage;
 WalUsage	pgWalUsage;
 static WalUsage save_pgWalUsage;
 
+/*
+ * With INSTRUMENT_TIMER_SAMPLED, only one in this many calls of a node is
+ * timed, apart from the first call of each cycle which is always timed so
+ * that the startup time is exact.
+ */
+#define INSTR_TIMER_SAMPLE_RATE		16
+
 static void BufferUsageAdd(BufferUsage *dst, const BufferUsage *add);
 static void WalUsageAdd(WalUsage *dst, WalUsage *add);
 
@@ -39,6 +46,7 @@ InstrAlloc(int n, int instrument_options)
 		bool		need_buffers = (instrument_options & INSTRUMENT_BUFFERS) != 0;
 		bool		need_wal = (instrument_options & INSTRUMENT_WAL) != 0;
 		bool		need_timer = (instrument_options & INSTRUMENT_TIMER) != 0;
+		bool		sample_timer = (instrument_options & INSTRUMENT_TIMER_SAMPLED) != 0;
 		int			i;
 
 		for (i = 0; i < n; i++)
@@ -46,6 +54,7 @@ InstrAlloc(int n, int instrument_options)
 			instr[i].need_bufusage = need_buffers;
 			instr[i].need_walusage = need_wal;
 			instr[i].need_timer = need_timer;
+			instr[i].sample_timer = need_timer && sample_timer;
 		}
 	}
 
@@ -60,13 +69,29 @@ InstrInit(Instrumentation *instr, int instrument_options)
 	instr->need_bufusage = (instrument_options & INSTRUMENT_BUFFERS) != 0;
 	instr->need_walusage = (instrument_options & INSTRUMENT_WAL) != 0;
 	instr->need_timer = (instrument_options & INSTRUMENT_TIMER) != 0;
+	instr->sample_timer = instr->need_timer &&
+		(instrument_options & INSTRUMENT_TIMER_SAMPLED) != 0;
 }
 
 /* Entry to a plan node */
 void
 InstrStartNode(Instrumentation *instr)
 {
-	if (instr->need_timer &&
+	bool		time_this_call = instr->need_timer;
+
+	/*
+	 * When sampling, leave starttime unset for the calls we skip, which tells
+	 * InstrStopNode not to read the clock either.
+	 */
+	if (time_this_call && instr->sample_timer && instr->running)
+	{
+		time_this_call = (instr->ncalls == instr->ntimed * INSTR_TIMER_SAMPLE_RATE);
+		if (time_this_call)
+			instr->ntimed++;
+		instr->ncalls++;
+	}
+
+	if (time_this_call &&
 		!INSTR_TIME_SET_CURRENT_LAZY(instr->starttime))
 		elog(ERROR, "InstrStartNode called twice in a row");
 
@@ -91,12 +116,17 @@ InstrStopNode(Instrumentation *instr, double nTuples)
 	if (instr->need_timer)
 	{
 		if (INSTR_TIME_IS_ZERO(instr->starttime))
-			elog(ERROR, "InstrStopNode called without start");
-
-		INSTR_TIME_SET_CURRENT(endtime);
-		INSTR_TIME_ACCUM_DIFF(instr->counter, endtime, instr->starttime);
+		{
+			if (!instr->sample_timer)
+				elog(ERROR, "InstrStopNode called without start");
+		}
+		else
+		{
+			INSTR_TIME_SET_CURRENT(endtime);
+			INSTR_TIME_ACCUM_DIFF(instr->counter, endtime, instr->starttime);
 
-		INSTR_TIME_SET_ZERO(instr->starttime);
+			INSTR_TIME_SET_ZERO(instr->starttime);
+		}
 	}
 
 	/* Add delta of buffer usage since entry to node's totals */
@@ -132,6 +162,14 @@ InstrEndLoop(Instrumentation *instr)
 	/* Accumulate per-cycle statistics into totals */
 	totaltime = INSTR_TIME_GET_DOUBLE(instr->counter);
 
+	/*
+	 * If only some calls after the first were timed, assume the rest took as
+	 * long on average.
+	 */
+	if (instr->ntimed > 0)
+		totaltime = instr->firsttuple +
+			(totaltime - instr->firsttuple) * instr->ncalls / instr->ntimed;
+
 	instr->startup += instr->firsttuple;
 	instr->total += totaltime;
 	instr->ntuples += instr->tuplecount;
@@ -143,6 +181,8 @@ InstrEndLoop(Instrumentation *instr)
 	INSTR_TIME_SET_ZERO(instr->counter);
 	instr->firsttuple = 0;
 	instr->tuplecount = 0;
+	instr->ncalls = 0;
+	instr->ntimed = 0;
 }
 
 /* aggregate instrumentation information */
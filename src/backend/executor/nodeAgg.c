@@ -305,6 +305,12 @@
  */
 #define HASHAGG_HLL_BIT_WIDTH 5
 
+/*
+ * Number of input tuples that AGG_HASHED mode reads ahead, so that the hash
+ * table buckets for all of them can be prefetched before they are looked up.
+ */
+#define HASHAGG_READAHEAD 8
+
 /*
  * Estimate chunk overhead as a constant 16 bytes. XXX: should this be
  * improved?
@@ -430,7 +436,8 @@ static int	hash_choose_num_partitions(double input_groups,
 static void initialize_hash_entry(AggState *aggstate,
 								  TupleHashTable hashtable,
 								  TupleHashEntry entry);
-static void lookup_hash_entries(AggState *aggstate);
+static void lookup_hash_entries(AggState *aggstate, uint32 *hashes);
+static int	hashagg_read_ahead(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
 static void agg_fill_hash_table(AggState *aggstate);
 static bool agg_refill_hash_table(AggState *aggstate);
@@ -1868,7 +1875,10 @@ hash_agg_check_limits(AggState *aggstate)
 		(meta_mem + hashkey_mem > aggstate->hash_mem_limit ||
 		 ngroups > aggstate->hash_ngroups_limit))
 	{
-		hash_agg_enter_spill_mode(aggstate);
+		if (aggstate->hash_emit_early)
+			aggstate->hash_flush_pending = true;
+		else
+			hash_agg_enter_spill_mode(aggstate);
 	}
 }
 
@@ -2087,7 +2097,7 @@ initialize_hash_entry(AggState *aggstate, TupleHashTable hashtable,
  * efficient.
  */
 static void
-lookup_hash_entries(AggState *aggstate)
+lookup_hash_entries(AggState *aggstate, uint32 *hashes)
 {
 	AggStatePerGroup *pergroup = aggstate->hash_pergroup;
 	TupleTableSlot *outerslot = aggstate->tmpcontext->ecxt_outertuple;
@@ -2111,8 +2121,15 @@ lookup_hash_entries(AggState *aggstate)
 						  outerslot,
 						  hashslot);
 
-		entry = LookupTupleHashEntry(hashtable, hashslot,
-									 p_isnew, &hash);
+		if (hashes != NULL)
+		{
+			hash = hashes[setno];
+			entry = LookupTupleHashEntryHash(hashtable, hashslot,
+											 p_isnew, hash);
+		}
+		else
+			entry = LookupTupleHashEntry(hashtable, hashslot,
+										 p_isnew, &hash);
 
 		if (entry != NULL)
 		{
@@ -2442,7 +2459,7 @@ agg_retrieve_direct(AggState *aggstate)
 					if (aggstate->aggstrategy == AGG_MIXED &&
 						aggstate->current_phase == 1)
 					{
-						lookup_hash_entries(aggstate);
+						lookup_hash_entries(aggstate, NULL);
 					}
 
 					/* Advance the aggregates (or combine functions) */
@@ -2537,21 +2554,30 @@ agg_fill_hash_table(AggState *aggstate)
 	TupleTableSlot *outerslot;
 	ExprContext *tmpcontext = aggstate->tmpcontext;
 
+	aggstate->hash_flush_pending = false;
+
 	/*
 	 * Process each outer-plan tuple, and then fetch the next one, until we
-	 * exhaust the outer plan.
+	 * exhaust the outer plan.  Tuples are read a few at a time, see
+	 * hashagg_read_ahead().
 	 */
 	for (;;)
 	{
-		outerslot = fetch_input_tuple(aggstate);
-		if (TupIsNull(outerslot))
+		int			next;
+
+		if (aggstate->hash_readahead_next >= aggstate->hash_readahead_count &&
+			hashagg_read_ahead(aggstate) == 0)
 			break;
 
+		next = aggstate->hash_readahead_next++;
+		outerslot = aggstate->hash_readahead_slots[next];
+
 		/* set up for lookup_hash_entries and advance_aggregates */
 		tmpcontext->ecxt_outertuple = outerslot;
 
 		/* Find or build hashtable entries */
-		lookup_hash_entries(aggstate);
+		lookup_hash_entries(aggstate,
+							&aggstate->hash_readahead_hashes[next * aggstate->num_hashes]);
 
 		/* Advance the aggregates (or combine functions) */
 		advance_aggregates(aggstate);
@@ -2561,6 +2587,16 @@ agg_fill_hash_table(AggState *aggstate)
 		 * hash lookups do this too
 		 */
 		ResetExprContext(aggstate->tmpcontext);
+
+		/*
+		 * In early emission mode, stop reading input once the hash table is
+		 * full and let agg_retrieve_hash_table() emit what we have.
+		 */
+		if (aggstate->hash_flush_pending)
+		{
+			aggstate->hash_ever_flushed = true;
+			break;
+		}
 	}
 
 	/* finalize spills, if any */
@@ -2573,6 +2609,63 @@ agg_fill_hash_table(AggState *aggstate)
 						   &aggstate->perhash[0].hashiter);
 }
 
+/*
+ * Read up to HASHAGG_READAHEAD tuples from the outer plan into the read-ahead
+ * slots, compute their hash values for every grouping set, and prefetch the
+ * hash table buckets they will be looked up in.  Probing a hash table much
+ * larger than the CPU cache is dominated by cache misses; issuing the
+ * prefetches for several tuples before resolving any of them lets those
+ * misses overlap.
+ *
+ * Returns the number of tuples read, which is zero once the outer plan is
+ * exhausted.
+ */
+static int
+hashagg_read_ahead(AggState *aggstate)
+{
+	int			ntuples = 0;
+	int			i;
+
+	while (ntuples < HASHAGG_READAHEAD && !aggstate->hash_input_done)
+	{
+		TupleTableSlot *outerslot = fetch_input_tuple(aggstate);
+
+		if (TupIsNull(outerslot))
+		{
+			aggstate->hash_input_done = true;
+			break;
+		}
+
+		ExecCopySlot(aggstate->hash_readahead_slots[ntuples], outerslot);
+		ntuples++;
+	}
+
+	for (i = 0; i < ntuples; i++)
+	{
+		TupleTableSlot *slot = aggstate->hash_readahead_slots[i];
+		int			setno;
+
+		for (setno = 0; setno < aggstate->num_hashes; setno++)
+		{
+			AggStatePerHash perhash = &aggstate->perhash[setno];
+			uint32		hash;
+
+			prepare_hash_slot(perhash, slot, perhash->hashslot);
+			hash = TupleHashTableHash(perhash->hashtable, perhash->hashslot);
+			TupleHashTablePrefetch(perhash->hashtable, hash);
+			aggstate->hash_readahead_hashes[i * aggstate->num_hashes + setno] = hash;
+		}
+	}
+
+	/* release any memory used by the hash functions */
+	ResetExprContext(aggstate->tmpcontext);
+
+	aggstate->hash_readahead_count = ntuples;
+	aggstate->hash_readahead_next = 0;
+
+	return ntuples;
+}
+
 /*
  * If any data was spilled during hash aggregation, reset the hash table and
  * reprocess one batch of spilled data. After reprocessing a batch, the hash
@@ -2746,6 +2839,22 @@ agg_retrieve_hash_table(AggState *aggstate)
 		result = agg_retrieve_hash_table_in_memory(aggstate);
 		if (result == NULL)
 		{
+			/*
+			 * If we stopped reading input early, empty the hash table and
+			 * continue with the rest of the input.
+			 */
+			if (aggstate->hash_flush_pending)
+			{
+				hash_agg_update_metrics(aggstate, false, 0);
+
+				ReScanExprContext(aggstate->hashcontext);
+				ResetTupleHashTable(aggstate->perhash[0].hashtable);
+				aggstate->hash_ngroups_current = 0;
+
+				agg_fill_hash_table(aggstate);
+				continue;
+			}
+
 			if (!agg_refill_hash_table(aggstate))
 			{
 				aggstate->agg_done = true;
@@ -3693,6 +3802,34 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 
 		/* Initialize this to 1, meaning nothing spilled, yet */
 		aggstate->hash_batches_used = 1;
+
+		/*
+		 * When computing partial aggregates, there's no need to spill when
+		 * the hash table grows too large: the groups in memory can be emitted
+		 * right away, as the node that finalizes the aggregates will combine
+		 * any duplicates with the groups emitted later.  This is typical for
+		 * high-cardinality grouping in parallel workers, where spilling would
+		 * only make each worker write and re-read most of its input.
+		 */
+		aggstate->hash_emit_early = (node->aggstrategy == AGG_HASHED &&
+									 aggstate->num_hashes == 1 &&
+									 DO_AGGSPLIT_SKIPFINAL(aggstate->aggsplit));
+
+		/* Set up to read input ahead, see hashagg_read_ahead() */
+		if (node->aggstrategy == AGG_HASHED)
+		{
+			int			slotno;
+
+			aggstate->hash_readahead_slots = (TupleTableSlot **)
+				palloc(sizeof(TupleTableSlot *) * HASHAGG_READAHEAD);
+			for (slotno = 0; slotno < HASHAGG_READAHEAD; slotno++)
+				aggstate->hash_readahead_slots[slotno] =
+					ExecInitExtraTupleSlot(estate, scanDesc,
+										   aggstate->ss.ps.outerops);
+			aggstate->hash_readahead_hashes = (uint32 *)
+				palloc(sizeof(uint32) * HASHAGG_READAHEAD *
+					   aggstate->num_hashes);
+		}
 	}
 
 	/*
@@ -4460,13 +4597,15 @@ ExecReScanAgg(AggState *node)
 			return;
 
 		/*
-		 * If we do have the hash table, and it never spilled, and the subplan
+		 * If we do have the hash table, and it never spilled nor emitted
+		 * groups early (so it holds all of them), and the subplan
 		 * does not have any parameter changes, and none of our own parameter
 		 * changes affect input expressions of the aggregated functions, then
 		 * we can just rescan the existing hash table; no need to build it
 		 * again.
 		 */
 		if (outerPlan->chgParam == NULL && !node->hash_ever_spilled &&
+			!node->hash_ever_flushed &&
 			!bms_overlap(node->ss.ps.chgParam, aggnode->aggParams))
 		{
 			ResetTupleHashIterator(node->perhash[0].hashtable,
@@ -4527,8 +4666,22 @@ ExecReScanAgg(AggState *node)
 
 		node->hash_ever_spilled = false;
 		node->hash_spill_mode = false;
+		node->hash_flush_pending = false;
+		node->hash_ever_flushed = false;
 		node->hash_ngroups_current = 0;
 
+		/* Discard any input we read ahead */
+		if (node->hash_readahead_slots)
+		{
+			int			slotno;
+
+			for (slotno = 0; slotno < HASHAGG_READAHEAD; slotno++)
+				ExecClearTuple(node->hash_readahead_slots[slotno]);
+		}
+		node->hash_readahead_count = 0;
+		node->hash_readahead_next = 0;
+		node->hash_input_done = false;
+
 		ReScanExprContext(node->hashcontext);
 		/* Rebuild an empty hash table */
 		build_hash_tables(node);
@@ -299,6 +299,14 @@ gather_getnext(GatherState *gatherstate)
 				return outerTupleSlot;
 
 			gatherstate->need_to_scan_locally = false;
+
+			/*
+			 * Our copy of the plan has run out of work, so there's none left
+			 * for workers that haven't started yet either; don't make them
+			 * go through the whole startup just to find that out.
+			 */
+			if (gatherstate->pei != NULL)
+				SkipUnstartedParallelWorkers(gatherstate->pei->pcxt);
 		}
 	}
 
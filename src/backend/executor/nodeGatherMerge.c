@@ -30,10 +30,15 @@
 /*
  * When we read tuples from workers, it's a good idea to read several at once
  * for efficiency when possible: this minimizes context-switching overhead.
- * But reading too many at a time wastes memory without improving performance.
+ * It also matters for keeping the workers busy: a worker whose tuple queue is
+ * full has to wait until the leader consumes from it, and the leader only
+ * reads from a worker when that worker's buffered tuples are exhausted.  With
+ * wide merges the leader is the bottleneck, so we buffer enough tuples that
+ * draining a queue frees a worthwhile amount of room in it.  Reading many
+ * more than that at a time wastes memory without improving performance.
  * We'll read up to MAX_TUPLE_STORE tuples (in addition to the first one).
  */
-#define MAX_TUPLE_STORE 10
+#define MAX_TUPLE_STORE 64
 
 /*
  * Pending-tuple array for each worker.  This holds additional tuples that
@@ -663,6 +668,10 @@ gather_merge_readnext(GatherMergeState *gm_state, int reader, bool nowait)
 			}
 			/* need_to_scan_locally serves as "done" flag for leader */
 			gm_state->need_to_scan_locally = false;
+
+			/* Workers that haven't started yet won't find any work, either */
+			if (gm_state->pei != NULL)
+				SkipUnstartedParallelWorkers(gm_state->pei->pcxt);
 		}
 		return false;
 	}
@@ -55,7 +55,10 @@ static void ExecHashSkewTableInsert(HashJoinTable hashtable,
 									uint32 hashvalue,
 									int bucketNumber);
 static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable);
+static void ExecHashTableFreeBloomFilter(HashJoinTable hashtable);
 
+static inline void ExecHashPushTuple(HashJoinTable hashtable, int bucketno,
+									 HashJoinTuple tuple);
 static void *dense_alloc(HashJoinTable hashtable, Size size);
 static HashJoinTuple ExecParallelHashTupleAlloc(HashJoinTable hashtable,
 												size_t size,
@@ -174,6 +177,11 @@ MultiExecPrivateHash(HashState *node)
 		{
 			int			bucketNumber;
 
+			if (hashtable->bloomFilter)
+				bloom_add_element(hashtable->bloomFilter,
+								  (unsigned char *) &hashvalue,
+								  sizeof(hashvalue));
+
 			bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
 			if (bucketNumber != INVALID_SKEW_BUCKET_NO)
 			{
@@ -196,7 +204,8 @@ MultiExecPrivateHash(HashState *node)
 		ExecHashIncreaseNumBuckets(hashtable);
 
 	/* Account for the buckets in spaceUsed (reported in EXPLAIN ANALYZE) */
-	hashtable->spaceUsed += hashtable->nbuckets * sizeof(HashJoinTuple);
+	hashtable->spaceUsed += hashtable->nbuckets *
+		(sizeof(HashJoinTuple) + sizeof(uint8));
 	if (hashtable->spaceUsed > hashtable->spacePeak)
 		hashtable->spacePeak = hashtable->spaceUsed;
 
@@ -486,6 +495,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 	hashtable->log2_nbuckets = log2_nbuckets;
 	hashtable->log2_nbuckets_optimal = log2_nbuckets;
 	hashtable->buckets.unshared = NULL;
+	hashtable->bucketTags = NULL;
 	hashtable->keepNulls = keepNulls;
 	hashtable->skewEnabled = false;
 	hashtable->skewBucket = NULL;
@@ -502,6 +512,10 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 	hashtable->skewTuples = 0;
 	hashtable->innerBatchFile = NULL;
 	hashtable->outerBatchFile = NULL;
+	hashtable->bloomFilter = NULL;
+	hashtable->bloomSize = 0;
+	hashtable->bloomTested = 0;
+	hashtable->bloomRejected = 0;
 	hashtable->spaceUsed = 0;
 	hashtable->spacePeak = 0;
 	hashtable->spaceAllowed = space_allowed;
@@ -546,6 +560,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 		(FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
 	hashtable->hashStrict = (bool *) palloc(nkeys * sizeof(bool));
 	hashtable->collations = (Oid *) palloc(nkeys * sizeof(Oid));
+	hashtable->hashBytes = (bool *) palloc(nkeys * sizeof(bool));
 	i = 0;
 	forboth(ho, hashOperators, hc, hashCollations)
 	{
@@ -560,6 +575,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 		fmgr_info(right_hashfn, &hashtable->inner_hashfunctions[i]);
 		hashtable->hashStrict[i] = op_strict(hashop);
 		hashtable->collations[i] = lfirst_oid(hc);
+		hashtable->hashBytes[i] = ExecHashKeyBytesOK(hashtable->collations[i]);
 		i++;
 	}
 
@@ -638,6 +654,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 
 		hashtable->buckets.unshared = (HashJoinTuple *)
 			palloc0(nbuckets * sizeof(HashJoinTuple));
+		hashtable->bucketTags = (uint8 *) palloc0(nbuckets * sizeof(uint8));
 
 		/*
 		 * Set up for skew optimization, if possible and there's a need for
@@ -957,6 +974,9 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		hashtable->buckets.unshared =
 			repalloc(hashtable->buckets.unshared,
 					 sizeof(HashJoinTuple) * hashtable->nbuckets);
+		hashtable->bucketTags =
+			repalloc(hashtable->bucketTags,
+					 sizeof(uint8) * hashtable->nbuckets);
 	}
 
 	/*
@@ -966,6 +986,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	 */
 	memset(hashtable->buckets.unshared, 0,
 		   sizeof(HashJoinTuple) * hashtable->nbuckets);
+	memset(hashtable->bucketTags, 0, sizeof(uint8) * hashtable->nbuckets);
 	oldchunks = hashtable->chunks;
 	hashtable->chunks = NULL;
 
@@ -999,8 +1020,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 				memcpy(copyTuple, hashTuple, hashTupleSize);
 
 				/* and add it back to the appropriate bucket */
-				copyTuple->next.unshared = hashtable->buckets.unshared[bucketno];
-				hashtable->buckets.unshared[bucketno] = copyTuple;
+				ExecHashPushTuple(hashtable, bucketno, copyTuple);
 			}
 			else
 			{
@@ -1032,14 +1052,15 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 #endif
 
 	/*
-	 * If we dumped out either all or none of the tuples in the table, disable
-	 * further expansion of nbatch.  This situation implies that we have
-	 * enough tuples of identical hashvalues to overflow spaceAllowed.
+	 * If we dumped out all, none or hardly any of the tuples in the table,
+	 * disable further expansion of nbatch.  This situation implies that we
+	 * have enough tuples of identical hashvalues to overflow spaceAllowed.
 	 * Increasing nbatch will not fix it since there's no way to subdivide the
-	 * group any more finely. We have to just gut it out and hope the server
-	 * has enough RAM.
+	 * group any more finely; it would only keep doubling the number of batch
+	 * files.  We have to just gut it out and hope the server has enough RAM.
 	 */
-	if (nfreed == 0 || nfreed == ninmemory)
+	if (nfreed < ninmemory * MIN_BATCH_SPLIT_FRACTION ||
+		nfreed > ninmemory * (1.0 - MIN_BATCH_SPLIT_FRACTION))
 	{
 		hashtable->growEnabled = false;
 #ifdef HJDEBUG
@@ -1236,13 +1257,15 @@ ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable)
 						space_exhausted = true;
 
 						/*
-						 * Did this batch receive ALL of the tuples from its
-						 * parent batch?  That would indicate that further
-						 * repartitioning isn't going to help (the hash values
-						 * are probably all the same).
+						 * Did this batch receive (nearly) ALL of the tuples
+						 * from its parent batch?  That would indicate that
+						 * further repartitioning isn't going to help (the
+						 * hash values are probably all the same).
 						 */
 						parent = i % pstate->old_nbatch;
-						if (batch->ntuples == hashtable->batches[parent].shared->old_ntuples)
+						if (batch->ntuples >=
+							hashtable->batches[parent].shared->old_ntuples *
+							(1.0 - MIN_BATCH_SPLIT_FRACTION))
 							extreme_skew_detected = true;
 					}
 				}
@@ -1461,8 +1484,13 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 		(HashJoinTuple *) repalloc(hashtable->buckets.unshared,
 								   hashtable->nbuckets * sizeof(HashJoinTuple));
 
+	hashtable->bucketTags =
+		(uint8 *) repalloc(hashtable->bucketTags,
+						   hashtable->nbuckets * sizeof(uint8));
+
 	memset(hashtable->buckets.unshared, 0,
 		   hashtable->nbuckets * sizeof(HashJoinTuple));
+	memset(hashtable->bucketTags, 0, hashtable->nbuckets * sizeof(uint8));
 
 	/* scan through all tuples in all chunks to rebuild the hash table */
 	for (chunk = hashtable->chunks; chunk != NULL; chunk = chunk->next.unshared)
@@ -1480,8 +1508,7 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 									  &bucketno, &batchno);
 
 			/* add the tuple to the proper bucket */
-			hashTuple->next.unshared = hashtable->buckets.unshared[bucketno];
-			hashtable->buckets.unshared[bucketno] = hashTuple;
+			ExecHashPushTuple(hashtable, bucketno, hashTuple);
 
 			/* advance index past the tuple */
 			idx += MAXALIGN(HJTUPLE_OVERHEAD +
@@ -1633,8 +1660,7 @@ ExecHashTableInsert(HashJoinTable hashtable,
 		HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
 
 		/* Push it onto the front of the bucket's list */
-		hashTuple->next.unshared = hashtable->buckets.unshared[bucketno];
-		hashtable->buckets.unshared[bucketno] = hashTuple;
+		ExecHashPushTuple(hashtable, bucketno, hashTuple);
 
 		/*
 		 * Increase the (optimal) number of buckets if we just exceeded the
@@ -1858,7 +1884,8 @@ ExecHashGetHashValue(HashJoinTable hashtable,
 			/* Compute the hash function */
 			uint32		hkey;
 
-			hkey = DatumGetUInt32(FunctionCall1Coll(&hashfunctions[i], hashtable->collations[i], keyval));
+			hkey = ExecHashKeyValue(&hashfunctions[i], hashtable->collations[i],
+									hashtable->hashBytes[i], keyval);
 			hashkey ^= hkey;
 		}
 
@@ -1920,6 +1947,106 @@ ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 	}
 }
 
+/*
+ * ExecHashTableCreateBloomFilter
+ *		set up a Bloom filter to be filled while building the hash table
+ *
+ * ntuples is the estimated number of inner tuples.  The filter records the
+ * hash value of every inner tuple, whichever batch it belongs to, so an
+ * outer tuple whose hash value is missing from it cannot have a join partner
+ * in any batch.  Callers use this to discard such outer tuples instead of
+ * postponing them to a later batch, which matters most when the inner side
+ * is much more selective than the outer side, as in star-schema joins.
+ *
+ * The filter's memory counts against hash_mem like the hash table's own, so
+ * it is allowed at most a quarter of spaceAllowed.  bloom_create() never
+ * makes a filter smaller than 1MB; if that's more than we can spare, we do
+ * without one.
+ *
+ * Must be called before the hash table is built, and only for a private
+ * (non-parallel) hash table.
+ */
+void
+ExecHashTableCreateBloomFilter(HashJoinTable hashtable, double ntuples)
+{
+	MemoryContext oldcxt;
+	Size		bloom_mem;
+
+	Assert(hashtable->parallel_state == NULL);
+	Assert(hashtable->totalTuples == 0);
+
+	/* budget in kilobytes, as bloom_create() wants it */
+	bloom_mem = hashtable->spaceAllowed / 4 / 1024;
+	if (bloom_mem < 1024)
+		return;
+	bloom_mem = Min(bloom_mem, (Size) work_mem);
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+	hashtable->bloomFilter = bloom_create((int64) Max(ntuples, 1.0),
+										  (int) bloom_mem, 0);
+	MemoryContextSwitchTo(oldcxt);
+
+	hashtable->bloomSize = bloom_size(hashtable->bloomFilter);
+	hashtable->spaceUsed += hashtable->bloomSize;
+	if (hashtable->spaceUsed > hashtable->spacePeak)
+		hashtable->spacePeak = hashtable->spaceUsed;
+}
+
+/*
+ * ExecHashTableFreeBloomFilter
+ *		release the Bloom filter, if any, and give back its memory
+ */
+static void
+ExecHashTableFreeBloomFilter(HashJoinTable hashtable)
+{
+	if (hashtable->bloomFilter == NULL)
+		return;
+
+	bloom_free(hashtable->bloomFilter);
+	hashtable->bloomFilter = NULL;
+	hashtable->spaceUsed -= hashtable->bloomSize;
+}
+
+/*
+ * Minimum number of outer tuples to test against the Bloom filter before
+ * judging whether it is worth keeping, and the minimum fraction of them that
+ * must be rejected for it to be kept.
+ */
+#define BLOOM_FILTER_MIN_TESTED		1024
+#define BLOOM_FILTER_MIN_REJECTED	0.01
+
+/*
+ * ExecHashBloomMayMatch
+ *		check whether an outer tuple's hash value may have a join partner
+ *
+ * Returns false only if no inner tuple has the given hash value.  If the
+ * filter turns out to reject hardly any outer tuples, it is thrown away so
+ * that we stop paying for checking it.
+ */
+bool
+ExecHashBloomMayMatch(HashJoinTable hashtable, uint32 hashvalue)
+{
+	bloom_filter *filter = hashtable->bloomFilter;
+
+	if (filter == NULL)
+		return true;
+
+	hashtable->bloomTested++;
+	if (bloom_lacks_element(filter, (unsigned char *) &hashvalue,
+							sizeof(hashvalue)))
+	{
+		hashtable->bloomRejected++;
+		return false;
+	}
+
+	if (hashtable->bloomTested == BLOOM_FILTER_MIN_TESTED &&
+		hashtable->bloomRejected <
+		BLOOM_FILTER_MIN_TESTED * BLOOM_FILTER_MIN_REJECTED)
+		ExecHashTableFreeBloomFilter(hashtable);
+
+	return true;
+}
+
 /*
  * ExecScanHashBucket
  *		scan a hash bucket for matches to the current outer tuple
@@ -1950,8 +2077,11 @@ ExecScanHashBucket(HashJoinState *hjstate,
 		hashTuple = hashTuple->next.unshared;
 	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
 		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
-	else
+	else if (hashtable->bucketTags[hjstate->hj_CurBucketNo] &
+			 HJ_BUCKET_TAG(hashvalue))
 		hashTuple = hashtable->buckets.unshared[hjstate->hj_CurBucketNo];
+	else
+		hashTuple = NULL;		/* no tuple in the bucket has this tag */
 
 	while (hashTuple != NULL)
 	{
@@ -2143,6 +2273,9 @@ ExecHashTableReset(HashJoinTable hashtable)
 	MemoryContext oldcxt;
 	int			nbuckets = hashtable->nbuckets;
 
+	/* The Bloom filter is only consulted while joining the first batch. */
+	ExecHashTableFreeBloomFilter(hashtable);
+
 	/*
 	 * Release all the hash buckets and tuples acquired in the prior pass, and
 	 * reinitialize the context for a new pass.
@@ -2153,6 +2286,7 @@ ExecHashTableReset(HashJoinTable hashtable)
 	/* Reallocate and reinitialize the hash bucket headers. */
 	hashtable->buckets.unshared = (HashJoinTuple *)
 		palloc0(nbuckets * sizeof(HashJoinTuple));
+	hashtable->bucketTags = (uint8 *) palloc0(nbuckets * sizeof(uint8));
 
 	hashtable->spaceUsed = 0;
 
@@ -2316,9 +2450,11 @@ ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node, int mcvsToUse)
 			uint32		hashvalue;
 			int			bucket;
 
-			hashvalue = DatumGetUInt32(FunctionCall1Coll(&hashfunctions[0],
-														 hashtable->collations[0],
-														 sslot.values[i]));
+			/* must hash the same way as ExecHashGetHashValue */
+			hashvalue = ExecHashKeyValue(&hashfunctions[0],
+										 hashtable->collations[0],
+										 hashtable->hashBytes[0],
+										 sslot.values[i]);
 
 			/*
 			 * While we have not hit a hole in the hashtable and have not hit
@@ -2510,8 +2646,7 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 			memcpy(copyTuple, hashTuple, tupleSize);
 			pfree(hashTuple);
 
-			copyTuple->next.unshared = hashtable->buckets.unshared[bucketno];
-			hashtable->buckets.unshared[bucketno] = copyTuple;
+			ExecHashPushTuple(hashtable, bucketno, copyTuple);
 
 			/* We have reduced skew space, but overall space doesn't change */
 			hashtable->spaceUsedSkew -= tupleSize;
@@ -2685,7 +2820,9 @@ ExecHashRetrieveInstrumentation(HashState *node)
  * the largest spacePeak regardless of whether it happened in the same
  * instance as the largest nbuckets or nbatch.  All the instances should have
  * the same nbuckets_original and nbatch_original; but there's little value
- * in depending on that here, so handle them the same way.
+ * in depending on that here, so handle them the same way.  The Bloom filter
+ * counters are different: each instance checks its own outer tuples, so we
+ * add those up.
  */
 void
 ExecHashAccumInstrumentation(HashInstrumentation *instrument,
@@ -2701,6 +2838,26 @@ ExecHashAccumInstrumentation(HashInstrumentation *instrument,
 									  hashtable->nbatch_original);
 	instrument->space_peak = Max(instrument->space_peak,
 								 hashtable->spacePeak);
+	if (hashtable->parallel_state ?
+		hashtable->parallel_state->growth == PHJ_GROWTH_DISABLED :
+		!hashtable->growEnabled)
+		instrument->growth_disabled = true;
+	instrument->bloom_size = Max(instrument->bloom_size,
+								 hashtable->bloomSize);
+	instrument->bloom_tested += hashtable->bloomTested;
+	instrument->bloom_rejected += hashtable->bloomRejected;
+}
+
+/*
+ * Insert a tuple at the front of a bucket's chain in an unshared hash table,
+ * and record its tag.
+ */
+static inline void
+ExecHashPushTuple(HashJoinTable hashtable, int bucketno, HashJoinTuple tuple)
+{
+	tuple->next.unshared = hashtable->buckets.unshared[bucketno];
+	hashtable->buckets.unshared[bucketno] = tuple;
+	hashtable->bucketTags[bucketno] |= HJ_BUCKET_TAG(tuple->hashvalue);
 }
 
 /*
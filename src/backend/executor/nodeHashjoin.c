@@ -282,6 +282,17 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 												HJ_FILL_INNER(node));
 				node->hj_HashTable = hashtable;
 
+				/*
+				 * If we expect to spill, and outer tuples without a match
+				 * aren't needed, build a Bloom filter over the inner hash
+				 * values, so that such outer tuples can be discarded rather
+				 * than written to batch files.
+				 */
+				if (!parallel && hashtable->nbatch > 1 &&
+					!HJ_FILL_OUTER(node) && node->js.jointype != JOIN_ANTI)
+					ExecHashTableCreateBloomFilter(hashtable,
+												   outerPlan(hashNode->ps.plan)->plan_rows);
+
 				/*
 				 * Execute the Hash node, to build the hash table.  If using
 				 * Parallel Hash, then we'll try to help hashing unless we
@@ -383,6 +394,19 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 																 hashvalue);
 				node->hj_CurTuple = NULL;
 
+				/*
+				 * If the Bloom filter says that no inner tuple has this hash
+				 * value, there is nothing to join with in any batch.  Only
+				 * outer tuples read during the first pass need checking,
+				 * since those have been filtered before being saved.
+				 */
+				if (hashtable->curbatch == 0 &&
+					!ExecHashBloomMayMatch(hashtable, hashvalue))
+				{
+					/* Loop around, staying in HJ_NEED_NEW_OUTER state */
+					continue;
+				}
+
 				/*
 				 * The tuple might not belong to the current batch (where
 				 * "current batch" includes the skew buckets if any).
@@ -1223,7 +1247,7 @@ ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
 	if (file == NULL)
 	{
 		/* First write to this batch file, so open it. */
-		file = BufFileCreateTemp(false);
+		file = BufFileCreateCompressTemp(false);
 		*fileptr = file;
 	}
 
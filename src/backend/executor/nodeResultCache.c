@@ -172,8 +172,9 @@ ResultCacheHash_hash(struct resultcache_hash *tb, const ResultCacheKey *key)
 		{
 			uint32		hkey;
 
-			hkey = DatumGetUInt32(FunctionCall1Coll(&hashfunctions[i],
-													collations[i], pslot->tts_values[i]));
+			hkey = ExecHashKeyValue(&hashfunctions[i], collations[i],
+									rcstate->hash_bytes[i],
+									pslot->tts_values[i]);
 			hashkey ^= hkey;
 		}
 	}
@@ -912,6 +913,7 @@ ExecInitResultCache(ResultCache *node, EState *estate, int eflags)
 	rcstate->collations = node->collations; /* Just point directly to the plan
 											 * data */
 	rcstate->hashfunctions = (FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
+	rcstate->hash_bytes = (bool *) palloc(nkeys * sizeof(bool));
 
 	eqfuncoids = palloc(nkeys * sizeof(Oid));
 
@@ -927,6 +929,7 @@ ExecInitResultCache(ResultCache *node, EState *estate, int eflags)
 				 hashop);
 
 		fmgr_info(left_hashfn, &rcstate->hashfunctions[i]);
+		rcstate->hash_bytes[i] = ExecHashKeyBytesOK(node->collations[i]);
 
 		rcstate->param_exprs[i] = ExecInitExpr(param_expr, (PlanState *) rcstate);
 		eqfuncoids[i] = get_opcode(hashop);
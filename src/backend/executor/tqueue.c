@@ -58,9 +58,13 @@ tqueueReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
 	shm_mq_result result;
 	bool		should_free;
 
-	/* Send the tuple itself. */
+	/*
+	 * Send the tuple itself.  We don't force a flush, so the receiver is only
+	 * woken up once a good batch of tuples has accumulated in the queue, or
+	 * the queue fills up, or we detach at the end of the scan.
+	 */
 	tuple = ExecFetchSlotMinimalTuple(slot, &should_free);
-	result = shm_mq_send(tqueue->queue, tuple->t_len, tuple, false);
+	result = shm_mq_send(tqueue->queue, tuple->t_len, tuple, false, false);
 
 	if (should_free)
 		pfree(tuple);
@@ -49,6 +49,9 @@ typedef struct CompiledExprState
 {
 	LLVMJitContext *context;
 	const char *funcname;
+	bool		checked;		/* has CheckExprStillValid been done? */
+	int			interp_calls_left;	/* evaluations left to the interpreter */
+	ExprStateEvalFunc interp_func;	/* interpreter entry point, if any */
 } CompiledExprState;
 
 
@@ -2369,6 +2372,21 @@ llvm_compile_expr(ExprState *state)
 		cstate->context = context;
 		cstate->funcname = funcname;
 
+		/*
+		 * Emitting the machine code is usually the expensive part, and it is
+		 * wasted if the expression ends up being evaluated only a few times,
+		 * e.g. because the planner overestimated the row count.  If so
+		 * configured, set up the interpreter as well and let it handle the
+		 * first evaluations; the module is emitted only once an expression
+		 * has proven to be worth it.
+		 */
+		if (jit_interpret_calls > 0)
+		{
+			ExecReadyInterpretedExpr(state);
+			cstate->interp_func = (ExprStateEvalFunc) state->evalfunc_private;
+			cstate->interp_calls_left = jit_interpret_calls;
+		}
+
 		state->evalfunc = ExecRunCompiledExpr;
 		state->evalfunc_private = cstate;
 	}
@@ -2385,10 +2403,12 @@ llvm_compile_expr(ExprState *state)
 /*
  * Run compiled expression.
  *
- * This will only be called the first time a JITed expression is called. We
- * first make sure the expression is still up2date, and then get a pointer to
- * the emitted function. The latter can be the first thing that triggers
- * optimizing and emitting all the generated functions.
+ * This will only be called the first time a JITed expression is called,
+ * or, with jit_interpret_calls set, for the evaluations that are left to the
+ * interpreter and the one after. We first make sure the expression is still
+ * up2date, and then get a pointer to the emitted function. The latter can be
+ * the first thing that triggers optimizing and emitting all the generated
+ * functions.
  */
 static Datum
 ExecRunCompiledExpr(ExprState *state, ExprContext *econtext, bool *isNull)
@@ -2396,7 +2416,17 @@ ExecRunCompiledExpr(ExprState *state, ExprContext *econtext, bool *isNull)
 	CompiledExprState *cstate = state->evalfunc_private;
 	ExprStateEvalFunc func;
 
-	CheckExprStillValid(state, econtext);
+	if (!cstate->checked)
+	{
+		CheckExprStillValid(state, econtext);
+		cstate->checked = true;
+	}
+
+	if (cstate->interp_calls_left > 0)
+	{
+		cstate->interp_calls_left--;
+		return cstate->interp_func(state, econtext, isNull);
+	}
 
 	llvm_enter_fatal_on_oom();
 	func = (ExprStateEvalFunc) llvm_get_function(cstate->context,
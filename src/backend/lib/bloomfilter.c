@@ -172,6 +172,16 @@ bloom_lacks_element(bloom_filter *filter, unsigned char *elem, size_t len)
 	return false;
 }
 
+/*
+ * How much memory does the filter use, in bytes?
+ */
+Size
+bloom_size(bloom_filter *filter)
+{
+	return offsetof(bloom_filter, bitset) +
+		sizeof(unsigned char) * (filter->m / BITS_PER_BYTE);
+}
+
 /*
  * What proportion of bits are currently set?
  *
@@ -9,16 +9,24 @@
  * supported: the hash table never becomes smaller.
  *
  * To deal with concurrency, it has a fixed size set of partitions, each of
- * which is independently locked.  Each bucket maps to a partition; so insert,
- * find and iterate operations normally only acquire one lock.  Therefore,
- * good concurrency is achieved whenever such operations don't collide at the
- * lock partition level.  However, when a resize operation begins, all
- * partition locks must be acquired simultaneously for a brief period.  This
- * is only expected to happen a small number of times until a stable size is
- * found, since growth is geometric.
+ * which is independently locked.  The highest order bits of the hash choose
+ * the partition, and each partition has its own array of buckets, chosen by
+ * the next bits of the hash; so insert, find and iterate operations normally
+ * only acquire one lock.  Therefore, good concurrency is achieved whenever
+ * such operations don't collide at the lock partition level.
  *
- * Future versions may support iterators and incremental resizing; for now
- * the implementation is minimalist.
+ * Resizing is incremental: when a partition's load factor gets too high, the
+ * backend inserting into it doubles that partition's bucket array while
+ * holding only that partition's lock, which it already has.  Other
+ * partitions are unaffected, so growing the table never stops the world, and
+ * the cost of rehashing is spread over many insertions.
+ *
+ * Lookups still take the partition lock in shared mode.  Readers can't skip
+ * it, because a concurrent delete frees the item's memory back to the area
+ * immediately, and there is no way to know when all readers have moved on.
+ *
+ * Future versions may support iterators; for now the implementation is
+ * minimalist.
  *
  * Portions Copyright (c) 1996-2021, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -66,8 +74,8 @@ struct dshash_table_item
 
 /*
  * Tracking information for each lock partition.  Initially, each partition
- * corresponds to one bucket, but each time the hash table grows, the buckets
- * covered by each partition split so the number of buckets covered doubles.
+ * has one bucket, located in a shared initial array, but each time the
+ * partition grows, it gets its own bucket array of twice the previous size.
  *
  * We might want to add padding here so that each partition is on a different
  * cache line, but doing so would bloat this structure considerably.
@@ -76,6 +84,13 @@ typedef struct dshash_partition
 {
 	LWLock		lock;			/* Protects all buckets in this partition. */
 	size_t		count;			/* # of items in this partition's buckets */
+
+	/*
+	 * The following members are written to only when this partition's lock
+	 * is held exclusively.
+	 */
+	size_t		size_log2;		/* log2(number of buckets in partition) */
+	dsa_pointer buckets;		/* current bucket array */
 } dshash_partition;
 
 /*
@@ -89,14 +104,8 @@ typedef struct dshash_table_control
 	dshash_partition partitions[DSHASH_NUM_PARTITIONS];
 	int			lwlock_tranche_id;
 
-	/*
-	 * The following members are written to only when ALL partitions locks are
-	 * held.  They can be read when any one partition lock is held.
-	 */
-
-	/* Number of buckets expressed as power of 2 (8 = 256 buckets). */
-	size_t		size_log2;		/* log2(number of buckets) */
-	dsa_pointer buckets;		/* current bucket array */
+	/* One bucket per partition, used until each partition first grows. */
+	dsa_pointer initial_buckets;
 } dshash_table_control;
 
 /*
@@ -108,8 +117,9 @@ struct dshash_table
 	dshash_parameters params;	/* Parameters. */
 	void	   *arg;			/* User-supplied data pointer. */
 	dshash_table_control *control;	/* Control object in DSM. */
-	dsa_pointer *buckets;		/* Current bucket pointers in DSM. */
-	size_t		size_log2;		/* log2(number of buckets) */
+	/* Current bucket pointers in DSM, and size, for each partition. */
+	dsa_pointer *buckets[DSHASH_NUM_PARTITIONS];
+	size_t		size_log2[DSHASH_NUM_PARTITIONS];
 	bool		find_locked;	/* Is any partition lock held by 'find'? */
 	bool		find_exclusively_locked;	/* ... exclusively? */
 };
@@ -123,46 +133,46 @@ struct dshash_table
 	((dshash_table_item *)((char *)(entry) -							\
 							 MAXALIGN(sizeof(dshash_table_item))))
 
-/* How many resize operations (bucket splits) have there been? */
-#define NUM_SPLITS(size_log2)					\
-	(size_log2 - DSHASH_NUM_PARTITIONS_LOG2)
-
-/* How many buckets are there in each partition at a given size? */
+/* How many buckets are there in a partition of a given size? */
 #define BUCKETS_PER_PARTITION(size_log2)		\
-	(((size_t) 1) << NUM_SPLITS(size_log2))
+	(((size_t) 1) << (size_log2))
+
+/* A partition can't use more hash bits than are left after choosing it. */
+#define MAX_PARTITION_SIZE_LOG2					\
+	((sizeof(dshash_hash) * CHAR_BIT) - DSHASH_NUM_PARTITIONS_LOG2)
 
 /* Max entries before we need to grow.  Half + quarter = 75% load factor. */
-#define MAX_COUNT_PER_PARTITION(hash_table)				\
-	(BUCKETS_PER_PARTITION(hash_table->size_log2) / 2 + \
-	 BUCKETS_PER_PARTITION(hash_table->size_log2) / 4)
+#define MAX_COUNT_PER_PARTITION(partition)				\
+	(BUCKETS_PER_PARTITION((partition)->size_log2) / 2 + \
+	 BUCKETS_PER_PARTITION((partition)->size_log2) / 4)
 
 /* Choose partition based on the highest order bits of the hash. */
 #define PARTITION_FOR_HASH(hash)										\
 	(hash >> ((sizeof(dshash_hash) * CHAR_BIT) - DSHASH_NUM_PARTITIONS_LOG2))
 
 /*
- * Find the bucket index for a given hash and table size.  Each time the table
- * doubles in size, the appropriate bucket for a given hash value doubles and
- * possibly adds one, depending on the newly revealed bit, so that all buckets
- * are split.
+ * Find the bucket index within a partition for a given hash and partition
+ * size, using the bits that follow the partition bits.  Each time the
+ * partition doubles in size, the appropriate bucket for a given hash value
+ * doubles and possibly adds one, depending on the newly revealed bit, so that
+ * all buckets are split.
  */
-#define BUCKET_INDEX_FOR_HASH_AND_SIZE(hash, size_log2)		\
-	(hash >> ((sizeof(dshash_hash) * CHAR_BIT) - (size_log2)))
-
-/* The index of the first bucket in a given partition. */
-#define BUCKET_INDEX_FOR_PARTITION(partition, size_log2)	\
-	((partition) << NUM_SPLITS(size_log2))
+#define BUCKET_INDEX_FOR_HASH_AND_SIZE(hash, size_log2)					\
+	((size_log2) == 0 ? 0 :												\
+	 ((dshash_hash) ((hash) << DSHASH_NUM_PARTITIONS_LOG2)) >>			\
+	 ((sizeof(dshash_hash) * CHAR_BIT) - (size_log2)))
 
 /* The head of the active bucket for a given hash value (lvalue). */
-#define BUCKET_FOR_HASH(hash_table, hash)								\
-	(hash_table->buckets[												\
+#define BUCKET_FOR_HASH(hash_table, partition_index, hash)				\
+	(hash_table->buckets[partition_index][								\
 		BUCKET_INDEX_FOR_HASH_AND_SIZE(hash,							\
-									   hash_table->size_log2)])
+			hash_table->control->partitions[partition_index].size_log2)])
 
 static void delete_item(dshash_table *hash_table,
 						dshash_table_item *item);
-static void resize(dshash_table *hash_table, size_t new_size);
-static inline void ensure_valid_bucket_pointers(dshash_table *hash_table);
+static void resize(dshash_table *hash_table, size_t partition_index);
+static inline void ensure_valid_bucket_pointers(dshash_table *hash_table,
+												size_t partition_index);
 static inline dshash_table_item *find_in_bucket(dshash_table *hash_table,
 												const void *key,
 												dsa_pointer item_pointer);
@@ -213,32 +223,18 @@ dshash_create(dsa_area *area, const dshash_parameters *params, void *arg)
 	hash_table->control->magic = DSHASH_MAGIC;
 	hash_table->control->lwlock_tranche_id = params->tranche_id;
 
-	/* Set up the array of lock partitions. */
-	{
-		dshash_partition *partitions = hash_table->control->partitions;
-		int			tranche_id = hash_table->control->lwlock_tranche_id;
-		int			i;
-
-		for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
-		{
-			LWLockInitialize(&partitions[i].lock, tranche_id);
-			partitions[i].count = 0;
-		}
-	}
-
 	hash_table->find_locked = false;
 	hash_table->find_exclusively_locked = false;
 
 	/*
-	 * Set up the initial array of buckets.  Our initial size is the same as
-	 * the number of partitions.
+	 * Set up the initial array of buckets.  Our initial size is one bucket
+	 * per partition, all in a single allocation.
 	 */
-	hash_table->control->size_log2 = DSHASH_NUM_PARTITIONS_LOG2;
-	hash_table->control->buckets =
+	hash_table->control->initial_buckets =
 		dsa_allocate_extended(area,
 							  sizeof(dsa_pointer) * DSHASH_NUM_PARTITIONS,
 							  DSA_ALLOC_NO_OOM | DSA_ALLOC_ZERO);
-	if (!DsaPointerIsValid(hash_table->control->buckets))
+	if (!DsaPointerIsValid(hash_table->control->initial_buckets))
 	{
 		dsa_free(area, control);
 		ereport(ERROR,
@@ -247,9 +243,26 @@ dshash_create(dsa_area *area, const dshash_parameters *params, void *arg)
 				 errdetail("Failed on DSA request of size %zu.",
 						   sizeof(dsa_pointer) * DSHASH_NUM_PARTITIONS)));
 	}
-	hash_table->buckets = dsa_get_address(area,
-										  hash_table->control->buckets);
-	hash_table->size_log2 = hash_table->control->size_log2;
+
+	/* Set up the array of lock partitions. */
+	{
+		dshash_partition *partitions = hash_table->control->partitions;
+		int			tranche_id = hash_table->control->lwlock_tranche_id;
+		int			i;
+
+		for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
+		{
+			LWLockInitialize(&partitions[i].lock, tranche_id);
+			partitions[i].count = 0;
+			partitions[i].size_log2 = 0;
+			partitions[i].buckets = hash_table->control->initial_buckets +
+				i * sizeof(dsa_pointer);
+
+			hash_table->size_log2[i] = 0;
+			hash_table->buckets[i] = dsa_get_address(area,
+													 partitions[i].buckets);
+		}
+	}
 
 	return hash_table;
 }
@@ -283,11 +296,15 @@ dshash_attach(dsa_area *area, const dshash_parameters *params,
 
 	/*
 	 * These will later be set to the correct values by
-	 * ensure_valid_bucket_pointers(), at which time we'll be holding a
-	 * partition lock for interlocking against concurrent resizing.
+	 * ensure_valid_bucket_pointers(), at which time we'll be holding the
+	 * partition lock for interlocking against concurrent resizing.  A
+	 * partition's size only ever grows, so an impossible size never matches.
 	 */
-	hash_table->buckets = NULL;
-	hash_table->size_log2 = 0;
+	for (int i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
+	{
+		hash_table->buckets[i] = NULL;
+		hash_table->size_log2[i] = MAX_PARTITION_SIZE_LOG2 + 1;
+	}
 
 	return hash_table;
 }
@@ -319,26 +336,36 @@ dshash_destroy(dshash_table *hash_table)
 {
 	size_t		size;
 	size_t		i;
+	size_t		j;
 
 	Assert(hash_table->control->magic == DSHASH_MAGIC);
-	ensure_valid_bucket_pointers(hash_table);
 
-	/* Free all the entries. */
-	size = ((size_t) 1) << hash_table->size_log2;
-	for (i = 0; i < size; ++i)
+	/* Free all the entries, and the partitions' own bucket arrays. */
+	for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
 	{
-		dsa_pointer item_pointer = hash_table->buckets[i];
+		dshash_partition *partition = &hash_table->control->partitions[i];
 
-		while (DsaPointerIsValid(item_pointer))
+		ensure_valid_bucket_pointers(hash_table, i);
+
+		size = BUCKETS_PER_PARTITION(partition->size_log2);
+		for (j = 0; j < size; ++j)
 		{
-			dshash_table_item *item;
-			dsa_pointer next_item_pointer;
+			dsa_pointer item_pointer = hash_table->buckets[i][j];
 
-			item = dsa_get_address(hash_table->area, item_pointer);
-			next_item_pointer = item->next;
-			dsa_free(hash_table->area, item_pointer);
-			item_pointer = next_item_pointer;
+			while (DsaPointerIsValid(item_pointer))
+			{
+				dshash_table_item *item;
+				dsa_pointer next_item_pointer;
+
+				item = dsa_get_address(hash_table->area, item_pointer);
+				next_item_pointer = item->next;
+				dsa_free(hash_table->area, item_pointer);
+				item_pointer = next_item_pointer;
+			}
 		}
+
+		if (partition->size_log2 > 0)
+			dsa_free(hash_table->area, partition->buckets);
 	}
 
 	/*
@@ -347,8 +374,8 @@ dshash_destroy(dshash_table *hash_table)
 	 */
 	hash_table->control->magic = 0;
 
-	/* Free the active table and control object. */
-	dsa_free(hash_table->area, hash_table->control->buckets);
+	/* Free the initial buckets and control object. */
+	dsa_free(hash_table->area, hash_table->control->initial_buckets);
 	dsa_free(hash_table->area, hash_table->control->handle);
 
 	pfree(hash_table);
@@ -396,10 +423,11 @@ dshash_find(dshash_table *hash_table, const void *key, bool exclusive)
 
 	LWLockAcquire(PARTITION_LOCK(hash_table, partition),
 				  exclusive ? LW_EXCLUSIVE : LW_SHARED);
-	ensure_valid_bucket_pointers(hash_table);
+	ensure_valid_bucket_pointers(hash_table, partition);
 
 	/* Search the active bucket. */
-	item = find_in_bucket(hash_table, key, BUCKET_FOR_HASH(hash_table, hash));
+	item = find_in_bucket(hash_table, key,
+						  BUCKET_FOR_HASH(hash_table, partition, hash));
 
 	if (!item)
 	{
@@ -443,13 +471,13 @@ dshash_find_or_insert(dshash_table *hash_table,
 	Assert(hash_table->control->magic == DSHASH_MAGIC);
 	Assert(!hash_table->find_locked);
 
-restart:
 	LWLockAcquire(PARTITION_LOCK(hash_table, partition_index),
 				  LW_EXCLUSIVE);
-	ensure_valid_bucket_pointers(hash_table);
+	ensure_valid_bucket_pointers(hash_table, partition_index);
 
 	/* Search the active bucket. */
-	item = find_in_bucket(hash_table, key, BUCKET_FOR_HASH(hash_table, hash));
+	item = find_in_bucket(hash_table, key,
+						  BUCKET_FOR_HASH(hash_table, partition_index, hash));
 
 	if (item)
 		*found = true;
@@ -457,29 +485,19 @@ restart:
 	{
 		*found = false;
 
-		/* Check if we are getting too full. */
-		if (partition->count > MAX_COUNT_PER_PARTITION(hash_table))
-		{
-			/*
-			 * The load factor (= keys / buckets) for all buckets protected by
-			 * this partition is > 0.75.  Presumably the same applies
-			 * generally across the whole hash table (though we don't attempt
-			 * to track that directly to avoid contention on some kind of
-			 * central counter; we just assume that this partition is
-			 * representative).  This is a good time to resize.
-			 *
-			 * Give up our existing lock first, because resizing needs to
-			 * reacquire all the locks in the right order to avoid deadlocks.
-			 */
-			LWLockRelease(PARTITION_LOCK(hash_table, partition_index));
-			resize(hash_table, hash_table->size_log2 + 1);
-
-			goto restart;
-		}
+		/*
+		 * Check if we are getting too full.  If the load factor (= keys /
+		 * buckets) for the buckets of this partition is > 0.75, this is a
+		 * good time to grow it, which needs no lock beyond the one we hold.
+		 */
+		if (partition->count > MAX_COUNT_PER_PARTITION(partition) &&
+			partition->size_log2 < MAX_PARTITION_SIZE_LOG2)
+			resize(hash_table, partition_index);
 
 		/* Finally we can try to insert the new item. */
 		item = insert_into_bucket(hash_table, key,
-								  &BUCKET_FOR_HASH(hash_table, hash));
+								  &BUCKET_FOR_HASH(hash_table, partition_index,
+												   hash));
 		item->hash = hash;
 		/* Adjust per-lock-partition counter for load factor knowledge. */
 		++partition->count;
@@ -512,10 +530,10 @@ dshash_delete_key(dshash_table *hash_table, const void *key)
 	partition = PARTITION_FOR_HASH(hash);
 
 	LWLockAcquire(PARTITION_LOCK(hash_table, partition), LW_EXCLUSIVE);
-	ensure_valid_bucket_pointers(hash_table);
+	ensure_valid_bucket_pointers(hash_table, partition);
 
 	if (delete_key_from_bucket(hash_table, key,
-							   &BUCKET_FOR_HASH(hash_table, hash)))
+							   &BUCKET_FOR_HASH(hash_table, partition, hash)))
 	{
 		Assert(hash_table->control->partitions[partition].count > 0);
 		found = true;
@@ -611,24 +629,22 @@ dshash_dump(dshash_table *hash_table)
 		LWLockAcquire(PARTITION_LOCK(hash_table, i), LW_SHARED);
 	}
 
-	ensure_valid_bucket_pointers(hash_table);
-
-	fprintf(stderr,
-			"hash table size = %zu\n", (size_t) 1 << hash_table->size_log2);
 	for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
 	{
 		dshash_partition *partition = &hash_table->control->partitions[i];
-		size_t		begin = BUCKET_INDEX_FOR_PARTITION(i, hash_table->size_log2);
-		size_t		end = BUCKET_INDEX_FOR_PARTITION(i + 1, hash_table->size_log2);
+		size_t		size = BUCKETS_PER_PARTITION(partition->size_log2);
+
+		ensure_valid_bucket_pointers(hash_table, i);
 
 		fprintf(stderr, "  partition %zu\n", i);
 		fprintf(stderr,
-				"    active buckets (key count = %zu)\n", partition->count);
+				"    active buckets (bucket count = %zu, key count = %zu)\n",
+				size, partition->count);
 
-		for (j = begin; j < end; ++j)
+		for (j = 0; j < size; ++j)
 		{
 			size_t		count = 0;
-			dsa_pointer bucket = hash_table->buckets[j];
+			dsa_pointer bucket = hash_table->buckets[i][j];
 
 			while (DsaPointerIsValid(bucket))
 			{
@@ -659,7 +675,7 @@ delete_item(dshash_table *hash_table, dshash_table_item *item)
 	Assert(LWLockHeldByMe(PARTITION_LOCK(hash_table, partition)));
 
 	if (delete_item_from_bucket(hash_table, item,
-								&BUCKET_FOR_HASH(hash_table, hash)))
+								&BUCKET_FOR_HASH(hash_table, partition, hash)))
 	{
 		Assert(hash_table->control->partitions[partition].count > 0);
 		--hash_table->control->partitions[partition].count;
@@ -671,56 +687,41 @@ delete_item(dshash_table *hash_table, dshash_table_item *item)
 }
 
 /*
- * Grow the hash table if necessary to the requested number of buckets.  The
- * requested size must be double some previously observed size.
+ * Double the number of buckets in one partition.
  *
- * Must be called without any partition lock held.
+ * Must be called with that partition's lock held exclusively.  No other lock
+ * is needed, since no other partition's buckets are affected.
  */
 static void
-resize(dshash_table *hash_table, size_t new_size_log2)
+resize(dshash_table *hash_table, size_t partition_index)
 {
+	dshash_partition *partition = &hash_table->control->partitions[partition_index];
 	dsa_pointer old_buckets;
 	dsa_pointer new_buckets_shared;
 	dsa_pointer *new_buckets;
 	size_t		size;
-	size_t		new_size = ((size_t) 1) << new_size_log2;
+	size_t		new_size_log2 = partition->size_log2 + 1;
 	size_t		i;
 
-	/*
-	 * Acquire the locks for all lock partitions.  This is expensive, but we
-	 * shouldn't have to do it many times.
-	 */
-	for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
-	{
-		Assert(!LWLockHeldByMe(PARTITION_LOCK(hash_table, i)));
-
-		LWLockAcquire(PARTITION_LOCK(hash_table, i), LW_EXCLUSIVE);
-		if (i == 0 && hash_table->control->size_log2 >= new_size_log2)
-		{
-			/*
-			 * Another backend has already increased the size; we can avoid
-			 * obtaining all the locks and return early.
-			 */
-			LWLockRelease(PARTITION_LOCK(hash_table, 0));
-			return;
-		}
-	}
-
-	Assert(new_size_log2 == hash_table->control->size_log2 + 1);
+	Assert(LWLockHeldByMeInMode(PARTITION_LOCK(hash_table, partition_index),
+								LW_EXCLUSIVE));
+	Assert(new_size_log2 <= MAX_PARTITION_SIZE_LOG2);
 
-	/* Allocate the space for the new table. */
+	/* Allocate the space for the new bucket array. */
 	new_buckets_shared = dsa_allocate0(hash_table->area,
-									   sizeof(dsa_pointer) * new_size);
+									   sizeof(dsa_pointer) *
+									   BUCKETS_PER_PARTITION(new_size_log2));
 	new_buckets = dsa_get_address(hash_table->area, new_buckets_shared);
 
 	/*
 	 * We've allocated the new bucket array; all that remains to do now is to
-	 * reinsert all items, which amounts to adjusting all the pointers.
+	 * reinsert this partition's items, which amounts to adjusting all the
+	 * pointers.
 	 */
-	size = ((size_t) 1) << hash_table->control->size_log2;
+	size = BUCKETS_PER_PARTITION(partition->size_log2);
 	for (i = 0; i < size; ++i)
 	{
-		dsa_pointer item_pointer = hash_table->buckets[i];
+		dsa_pointer item_pointer = hash_table->buckets[partition_index][i];
 
 		while (DsaPointerIsValid(item_pointer))
 		{
@@ -736,31 +737,34 @@ resize(dshash_table *hash_table, size_t new_size_log2)
 		}
 	}
 
-	/* Swap the hash table into place and free the old one. */
-	old_buckets = hash_table->control->buckets;
-	hash_table->control->buckets = new_buckets_shared;
-	hash_table->control->size_log2 = new_size_log2;
-	hash_table->buckets = new_buckets;
-	dsa_free(hash_table->area, old_buckets);
-
-	/* Release all the locks. */
-	for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
-		LWLockRelease(PARTITION_LOCK(hash_table, i));
+	/*
+	 * Swap the new array into place and free the old one, unless it was this
+	 * partition's slot in the initial array.
+	 */
+	old_buckets = partition->buckets;
+	partition->buckets = new_buckets_shared;
+	if (partition->size_log2 > 0)
+		dsa_free(hash_table->area, old_buckets);
+	partition->size_log2 = new_size_log2;
+	hash_table->buckets[partition_index] = new_buckets;
+	hash_table->size_log2[partition_index] = new_size_log2;
 }
 
 /*
- * Make sure that our backend-local bucket pointers are up to date.  The
- * caller must have locked one lock partition, which prevents resize() from
- * running concurrently.
+ * Make sure that our backend-local bucket pointers for a partition are up to
+ * date.  The caller must have locked that partition, which prevents resize()
+ * from running on it concurrently.
  */
 static inline void
-ensure_valid_bucket_pointers(dshash_table *hash_table)
+ensure_valid_bucket_pointers(dshash_table *hash_table, size_t partition_index)
 {
-	if (hash_table->size_log2 != hash_table->control->size_log2)
+	dshash_partition *partition = &hash_table->control->partitions[partition_index];
+
+	if (hash_table->size_log2[partition_index] != partition->size_log2)
 	{
-		hash_table->buckets = dsa_get_address(hash_table->area,
-											  hash_table->control->buckets);
-		hash_table->size_log2 = hash_table->control->size_log2;
+		hash_table->buckets[partition_index] =
+			dsa_get_address(hash_table->area, partition->buckets);
+		hash_table->size_log2[partition_index] = partition->size_log2;
 	}
 }
 
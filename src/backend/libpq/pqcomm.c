@@ -148,6 +148,7 @@ static int	socket_putmessage(char msgtype, const char *s, size_t len);
 static void socket_putmessage_noblock(char msgtype, const char *s, size_t len);
 static int	internal_putbytes(const char *s, size_t len);
 static int	internal_flush(void);
+static int	internal_flush_buffer(const char *buf, int *start, int *end);
 
 #ifdef HAVE_UNIX_SOCKETS
 static int	Lock_AF_UNIX(const char *unixSocketDir, const char *unixSocketPath);
@@ -1192,6 +1193,32 @@ pq_is_reading_msg(void)
 	return PqCommReadingMsg;
 }
 
+/* --------------------------------
+ *		pq_buffer_has_complete_msg - is a whole message waiting to be read?
+ *
+ * Returns true if the receive buffer holds at least one complete message,
+ * so that reading it won't have to wait for the client.  Data that the
+ * SSL or GSSAPI layer has buffered is not considered.
+ * --------------------------------
+ */
+bool
+pq_buffer_has_complete_msg(void)
+{
+	int			avail = PqRecvLength - PqRecvPointer;
+	uint32		len;
+
+	Assert(!PqCommReadingMsg);
+
+	/* need the type byte and the length word at least */
+	if (avail < 1 + 4)
+		return false;
+
+	memcpy(&len, PqRecvBuffer + PqRecvPointer + 1, 4);
+	len = pg_ntoh32(len);
+
+	return (uint32) (avail - 1) >= len;
+}
+
 /* --------------------------------
  *		pq_getmessage	- get a message with length word from connection
  *
@@ -1297,11 +1324,32 @@ internal_putbytes(const char *s, size_t len)
 			if (internal_flush())
 				return EOF;
 		}
-		amount = PqSendBufferSize - PqSendPointer;
-		if (amount > len)
-			amount = len;
-		memcpy(PqSendBuffer + PqSendPointer, s, amount);
-		PqSendPointer += amount;
+
+		/*
+		 * If the buffer is empty and there's at least a bufferful of data
+		 * left, send it straight from the caller's memory.  Large DataRow
+		 * messages then don't have to be copied through the buffer 8kB at a
+		 * time.
+		 */
+		if (PqSendStart == PqSendPointer && len >= PqSendBufferSize)
+		{
+			int			start = 0;
+			int			end;
+
+			amount = Min(len, (size_t) PG_INT32_MAX);
+			end = (int) amount;
+			socket_set_nonblocking(false);
+			if (internal_flush_buffer(s, &start, &end))
+				return EOF;
+		}
+		else
+		{
+			amount = PqSendBufferSize - PqSendPointer;
+			if (amount > len)
+				amount = len;
+			memcpy(PqSendBuffer + PqSendPointer, s, amount);
+			PqSendPointer += amount;
+		}
 		s += amount;
 		len -= amount;
 	}
@@ -1338,17 +1386,31 @@ socket_flush(void)
  */
 static int
 internal_flush(void)
+{
+	return internal_flush_buffer(PqSendBuffer, &PqSendStart, &PqSendPointer);
+}
+
+/* --------------------------------
+ *		internal_flush_buffer - flush the given buffer content
+ *
+ * Sends buf[*start .. *end), advancing *start as data goes out.  Once it has
+ * all been sent, or if sending fails, *start and *end are both reset to zero.
+ * Return value is as for internal_flush.
+ * --------------------------------
+ */
+static int
+internal_flush_buffer(const char *buf, int *start, int *end)
 {
 	static int	last_reported_send_errno = 0;
 
-	char	   *bufptr = PqSendBuffer + PqSendStart;
-	char	   *bufend = PqSendBuffer + PqSendPointer;
+	const char *bufptr = buf + *start;
+	const char *bufend = buf + *end;
 
 	while (bufptr < bufend)
 	{
 		int			r;
 
-		r = secure_write(MyProcPort, bufptr, bufend - bufptr);
+		r = secure_write(MyProcPort, (char *) bufptr, bufend - bufptr);
 
 		if (r <= 0)
 		{
@@ -1388,7 +1450,7 @@ internal_flush(void)
 			 * flag that'll cause the next CHECK_FOR_INTERRUPTS to terminate
 			 * the connection.
 			 */
-			PqSendStart = PqSendPointer = 0;
+			*start = *end = 0;
 			ClientConnectionLost = 1;
 			InterruptPending = 1;
 			return EOF;
@@ -1396,10 +1458,10 @@ internal_flush(void)
 
 		last_reported_send_errno = 0;	/* reset after any successful send */
 		bufptr += r;
-		PqSendStart += r;
+		*start += r;
 	}
 
-	PqSendStart = PqSendPointer = 0;
+	*start = *end = 0;
 	return 0;
 }
 
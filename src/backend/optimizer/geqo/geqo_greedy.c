@@ -0,0 +1,281 @@
+/*------------------------------------------------------------------------
+ *
+ * geqo_greedy.c
+ *	  greedy join order search, an alternative to the genetic algorithm
+ *
+ * Rather than evolving random join orders, we repeatedly join whichever two
+ * "clumps" (base relations, or join relations built so far) give the join
+ * with the fewest estimated rows, considering only pairs linked by a join
+ * clause or a join order restriction unless no such pair remains.  This is
+ * the "greedy operator ordering" heuristic.  It examines O(N^2) joins for N
+ * relations, so planning time stays bounded where the exhaustive search
+ * would blow up, and unlike the genetic algorithm the result does not depend
+ * on a random seed.
+ *
+ * Candidate joins are built in a short-lived memory context, as geqo_eval()
+ * does, and only their size and cost are remembered; just the join chosen at
+ * each step is kept.  Otherwise the joinrels and paths of all O(N^2)
+ * candidates would stay around until the end of planning.
+ *
+ * Portions Copyright (c) 1996-2021, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/backend/optimizer/geqo/geqo_greedy.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "optimizer/geqo.h"
+#include "optimizer/joininfo.h"
+#include "optimizer/pathnode.h"
+#include "optimizer/paths.h"
+#include "utils/memutils.h"
+
+/* What we know about joining one pair of clumps */
+typedef struct GreedyPair
+{
+	bool		examined;		/* have we looked at this pair yet? */
+	bool		desirable;		/* is there a reason to join them now? */
+	bool		tried;			/* have we estimated the join? */
+	bool		legal;			/* did make_join_rel accept it? */
+	double		rows;			/* estimated rows of the join, if legal */
+	Cost		total_cost;		/* cost of its cheapest path, if legal */
+} GreedyPair;
+
+static void greedy_estimate_join(PlannerInfo *root, MemoryContext tmpcxt,
+								 RelOptInfo *rel1, RelOptInfo *rel2,
+								 bool last, GreedyPair *pair);
+static RelOptInfo *greedy_make_join(PlannerInfo *root, RelOptInfo *rel1,
+									RelOptInfo *rel2, bool last);
+static bool greedy_is_better(GreedyPair *pair1, GreedyPair *pair2);
+
+
+/*
+ * geqo_greedy
+ *	  find a join order for the given relations by greedy search
+ */
+RelOptInfo *
+geqo_greedy(PlannerInfo *root, int number_of_rels, List *initial_rels)
+{
+	RelOptInfo **clumps;
+	GreedyPair *pairs;
+	MemoryContext tmpcxt;
+	int			nclumps = number_of_rels;
+	int			i;
+	ListCell   *lc;
+
+	Assert(list_length(initial_rels) == number_of_rels);
+	Assert(root->join_rel_level == NULL);
+
+	/*
+	 * Candidate joins are built in this context and thrown away.  Make it a
+	 * child of the planner's normal context, so that it will be freed even if
+	 * we abort via ereport(ERROR).
+	 */
+	tmpcxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "GEQO greedy",
+								   ALLOCSET_DEFAULT_SIZES);
+
+	/*
+	 * Clumps keep the slot of their first member, and slots of clumps that
+	 * have been absorbed are set to NULL.  Scanning the slots in order makes
+	 * the outcome of ties deterministic.
+	 */
+	clumps = (RelOptInfo **) palloc(number_of_rels * sizeof(RelOptInfo *));
+	i = 0;
+	foreach(lc, initial_rels)
+		clumps[i++] = (RelOptInfo *) lfirst(lc);
+
+	pairs = (GreedyPair *)
+		palloc0(number_of_rels * number_of_rels * sizeof(GreedyPair));
+
+	while (nclumps > 1)
+	{
+		GreedyPair *best = NULL;
+		RelOptInfo *bestrel;
+		int			best1 = -1;
+		int			best2 = -1;
+		bool		force;
+
+		/*
+		 * Look for the best desirable join first.  If there is none, which
+		 * can happen when the query has a cross join, consider every pair.
+		 */
+		for (force = false; best == NULL; force = true)
+		{
+			for (i = 0; i < number_of_rels; i++)
+			{
+				int			j;
+
+				if (clumps[i] == NULL)
+					continue;
+
+				for (j = i + 1; j < number_of_rels; j++)
+				{
+					GreedyPair *pair = &pairs[i * number_of_rels + j];
+
+					if (clumps[j] == NULL)
+						continue;
+
+					if (!pair->examined)
+					{
+						pair->desirable =
+							have_relevant_joinclause(root, clumps[i], clumps[j]) ||
+							have_join_order_restriction(root, clumps[i], clumps[j]);
+						pair->examined = true;
+					}
+
+					if (!pair->desirable && !force)
+						continue;
+
+					/*
+					 * The estimate for this pair stays valid until one of its
+					 * clumps absorbs another one, so make it only once.
+					 */
+					if (!pair->tried)
+					{
+						greedy_estimate_join(root, tmpcxt,
+											 clumps[i], clumps[j],
+											 nclumps == 2, pair);
+						pair->tried = true;
+					}
+
+					if (pair->legal &&
+						(best == NULL || greedy_is_better(pair, best)))
+					{
+						best = pair;
+						best1 = i;
+						best2 = j;
+					}
+				}
+			}
+
+			if (best == NULL && force)
+				elog(ERROR, "failed to join all relations together");
+		}
+
+		/* Now build the chosen join for real */
+		bestrel = greedy_make_join(root, clumps[best1], clumps[best2],
+								   nclumps == 2);
+		if (bestrel == NULL)
+			elog(ERROR, "failed to build join chosen by greedy search");
+
+		/* Absorb the second clump into the first */
+		clumps[best1] = bestrel;
+		clumps[best2] = NULL;
+		nclumps--;
+
+		/* Forget whatever we knew about joining the enlarged clump */
+		for (i = 0; i < number_of_rels; i++)
+		{
+			GreedyPair *pair;
+
+			if (i < best1)
+				pair = &pairs[i * number_of_rels + best1];
+			else if (i > best1)
+				pair = &pairs[best1 * number_of_rels + i];
+			else
+				continue;
+			memset(pair, 0, sizeof(GreedyPair));
+		}
+	}
+
+	MemoryContextDelete(tmpcxt);
+
+	for (i = 0; i < number_of_rels; i++)
+	{
+		if (clumps[i] != NULL)
+			return clumps[i];
+	}
+
+	elog(ERROR, "failed to join all relations together");
+	return NULL;				/* keep compiler quiet */
+}
+
+/*
+ * Build the join of two clumps in tmpcxt, record its size and cost in *pair,
+ * and throw it away again.
+ *
+ * As in geqo_eval(), the joinrels added to root->join_rel_list are removed
+ * by truncating the list to its former length, and the outer join_rel_hash
+ * is hidden meanwhile so that a local one gets built if needed.
+ */
+static void
+greedy_estimate_join(PlannerInfo *root, MemoryContext tmpcxt,
+					 RelOptInfo *rel1, RelOptInfo *rel2,
+					 bool last, GreedyPair *pair)
+{
+	MemoryContext oldcxt;
+	RelOptInfo *joinrel;
+	int			savelength;
+	struct HTAB *savehash;
+
+	savelength = list_length(root->join_rel_list);
+	savehash = root->join_rel_hash;
+	root->join_rel_hash = NULL;
+
+	oldcxt = MemoryContextSwitchTo(tmpcxt);
+
+	joinrel = greedy_make_join(root, rel1, rel2, last);
+	pair->legal = (joinrel != NULL);
+	if (joinrel != NULL)
+	{
+		pair->rows = joinrel->rows;
+		pair->total_cost = joinrel->cheapest_total_path->total_cost;
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	root->join_rel_list = list_truncate(root->join_rel_list, savelength);
+	root->join_rel_hash = savehash;
+
+	MemoryContextReset(tmpcxt);
+}
+
+/*
+ * Build the join of two clumps and its paths, as merge_clump() does for the
+ * genetic algorithm.  Returns NULL if the join is not legal.
+ *
+ * "last" is true if this join would include all the relations, in which case
+ * gathering of partial paths is left to the caller as usual.
+ */
+static RelOptInfo *
+greedy_make_join(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2,
+				 bool last)
+{
+	RelOptInfo *joinrel;
+
+	joinrel = make_join_rel(root, rel1, rel2);
+	if (joinrel == NULL)
+		return NULL;
+
+	/* Create paths for partitionwise joins. */
+	generate_partitionwise_join_paths(root, joinrel);
+
+	/*
+	 * Except for the topmost scan/join rel, consider gathering partial paths.
+	 * We'll do the same for the topmost scan/join rel once we know the final
+	 * targetlist (see grouping_planner).
+	 */
+	if (!last)
+		generate_useful_gather_paths(root, joinrel, false);
+
+	/* Find and save the cheapest paths for this joinrel */
+	set_cheapest(joinrel);
+
+	return joinrel;
+}
+
+/*
+ * Is pair1 a better next join than pair2?  Fewer rows wins, since that keeps
+ * the inputs of later joins small; the cheaper total cost breaks ties.
+ */
+static bool
+greedy_is_better(GreedyPair *pair1, GreedyPair *pair2)
+{
+	if (pair1->rows != pair2->rows)
+		return pair1->rows < pair2->rows;
+	return pair1->total_cost < pair2->total_cost;
+}
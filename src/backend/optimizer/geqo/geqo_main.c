@@ -41,6 +41,7 @@ int			Geqo_pool_size;
 int			Geqo_generations;
 double		Geqo_selection_bias;
 double		Geqo_seed;
+int			Geqo_strategy = GEQO_STRATEGY_GENETIC;
 
 
 static int	gimme_pool_size(int nr_rel);
@@ -93,6 +94,10 @@ geqo(PlannerInfo *root, int number_of_rels, List *initial_rels)
 	int			mutations = 0;
 #endif
 
+	/* the greedy search needs none of the machinery below */
+	if (Geqo_strategy == GEQO_STRATEGY_GREEDY)
+		return geqo_greedy(root, number_of_rels, initial_rels);
+
 /* set up private information */
 	root->join_search_private = (void *) &private;
 	private.initial_rels = initial_rels;
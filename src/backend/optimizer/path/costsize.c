@@ -3310,15 +3310,39 @@ initial_cost_mergejoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 
 	if (outersortkeys)			/* do we need to sort outer? */
 	{
-		cost_sort(&sort_path,
-				  root,
-				  outersortkeys,
-				  outer_path->total_cost,
-				  outer_path_rows,
-				  outer_path->pathtarget->width,
-				  0.0,
-				  work_mem,
-				  -1.0);
+		int			presorted_keys;
+
+		/*
+		 * If the outer path is already sorted by a prefix of the required
+		 * keys, create_mergejoin_plan will use an incremental sort, so cost
+		 * it that way.  (The inner side must support mark and restore, which
+		 * incremental sort does not, so it always gets a full sort.)
+		 */
+		if (enable_incremental_sort &&
+			!pathkeys_count_contained_in(outersortkeys, outer_path->pathkeys,
+										 &presorted_keys) &&
+			presorted_keys > 0)
+			cost_incremental_sort(&sort_path,
+								  root,
+								  outersortkeys,
+								  presorted_keys,
+								  outer_path->startup_cost,
+								  outer_path->total_cost,
+								  outer_path_rows,
+								  outer_path->pathtarget->width,
+								  0.0,
+								  work_mem,
+								  -1.0);
+		else
+			cost_sort(&sort_path,
+					  root,
+					  outersortkeys,
+					  outer_path->total_cost,
+					  outer_path_rows,
+					  outer_path->pathtarget->width,
+					  0.0,
+					  work_mem,
+					  -1.0);
 		startup_cost += sort_path.startup_cost;
 		startup_cost += (sort_path.total_cost - sort_path.startup_cost)
 			* outerstartsel;
@@ -42,6 +42,8 @@ static void try_partitionwise_join(PlannerInfo *root, RelOptInfo *rel1,
 								   RelOptInfo *rel2, RelOptInfo *joinrel,
 								   SpecialJoinInfo *parent_sjinfo,
 								   List *parent_restrictlist);
+static void free_child_join_sjinfo(SpecialJoinInfo *child_sjinfo,
+								  SpecialJoinInfo *parent_sjinfo);
 static SpecialJoinInfo *build_child_join_sjinfo(PlannerInfo *root,
 												SpecialJoinInfo *parent_sjinfo,
 												Relids left_relids, Relids right_relids);
@@ -1548,6 +1550,15 @@ try_partitionwise_join(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2,
 		populate_joinrel_with_paths(root, child_rel1, child_rel2,
 									child_joinrel, child_sjinfo,
 									child_restrictlist);
+
+		/*
+		 * The translated SpecialJoinInfo is only needed while building paths
+		 * for this pair of children.  With thousands of partitions, and this
+		 * being repeated for every join order considered, keeping them around
+		 * adds up to a lot of planner memory, so release it right away.
+		 */
+		free_child_join_sjinfo(child_sjinfo, parent_sjinfo);
+		bms_free(child_joinrelids);
 	}
 }
 
@@ -1593,6 +1604,31 @@ build_child_join_sjinfo(PlannerInfo *root, SpecialJoinInfo *parent_sjinfo,
 	return sjinfo;
 }
 
+/*
+ * Free memory consumed by a SpecialJoinInfo built by
+ * build_child_join_sjinfo().
+ *
+ * adjust_child_relids() returns the parent's set unchanged when it contains
+ * nothing to translate, so only free the sets that were actually copied.
+ * semi_rhs_exprs is left alone: a UniquePath built for the child join may
+ * point to it, and a plain pfree() wouldn't free the whole tree anyway.
+ */
+static void
+free_child_join_sjinfo(SpecialJoinInfo *child_sjinfo,
+					   SpecialJoinInfo *parent_sjinfo)
+{
+	if (child_sjinfo->min_lefthand != parent_sjinfo->min_lefthand)
+		bms_free(child_sjinfo->min_lefthand);
+	if (child_sjinfo->min_righthand != parent_sjinfo->min_righthand)
+		bms_free(child_sjinfo->min_righthand);
+	if (child_sjinfo->syn_lefthand != parent_sjinfo->syn_lefthand)
+		bms_free(child_sjinfo->syn_lefthand);
+	if (child_sjinfo->syn_righthand != parent_sjinfo->syn_righthand)
+		bms_free(child_sjinfo->syn_righthand);
+
+	pfree(child_sjinfo);
+}
+
 /*
  * compute_partition_bounds
  *		Compute the partition bounds for a join rel from those for inputs
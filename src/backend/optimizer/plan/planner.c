@@ -129,6 +129,7 @@ typedef struct
 /* Local functions */
 static Node *preprocess_expression(PlannerInfo *root, Node *expr, int kind);
 static void preprocess_qual_conditions(PlannerInfo *root, Node *jtnode);
+static Cost mark_jit_plan_nodes(Plan *plan, double loops);
 static void grouping_planner(PlannerInfo *root, double tuple_fraction);
 static grouping_sets_data *preprocess_grouping_sets(PlannerInfo *root);
 static List *remap_to_groupclause_idx(List *groupClause, List *gsets,
@@ -283,6 +284,7 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	RelOptInfo *final_rel;
 	Path	   *best_path;
 	Plan	   *top_plan;
+	Cost		jit_cost = 0;
 	ListCell   *lp,
 			   *lr;
 
@@ -527,8 +529,17 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	result->stmt_len = parse->stmt_len;
 
 	result->jitFlags = PGJIT_NONE;
-	if (jit_enabled && jit_above_cost >= 0 &&
-		top_plan->total_cost > jit_above_cost)
+	if (jit_enabled && jit_above_cost >= 0)
+	{
+		/*
+		 * Decide which plan nodes are worth JIT compiling, and total up their
+		 * costs.
+		 */
+		jit_cost = mark_jit_plan_nodes(top_plan, 1);
+		foreach(lp, glob->subplans)
+			jit_cost += mark_jit_plan_nodes((Plan *) lfirst(lp), 1);
+	}
+	if (jit_cost > 0)
 	{
 		result->jitFlags |= PGJIT_PERFORM;
 
@@ -536,10 +547,10 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 		 * Decide how much effort should be put into generating better code.
 		 */
 		if (jit_optimize_above_cost >= 0 &&
-			top_plan->total_cost > jit_optimize_above_cost)
+			jit_cost > jit_optimize_above_cost)
 			result->jitFlags |= PGJIT_OPT3;
 		if (jit_inline_above_cost >= 0 &&
-			top_plan->total_cost > jit_inline_above_cost)
+			jit_cost > jit_inline_above_cost)
 			result->jitFlags |= PGJIT_INLINE;
 
 		/*
@@ -557,6 +568,100 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	return result;
 }
 
+/*
+ * mark_jit_plan_nodes
+ *		Flag the nodes of a finished plan tree that are worth JIT compiling.
+ *
+ * Expressions are compiled per plan node, so what matters is the work done by
+ * each node itself: its total cost less that of its children, times the
+ * number of times it is expected to be run.  Comparing only the cost of the
+ * whole plan to jit_above_cost would compile the expressions of every node
+ * in an expensive plan, e.g. of each of a thousand small partition scans,
+ * and none of those in a cheap plan with one expensive node.
+ *
+ * Returns the summed cost of the nodes that were flagged.
+ */
+static Cost
+mark_jit_plan_nodes(Plan *plan, double loops)
+{
+	List	   *children = NIL;
+	Cost		child_cost = 0;
+	Cost		jit_cost = 0;
+	Cost		node_cost;
+	double		inner_loops = loops;
+	ListCell   *lc;
+
+	if (plan == NULL)
+		return 0;
+
+	switch (nodeTag(plan))
+	{
+		case T_Append:
+			children = ((Append *) plan)->appendplans;
+			break;
+		case T_MergeAppend:
+			children = ((MergeAppend *) plan)->mergeplans;
+			break;
+		case T_BitmapAnd:
+			children = ((BitmapAnd *) plan)->bitmapplans;
+			break;
+		case T_BitmapOr:
+			children = ((BitmapOr *) plan)->bitmapplans;
+			break;
+		case T_CustomScan:
+			children = ((CustomScan *) plan)->custom_plans;
+			break;
+		case T_SubqueryScan:
+			{
+				Plan	   *subplan = ((SubqueryScan *) plan)->subplan;
+
+				child_cost += subplan->total_cost;
+				jit_cost += mark_jit_plan_nodes(subplan, loops);
+			}
+			break;
+		default:
+			break;
+	}
+
+	/* The inner side of a nestloop is rescanned for each outer row */
+	if (IsA(plan, NestLoop) && plan->lefttree != NULL)
+		inner_loops = loops * Max(plan->lefttree->plan_rows, 1.0);
+
+	if (plan->lefttree != NULL)
+	{
+		child_cost += plan->lefttree->total_cost;
+		jit_cost += mark_jit_plan_nodes(plan->lefttree, loops);
+	}
+	if (plan->righttree != NULL)
+	{
+		child_cost += plan->righttree->total_cost;
+		jit_cost += mark_jit_plan_nodes(plan->righttree, inner_loops);
+	}
+	foreach(lc, children)
+	{
+		Plan	   *child = (Plan *) lfirst(lc);
+
+		child_cost += child->total_cost;
+		jit_cost += mark_jit_plan_nodes(child, loops);
+	}
+
+	node_cost = Max(plan->total_cost - child_cost, 0) * loops;
+	if (node_cost > jit_above_cost)
+	{
+		plan->jit = true;
+		jit_cost += node_cost;
+
+		/*
+		 * A hash join's inner hash keys are evaluated by its Hash node, whose
+		 * own cost is nil since the hashing is charged to the join.
+		 */
+		if (IsA(plan, HashJoin) && IsA(plan->righttree, Hash))
+			plan->righttree->jit = true;
+	}
+
+	return jit_cost;
+}
+
 
 /*--------------------
  * subquery_planner
@@ -815,6 +920,9 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
 												EXPRKIND_LIMIT);
 		wc->endOffset = preprocess_expression(root, wc->endOffset,
 											  EXPRKIND_LIMIT);
+		wc->runCondition = (List *) preprocess_expression(root,
+														  (Node *) wc->runCondition,
+														  EXPRKIND_TARGET);
 	}
 
 	parse->limitOffset = preprocess_expression(root, parse->limitOffset,
@@ -4120,6 +4228,7 @@ create_one_window_path(PlannerInfo *root,
 {
 	PathTarget *window_target;
 	ListCell   *l;
+	List	   *topqual = NIL;
 
 	/*
 	 * Since each window clause could require a different sort order, we stack
@@ -4144,6 +4253,7 @@ create_one_window_path(PlannerInfo *root,
 		List	   *window_pathkeys;
 		int			presorted_keys;
 		bool		is_sorted;
+		bool		topwindow;
 
 		window_pathkeys = make_pathkeys_for_window(root,
 												   wc,
@@ -4207,10 +4317,21 @@ create_one_window_path(PlannerInfo *root,
 			window_target = output_target;
 		}
 
+		/* mark the final item in the list as the top-level window */
+		topwindow = foreach_current_index(l) == list_length(activeWindows) - 1;
+
+		/*
+		 * Accumulate all of the runConditions from each intermediate
+		 * WindowClause.  The top-level WindowAgg must pass these as a qual so
+		 * that it filters out unwanted tuples correctly.
+		 */
+		if (!topwindow)
+			topqual = list_concat(topqual, wc->runCondition);
+
 		path = (Path *)
 			create_windowagg_path(root, window_rel, path, window_target,
 								  wflists->windowFuncs[wc->winref],
-								  wc);
+								  wc, topwindow ? topqual : NIL, topwindow);
 	}
 
 	add_path(window_rel, path);
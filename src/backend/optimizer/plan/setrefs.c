@@ -71,6 +71,11 @@ typedef struct
 	double		num_exec;
 } fix_upper_expr_context;
 
+typedef struct
+{
+	indexed_tlist *itlist;
+} fix_windowagg_cond_context;
+
 /*
  * Selecting the best alternative in an AlternativeSubPlan expression requires
  * estimating how many times that expression will be evaluated.  For an
@@ -172,6 +177,10 @@ static List *set_returning_clause_references(PlannerInfo *root,
 											 Plan *topplan,
 											 Index resultRelation,
 											 int rtoffset);
+static List *set_windowagg_runcondition_references(List *runcondition,
+												   Plan *plan);
+static Node *fix_windowagg_condition_expr_mutator(Node *node,
+												  fix_windowagg_cond_context *context);
 
 
 /*****************************************************************************
@@ -853,17 +862,36 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			{
 				WindowAgg  *wplan = (WindowAgg *) plan;
 
+				/*
+				 * Adjust the WindowAgg's run condition so that it references
+				 * the WindowFunc values in the node's own output tuple,
+				 * rather than evaluating the WindowFuncs all over again.
+				 * This must be done before set_upper_references changes the
+				 * targetlist.
+				 */
+				wplan->runCondition =
+					set_windowagg_runcondition_references(wplan->runCondition,
+														  plan);
+
 				set_upper_references(root, plan, rtoffset);
 
 				/*
 				 * Like Limit node limit/offset expressions, WindowAgg has
 				 * frame offset expressions, which cannot contain subplan
-				 * variable refs, so fix_scan_expr works for them.
+				 * variable refs, so fix_scan_expr works for them.  The same
+				 * goes for the run condition, whose WindowFuncs were
+				 * replaced above; runConditionOrig is only for EXPLAIN.
 				 */
 				wplan->startOffset =
 					fix_scan_expr(root, wplan->startOffset, rtoffset, 1);
 				wplan->endOffset =
 					fix_scan_expr(root, wplan->endOffset, rtoffset, 1);
+				wplan->runCondition =
+					fix_scan_list(root, wplan->runCondition, rtoffset,
+								  NUM_EXEC_TLIST(plan));
+				wplan->runConditionOrig =
+					fix_scan_list(root, wplan->runConditionOrig, rtoffset,
+								  NUM_EXEC_TLIST(plan));
 			}
 			break;
 		case T_Result:
@@ -2861,6 +2889,58 @@ fix_upper_expr_mutator(Node *node, fix_upper_expr_context *context)
 								   (void *) context);
 }
 
+/*
+ * set_windowagg_runcondition_references
+ *		Replace the WindowFuncs in a WindowAgg's run condition with Vars that
+ *		reference the matching entries of the WindowAgg's own targetlist.
+ *
+ * The executor evaluates the run condition against the node's projected
+ * output tuple, so the Vars use INDEX_VAR, which is evaluated against the
+ * expression context's scan tuple.
+ */
+static List *
+set_windowagg_runcondition_references(List *runcondition, Plan *plan)
+{
+	fix_windowagg_cond_context context;
+	List	   *newlist;
+
+	if (runcondition == NIL)
+		return NIL;
+
+	context.itlist = build_tlist_index(plan->targetlist);
+
+	newlist = (List *)
+		fix_windowagg_condition_expr_mutator((Node *) runcondition, &context);
+
+	pfree(context.itlist);
+
+	return newlist;
+}
+
+static Node *
+fix_windowagg_condition_expr_mutator(Node *node,
+									 fix_windowagg_cond_context *context)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (IsA(node, WindowFunc))
+	{
+		Var		   *newvar;
+
+		newvar = search_indexed_tlist_for_non_var((Expr *) node,
+												  context->itlist,
+												  INDEX_VAR);
+		if (newvar)
+			return (Node *) newvar;
+		elog(ERROR, "WindowFunc not found in WindowAgg target list");
+	}
+
+	return expression_tree_mutator(node,
+								   fix_windowagg_condition_expr_mutator,
+								   (void *) context);
+}
+
 /*
  * set_returning_clause_references
  *		Perform setrefs.c's work on a RETURNING targetlist
@@ -186,6 +186,20 @@ typedef struct av_relation
 								 * reloptions, or NULL if none */
 } av_relation;
 
+/*
+ * struct to keep track of tables found to need vacuum and/or analyze, before
+ * rechecking.  ac_score says how urgent the work is: for tables at risk of
+ * wraparound, how far their relfrozenxid or relminmxid is past the forced
+ * vacuum age (as a fraction of it); otherwise, by how much the dead tuple,
+ * inserted tuple or changed tuple count exceeds its threshold.
+ */
+typedef struct av_candidate
+{
+	Oid			ac_relid;
+	bool		ac_wraparound;
+	float4		ac_score;
+} av_candidate;
+
 /* struct to keep track of tables to vacuum and/or analyze, after rechecking */
 typedef struct autovac_table
 {
@@ -243,6 +257,7 @@ typedef enum
 {
 	AutoVacForkFailed,			/* failed trying to start a worker */
 	AutoVacRebalance,			/* rebalance the cost limits */
+	AutoVacWorkItemAdded,		/* a backend requested a work item */
 	AutoVacNumSignals			/* must be last */
 }			AutoVacuumSignal;
 
@@ -320,6 +335,7 @@ static void launcher_determine_sleep(bool canlaunch, bool recursing,
 static void launch_worker(TimestampTz now);
 static List *get_database_list(void);
 static void rebuild_database_list(Oid newdb);
+static void launcher_schedule_workitems(void);
 static int	db_comparator(const void *a, const void *b);
 static void autovac_balance_cost(void);
 
@@ -337,7 +353,11 @@ static void relation_needs_vacanalyze(Oid relid, AutoVacOpts *relopts,
 									  Form_pg_class classForm,
 									  PgStat_StatTabEntry *tabentry,
 									  int effective_multixact_freeze_max_age,
-									  bool *dovacuum, bool *doanalyze, bool *wraparound);
+									  bool *dovacuum, bool *doanalyze, bool *wraparound,
+									  float4 *score);
+static List *add_candidate(List *candidates, Oid relid, bool wraparound,
+						   float4 score);
+static int	candidate_cmp(const ListCell *a, const ListCell *b);
 
 static void autovacuum_do_vac_analyze(autovac_table *tab,
 									  BufferAccessStrategy bstrategy);
@@ -347,6 +367,8 @@ static PgStat_StatTabEntry *get_pgstat_tabentry_relid(Oid relid, bool isshared,
 													  PgStat_StatDBEntry *shared,
 													  PgStat_StatDBEntry *dbentry);
 static void perform_work_item(AutoVacuumWorkItem *workitem);
+static bool AutoVacuumWorkItemPending(AutoVacuumWorkItemType type,
+									  Oid relationId, BlockNumber blkno);
 static void autovac_report_activity(autovac_table *tab);
 static void autovac_report_workitem(AutoVacuumWorkItem *workitem,
 									const char *nspname, const char *relname);
@@ -680,6 +702,13 @@ AutoVacLauncherMain(int argc, char *argv[])
 				LWLockRelease(AutovacuumLock);
 			}
 
+			/* schedule databases that have new work items */
+			if (AutoVacuumShmem->av_signal[AutoVacWorkItemAdded])
+			{
+				AutoVacuumShmem->av_signal[AutoVacWorkItemAdded] = false;
+				launcher_schedule_workitems();
+			}
+
 			if (AutoVacuumShmem->av_signal[AutoVacForkFailed])
 			{
 				/*
@@ -1125,6 +1154,82 @@ rebuild_database_list(Oid newdb)
 	MemoryContextSwitchTo(oldcxt);
 }
 
+/*
+ * launcher_schedule_workitems
+ *
+ * Make each database that has work items waiting due for a worker right
+ * away, rather than at its next turn, which could be up to
+ * autovacuum_naptime away.  The database list's ordering by decreasing
+ * adl_next_worker is preserved.
+ */
+static void
+launcher_schedule_workitems(void)
+{
+	Oid			dbids[NUM_WORKITEMS];
+	int			ndbids = 0;
+	TimestampTz current_time;
+	int			i;
+
+	LWLockAcquire(AutovacuumLock, LW_SHARED);
+	for (i = 0; i < NUM_WORKITEMS; i++)
+	{
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
+		int			j;
+
+		if (!workitem->avw_used || workitem->avw_active)
+			continue;
+
+		for (j = 0; j < ndbids; j++)
+		{
+			if (dbids[j] == workitem->avw_database)
+				break;
+		}
+		if (j == ndbids)
+			dbids[ndbids++] = workitem->avw_database;
+	}
+	LWLockRelease(AutovacuumLock);
+
+	current_time = GetCurrentTimestamp();
+
+	for (i = 0; i < ndbids; i++)
+	{
+		avl_dbase  *avdb = NULL;
+		dlist_iter	iter;
+
+		dlist_foreach(iter, &DatabaseList)
+		{
+			avl_dbase  *dbp = dlist_container(avl_dbase, adl_node, iter.cur);
+
+			if (dbp->adl_datid == dbids[i])
+			{
+				avdb = dbp;
+				break;
+			}
+		}
+
+		/* not known yet, or already due */
+		if (avdb == NULL ||
+			!TimestampDifferenceExceeds(current_time, avdb->adl_next_worker, 0))
+			continue;
+
+		avdb->adl_next_worker = current_time;
+		dlist_delete(&avdb->adl_node);
+
+		/* put it before the first entry that is due no later than it */
+		dlist_foreach(iter, &DatabaseList)
+		{
+			avl_dbase  *dbp = dlist_container(avl_dbase, adl_node, iter.cur);
+
+			if (dbp->adl_next_worker <= current_time)
+				break;
+		}
+		if (iter.cur != &DatabaseList.head)
+			dlist_insert_before(iter.cur, &avdb->adl_node);
+		else
+			dlist_push_tail(&DatabaseList, &avdb->adl_node);
+	}
+}
+
 /* qsort comparator for avl_dbase, using adl_score */
 static int
 db_comparator(const void *a, const void *b)
@@ -1957,6 +2062,7 @@ do_autovacuum(void)
 	HeapTuple	tuple;
 	TableScanDesc relScan;
 	Form_pg_database dbForm;
+	List	   *candidates = NIL;
 	List	   *table_oids = NIL;
 	List	   *orphan_oids = NIL;
 	HASHCTL		ctl;
@@ -2126,6 +2232,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		float4		score;
 
 		if (classForm->relkind != RELKIND_RELATION &&
 			classForm->relkind != RELKIND_MATVIEW &&
@@ -2167,11 +2274,11 @@ do_autovacuum(void)
 		/* Check if it needs vacuum or analyze */
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound, &score);
 
-		/* Relations that need work are added to table_oids */
+		/* Relations that need work are added to candidates */
 		if (dovacuum || doanalyze)
-			table_oids = lappend_oid(table_oids, relid);
+			candidates = add_candidate(candidates, relid, wraparound, score);
 
 		/*
 		 * Remember TOAST associations for the second pass.  Note: we must do
@@ -2220,6 +2327,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		float4		score;
 
 		/*
 		 * We cannot safely process other backends' temp tables, so skip 'em.
@@ -2250,16 +2358,34 @@ do_autovacuum(void)
 
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound, &score);
 
 		/* ignore analyze for toast tables */
 		if (dovacuum)
-			table_oids = lappend_oid(table_oids, relid);
+			candidates = add_candidate(candidates, relid, wraparound, score);
 	}
 
 	table_endscan(relScan);
 	table_close(classRel, AccessShareLock);
 
+	/*
+	 * Process the tables in order of urgency rather than in pg_class order:
+	 * first those at risk of wraparound, oldest first, and then those that
+	 * exceed their thresholds by the largest factor.  This keeps a large
+	 * table that barely qualifies from delaying small tables that are
+	 * accumulating dead tuples quickly.  Since every worker sorts the same
+	 * way and skips tables another worker is processing, concurrent workers
+	 * in a database naturally go down the list together.
+	 */
+	list_sort(candidates, candidate_cmp);
+	foreach(cell, candidates)
+	{
+		av_candidate *cand = (av_candidate *) lfirst(cell);
+
+		table_oids = lappend_oid(table_oids, cand->ac_relid);
+	}
+	list_free_deep(candidates);
+
 	/*
 	 * Recheck orphan temporary tables, and if they still seem orphaned, drop
 	 * them.  We'll eat a transaction per dropped table, which might seem
@@ -2727,6 +2853,10 @@ perform_work_item(AutoVacuumWorkItem *workitem)
 									ObjectIdGetDatum(workitem->avw_relation),
 									Int64GetDatum((int64) workitem->avw_blockNumber));
 				break;
+			case AVW_GINCleanPendingList:
+				DirectFunctionCall1(gin_clean_pending_list,
+									ObjectIdGetDatum(workitem->avw_relation));
+				break;
 			default:
 				elog(WARNING, "unrecognized work item found: type %d",
 					 workitem->avw_type);
@@ -3035,6 +3165,7 @@ recheck_relation_needs_vacanalyze(Oid relid,
 	PgStat_StatTabEntry *tabentry;
 	PgStat_StatDBEntry *shared = NULL;
 	PgStat_StatDBEntry *dbentry = NULL;
+	float4		score;
 
 	if (classForm->relisshared)
 		shared = pgstat_fetch_stat_dbentry(InvalidOid);
@@ -3047,7 +3178,7 @@ recheck_relation_needs_vacanalyze(Oid relid,
 
 	relation_needs_vacanalyze(relid, avopts, classForm, tabentry,
 							  effective_multixact_freeze_max_age,
-							  dovacuum, doanalyze, wraparound);
+							  dovacuum, doanalyze, wraparound, &score);
 
 	/* ignore ANALYZE for toast tables */
 	if (classForm->relkind == RELKIND_TOASTVALUE)
@@ -3059,7 +3190,8 @@ recheck_relation_needs_vacanalyze(Oid relid,
  *
  * Check whether a relation needs to be vacuumed or analyzed; return each into
  * "dovacuum" and "doanalyze", respectively.  Also return whether the vacuum is
- * being forced because of Xid or multixact wraparound.
+ * being forced because of Xid or multixact wraparound, and in "score" how
+ * urgent the work is (see av_candidate).
  *
  * relopts is a pointer to the AutoVacOpts options (either for itself in the
  * case of a plain table, or for either itself or its parent table in the case
@@ -3100,7 +3232,8 @@ relation_needs_vacanalyze(Oid relid,
  /* output params below */
 						  bool *dovacuum,
 						  bool *doanalyze,
-						  bool *wraparound)
+						  bool *wraparound,
+						  float4 *score)
 {
 	bool		force_vacuum;
 	bool		av_enabled;
@@ -3191,6 +3324,21 @@ relation_needs_vacanalyze(Oid relid,
 			MultiXactIdPrecedes(classForm->relminmxid, multiForceLimit);
 	}
 	*wraparound = force_vacuum;
+	*score = 0;
+
+	if (force_vacuum)
+	{
+		float4		xid_age = 0;
+		float4		mxid_age = 0;
+
+		if (TransactionIdIsNormal(classForm->relfrozenxid))
+			xid_age = (float4) (int32) (recentXid - classForm->relfrozenxid);
+		if (MultiXactIdIsValid(classForm->relminmxid))
+			mxid_age = (float4) (int32) (recentMulti - classForm->relminmxid);
+
+		*score = Max(xid_age / Max(freeze_max_age, 1),
+					 mxid_age / Max(multixact_freeze_max_age, 1));
+	}
 
 	/* User disabled it in pg_class.reloptions?  (But ignore if at risk) */
 	if (!av_enabled && !force_vacuum)
@@ -3240,6 +3388,16 @@ relation_needs_vacanalyze(Oid relid,
 		*dovacuum = force_vacuum || (vactuples > vacthresh) ||
 			(vac_ins_base_thresh >= 0 && instuples > vacinsthresh);
 		*doanalyze = (anltuples > anlthresh);
+
+		if (!force_vacuum)
+		{
+			if (vactuples > vacthresh)
+				*score = Max(*score, vactuples / Max(vacthresh, 1));
+			if (vac_ins_base_thresh >= 0 && instuples > vacinsthresh)
+				*score = Max(*score, instuples / Max(vacinsthresh, 1));
+			if (anltuples > anlthresh)
+				*score = Max(*score, anltuples / Max(anlthresh, 1));
+		}
 	}
 	else
 	{
@@ -3257,6 +3415,39 @@ relation_needs_vacanalyze(Oid relid,
 		*doanalyze = false;
 }
 
+/*
+ * Append a table needing work to the list of candidates for do_autovacuum.
+ */
+static List *
+add_candidate(List *candidates, Oid relid, bool wraparound, float4 score)
+{
+	av_candidate *cand = palloc(sizeof(av_candidate));
+
+	cand->ac_relid = relid;
+	cand->ac_wraparound = wraparound;
+	cand->ac_score = score;
+
+	return lappend(candidates, cand);
+}
+
+/*
+ * list_sort comparator putting the most urgent candidates first
+ */
+static int
+candidate_cmp(const ListCell *a, const ListCell *b)
+{
+	av_candidate *ca = (av_candidate *) lfirst(a);
+	av_candidate *cb = (av_candidate *) lfirst(b);
+
+	if (ca->ac_wraparound != cb->ac_wraparound)
+		return ca->ac_wraparound ? -1 : 1;
+	if (ca->ac_score > cb->ac_score)
+		return -1;
+	if (ca->ac_score < cb->ac_score)
+		return 1;
+	return 0;
+}
+
 /*
  * autovacuum_do_vac_analyze
  *		Vacuum and/or analyze the specified table
@@ -3339,6 +3530,10 @@ autovac_report_workitem(AutoVacuumWorkItem *workitem,
 			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
 					 "autovacuum: BRIN summarize");
 			break;
+		case AVW_GINCleanPendingList:
+			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
+					 "autovacuum: GIN pending list cleanup");
+			break;
 	}
 
 	/*
@@ -3383,9 +3578,32 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 {
 	int			i;
 	bool		result = false;
+	pid_t		launcherpid = 0;
+
+	/*
+	 * If the same work has already been requested and not yet started, there
+	 * is no need to record it again.  This lets callers that may ask for the
+	 * same work many times before a worker gets to it, such as GIN inserters
+	 * finding an overlong pending list, avoid filling up the array.  That's
+	 * the common case for them, so check with only a shared lock first.
+	 */
+	LWLockAcquire(AutovacuumLock, LW_SHARED);
+	if (AutoVacuumWorkItemPending(type, relationId, blkno))
+	{
+		LWLockRelease(AutovacuumLock);
+		return true;
+	}
+	LWLockRelease(AutovacuumLock);
 
 	LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
 
+	/* recheck, since someone might have added it meanwhile */
+	if (AutoVacuumWorkItemPending(type, relationId, blkno))
+	{
+		LWLockRelease(AutovacuumLock);
+		return true;
+	}
+
 	/*
 	 * Locate an unused work item and fill it with the given data.
 	 */
@@ -3404,15 +3622,48 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 		workitem->avw_blockNumber = blkno;
 		result = true;
 
+		/* ask the launcher to schedule a worker for our database soon */
+		AutoVacuumShmem->av_signal[AutoVacWorkItemAdded] = true;
+		launcherpid = AutoVacuumShmem->av_launcherpid;
+
 		/* done */
 		break;
 	}
 
 	LWLockRelease(AutovacuumLock);
 
+	if (launcherpid != 0)
+		kill(launcherpid, SIGUSR2);
+
 	return result;
 }
 
+/*
+ * Is there a work item like the given one that hasn't been started yet?
+ *
+ * Caller must hold AutovacuumLock.
+ */
+static bool
+AutoVacuumWorkItemPending(AutoVacuumWorkItemType type, Oid relationId,
+						  BlockNumber blkno)
+{
+	int			i;
+
+	for (i = 0; i < NUM_WORKITEMS; i++)
+	{
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
+
+		if (workitem->avw_used && !workitem->avw_active &&
+			workitem->avw_type == type &&
+			workitem->avw_database == MyDatabaseId &&
+			workitem->avw_relation == relationId &&
+			workitem->avw_blockNumber == blkno)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * autovac_init
  *		This is called at postmaster initialization.
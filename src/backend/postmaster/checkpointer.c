@@ -36,6 +36,7 @@
  */
 #include "postgres.h"
 
+#include <math.h>
 #include <sys/time.h>
 #include <time.h>
 
@@ -807,6 +808,20 @@ IsCheckpointOnSchedule(double progress)
 	elapsed_xlogs = (((double) (recptr - ckpt_start_recptr)) /
 					 wal_segment_size) / CheckPointSegments;
 
+	/*
+	 * With full_page_writes, WAL is generated much faster just after the
+	 * checkpoint started, because the first modification of each page emits
+	 * a full-page image, and the rate then tails off as fewer pages remain
+	 * unmodified.  Measuring progress linearly in WAL makes us write buffers
+	 * in a burst at the start of the checkpoint, right when the FPIs are
+	 * already loading the I/O system, and dawdle at the end.  Compensate by
+	 * assuming that WAL volume grows roughly as elapsed^(2/3), which is what
+	 * typical workloads show.  This doesn't apply to restartpoints, since
+	 * the WAL being replayed was generated on the primary's own schedule.
+	 */
+	if (fullPageWrites && !RecoveryInProgress() && elapsed_xlogs < 1.0)
+		elapsed_xlogs = pow(elapsed_xlogs, 1.5);
+
 	if (progress < elapsed_xlogs)
 	{
 		ckpt_cached_elapsed = elapsed_xlogs;
@@ -94,8 +94,20 @@
 #define PGSTAT_POLL_LOOP_COUNT	(PGSTAT_MAX_WAIT_TIME / PGSTAT_RETRY_DELAY)
 #define PGSTAT_INQ_LOOP_COUNT	(PGSTAT_INQ_INTERVAL / PGSTAT_RETRY_DELAY)
 
-/* Minimum receive buffer size for the collector's socket. */
-#define PGSTAT_MIN_RCVBUF		(100 * 1024)
+/*
+ * Minimum receive buffer size for the collector's socket.  Backends can
+ * produce bursts of messages much faster than the collector drains them,
+ * e.g. when many sessions touching thousands of tables end transactions at
+ * once, so be generous.  The kernel may clamp this to a lower limit.
+ */
+#define PGSTAT_MIN_RCVBUF		(1024 * 1024)
+
+/*
+ * stdio buffer size for reading and writing the per-database statistics
+ * files, which hold one entry per table and function and can grow to many
+ * megabytes.
+ */
+#define PGSTAT_FILE_BUFSIZE		(64 * 1024)
 
 
 /* ----------
@@ -242,6 +254,13 @@ static PgStat_SubXactStatus *pgStatXactStack = NULL;
 
 static int	pgStatXactCommit = 0;
 static int	pgStatXactRollback = 0;
+
+/*
+ * Temporary files created since the last tabstat message.  A query that
+ * spills to many batch files would otherwise send a message per file.
+ */
+static PgStat_Counter pgStatTempFiles = 0;
+static PgStat_Counter pgStatTempBytes = 0;
 PgStat_Counter pgStatBlockReadTime = 0;
 PgStat_Counter pgStatBlockWriteTime = 0;
 PgStat_Counter pgStatActiveTime = 0;
@@ -857,6 +876,7 @@ pgstat_report_stat(bool disconnect)
 	/* Don't expend a clock check if nothing to do */
 	if ((pgStatTabList == NULL || pgStatTabList->tsa_used == 0) &&
 		pgStatXactCommit == 0 && pgStatXactRollback == 0 &&
+		pgStatTempFiles == 0 &&
 		!have_function_stats && !disconnect)
 		return;
 
@@ -938,10 +958,12 @@ pgstat_report_stat(bool disconnect)
 
 	/*
 	 * Send partial messages.  Make sure that any pending xact commit/abort
-	 * gets counted, even if there are no table stats to send.
+	 * and temporary files get counted, even if there are no table stats to
+	 * send.
 	 */
 	if (regular_msg.m_nentries > 0 ||
-		pgStatXactCommit > 0 || pgStatXactRollback > 0)
+		pgStatXactCommit > 0 || pgStatXactRollback > 0 ||
+		pgStatTempFiles > 0)
 		pgstat_send_tabstat(&regular_msg);
 	if (shared_msg.m_nentries > 0)
 		pgstat_send_tabstat(&shared_msg);
@@ -970,8 +992,8 @@ pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg)
 		return;
 
 	/*
-	 * Report and reset accumulated xact commit/rollback and I/O timings
-	 * whenever we send a normal tabstat message
+	 * Report and reset accumulated xact commit/rollback, I/O timings and
+	 * temporary files whenever we send a normal tabstat message
 	 */
 	if (OidIsValid(tsmsg->m_databaseid))
 	{
@@ -979,10 +1001,14 @@ pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg)
 		tsmsg->m_xact_rollback = pgStatXactRollback;
 		tsmsg->m_block_read_time = pgStatBlockReadTime;
 		tsmsg->m_block_write_time = pgStatBlockWriteTime;
+		tsmsg->m_temp_files = pgStatTempFiles;
+		tsmsg->m_temp_bytes = pgStatTempBytes;
 		pgStatXactCommit = 0;
 		pgStatXactRollback = 0;
 		pgStatBlockReadTime = 0;
 		pgStatBlockWriteTime = 0;
+		pgStatTempFiles = 0;
+		pgStatTempBytes = 0;
 	}
 	else
 	{
@@ -990,6 +1016,8 @@ pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg)
 		tsmsg->m_xact_rollback = 0;
 		tsmsg->m_block_read_time = 0;
 		tsmsg->m_block_write_time = 0;
+		tsmsg->m_temp_files = 0;
+		tsmsg->m_temp_bytes = 0;
 	}
 
 	n = tsmsg->m_nentries;
@@ -1788,7 +1816,10 @@ pgstat_report_checksum_failure(void)
 /* --------
  * pgstat_report_tempfile() -
  *
- *	Tell the collector about a temporary file.
+ *	Tell the collector about a temporary file.  Backends connected to a
+ *	database count the file locally, and pgstat_report_stat() sends the
+ *	counts along with their table statistics; other processes may never
+ *	call that, so they send a message right away.
  * --------
  */
 void
@@ -1799,6 +1830,13 @@ pgstat_report_tempfile(size_t filesize)
 	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
 		return;
 
+	if (OidIsValid(MyDatabaseId))
+	{
+		pgStatTempFiles++;
+		pgStatTempBytes += filesize;
+		return;
+	}
+
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_TEMPFILE);
 	msg.m_databaseid = MyDatabaseId;
 	msg.m_filesize = filesize;
@@ -3856,6 +3894,7 @@ pgstat_write_db_statsfile(PgStat_StatDBEntry *dbentry, bool permanent)
 						tmpfile)));
 		return;
 	}
+	setvbuf(fpout, NULL, _IOFBF, PGSTAT_FILE_BUFSIZE);
 
 	/*
 	 * Write the file header --- currently just a format ID.
@@ -4285,6 +4324,7 @@ pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
 							statfile)));
 		return;
 	}
+	setvbuf(fpin, NULL, _IOFBF, PGSTAT_FILE_BUFSIZE);
 
 	/*
 	 * Verify it's of the expected format.
@@ -4892,6 +4932,8 @@ pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len)
 	dbentry->n_xact_rollback += (PgStat_Counter) (msg->m_xact_rollback);
 	dbentry->n_block_read_time += msg->m_block_read_time;
 	dbentry->n_block_write_time += msg->m_block_write_time;
+	dbentry->n_temp_files += msg->m_temp_files;
+	dbentry->n_temp_bytes += msg->m_temp_bytes;
 
 	/*
 	 * Process all table entries in the message.
@@ -237,6 +237,7 @@ int			AuthenticationTimeout = 60;
 
 bool		log_hostname;		/* for ps display and logging */
 bool		Log_connections = false;
+ConnectionTiming conn_timing = {0};
 bool		Db_user_namespace = false;
 
 bool		enable_bonjour = false;
@@ -523,6 +524,7 @@ typedef struct
 	bool		IsBinaryUpgrade;
 	int			max_safe_fds;
 	int			MaxBackends;
+	int			FastPathLockGroupsPerBackend;
 #ifdef WIN32
 	HANDLE		PostmasterHandle;
 	HANDLE		initial_signal_pipe;
@@ -1011,6 +1013,9 @@ PostmasterMain(int argc, char *argv[])
 	 */
 	InitializeMaxBackends();
 
+	/* Size the fast-path lock arrays according to max_locks_per_transaction */
+	InitializeFastPathLocks();
+
 	/*
 	 * Set up shared memory and semaphores.
 	 */
@@ -4187,6 +4192,8 @@ BackendStartup(Port *port)
 #ifdef EXEC_BACKEND
 	pid = backend_forkexec(port);
 #else							/* !EXEC_BACKEND */
+	if (Log_connections)
+		conn_timing.fork_start = GetCurrentTimestamp();
 	pid = fork_process();
 	if (pid == 0)				/* child */
 	{
@@ -6165,6 +6172,7 @@ save_backend_variables(BackendParameters *param, Port *port,
 	param->max_safe_fds = max_safe_fds;
 
 	param->MaxBackends = MaxBackends;
+	param->FastPathLockGroupsPerBackend = FastPathLockGroupsPerBackend;
 
 #ifdef WIN32
 	param->PostmasterHandle = PostmasterHandle;
@@ -6398,6 +6406,7 @@ restore_backend_variables(BackendParameters *param, Port *port)
 	max_safe_fds = param->max_safe_fds;
 
 	MaxBackends = param->MaxBackends;
+	FastPathLockGroupsPerBackend = param->FastPathLockGroupsPerBackend;
 
 #ifdef WIN32
 	PostmasterHandle = param->PostmasterHandle;
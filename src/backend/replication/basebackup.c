@@ -12,6 +12,7 @@
  */
 #include "postgres.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <time.h>
@@ -81,6 +82,7 @@ static int	compareWalFileNames(const ListCell *a, const ListCell *b);
 static void throttle(size_t increment);
 static void update_basebackup_progress(int64 delta);
 static bool is_checksummed_file(const char *fullpath, const char *filename);
+static void basebackup_prefetch_file(int fd, off_t offset, size_t nbytes);
 static int	basebackup_read_file(int fd, char *buf, size_t nbytes, off_t offset,
 								 const char *filename, bool partial_read_ok);
 
@@ -95,6 +97,14 @@ static char *statrelpath = NULL;
  */
 #define TAR_SEND_SIZE 32768
 
+/*
+ * How far ahead of the send position of a file to ask the kernel to read.
+ * File data is read synchronously, so without this the disk sits idle while
+ * each block is being checksummed and sent.  Must be a multiple of
+ * TAR_SEND_SIZE.
+ */
+#define BASEBACKUP_PREFETCH_DISTANCE (32 * TAR_SEND_SIZE)
+
 /*
  * How frequently to throttle, as a fraction of the specified rate-second.
  */
@@ -1595,6 +1605,7 @@ sendFile(const char *readfilename, const char *tarfilename,
 	char	   *segmentpath;
 	bool		verify_checksum = false;
 	pg_checksum_context checksum_ctx;
+	pgoff_t		prefetched;
 
 	if (pg_checksum_init(&checksum_ctx, manifest->checksum_type) < 0)
 		elog(ERROR, "could not initialize checksum of file \"%s\"",
@@ -1649,8 +1660,22 @@ sendFile(const char *readfilename, const char *tarfilename,
 	 * for a base backup we can ignore such extended data. It will be restored
 	 * from WAL.
 	 */
+	prefetched = Min(statbuf->st_size, BASEBACKUP_PREFETCH_DISTANCE);
+	if (prefetched > TAR_SEND_SIZE)
+		basebackup_prefetch_file(fd, 0, prefetched);
+
 	while (len < statbuf->st_size)
 	{
+		/* Keep the read-ahead window BASEBACKUP_PREFETCH_DISTANCE wide */
+		if (prefetched < statbuf->st_size)
+		{
+			size_t		nbytes = Min(TAR_SEND_SIZE,
+									 statbuf->st_size - prefetched);
+
+			basebackup_prefetch_file(fd, prefetched, nbytes);
+			prefetched += nbytes;
+		}
+
 		/* Try to read some more data. */
 		cnt = basebackup_read_file(fd, buf,
 								   Min(sizeof(buf), statbuf->st_size - len),
@@ -1995,6 +2020,19 @@ update_basebackup_progress(int64 delta)
 	pgstat_progress_update_multi_param(nparam, index, val);
 }
 
+/*
+ * Ask the kernel to start reading part of a file that we will soon send.
+ *
+ * This is only a hint, so any failure is ignored.
+ */
+static void
+basebackup_prefetch_file(int fd, off_t offset, size_t nbytes)
+{
+#if defined(USE_PREFETCH) && defined(POSIX_FADV_WILLNEED)
+	(void) posix_fadvise(fd, offset, nbytes, POSIX_FADV_WILLNEED);
+#endif
+}
+
 /*
  * Read some data from a file, setting a wait event and reporting any error
  * encountered.
@@ -456,9 +456,23 @@ libpqrcv_startstreaming(WalReceiverConn *conn,
 		appendStringInfoChar(&cmd, ')');
 	}
 	else
+	{
 		appendStringInfo(&cmd, " TIMELINE %u",
 						 options->proto.physical.startpointTLI);
 
+		switch ((WalCompression) options->proto.physical.compression)
+		{
+			case WAL_COMPRESSION_NONE:
+				break;
+			case WAL_COMPRESSION_PGLZ:
+				appendStringInfoString(&cmd, " (compression 'pglz')");
+				break;
+			case WAL_COMPRESSION_LZ4:
+				appendStringInfoString(&cmd, " (compression 'lz4')");
+				break;
+		}
+	}
+
 	/* Start streaming. */
 	res = libpqrcv_PQexec(conn->streamConn, cmd.data);
 	pfree(cmd.data);
@@ -131,12 +131,26 @@ typedef struct ReorderBufferTupleCidEnt
 	CommandId	combocid;		/* just for debugging */
 } ReorderBufferTupleCidEnt;
 
-/* Virtual file descriptor with file offset tracking */
+/*
+ * Spilled changes are written and read back in chunks of this size, rather
+ * than with one or two system calls per change.
+ */
+#define REORDER_BUFFER_SPILL_WRITE_SIZE		(64 * 1024)
+#define REORDER_BUFFER_SPILL_READ_SIZE		(8 * 1024)
+
+/*
+ * Virtual file descriptor with file offset tracking.  Reads are buffered in
+ * readbuf, which holds readlen bytes ending just before curOffset, of which
+ * the ones from readpos on have not been consumed yet.
+ */
 typedef struct TXNEntryFile
 {
 	File		vfd;			/* -1 when the file is closed */
 	off_t		curOffset;		/* offset for next write or read. Reset to 0
 								 * when vfd is opened. */
+	char	   *readbuf;		/* allocated when vfd is opened */
+	int			readpos;
+	int			readlen;
 } TXNEntryFile;
 
 /* k-way in-order change iteration support structures */
@@ -246,8 +260,14 @@ static void ReorderBufferCheckMemoryLimit(ReorderBuffer *rb);
 static void ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
 static void ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 										 int fd, ReorderBufferChange *change);
+static void ReorderBufferWriteSpill(ReorderBuffer *rb, ReorderBufferTXN *txn,
+									int fd, char *data, Size len);
+static void ReorderBufferFlushSpill(ReorderBuffer *rb, ReorderBufferTXN *txn,
+									int fd);
 static Size ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 										TXNEntryFile *file, XLogSegNo *segno);
+static int	ReorderBufferReadSpill(TXNEntryFile *file, char *dest, int len);
+static void ReorderBufferCloseSpill(TXNEntryFile *file);
 static void ReorderBufferRestoreChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 									   char *change);
 static void ReorderBufferRestoreCleanup(ReorderBuffer *rb, ReorderBufferTXN *txn);
@@ -342,6 +362,8 @@ ReorderBufferAllocate(void)
 
 	buffer->outbuf = NULL;
 	buffer->outbufsize = 0;
+	buffer->spillbuf = NULL;
+	buffer->spillbuflen = 0;
 	buffer->size = 0;
 
 	buffer->spillTxns = 0;
@@ -1403,7 +1425,7 @@ ReorderBufferIterTXNFinish(ReorderBuffer *rb,
 	for (off = 0; off < state->nr_txns; off++)
 	{
 		if (state->entries[off].file.vfd != -1)
-			FileClose(state->entries[off].file.vfd);
+			ReorderBufferCloseSpill(&state->entries[off].file);
 	}
 
 	/* free memory we might have "leaked" in the last *Next call */
@@ -3491,7 +3513,10 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 			char		path[MAXPGPATH];
 
 			if (fd != -1)
+			{
+				ReorderBufferFlushSpill(rb, txn, fd);
 				CloseTransientFile(fd);
+			}
 
 			XLByteToSeg(change->lsn, curOpenSegNo, wal_segment_size);
 
@@ -3535,7 +3560,10 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	txn->txn_flags |= RBTXN_IS_SERIALIZED;
 
 	if (fd != -1)
+	{
+		ReorderBufferFlushSpill(rb, txn, fd);
 		CloseTransientFile(fd);
+	}
 }
 
 /*
@@ -3723,9 +3751,82 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	ondisk->size = sz;
 
+	ReorderBufferWriteSpill(rb, txn, fd, rb->outbuf, ondisk->size);
+
+	/*
+	 * Keep the transaction's final_lsn up to date with each change we send to
+	 * disk, so that ReorderBufferRestoreCleanup works correctly.  (We used to
+	 * only do this on commit and abort records, but that doesn't work if a
+	 * system crash leaves a transaction without its abort record).
+	 *
+	 * Make sure not to move it backwards.
+	 */
+	if (txn->final_lsn < change->lsn)
+		txn->final_lsn = change->lsn;
+
+	Assert(ondisk->change.action == change->action);
+}
+
+/*
+ * Queue serialized change data for writing to the spill file fd.
+ *
+ * Small changes are collected in rb->spillbuf and written out together once
+ * it fills up; the caller must call ReorderBufferFlushSpill() before closing
+ * fd.  Changes too big for the buffer are written directly.
+ */
+static void
+ReorderBufferWriteSpill(ReorderBuffer *rb, ReorderBufferTXN *txn, int fd,
+						char *data, Size len)
+{
+	if (rb->spillbuf == NULL)
+		rb->spillbuf = MemoryContextAlloc(rb->context,
+										  REORDER_BUFFER_SPILL_WRITE_SIZE);
+
+	if (rb->spillbuflen + len > REORDER_BUFFER_SPILL_WRITE_SIZE)
+		ReorderBufferFlushSpill(rb, txn, fd);
+
+	if (len > REORDER_BUFFER_SPILL_WRITE_SIZE)
+	{
+		errno = 0;
+		pgstat_report_wait_start(WAIT_EVENT_REORDER_BUFFER_WRITE);
+		if (write(fd, data, len) != len)
+		{
+			int			save_errno = errno;
+
+			CloseTransientFile(fd);
+
+			/* if write didn't set errno, assume problem is no disk space */
+			errno = save_errno ? save_errno : ENOSPC;
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to data file for XID %u: %m",
+							txn->xid)));
+		}
+		pgstat_report_wait_end();
+		return;
+	}
+
+	memcpy(rb->spillbuf + rb->spillbuflen, data, len);
+	rb->spillbuflen += len;
+}
+
+/*
+ * Write out the changes collected by ReorderBufferWriteSpill().
+ */
+static void
+ReorderBufferFlushSpill(ReorderBuffer *rb, ReorderBufferTXN *txn, int fd)
+{
+	Size		len = rb->spillbuflen;
+
+	if (len == 0)
+		return;
+
+	/* forget the data even on failure, it belongs to this file only */
+	rb->spillbuflen = 0;
+
 	errno = 0;
 	pgstat_report_wait_start(WAIT_EVENT_REORDER_BUFFER_WRITE);
-	if (write(fd, rb->outbuf, ondisk->size) != ondisk->size)
+	if (write(fd, rb->spillbuf, len) != len)
 	{
 		int			save_errno = errno;
 
@@ -3739,19 +3840,6 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 						txn->xid)));
 	}
 	pgstat_report_wait_end();
-
-	/*
-	 * Keep the transaction's final_lsn up to date with each change we send to
-	 * disk, so that ReorderBufferRestoreCleanup works correctly.  (We used to
-	 * only do this on commit and abort records, but that doesn't work if a
-	 * system crash leaves a transaction without its abort record).
-	 *
-	 * Make sure not to move it backwards.
-	 */
-	if (txn->final_lsn < change->lsn)
-		txn->final_lsn = change->lsn;
-
-	Assert(ondisk->change.action == change->action);
 }
 
 /* Returns true, if the output plugin supports streaming, false, otherwise. */
@@ -4040,6 +4128,8 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 			/* No harm in resetting the offset even in case of failure */
 			file->curOffset = 0;
+			file->readpos = 0;
+			file->readlen = 0;
 
 			if (*fd < 0 && errno == ENOENT)
 			{
@@ -4052,6 +4142,10 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 						(errcode_for_file_access(),
 						 errmsg("could not open file \"%s\": %m",
 								path)));
+
+			if (file->readbuf == NULL)
+				file->readbuf = MemoryContextAlloc(rb->context,
+												   REORDER_BUFFER_SPILL_READ_SIZE);
 		}
 
 		/*
@@ -4060,15 +4154,13 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 		 * end of this file.
 		 */
 		ReorderBufferSerializeReserve(rb, sizeof(ReorderBufferDiskChange));
-		readBytes = FileRead(file->vfd, rb->outbuf,
-							 sizeof(ReorderBufferDiskChange),
-							 file->curOffset, WAIT_EVENT_REORDER_BUFFER_READ);
+		readBytes = ReorderBufferReadSpill(file, rb->outbuf,
+										   sizeof(ReorderBufferDiskChange));
 
 		/* eof */
 		if (readBytes == 0)
 		{
-			FileClose(*fd);
-			*fd = -1;
+			ReorderBufferCloseSpill(file);
 			(*segno)++;
 			continue;
 		}
@@ -4083,19 +4175,15 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 							readBytes,
 							(uint32) sizeof(ReorderBufferDiskChange))));
 
-		file->curOffset += readBytes;
-
 		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
 
 		ReorderBufferSerializeReserve(rb,
 									  sizeof(ReorderBufferDiskChange) + ondisk->size);
 		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
 
-		readBytes = FileRead(file->vfd,
-							 rb->outbuf + sizeof(ReorderBufferDiskChange),
-							 ondisk->size - sizeof(ReorderBufferDiskChange),
-							 file->curOffset,
-							 WAIT_EVENT_REORDER_BUFFER_READ);
+		readBytes = ReorderBufferReadSpill(file,
+										   rb->outbuf + sizeof(ReorderBufferDiskChange),
+										   ondisk->size - sizeof(ReorderBufferDiskChange));
 
 		if (readBytes < 0)
 			ereport(ERROR,
@@ -4108,8 +4196,6 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 							readBytes,
 							(uint32) (ondisk->size - sizeof(ReorderBufferDiskChange)))));
 
-		file->curOffset += readBytes;
-
 		/*
 		 * ok, read a full change from disk, now restore it into proper
 		 * in-memory format
@@ -4121,6 +4207,83 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	return restored;
 }
 
+/*
+ * Read up to len bytes from a spill file opened by
+ * ReorderBufferRestoreChanges(), going through the file's read buffer.
+ *
+ * Returns the number of bytes read, which is less than len only at the end
+ * of the file.
+ */
+static int
+ReorderBufferReadSpill(TXNEntryFile *file, char *dest, int len)
+{
+	int			done = 0;
+
+	while (done < len)
+	{
+		int			avail = file->readlen - file->readpos;
+		int			readBytes;
+
+		if (avail > 0)
+		{
+			int			n = Min(avail, len - done);
+
+			memcpy(dest + done, file->readbuf + file->readpos, n);
+			file->readpos += n;
+			done += n;
+			continue;
+		}
+
+		/* Large remainders bypass the buffer */
+		if (len - done >= REORDER_BUFFER_SPILL_READ_SIZE)
+		{
+			readBytes = FileRead(file->vfd, dest + done, len - done,
+								 file->curOffset,
+								 WAIT_EVENT_REORDER_BUFFER_READ);
+			if (readBytes < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read from reorderbuffer spill file: %m")));
+			file->curOffset += readBytes;
+			done += readBytes;
+			break;
+		}
+
+		readBytes = FileRead(file->vfd, file->readbuf,
+							 REORDER_BUFFER_SPILL_READ_SIZE,
+							 file->curOffset, WAIT_EVENT_REORDER_BUFFER_READ);
+		if (readBytes < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read from reorderbuffer spill file: %m")));
+		file->curOffset += readBytes;
+		file->readpos = 0;
+		file->readlen = readBytes;
+
+		if (readBytes == 0)
+			break;				/* eof */
+	}
+
+	return done;
+}
+
+/*
+ * Close a spill file opened by ReorderBufferRestoreChanges().
+ */
+static void
+ReorderBufferCloseSpill(TXNEntryFile *file)
+{
+	FileClose(file->vfd);
+	file->vfd = -1;
+	if (file->readbuf != NULL)
+	{
+		pfree(file->readbuf);
+		file->readbuf = NULL;
+	}
+	file->readpos = 0;
+	file->readlen = 0;
+}
+
 /*
  * Convert change from its on-disk format to in-memory format and queue it onto
  * the TXN's ->changes list.
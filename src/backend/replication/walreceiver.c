@@ -50,6 +50,9 @@
 #include "postgres.h"
 
 #include <unistd.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
 
 #include "access/htup_details.h"
 #include "access/timeline.h"
@@ -59,6 +62,7 @@
 #include "catalog/pg_authid.h"
 #include "catalog/pg_type.h"
 #include "common/ip.h"
+#include "common/pg_lzcompress.h"
 #include "funcapi.h"
 #include "libpq/pqformat.h"
 #include "libpq/pqsignal.h"
@@ -88,6 +92,7 @@
  */
 int			wal_receiver_status_interval;
 int			wal_receiver_timeout;
+int			wal_receiver_compression = WAL_COMPRESSION_NONE;	/* WalCompression */
 bool		hot_standby_feedback;
 
 /* libpqwalreceiver connection */
@@ -96,6 +101,14 @@ WalReceiverFunctionsType *WalReceiverFunctions = NULL;
 
 #define NAPTIME_PER_CYCLE 100	/* max sleep time between cycles (100ms) */
 
+/*
+ * While the primary keeps sending data faster than we can drain the socket,
+ * flush and report our position whenever this much WAL has been written but
+ * not flushed, rather than waiting for the stream to pause.  This matches
+ * the default of wal_writer_flush_after.
+ */
+#define WALRCV_FLUSH_AFTER		(1024 * 1024)
+
 /*
  * These variables are used similarly to openLogFile/SegNo,
  * but for walreceiver to write the XLOG. recvFileTLI is the TimeLineID
@@ -117,6 +130,7 @@ static struct
 
 static StringInfoData reply_message;
 static StringInfoData incoming_message;
+static StringInfoData decompressed_message;
 
 /* Prototypes for private functions */
 static void WalRcvFetchTimeLineHistoryFiles(TimeLineID first, TimeLineID last);
@@ -388,6 +402,7 @@ WalReceiverMain(void)
 		options.startpoint = startpoint;
 		options.slotname = slotname[0] != '\0' ? slotname : NULL;
 		options.proto.physical.startpointTLI = startpointTLI;
+		options.proto.physical.compression = wal_receiver_compression;
 		ThisTimeLineID = startpointTLI;
 		if (walrcv_startstreaming(wrconn, &options))
 		{
@@ -405,6 +420,7 @@ WalReceiverMain(void)
 			LogstreamResult.Write = LogstreamResult.Flush = GetXLogReplayRecPtr(NULL);
 			initStringInfo(&reply_message);
 			initStringInfo(&incoming_message);
+			initStringInfo(&decompressed_message);
 
 			/* Initialize the last recv timestamp */
 			last_recv_timestamp = GetCurrentTimestamp();
@@ -456,6 +472,16 @@ WalReceiverMain(void)
 							last_recv_timestamp = GetCurrentTimestamp();
 							ping_sent = false;
 							XLogWalRcvProcessMsg(buf[0], &buf[1], len - 1);
+
+							/*
+							 * Under a continuous stream the loop might not
+							 * exit for a long time, and synchronous commits
+							 * on the primary would wait for all of it.  So
+							 * flush periodically.  This also sends a reply.
+							 */
+							if (LogstreamResult.Write - LogstreamResult.Flush >=
+								WALRCV_FLUSH_AFTER)
+								XLogWalRcvFlush(false);
 						}
 						else if (len == 0)
 							break;
@@ -833,6 +859,73 @@ XLogWalRcvProcessMsg(unsigned char type, char *buf, Size len)
 				XLogWalRcvWrite(buf, len, dataStart);
 				break;
 			}
+		case 'z':				/* compressed WAL records */
+			{
+				uint8		method;
+				int32		rawlen;
+				int32		decomplen = -1;
+
+				/* copy message to StringInfo */
+				hdrlen = sizeof(int64) + sizeof(int64) + sizeof(int64) +
+					sizeof(uint8) + sizeof(int32);
+				if (len < hdrlen)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid compressed WAL message received from primary")));
+				appendBinaryStringInfo(&incoming_message, buf, hdrlen);
+
+				/* read the fields */
+				dataStart = pq_getmsgint64(&incoming_message);
+				walEnd = pq_getmsgint64(&incoming_message);
+				sendTime = pq_getmsgint64(&incoming_message);
+				method = pq_getmsgbyte(&incoming_message);
+				rawlen = pq_getmsgint(&incoming_message, 4);
+				ProcessWalSndrMessage(walEnd, sendTime);
+
+				if (rawlen <= 0 || !AllocSizeIsValid(rawlen))
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid compressed WAL message received from primary")));
+
+				buf += hdrlen;
+				len -= hdrlen;
+
+				resetStringInfo(&decompressed_message);
+				enlargeStringInfo(&decompressed_message, rawlen);
+
+				switch (method)
+				{
+					case WAL_COMPRESSION_PGLZ:
+						decomplen = pglz_decompress(buf, len,
+													decompressed_message.data,
+													rawlen, true);
+						break;
+					case WAL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+						decomplen = LZ4_decompress_safe(buf,
+														decompressed_message.data,
+														len, rawlen);
+#else
+						ereport(ERROR,
+								(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+								 errmsg("WAL received from primary is compressed with LZ4, which is not supported by this build")));
+#endif
+						break;
+					default:
+						ereport(ERROR,
+								(errcode(ERRCODE_PROTOCOL_VIOLATION),
+								 errmsg_internal("invalid WAL compression method %u received from primary",
+												 method)));
+				}
+
+				if (decomplen != rawlen)
+					ereport(ERROR,
+							(errcode(ERRCODE_DATA_CORRUPTED),
+							 errmsg_internal("compressed WAL data received from primary is corrupt")));
+
+				XLogWalRcvWrite(decompressed_message.data, rawlen, dataStart);
+				break;
+			}
 		case 'k':				/* Keepalive */
 			{
 				/* copy message to StringInfo */
@@ -48,6 +48,9 @@
 
 #include <signal.h>
 #include <unistd.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
 
 #include "access/printtup.h"
 #include "access/timeline.h"
@@ -60,6 +63,7 @@
 #include "catalog/pg_type.h"
 #include "commands/dbcommands.h"
 #include "commands/defrem.h"
+#include "common/pg_lzcompress.h"
 #include "funcapi.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
@@ -105,6 +109,14 @@
  */
 #define MAX_SEND_SIZE (XLOG_BLCKSZ * 16)
 
+/*
+ * WalSndWriteData() lets this much logical decoding output accumulate in the
+ * send buffer before trying to flush it, rather than issuing a send() for
+ * every change.  WalSndLoop() flushes whatever is left once the current WAL
+ * record has been decoded.
+ */
+#define LOGICAL_SEND_BATCH_SIZE (64 * 1024)
+
 /* Array of WalSnds in shared memory */
 WalSndCtlData *WalSndCtl = NULL;
 
@@ -123,6 +135,7 @@ int			max_wal_senders = 0;	/* the maximum number of concurrent
 int			wal_sender_timeout = 60 * 1000; /* maximum time to send one WAL
 											 * data message */
 bool		log_replication_commands = false;
+bool		wal_sender_allow_compression = true;
 
 /*
  * State for WalSndWakeupRequest
@@ -155,6 +168,10 @@ static XLogRecPtr sentPtr = InvalidXLogRecPtr;
 
 /* Buffers for constructing outgoing messages and processing reply messages. */
 static StringInfoData output_message;
+static char *compress_buf = NULL;	/* scratch space for WalSndCompressXLogData */
+
+/* Compression the client asked for in START_REPLICATION */
+static WalCompression send_compression = WAL_COMPRESSION_NONE;
 static StringInfoData reply_message;
 static StringInfoData tmpbuf;
 
@@ -228,12 +245,14 @@ static void InitWalSenderSlot(void);
 static void WalSndKill(int code, Datum arg);
 static void WalSndShutdown(void) pg_attribute_noreturn();
 static void XLogSendPhysical(void);
+static void WalSndCompressXLogData(int nbytes);
 static void XLogSendLogical(void);
 static void WalSndDone(WalSndSendDataCallback send_data);
 static XLogRecPtr GetStandbyFlushRecPtr(void);
 static void IdentifySystem(void);
 static void CreateReplicationSlot(CreateReplicationSlotCmd *cmd);
 static void DropReplicationSlot(DropReplicationSlotCmd *cmd);
+static void parseStartReplicationOptions(StartReplicationCmd *cmd);
 static void StartReplication(StartReplicationCmd *cmd);
 static void StartLogicalReplication(StartReplicationCmd *cmd);
 static void ProcessStandbyMessage(void);
@@ -561,6 +580,75 @@ SendTimeLineHistory(TimeLineHistoryCmd *cmd)
 	pq_endmessage(&buf);
 }
 
+/*
+ * Process the options of a physical START_REPLICATION command.
+ *
+ * The only option is the compression of the streamed WAL.  It has to be
+ * requested by the client, since only clients that asked for it can be
+ * expected to understand compressed XLogData messages.  A client that asks
+ * for compression also accepts plain XLogData, and pglz is always available
+ * to it, so if we can't compress as asked we fall back rather than fail.
+ */
+static void
+parseStartReplicationOptions(StartReplicationCmd *cmd)
+{
+	ListCell   *lc;
+	bool		compression_given = false;
+
+	send_compression = WAL_COMPRESSION_NONE;
+
+	foreach(lc, cmd->options)
+	{
+		DefElem    *defel = (DefElem *) lfirst(lc);
+
+		if (strcmp(defel->defname, "compression") == 0)
+		{
+			char	   *method;
+
+			if (compression_given)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			compression_given = true;
+
+			method = defGetString(defel);
+			if (pg_strcasecmp(method, "off") == 0)
+				send_compression = WAL_COMPRESSION_NONE;
+			else if (pg_strcasecmp(method, "pglz") == 0)
+				send_compression = WAL_COMPRESSION_PGLZ;
+			else if (pg_strcasecmp(method, "lz4") == 0)
+			{
+#ifdef USE_LZ4
+				send_compression = WAL_COMPRESSION_LZ4;
+#else
+				ereport(LOG,
+						(errmsg("compressing streamed WAL with pglz instead of lz4"),
+						 errdetail("This server was built without lz4 support.")));
+				send_compression = WAL_COMPRESSION_PGLZ;
+#endif
+			}
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("unrecognized WAL compression method \"%s\"",
+								method)));
+		}
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("unrecognized START_REPLICATION option \"%s\"",
+							defel->defname)));
+	}
+
+	if (send_compression != WAL_COMPRESSION_NONE &&
+		!wal_sender_allow_compression)
+	{
+		ereport(LOG,
+				(errmsg("not compressing streamed WAL because wal_sender_allow_compression is off")));
+		send_compression = WAL_COMPRESSION_NONE;
+	}
+}
+
 /*
  * Handle START_REPLICATION command.
  *
@@ -578,6 +666,8 @@ StartReplication(StartReplicationCmd *cmd)
 				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 				 errmsg("IDENTIFY_SYSTEM has not been run before START_REPLICATION")));
 
+	parseStartReplicationOptions(cmd);
+
 	/* create xlogreader for physical replication */
 	xlogreader =
 		XLogReaderAllocate(wal_segment_size, NULL, wal_segment_close);
@@ -1258,6 +1348,7 @@ static void
 WalSndWriteData(LogicalDecodingContext *ctx, XLogRecPtr lsn, TransactionId xid,
 				bool last_write)
 {
+	static Size unflushed_bytes = 0;
 	TimestampTz now;
 
 	/*
@@ -1273,9 +1364,21 @@ WalSndWriteData(LogicalDecodingContext *ctx, XLogRecPtr lsn, TransactionId xid,
 
 	/* output previously gathered data in a CopyData packet */
 	pq_putmessage_noblock('d', ctx->out->data, ctx->out->len);
+	unflushed_bytes += ctx->out->len;
 
 	CHECK_FOR_INTERRUPTS();
 
+	/*
+	 * Batch small messages, as long as we're not getting close to the
+	 * walsender timeout.
+	 */
+	if (unflushed_bytes < LOGICAL_SEND_BATCH_SIZE &&
+		(wal_sender_timeout <= 0 ||
+		 now < TimestampTzPlusMilliseconds(last_reply_timestamp,
+										   wal_sender_timeout / 2)))
+		return;
+	unflushed_bytes = 0;
+
 	/* Try to flush pending output to the client */
 	if (pq_flush_if_writable() != 0)
 		WalSndShutdown();
@@ -2787,8 +2890,12 @@ retry:
 	output_message.len += nbytes;
 	output_message.data[output_message.len] = '\0';
 
+	if (send_compression != WAL_COMPRESSION_NONE)
+		WalSndCompressXLogData(nbytes);
+
 	/*
 	 * Fill the send timestamp last, so that it is taken as late as possible.
+	 * Its offset is the same for compressed messages.
 	 */
 	resetStringInfo(&tmpbuf);
 	pq_sendint64(&tmpbuf, GetCurrentTimestamp());
@@ -2819,6 +2926,67 @@ retry:
 	}
 }
 
+/*
+ * Replace the XLogData message just built in output_message, carrying nbytes
+ * of WAL, with a compressed XLogData message if that makes it smaller.
+ *
+ * The compressed message has the same header as XLogData, except for its
+ * type byte, followed by the compression method as a byte and the
+ * uncompressed length as an Int32.
+ */
+static void
+WalSndCompressXLogData(int nbytes)
+{
+	const int	hdrlen = 1 + sizeof(int64) * 3;
+	char	   *source = &output_message.data[hdrlen];
+	int			maxlen = nbytes - 1 - sizeof(int32);
+	int			complen = -1;
+
+	Assert(output_message.len == hdrlen + nbytes);
+
+	if (maxlen <= 0)
+		return;
+
+	/* Big enough for any method, since we never accept a larger result */
+	if (compress_buf == NULL)
+		compress_buf = MemoryContextAlloc(TopMemoryContext,
+										  PGLZ_MAX_OUTPUT(MAX_SEND_SIZE));
+
+	switch (send_compression)
+	{
+		case WAL_COMPRESSION_PGLZ:
+			complen = pglz_compress(source, nbytes, compress_buf,
+									PGLZ_strategy_default);
+			break;
+
+		case WAL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			complen = LZ4_compress_default(source, compress_buf, nbytes,
+										   maxlen);
+			if (complen == 0)
+				complen = -1;
+#else
+			elog(ERROR, "LZ4 is not supported by this build");
+#endif
+			break;
+
+		case WAL_COMPRESSION_NONE:
+			Assert(false);		/* cannot happen */
+			break;
+			/* no default case, so that compiler will warn */
+	}
+
+	/* Send it uncompressed if compression didn't help enough */
+	if (complen < 0 || complen > maxlen)
+		return;
+
+	output_message.data[0] = 'z';
+	output_message.len = hdrlen;
+	pq_sendbyte(&output_message, (uint8) send_compression);
+	pq_sendint32(&output_message, nbytes);
+	appendBinaryStringInfo(&output_message, compress_buf, complen);
+}
+
 /*
  * Stream out logically decoded data.
  */
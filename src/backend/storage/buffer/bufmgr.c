@@ -689,6 +689,76 @@ ReadRecentBuffer(RelFileNode rnode, ForkNumber forkNum, BlockNumber blockNum,
 	return false;
 }
 
+/*
+ * CheckBuffersBeyondEOF -- sanity check before extending a relation without
+ *		going through shared buffers
+ *
+ * smgrzeroextend() callers use this to make the check that ReadBuffer() makes
+ * for P_NEW, for each of the nblocks blocks starting at firstBlock that are
+ * about to be added to the fork.  A valid buffer for one of them must hold an
+ * all-zeroes page, such as a failed read beyond EOF can leave behind with
+ * zero_damaged_pages; anything else means the size of the file we were told
+ * is wrong, and the new blocks would hide data behind a stale buffer.
+ *
+ * Only shared buffers are checked; temporary relations never have lock
+ * waiters to bulk-extend for.
+ */
+void
+CheckBuffersBeyondEOF(SMgrRelation smgr, ForkNumber forkNum,
+					  BlockNumber firstBlock, int nblocks)
+{
+	Assert(!SmgrIsTemp(smgr));
+
+	for (BlockNumber blockNum = firstBlock; blockNum < firstBlock + nblocks;
+		 blockNum++)
+	{
+		BufferTag	tag;
+		uint32		hash;
+		LWLock	   *partitionLock;
+		int			buf_id;
+		BufferDesc *bufHdr;
+		uint32		buf_state;
+		bool		isnew;
+
+		INIT_BUFFERTAG(tag, smgr->smgr_rnode.node, forkNum, blockNum);
+		hash = BufTableHashCode(&tag);
+		partitionLock = BufMappingPartitionLock(hash);
+
+		LWLockAcquire(partitionLock, LW_SHARED);
+		buf_id = BufTableLookup(&tag, hash);
+		LWLockRelease(partitionLock);
+
+		/* The usual case: the block has never been in the buffer pool */
+		if (buf_id < 0)
+			continue;
+
+		/*
+		 * Pin it if it still holds the block and is valid, as in
+		 * ReadRecentBuffer().  A buffer that isn't valid is reread from the
+		 * file when next used, so it does no harm.
+		 */
+		ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+		ReservePrivateRefCountEntry();
+		bufHdr = GetBufferDescriptor(buf_id);
+		buf_state = LockBufHdr(bufHdr);
+		if (!(buf_state & BM_VALID) || !BUFFERTAGS_EQUAL(tag, bufHdr->tag))
+		{
+			UnlockBufHdr(bufHdr, buf_state);
+			continue;
+		}
+		PinBuffer_Locked(bufHdr);
+
+		isnew = PageIsNew((Page) BufHdrGetBlock(bufHdr));
+		ReleaseBuffer(BufferDescriptorGetBuffer(bufHdr));
+
+		if (!isnew)
+			ereport(ERROR,
+					(errmsg("unexpected data beyond EOF in block %u of relation %s",
+							blockNum, relpath(smgr->smgr_rnode, forkNum)),
+					 errhint("This has been seen to occur with buggy kernels; consider updating your system.")));
+	}
+}
+
 /*
  * ReadBuffer -- a shorthand for ReadBufferExtended, for reading from main
  *		fork with RBM_NORMAL mode and default strategy.
@@ -2224,8 +2294,13 @@ BgBufferSync(WritebackContext *wb_context)
 	static float smoothed_alloc = 0;
 	static float smoothed_density = 10.0;
 
+	/* Moving average of the cycle-to-cycle change in allocations */
+	static uint32 prev_recent_alloc = 0;
+	static float smoothed_alloc_trend = 0;
+
 	/* Potentially these could be tunables, but for now, not */
 	float		smoothing_samples = 16;
+	float		trend_smoothing_samples = 4;
 	float		scan_whole_pool_milliseconds = 120000.0;
 
 	/* Used to compute how far we scan ahead */
@@ -2258,11 +2333,14 @@ BgBufferSync(WritebackContext *wb_context)
 	/*
 	 * If we're not running the LRU scan, just stop after doing the stats
 	 * stuff.  We mark the saved state invalid so that we can recover sanely
-	 * if LRU scan is turned back on later.
+	 * if LRU scan is turned back on later.  Keep prev_recent_alloc current
+	 * too, lest the first cycle after that see a bogus jump in allocations.
 	 */
 	if (bgwriter_lru_maxpages <= 0)
 	{
 		saved_info_valid = false;
+		prev_recent_alloc = recent_alloc;
+		smoothed_alloc_trend = 0;
 		return true;
 	}
 
@@ -2376,8 +2454,20 @@ BgBufferSync(WritebackContext *wb_context)
 		smoothed_alloc += ((float) recent_alloc - smoothed_alloc) /
 			smoothing_samples;
 
+	/*
+	 * Also track how fast allocations are growing.  While demand is ramping
+	 * up, following the last cycle's count still leaves us one cycle behind,
+	 * and the backends end up writing the dirty victims we didn't get to; so
+	 * extrapolate a rising trend into the next cycle.  A falling trend is
+	 * ignored, as the slow decline of smoothed_alloc already handles that.
+	 */
+	smoothed_alloc_trend += (((float) recent_alloc - (float) prev_recent_alloc) -
+							 smoothed_alloc_trend) / trend_smoothing_samples;
+	prev_recent_alloc = recent_alloc;
+
 	/* Scale the estimate by a GUC to allow more aggressive tuning. */
-	upcoming_alloc_est = (int) (smoothed_alloc * bgwriter_lru_multiplier);
+	upcoming_alloc_est = (int) ((smoothed_alloc + Max(smoothed_alloc_trend, 0)) *
+								bgwriter_lru_multiplier);
 
 	/*
 	 * If recent_alloc remains at zero for many cycles, smoothed_alloc will
@@ -2388,7 +2478,10 @@ BgBufferSync(WritebackContext *wb_context)
 	 * syndrome.  It will pop back up as soon as recent_alloc increases.
 	 */
 	if (upcoming_alloc_est == 0)
+	{
 		smoothed_alloc = 0;
+		smoothed_alloc_trend = 0;
+	}
 
 	/*
 	 * Even in cases where there's been little or no buffer allocation
@@ -2454,8 +2547,9 @@ BgBufferSync(WritebackContext *wb_context)
 	BgWriterStats.m_buf_written_clean += num_written;
 
 #ifdef BGW_DEBUG
-	elog(DEBUG1, "bgwriter: recent_alloc=%u smoothed=%.2f delta=%ld ahead=%d density=%.2f reusable_est=%d upcoming_est=%d scanned=%d wrote=%d reusable=%d",
-		 recent_alloc, smoothed_alloc, strategy_delta, bufs_ahead,
+	elog(DEBUG1, "bgwriter: recent_alloc=%u smoothed=%.2f trend=%.2f delta=%ld ahead=%d density=%.2f reusable_est=%d upcoming_est=%d scanned=%d wrote=%d reusable=%d",
+		 recent_alloc, smoothed_alloc, smoothed_alloc_trend,
+		 strategy_delta, bufs_ahead,
 		 smoothed_density, reusable_buffers_est, upcoming_alloc_est,
 		 bufs_to_lap - num_to_scan,
 		 num_written,
@@ -3081,7 +3175,7 @@ DropRelFileNodeBuffers(SMgrRelation smgr_reln, ForkNumber *forkNum,
 		if (rnode.backend == MyBackendId)
 		{
 			for (j = 0; j < nforks; j++)
-				DropRelFileNodeLocalBuffers(rnode.node, forkNum[j],
+				DropRelFileNodeLocalBuffers(smgr_reln, forkNum[j],
 											firstDelBlock[j]);
 		}
 		return;
@@ -3211,7 +3305,7 @@ DropRelFileNodesAllBuffers(SMgrRelation *smgr_reln, int nnodes)
 		if (RelFileNodeBackendIsTemp(smgr_reln[i]->smgr_rnode))
 		{
 			if (smgr_reln[i]->smgr_rnode.backend == MyBackendId)
-				DropRelFileNodeAllLocalBuffers(smgr_reln[i]->smgr_rnode.node);
+				DropRelFileNodeAllLocalBuffers(smgr_reln[i]);
 		}
 		else
 			rels[n++] = smgr_reln[i];
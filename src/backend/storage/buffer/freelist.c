@@ -103,6 +103,17 @@ static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
 static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
 
+/*
+ * To reduce contention on the shared nextVictimBuffer counter, each backend
+ * moves the clock hand forward by a batch of buffers at once, and then
+ * sweeps through the buffers of its batch privately.  The hand positions of
+ * the current batch are kept here.
+ */
+#define CLOCK_SWEEP_BATCH_SIZE	8
+
+static uint32 ClockSweepBatchNext = 0;
+static uint32 ClockSweepBatchEnd = 0;
+
 /*
  * ClockSweepTick - Helper routine for StrategyGetBuffer()
  *
@@ -112,36 +123,47 @@ static void AddBufferToRing(BufferAccessStrategy strategy,
 static inline uint32
 ClockSweepTick(void)
 {
-	uint32		victim;
+	if (ClockSweepBatchNext == ClockSweepBatchEnd)
+	{
+		uint32		batch;
+		uint32		start;
+		uint32		wrap_at;
 
-	/*
-	 * Atomically move hand ahead one buffer - if there's several processes
-	 * doing this, this can lead to buffers being returned slightly out of
-	 * apparent order.
-	 */
-	victim =
-		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+		/*
+		 * Keep batches small relative to the buffer pool, so that a batch can
+		 * never span more than one wraparound, and so that on a small pool
+		 * the sweep stays close to strict clock order.
+		 */
+		batch = Max(1, Min(CLOCK_SWEEP_BATCH_SIZE, NBuffers / 128));
 
-	if (victim >= NBuffers)
-	{
-		uint32		originalVictim = victim;
+		/*
+		 * Atomically move hand ahead by a batch of buffers - if there's
+		 * several processes doing this, this can lead to buffers being
+		 * returned slightly out of apparent order.
+		 */
+		start = pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer,
+										batch);
+		ClockSweepBatchNext = start;
+		ClockSweepBatchEnd = start + batch;
 
-		/* always wrap what we look up in BufferDescriptors */
-		victim = victim % NBuffers;
+		/* The first hand position at or after start that is a wraparound */
+		wrap_at = (start / NBuffers + 1) * NBuffers;
+		if (start % NBuffers == 0 && start >= NBuffers)
+			wrap_at = start;
 
 		/*
-		 * If we're the one that just caused a wraparound, force
-		 * completePasses to be incremented while holding the spinlock. We
-		 * need the spinlock so StrategySyncStart() can return a consistent
-		 * value consisting of nextVictimBuffer and completePasses.
+		 * If our batch includes a wraparound, force completePasses to be
+		 * incremented while holding the spinlock. We need the spinlock so
+		 * StrategySyncStart() can return a consistent value consisting of
+		 * nextVictimBuffer and completePasses.
 		 */
-		if (victim == 0)
+		if (wrap_at < ClockSweepBatchEnd)
 		{
 			uint32		expected;
 			uint32		wrapped;
 			bool		success = false;
 
-			expected = originalVictim + 1;
+			expected = ClockSweepBatchEnd;
 
 			while (!success)
 			{
@@ -165,7 +187,9 @@ ClockSweepTick(void)
 			}
 		}
 	}
-	return victim;
+
+	/* always wrap what we look up in BufferDescriptors */
+	return ClockSweepBatchNext++ % NBuffers;
 }
 
 /*
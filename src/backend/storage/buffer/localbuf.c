@@ -311,6 +311,90 @@ MarkLocalBufferDirty(Buffer buffer)
 	pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
 }
 
+/*
+ * If the number of blocks to be dropped is small compared to the number of
+ * local buffers, it's cheaper to look up each block in the hash table than to
+ * scan all the buffer headers, as DropRelFileNodeBuffers does for shared
+ * buffers.  That matters with a large temp_buffers setting and sessions that
+ * create and drop many small temporary tables.  Finding out the size of the
+ * relation may cost a few system calls, so with few local buffers we don't
+ * bother.
+ */
+#define LOCALBUF_DROP_FULL_SCAN_THRESHOLD	(uint64) (NLocBuffer / 32)
+#define LOCALBUF_DROP_LOOKUP_MIN_BUFFERS	4096
+
+/*
+ * InvalidateLocalBuffer -- remove a local buffer from the pool
+ *
+ * Its contents are dropped, even if dirty.
+ */
+static void
+InvalidateLocalBuffer(int bufid)
+{
+	BufferDesc *bufHdr = GetLocalBufferDescriptor(bufid);
+	LocalBufferLookupEnt *hresult;
+	uint32		buf_state;
+
+	if (LocalRefCount[bufid] != 0)
+		elog(ERROR, "block %u of %s is still referenced (local %u)",
+			 bufHdr->tag.blockNum,
+			 relpathbackend(bufHdr->tag.rnode, MyBackendId,
+							bufHdr->tag.forkNum),
+			 LocalRefCount[bufid]);
+	/* Remove entry from hashtable */
+	hresult = (LocalBufferLookupEnt *)
+		hash_search(LocalBufHash, (void *) &bufHdr->tag,
+					HASH_REMOVE, NULL);
+	if (!hresult)				/* shouldn't happen */
+		elog(ERROR, "local buffer hash table corrupted");
+	/* Mark buffer invalid */
+	CLEAR_BUFFERTAG(bufHdr->tag);
+	buf_state = pg_atomic_read_u32(&bufHdr->state);
+	buf_state &= ~BUF_FLAG_MASK;
+	buf_state &= ~BUF_USAGECOUNT_MASK;
+	pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
+}
+
+/*
+ * LocalRelationForkBlocks -- current size of a fork of a local relation
+ *
+ * Only this backend can extend the relation, and it writes out each new block
+ * as it adds it, so no local buffer can hold a block beyond this.
+ */
+static BlockNumber
+LocalRelationForkBlocks(SMgrRelation smgr, ForkNumber forkNum)
+{
+	/* The cached size is reliable, since no other backend can change it */
+	if (smgr->smgr_cached_nblocks[forkNum] != InvalidBlockNumber)
+		return smgr->smgr_cached_nblocks[forkNum];
+	if (!smgrexists(smgr, forkNum))
+		return 0;
+	return smgrnblocks(smgr, forkNum);
+}
+
+/*
+ * DropLocalBuffersByLookup -- remove the given range of blocks of one fork
+ *		from the pool, by looking up each block in the hash table
+ */
+static void
+DropLocalBuffersByLookup(RelFileNode rnode, ForkNumber forkNum,
+						 BlockNumber firstDelBlock, BlockNumber nblocks)
+{
+	BlockNumber blkno;
+
+	for (blkno = firstDelBlock; blkno < nblocks; blkno++)
+	{
+		BufferTag	tag;
+		LocalBufferLookupEnt *hresult;
+
+		INIT_BUFFERTAG(tag, rnode, forkNum, blkno);
+		hresult = (LocalBufferLookupEnt *)
+			hash_search(LocalBufHash, (void *) &tag, HASH_FIND, NULL);
+		if (hresult)
+			InvalidateLocalBuffer(hresult->id);
+	}
+}
+
 /*
  * DropRelFileNodeLocalBuffers
  *		This function removes from the buffer pool all the pages of the
@@ -323,15 +407,33 @@ MarkLocalBufferDirty(Buffer buffer)
  *		See DropRelFileNodeBuffers in bufmgr.c for more notes.
  */
 void
-DropRelFileNodeLocalBuffers(RelFileNode rnode, ForkNumber forkNum,
+DropRelFileNodeLocalBuffers(SMgrRelation smgr, ForkNumber forkNum,
 							BlockNumber firstDelBlock)
 {
+	RelFileNode rnode = smgr->smgr_rnode.node;
 	int			i;
 
+	/* Nothing to do if we never set up local buffers */
+	if (LocalBufHash == NULL)
+		return;
+
+	if (NLocBuffer >= LOCALBUF_DROP_LOOKUP_MIN_BUFFERS)
+	{
+		BlockNumber nblocks = LocalRelationForkBlocks(smgr, forkNum);
+
+		if (nblocks <= firstDelBlock)
+			return;
+
+		if ((uint64) (nblocks - firstDelBlock) < LOCALBUF_DROP_FULL_SCAN_THRESHOLD)
+		{
+			DropLocalBuffersByLookup(rnode, forkNum, firstDelBlock, nblocks);
+			return;
+		}
+	}
+
 	for (i = 0; i < NLocBuffer; i++)
 	{
 		BufferDesc *bufHdr = GetLocalBufferDescriptor(i);
-		LocalBufferLookupEnt *hresult;
 		uint32		buf_state;
 
 		buf_state = pg_atomic_read_u32(&bufHdr->state);
@@ -340,25 +442,7 @@ DropRelFileNodeLocalBuffers(RelFileNode rnode, ForkNumber forkNum,
 			RelFileNodeEquals(bufHdr->tag.rnode, rnode) &&
 			bufHdr->tag.forkNum == forkNum &&
 			bufHdr->tag.blockNum >= firstDelBlock)
-		{
-			if (LocalRefCount[i] != 0)
-				elog(ERROR, "block %u of %s is still referenced (local %u)",
-					 bufHdr->tag.blockNum,
-					 relpathbackend(bufHdr->tag.rnode, MyBackendId,
-									bufHdr->tag.forkNum),
-					 LocalRefCount[i]);
-			/* Remove entry from hashtable */
-			hresult = (LocalBufferLookupEnt *)
-				hash_search(LocalBufHash, (void *) &bufHdr->tag,
-							HASH_REMOVE, NULL);
-			if (!hresult)		/* shouldn't happen */
-				elog(ERROR, "local buffer hash table corrupted");
-			/* Mark buffer invalid */
-			CLEAR_BUFFERTAG(bufHdr->tag);
-			buf_state &= ~BUF_FLAG_MASK;
-			buf_state &= ~BUF_USAGECOUNT_MASK;
-			pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
-		}
+			InvalidateLocalBuffer(i);
 	}
 }
 
@@ -370,39 +454,46 @@ DropRelFileNodeLocalBuffers(RelFileNode rnode, ForkNumber forkNum,
  *		See DropRelFileNodesAllBuffers in bufmgr.c for more notes.
  */
 void
-DropRelFileNodeAllLocalBuffers(RelFileNode rnode)
+DropRelFileNodeAllLocalBuffers(SMgrRelation smgr)
 {
+	RelFileNode rnode = smgr->smgr_rnode.node;
 	int			i;
 
+	/* Nothing to do if we never set up local buffers */
+	if (LocalBufHash == NULL)
+		return;
+
+	if (NLocBuffer >= LOCALBUF_DROP_LOOKUP_MIN_BUFFERS)
+	{
+		BlockNumber nForkBlock[MAX_FORKNUM + 1];
+		uint64		nBlocksToInvalidate = 0;
+		ForkNumber	forkNum;
+
+		for (forkNum = 0; forkNum <= MAX_FORKNUM; forkNum++)
+		{
+			nForkBlock[forkNum] = LocalRelationForkBlocks(smgr, forkNum);
+			nBlocksToInvalidate += nForkBlock[forkNum];
+		}
+
+		if (nBlocksToInvalidate < LOCALBUF_DROP_FULL_SCAN_THRESHOLD)
+		{
+			for (forkNum = 0; forkNum <= MAX_FORKNUM; forkNum++)
+				DropLocalBuffersByLookup(rnode, forkNum, 0,
+										 nForkBlock[forkNum]);
+			return;
+		}
+	}
+
 	for (i = 0; i < NLocBuffer; i++)
 	{
 		BufferDesc *bufHdr = GetLocalBufferDescriptor(i);
-		LocalBufferLookupEnt *hresult;
 		uint32		buf_state;
 
 		buf_state = pg_atomic_read_u32(&bufHdr->state);
 
 		if ((buf_state & BM_TAG_VALID) &&
 			RelFileNodeEquals(bufHdr->tag.rnode, rnode))
-		{
-			if (LocalRefCount[i] != 0)
-				elog(ERROR, "block %u of %s is still referenced (local %u)",
-					 bufHdr->tag.blockNum,
-					 relpathbackend(bufHdr->tag.rnode, MyBackendId,
-									bufHdr->tag.forkNum),
-					 LocalRefCount[i]);
-			/* Remove entry from hashtable */
-			hresult = (LocalBufferLookupEnt *)
-				hash_search(LocalBufHash, (void *) &bufHdr->tag,
-							HASH_REMOVE, NULL);
-			if (!hresult)		/* shouldn't happen */
-				elog(ERROR, "local buffer hash table corrupted");
-			/* Mark buffer invalid */
-			CLEAR_BUFFERTAG(bufHdr->tag);
-			buf_state &= ~BUF_FLAG_MASK;
-			buf_state &= ~BUF_USAGECOUNT_MASK;
-			pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
-		}
+			InvalidateLocalBuffer(i);
 	}
 }
 
@@ -523,10 +614,13 @@ GetLocalBufferStorage(void)
 		/* But not more than what we need for all remaining local bufs */
 		num_bufs = Min(num_bufs, NLocBuffer - total_bufs_allocated);
 		/* And don't overflow MaxAllocSize, either */
-		num_bufs = Min(num_bufs, MaxAllocSize / BLCKSZ);
+		num_bufs = Min(num_bufs, (MaxAllocSize - PG_IO_ALIGN_SIZE) / BLCKSZ);
 
-		cur_block = (char *) MemoryContextAlloc(LocalBufferContext,
-												num_bufs * BLCKSZ);
+		/* Buffers must be aligned suitably for direct I/O */
+		cur_block = (char *)
+			TYPEALIGN(PG_IO_ALIGN_SIZE,
+					  MemoryContextAlloc(LocalBufferContext,
+										 num_bufs * BLCKSZ + PG_IO_ALIGN_SIZE));
 		next_buf_in_block = 0;
 		num_bufs_in_block = num_bufs;
 	}
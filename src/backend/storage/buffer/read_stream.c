@@ -0,0 +1,198 @@
+/*-------------------------------------------------------------------------
+ *
+ * read_stream.c
+ *	  Mechanism for reading a sequence of relation blocks with look-ahead.
+ *
+ * Code that needs to read many blocks of a relation, in an order it can
+ * predict, describes the sequence with a callback that returns one block
+ * number at a time.  The stream calls it ahead of the consumer, issuing
+ * PrefetchBuffer() hints for the blocks it has seen, and hands out pinned
+ * buffers in the same order via read_stream_next_buffer().  This replaces
+ * the ad hoc "prefetch iterator running ahead of the main iterator" logic
+ * that individual callers would otherwise have to implement.
+ *
+ * The look-ahead distance adapts to what is observed: every block that
+ * PrefetchBuffer() reports as requiring I/O doubles the distance, up to a
+ * maximum taken from effective_io_concurrency (or maintenance_io_concurrency
+ * for maintenance work), while every block already found in shared buffers
+ * shrinks it by one.  A stream over a fully cached relation therefore settles
+ * down to a distance of one and costs little more than a plain loop, while a
+ * stream that keeps missing quickly ramps up to keep many reads in flight.
+ *
+ * Portions Copyright (c) 1996-2021, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/read_stream.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/catalog.h"
+#include "storage/read_stream.h"
+#include "utils/rel.h"
+#include "utils/spccache.h"
+
+struct ReadStream
+{
+	Relation	rel;
+	ForkNumber	forknum;
+	BufferAccessStrategy strategy;
+	ReadStreamBlockNumberCB callback;
+	void	   *callback_private_data;
+
+	int			max_distance;	/* upper bound for distance */
+	int			distance;		/* current look-ahead distance */
+	bool		exhausted;		/* callback has returned InvalidBlockNumber */
+
+	/* circular queue of block numbers handed to us but not yet returned */
+	int			queue_size;
+	int			head;			/* next entry to return */
+	int			nqueued;
+	BlockNumber queue[FLEXIBLE_ARRAY_MEMBER];
+};
+
+/*
+ * Pull more block numbers from the callback until the queue holds the
+ * block about to be returned plus 'distance' blocks of look-ahead.
+ */
+static void
+read_stream_look_ahead(ReadStream *stream)
+{
+	while (!stream->exhausted && stream->nqueued <= stream->distance)
+	{
+		BlockNumber blocknum;
+
+		blocknum = stream->callback(stream, stream->callback_private_data);
+		if (blocknum == InvalidBlockNumber)
+		{
+			stream->exhausted = true;
+			break;
+		}
+
+		/*
+		 * Hint the kernel about the block, unless it is the one we are about
+		 * to read synchronously anyway, and adjust the distance according to
+		 * whether that needed any I/O.
+		 */
+		if (stream->max_distance > 0 && stream->nqueued > 0)
+		{
+			PrefetchBufferResult prefetch;
+
+			prefetch = PrefetchBuffer(stream->rel, stream->forknum, blocknum);
+			if (prefetch.initiated_io)
+				stream->distance = Min(stream->distance * 2,
+									   stream->max_distance);
+			else if (stream->distance > 1)
+				stream->distance--;
+		}
+
+		Assert(stream->nqueued < stream->queue_size);
+		stream->queue[(stream->head + stream->nqueued) % stream->queue_size] =
+			blocknum;
+		stream->nqueued++;
+	}
+}
+
+/*
+ * Create a new read stream for the given fork of a relation.  The callback
+ * is invoked with callback_private_data to obtain block numbers, which are
+ * read using the given buffer access strategy (may be NULL).
+ */
+ReadStream *
+read_stream_begin_relation(int flags,
+						   BufferAccessStrategy strategy,
+						   Relation rel,
+						   ForkNumber forknum,
+						   ReadStreamBlockNumberCB callback,
+						   void *callback_private_data)
+{
+	ReadStream *stream;
+	int			max_distance = 0;
+
+#ifdef USE_PREFETCH
+
+	/*
+	 * Prefetching only makes sense for relations in shared buffers that we
+	 * actually have to read through the kernel.  Avoid syscache lookups for
+	 * catalogs, whose callers may hold other buffer locks.
+	 */
+	if (!RelationUsesLocalBuffers(rel))
+	{
+		if (IsCatalogRelation(rel))
+			max_distance = (flags & READ_STREAM_MAINTENANCE) ?
+				maintenance_io_concurrency : effective_io_concurrency;
+		else if (flags & READ_STREAM_MAINTENANCE)
+			max_distance =
+				get_tablespace_maintenance_io_concurrency(rel->rd_rel->reltablespace);
+		else
+			max_distance =
+				get_tablespace_io_concurrency(rel->rd_rel->reltablespace);
+	}
+#endif
+
+	stream = (ReadStream *)
+		palloc(offsetof(ReadStream, queue) +
+			   sizeof(BlockNumber) * (max_distance + 1));
+	stream->rel = rel;
+	stream->forknum = forknum;
+	stream->strategy = strategy;
+	stream->callback = callback;
+	stream->callback_private_data = callback_private_data;
+	stream->max_distance = max_distance;
+	stream->distance = Min(1, max_distance);
+	stream->exhausted = false;
+	stream->queue_size = max_distance + 1;
+	stream->head = 0;
+	stream->nqueued = 0;
+
+	return stream;
+}
+
+/*
+ * Return the next buffer of the stream, pinned but not locked, or
+ * InvalidBuffer once the callback has run out of blocks.  The caller must
+ * release the buffer.
+ */
+Buffer
+read_stream_next_buffer(ReadStream *stream)
+{
+	BlockNumber blocknum;
+
+	read_stream_look_ahead(stream);
+
+	if (stream->nqueued == 0)
+		return InvalidBuffer;
+
+	blocknum = stream->queue[stream->head];
+	stream->head = (stream->head + 1) % stream->queue_size;
+	stream->nqueued--;
+
+	return ReadBufferExtended(stream->rel, stream->forknum, blocknum,
+							  RBM_NORMAL, stream->strategy);
+}
+
+/*
+ * Forget any blocks that have been looked ahead but not returned, and start
+ * calling the callback again.  This is useful if the callback's state has
+ * been reset, e.g. for a rescan.
+ */
+void
+read_stream_reset(ReadStream *stream)
+{
+	stream->head = 0;
+	stream->nqueued = 0;
+	stream->exhausted = false;
+	stream->distance = Min(1, stream->max_distance);
+}
+
+/*
+ * Release the stream's resources.
+ */
+void
+read_stream_end(ReadStream *stream)
+{
+	pfree(stream);
+}
@@ -40,12 +40,26 @@
  * when the corresponding files need to be survived across the transaction and
  * need to be opened and closed multiple times.  Such files need to be created
  * as a member of a SharedFileSet.
+ *
+ * Finally, BufFiles created by BufFileCreateCompressTemp() compress each
+ * buffer before writing it out, according to temp_file_compression.  Each
+ * buffer is stored as a small header followed by the compressed data, so the
+ * physical layout of the file no longer matches logical positions.  Such
+ * files therefore only support writing sequentially, rewinding to the start
+ * and reading sequentially; that suffices for hash join batch files, which
+ * are the largest source of temporary file traffic that follows this
+ * pattern.
  *-------------------------------------------------------------------------
  */
 
 #include "postgres.h"
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
 #include "commands/tablespace.h"
+#include "common/pg_lzcompress.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -62,6 +76,19 @@
 #define MAX_PHYSICAL_FILESIZE	0x40000000
 #define BUFFILE_SEG_SIZE		(MAX_PHYSICAL_FILESIZE / BLCKSZ)
 
+/*
+ * Header preceding each buffer written to a compressed BufFile.  If the data
+ * did not compress, it is stored as-is and complen equals rawlen.
+ */
+typedef struct BufFileChunkHeader
+{
+	int32		rawlen;			/* bytes of data after decompression */
+	int32		complen;		/* bytes of data following the header */
+} BufFileChunkHeader;
+
+/* GUC variable */
+int			temp_file_compression = TEMP_FILE_COMPRESSION_NONE;
+
 /*
  * This data structure represents a buffered file that consists of one or
  * more physical files (each accessed through a virtual file descriptor
@@ -95,6 +122,17 @@ struct BufFile
 	off_t		curOffset;		/* offset part of current pos */
 	int			pos;			/* next read/write position in buffer */
 	int			nbytes;			/* total # of valid bytes in buffer */
+
+	/*
+	 * For compressed files, the compression method, a work area holding one
+	 * compressed chunk, and the physical size of the chunk currently loaded
+	 * into the buffer.  For uncompressed files, compress is
+	 * TEMP_FILE_COMPRESSION_NONE and cbuffer is NULL.
+	 */
+	int			compress;
+	char	   *cbuffer;
+	int			chunklen;
+
 	PGAlignedBlock buffer;
 };
 
@@ -102,7 +140,9 @@ static BufFile *makeBufFileCommon(int nfiles);
 static BufFile *makeBufFile(File firstfile);
 static void extendBufFile(BufFile *file);
 static void BufFileLoadBuffer(BufFile *file);
+static void BufFileLoadBufferCompressed(BufFile *file);
 static void BufFileDumpBuffer(BufFile *file);
+static void BufFileDumpBufferCompressed(BufFile *file);
 static void BufFileFlush(BufFile *file);
 static File MakeNewSharedSegment(BufFile *file, int segment);
 
@@ -122,6 +162,9 @@ makeBufFileCommon(int nfiles)
 	file->curOffset = 0L;
 	file->pos = 0;
 	file->nbytes = 0;
+	file->compress = TEMP_FILE_COMPRESSION_NONE;
+	file->cbuffer = NULL;
+	file->chunklen = 0;
 
 	return file;
 }
@@ -210,6 +253,29 @@ BufFileCreateTemp(bool interXact)
 	return file;
 }
 
+/*
+ * Create a BufFile for a new temporary file whose contents are compressed
+ * using the method selected by temp_file_compression, if any.
+ *
+ * The caller may only write to the file sequentially, then rewind it with
+ * BufFileSeek(file, 0, 0, SEEK_SET) and read it sequentially.  If it needs
+ * anything else, it must use BufFileCreateTemp() instead.
+ */
+BufFile *
+BufFileCreateCompressTemp(bool interXact)
+{
+	BufFile    *file = BufFileCreateTemp(interXact);
+
+	if (temp_file_compression != TEMP_FILE_COMPRESSION_NONE)
+	{
+		file->compress = temp_file_compression;
+		file->cbuffer = palloc(sizeof(BufFileChunkHeader) +
+							   PGLZ_MAX_OUTPUT(BLCKSZ));
+	}
+
+	return file;
+}
+
 /*
  * Build the name for a given segment of a given BufFile.
  */
@@ -403,6 +469,8 @@ BufFileClose(BufFile *file)
 		FileClose(file->files[i]);
 	/* release the buffer space */
 	pfree(file->files);
+	if (file->cbuffer)
+		pfree(file->cbuffer);
 	pfree(file);
 }
 
@@ -418,6 +486,12 @@ BufFileLoadBuffer(BufFile *file)
 {
 	File		thisfile;
 
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		BufFileLoadBufferCompressed(file);
+		return;
+	}
+
 	/*
 	 * Advance to next component file if necessary and possible.
 	 */
@@ -452,6 +526,114 @@ BufFileLoadBuffer(BufFile *file)
 		pgBufferUsage.temp_blks_read++;
 }
 
+/*
+ * BufFileLoadBufferCompressed
+ *
+ * Like BufFileLoadBuffer, but for compressed files: read the chunk starting
+ * at curOffset and decompress it into the buffer.  On exit, chunklen is the
+ * physical size of the chunk, by which curOffset must be advanced to get to
+ * the next one.
+ */
+static void
+BufFileLoadBufferCompressed(BufFile *file)
+{
+	BufFileChunkHeader hdr;
+	File		thisfile;
+	char	   *data;
+	int			nread;
+
+	for (;;)
+	{
+		thisfile = file->files[file->curFile];
+		nread = FileRead(thisfile, (char *) &hdr, sizeof(hdr),
+						 file->curOffset, WAIT_EVENT_BUFFILE_READ);
+		if (nread < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m",
+							FilePathName(thisfile))));
+
+		/*
+		 * Chunks never cross segment boundaries, so the end of a segment
+		 * other than the last one just means that we continue with the next.
+		 */
+		if (nread == 0 && file->curFile + 1 < file->numFiles)
+		{
+			file->curFile++;
+			file->curOffset = 0L;
+			continue;
+		}
+		break;
+	}
+
+	if (nread == 0)
+	{
+		/* end of file */
+		file->nbytes = 0;
+		file->chunklen = 0;
+		return;
+	}
+
+	if (nread != sizeof(hdr) ||
+		hdr.rawlen <= 0 || hdr.rawlen > BLCKSZ ||
+		hdr.complen <= 0 || hdr.complen > hdr.rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("invalid compressed chunk in file \"%s\"",
+								 FilePathName(thisfile))));
+
+	/* Uncompressed data can be read straight into the buffer */
+	data = (hdr.complen == hdr.rawlen) ? file->buffer.data : file->cbuffer;
+
+	nread = FileRead(thisfile, data, hdr.complen,
+					 file->curOffset + sizeof(hdr), WAIT_EVENT_BUFFILE_READ);
+	if (nread != hdr.complen)
+	{
+		if (nread < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m",
+							FilePathName(thisfile))));
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\": read only %d of %d bytes",
+						FilePathName(thisfile), nread, hdr.complen)));
+	}
+
+	if (hdr.complen != hdr.rawlen)
+	{
+		int			rawlen = -1;
+
+		switch (file->compress)
+		{
+			case TEMP_FILE_COMPRESSION_PGLZ:
+				rawlen = pglz_decompress(data, hdr.complen,
+										 file->buffer.data, hdr.rawlen, true);
+				break;
+#ifdef USE_LZ4
+			case TEMP_FILE_COMPRESSION_LZ4:
+				rawlen = LZ4_decompress_safe(data, file->buffer.data,
+											 hdr.complen, hdr.rawlen);
+				break;
+#endif
+			default:
+				elog(ERROR, "invalid temporary file compression method %d",
+					 file->compress);
+		}
+
+		if (rawlen != hdr.rawlen)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("compressed data is corrupted in file \"%s\"",
+									 FilePathName(thisfile))));
+	}
+
+	file->nbytes = hdr.rawlen;
+	file->chunklen = sizeof(hdr) + hdr.complen;
+
+	pgBufferUsage.temp_blks_read++;
+}
+
 /*
  * BufFileDumpBuffer
  *
@@ -466,6 +648,12 @@ BufFileDumpBuffer(BufFile *file)
 	int			bytestowrite;
 	File		thisfile;
 
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		BufFileDumpBufferCompressed(file);
+		return;
+	}
+
 	/*
 	 * Unlike BufFileLoadBuffer, we must dump the whole buffer even if it
 	 * crosses a component-file boundary; so we need a loop.
@@ -533,6 +721,83 @@ BufFileDumpBuffer(BufFile *file)
 	file->nbytes = 0;
 }
 
+/*
+ * BufFileDumpBufferCompressed
+ *
+ * Like BufFileDumpBuffer, but for compressed files: compress the buffer and
+ * write it out as one chunk at curOffset.  Since compressed files are only
+ * written sequentially, the whole buffer is always written.
+ */
+static void
+BufFileDumpBufferCompressed(BufFile *file)
+{
+	BufFileChunkHeader *hdr = (BufFileChunkHeader *) file->cbuffer;
+	char	   *data = file->cbuffer + sizeof(BufFileChunkHeader);
+	int32		complen = -1;
+	int			chunklen;
+	File		thisfile;
+
+	Assert(file->pos == file->nbytes);
+
+	switch (file->compress)
+	{
+		case TEMP_FILE_COMPRESSION_PGLZ:
+			complen = pglz_compress(file->buffer.data, file->nbytes, data,
+									PGLZ_strategy_default);
+			break;
+#ifdef USE_LZ4
+		case TEMP_FILE_COMPRESSION_LZ4:
+			/* a result that does not fit in nbytes is no use to us */
+			complen = LZ4_compress_default(file->buffer.data, data,
+										   file->nbytes, file->nbytes - 1);
+			if (complen == 0)
+				complen = -1;
+			break;
+#endif
+		default:
+			elog(ERROR, "invalid temporary file compression method %d",
+				 file->compress);
+	}
+
+	/* Store the data uncompressed if compression didn't help */
+	if (complen < 0 || complen >= file->nbytes)
+	{
+		memcpy(data, file->buffer.data, file->nbytes);
+		complen = file->nbytes;
+	}
+
+	hdr->rawlen = file->nbytes;
+	hdr->complen = complen;
+	chunklen = sizeof(BufFileChunkHeader) + complen;
+
+	/*
+	 * Advance to next component file if the chunk doesn't fit into this one;
+	 * chunks never cross segment boundaries.
+	 */
+	if (file->curOffset + chunklen > MAX_PHYSICAL_FILESIZE)
+	{
+		while (file->curFile + 1 >= file->numFiles)
+			extendBufFile(file);
+		file->curFile++;
+		file->curOffset = 0L;
+	}
+
+	thisfile = file->files[file->curFile];
+	if (FileWrite(thisfile, file->cbuffer, chunklen, file->curOffset,
+				  WAIT_EVENT_BUFFILE_WRITE) != chunklen)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to file \"%s\": %m",
+						FilePathName(thisfile))));
+	file->curOffset += chunklen;
+
+	pgBufferUsage.temp_blks_written++;
+
+	file->dirty = false;
+	file->pos = 0;
+	file->nbytes = 0;
+}
+
 /*
  * BufFileRead
  *
@@ -552,7 +817,10 @@ BufFileRead(BufFile *file, void *ptr, size_t size)
 		if (file->pos >= file->nbytes)
 		{
 			/* Try to load more data into buffer. */
-			file->curOffset += file->pos;
+			if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+				file->curOffset += file->chunklen;
+			else
+				file->curOffset += file->pos;
 			file->pos = 0;
 			file->nbytes = 0;
 			BufFileLoadBuffer(file);
@@ -599,6 +867,8 @@ BufFileWrite(BufFile *file, void *ptr, size_t size)
 			else
 			{
 				/* Hmm, went directly from reading to writing? */
+				if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+					elog(ERROR, "cannot write to a compressed temporary file after reading from it");
 				file->curOffset += file->pos;
 				file->pos = 0;
 				file->nbytes = 0;
@@ -652,6 +922,21 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 	int			newFile;
 	off_t		newOffset;
 
+	/* Compressed files only support rewinding; see BufFileCreateCompressTemp */
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		if (whence != SEEK_SET || fileno != 0 || offset != 0)
+			elog(ERROR, "compressed temporary files only support seeking to the start");
+
+		BufFileFlush(file);
+		file->curFile = 0;
+		file->curOffset = 0L;
+		file->pos = 0;
+		file->nbytes = 0;
+		file->chunklen = 0;
+		return 0;
+	}
+
 	switch (whence)
 	{
 		case SEEK_SET:
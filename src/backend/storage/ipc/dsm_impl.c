@@ -68,6 +68,7 @@
 #include "postmaster/postmaster.h"
 #include "storage/dsm_impl.h"
 #include "storage/fd.h"
+#include "storage/pg_shmem.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 
@@ -121,6 +122,9 @@ int			min_dynamic_shared_memory;
 
 #define SEGMENT_NAME_PREFIX			"Global/PostgreSQL"
 
+/* Smallest POSIX segment we ask the kernel to back with huge pages */
+#define DSM_HUGE_PAGE_MIN_SIZE		(2 * 1024 * 1024)
+
 /*------
  * Perform a low-level shared memory operation in a platform-specific way,
  * as dictated by the selected implementation.  Each implementation is
@@ -347,6 +351,18 @@ dsm_impl_posix(dsm_op op, dsm_handle handle, Size request_size,
 	close(fd);
 	ReleaseExternalFD();
 
+	/*
+	 * Segments are attached by name, so we can't use MAP_HUGETLB here.  But
+	 * on Linux, POSIX shared memory lives on tmpfs, which will back the
+	 * mapping with transparent huge pages if asked to (and if the tmpfs
+	 * shmem_enabled setting allows it).  That matters for large segments
+	 * such as parallel hash tables, so ask.  Failure is harmless.
+	 */
+#ifdef MADV_HUGEPAGE
+	if (transparent_huge_pages && request_size >= DSM_HUGE_PAGE_MIN_SIZE)
+		(void) madvise(address, request_size, MADV_HUGEPAGE);
+#endif
+
 	return true;
 }
 
@@ -19,6 +19,7 @@
 
 #include "access/transam.h"
 #include "miscadmin.h"
+#include "port/pg_bitutils.h"
 #include "storage/backendid.h"
 #include "storage/ipc.h"
 #include "storage/proc.h"
@@ -42,11 +43,13 @@
  * smallest nextMsgNum --- it may lag behind.  We only update it when
  * SICleanupQueue is called, and we try not to do that often.)
  *
- * In reality, the messages are stored in a circular buffer of MAXNUMMESSAGES
- * entries.  We translate MsgNum values into circular-buffer indexes by
- * computing MsgNum % MAXNUMMESSAGES (this should be fast as long as
- * MAXNUMMESSAGES is a constant and a power of 2).  As long as maxMsgNum
- * doesn't exceed minMsgNum by more than MAXNUMMESSAGES, we have enough space
+ * In reality, the messages are stored in a circular buffer of numMessages
+ * entries, which is sized at startup according to MaxBackends (more backends
+ * means more chances for one of them to fall behind, so we give them more
+ * slack before anyone has to be reset).  We translate MsgNum values into
+ * circular-buffer indexes by computing MsgNum & (numMessages - 1), which
+ * is why numMessages must be a power of 2.  As long as maxMsgNum doesn't
+ * exceed minMsgNum by more than numMessages, we have enough space
  * in the buffer.  If the buffer does overflow, we recover by setting the
  * "reset" flag for each backend that has fallen too far behind.  A backend
  * that is in "reset" state is ignored while determining minMsgNum.  When
@@ -73,7 +76,7 @@
  * whenever minMsgNum exceeds MSGNUMWRAPAROUND, we subtract MSGNUMWRAPAROUND
  * from all the MsgNum variables simultaneously.  MSGNUMWRAPAROUND can be
  * large so that we don't need to do this often.  It must be a multiple of
- * MAXNUMMESSAGES so that the existing circular-buffer entries don't need
+ * numMessages so that the existing circular-buffer entries don't need
  * to be moved when we do it.
  *
  * Access to the shared sinval array is protected by two locks, SInvalReadLock
@@ -106,8 +109,11 @@
 /*
  * Configurable parameters.
  *
- * MAXNUMMESSAGES: max number of shared-inval messages we can buffer.
- * Must be a power of 2 for speed.
+ * MINNUMMESSAGES, MAXNUMMESSAGES: bounds on the number of shared-inval
+ * messages we can buffer.  Both must be powers of 2.
+ *
+ * MESSAGES_PER_BACKEND: buffer slots to allocate per backend, within the
+ * above bounds.
  *
  * MSGNUMWRAPAROUND: how often to reduce MsgNum variables to avoid overflow.
  * Must be a multiple of MAXNUMMESSAGES.  Should be large.
@@ -121,19 +127,26 @@
  * SIG_THRESHOLD: the minimum number of messages a backend must have fallen
  * behind before we'll send it PROCSIG_CATCHUP_INTERRUPT.
  *
+ * The last three scale with the actual buffer size.
+ *
  * WRITE_QUANTUM: the max number of messages to push into the buffer per
  * iteration of SIInsertDataEntries.  Noncritical but should be less than
  * CLEANUP_QUANTUM, because we only consider calling SICleanupQueue once
  * per iteration.
  */
 
-#define MAXNUMMESSAGES 4096
-#define MSGNUMWRAPAROUND (MAXNUMMESSAGES * 262144)
-#define CLEANUP_MIN (MAXNUMMESSAGES / 2)
-#define CLEANUP_QUANTUM (MAXNUMMESSAGES / 16)
-#define SIG_THRESHOLD (MAXNUMMESSAGES / 2)
+#define MINNUMMESSAGES 4096
+#define MAXNUMMESSAGES (1024 * 1024)
+#define MESSAGES_PER_BACKEND 32
+#define MSGNUMWRAPAROUND (MAXNUMMESSAGES * 1024)
+#define CLEANUP_MIN(segP) ((segP)->numMessages / 2)
+#define CLEANUP_QUANTUM(segP) ((segP)->numMessages / 16)
+#define SIG_THRESHOLD(segP) ((segP)->numMessages / 2)
 #define WRITE_QUANTUM 64
 
+#define SI_BUFFER_SLOT(segP, msgnum) \
+	((segP)->buffer[(msgnum) & ((segP)->numMessages - 1)])
+
 /* Per-backend state in shared invalidation structure */
 typedef struct ProcState
 {
@@ -174,13 +187,15 @@ typedef struct SISeg
 	int			nextThreshold;	/* # of messages to call SICleanupQueue */
 	int			lastBackend;	/* index of last active procState entry, +1 */
 	int			maxBackends;	/* size of procState array */
+	int			numMessages;	/* size of buffer array */
 
 	slock_t		msgnumLock;		/* spinlock protecting maxMsgNum */
 
 	/*
-	 * Circular buffer holding shared-inval messages
+	 * Circular buffer holding shared-inval messages (has numMessages
+	 * entries, and is allocated just after the procState array)
 	 */
-	SharedInvalidationMessage buffer[MAXNUMMESSAGES];
+	SharedInvalidationMessage *buffer;
 
 	/*
 	 * Per-backend invalidation state info (has MaxBackends entries).
@@ -196,6 +211,22 @@ static LocalTransactionId nextLocalTransactionId;
 static void CleanupInvalidationState(int status, Datum arg);
 
 
+/*
+ * SInvalQueueSize --- number of messages the circular buffer can hold
+ */
+static int
+SInvalQueueSize(void)
+{
+	uint32		nmsgs;
+
+	nmsgs = (uint32) Min((uint64) MaxBackends * MESSAGES_PER_BACKEND,
+						 MAXNUMMESSAGES);
+	nmsgs = pg_nextpower2_32(Max(nmsgs, MINNUMMESSAGES));
+
+	Assert(nmsgs <= MAXNUMMESSAGES);
+	return (int) nmsgs;
+}
+
 /*
  * SInvalShmemSize --- return shared-memory space needed
  */
@@ -206,6 +237,9 @@ SInvalShmemSize(void)
 
 	size = offsetof(SISeg, procState);
 	size = add_size(size, mul_size(sizeof(ProcState), MaxBackends));
+	size = MAXALIGN(size);
+	size = add_size(size, mul_size(sizeof(SharedInvalidationMessage),
+								   SInvalQueueSize()));
 
 	return size;
 }
@@ -226,12 +260,17 @@ CreateSharedInvalidationState(void)
 	if (found)
 		return;
 
-	/* Clear message counters, save size of procState array, init spinlock */
+	/* Clear message counters, save size of arrays, init spinlock */
 	shmInvalBuffer->minMsgNum = 0;
 	shmInvalBuffer->maxMsgNum = 0;
-	shmInvalBuffer->nextThreshold = CLEANUP_MIN;
 	shmInvalBuffer->lastBackend = 0;
 	shmInvalBuffer->maxBackends = MaxBackends;
+	shmInvalBuffer->numMessages = SInvalQueueSize();
+	shmInvalBuffer->nextThreshold = CLEANUP_MIN(shmInvalBuffer);
+	shmInvalBuffer->buffer = (SharedInvalidationMessage *)
+		((char *) shmInvalBuffer +
+		 MAXALIGN(offsetof(SISeg, procState) +
+				  sizeof(ProcState) * MaxBackends));
 	SpinLockInit(&shmInvalBuffer->msgnumLock);
 
 	/* The buffer[] array is initially all unused, so we need not fill it */
@@ -464,7 +503,7 @@ SIInsertDataEntries(const SharedInvalidationMessage *data, int n)
 		for (;;)
 		{
 			numMsgs = segP->maxMsgNum - segP->minMsgNum;
-			if (numMsgs + nthistime > MAXNUMMESSAGES ||
+			if (numMsgs + nthistime > segP->numMessages ||
 				numMsgs >= segP->nextThreshold)
 				SICleanupQueue(true, nthistime);
 			else
@@ -477,7 +516,7 @@ SIInsertDataEntries(const SharedInvalidationMessage *data, int n)
 		max = segP->maxMsgNum;
 		while (nthistime-- > 0)
 		{
-			segP->buffer[max % MAXNUMMESSAGES] = *data++;
+			SI_BUFFER_SLOT(segP, max) = *data++;
 			max++;
 		}
 
@@ -600,7 +639,7 @@ SIGetDataEntries(SharedInvalidationMessage *data, int datasize)
 	n = 0;
 	while (n < datasize && stateP->nextMsgNum < max)
 	{
-		data[n++] = segP->buffer[stateP->nextMsgNum % MAXNUMMESSAGES];
+		data[n++] = SI_BUFFER_SLOT(segP, stateP->nextMsgNum);
 		stateP->nextMsgNum++;
 	}
 
@@ -660,8 +699,8 @@ SICleanupQueue(bool callerHasWriteLock, int minFree)
 	 * a problem even when they are the only active backend.
 	 */
 	min = segP->maxMsgNum;
-	minsig = min - SIG_THRESHOLD;
-	lowbound = min - MAXNUMMESSAGES + minFree;
+	minsig = min - SIG_THRESHOLD(segP);
+	lowbound = min - segP->numMessages + minFree;
 
 	for (i = 0; i < segP->lastBackend; i++)
 	{
@@ -717,10 +756,11 @@ SICleanupQueue(bool callerHasWriteLock, int minFree)
 	 * threshold at which we should repeat SICleanupQueue().
 	 */
 	numMsgs = segP->maxMsgNum - segP->minMsgNum;
-	if (numMsgs < CLEANUP_MIN)
-		segP->nextThreshold = CLEANUP_MIN;
+	if (numMsgs < CLEANUP_MIN(segP))
+		segP->nextThreshold = CLEANUP_MIN(segP);
 	else
-		segP->nextThreshold = (numMsgs / CLEANUP_QUANTUM + 1) * CLEANUP_QUANTUM;
+		segP->nextThreshold = (numMsgs / CLEANUP_QUANTUM(segP) + 1) *
+			CLEANUP_QUANTUM(segP);
 
 	/*
 	 * Lastly, signal anyone who needs a catchup interrupt.  Since
@@ -27,6 +27,12 @@
 #include "storage/spin.h"
 #include "utils/memutils.h"
 
+/*
+ * Maximum number of waiters ConditionVariableBroadcast removes from the
+ * wakeup list per acquisition of the CV's spinlock.
+ */
+#define CV_BROADCAST_BATCH_SIZE		16
+
 /* Initially, we are not prepared to sleep on any condition variable. */
 static ConditionVariable *cv_sleep_target = NULL;
 
@@ -339,10 +345,18 @@ ConditionVariableBroadcast(ConditionVariable *cv)
 
 	while (have_sentinel)
 	{
+		PGPROC	   *procs[CV_BROADCAST_BATCH_SIZE];
+		int			nprocs = 0;
+		int			i;
+
 		/*
-		 * Each time through the loop, remove the first wakeup list entry, and
-		 * signal it unless it's our sentinel.  Repeat as long as the sentinel
-		 * remains in the list.
+		 * Each time through the loop, remove a batch of entries from the head
+		 * of the wakeup list, stopping early if we reach our sentinel, and
+		 * then signal them all once we've released the spinlock.  Taking
+		 * several entries at a time keeps a broadcast to many waiters from
+		 * bouncing the spinlock back and forth with the processes it has
+		 * just woken up, which will often want it to queue themselves again.
+		 * Repeat as long as the sentinel remains in the list.
 		 *
 		 * Notice that if someone else removes our sentinel, we will waken one
 		 * additional process before exiting.  That's intentional, because if
@@ -351,14 +365,23 @@ ConditionVariableBroadcast(ConditionVariable *cv)
 		 * sentinel.  Better to give a spurious wakeup (which should be
 		 * harmless beyond wasting some cycles) than to lose a wakeup.
 		 */
-		proc = NULL;
 		SpinLockAcquire(&cv->mutex);
-		if (!proclist_is_empty(&cv->wakeup))
+		while (nprocs < CV_BROADCAST_BATCH_SIZE &&
+			   !proclist_is_empty(&cv->wakeup))
+		{
 			proc = proclist_pop_head_node(&cv->wakeup, cvWaitLink);
-		have_sentinel = proclist_contains(&cv->wakeup, pgprocno, cvWaitLink);
+			if (proc != MyProc)
+				procs[nprocs++] = proc;
+			have_sentinel = proclist_contains(&cv->wakeup, pgprocno,
+											  cvWaitLink);
+			if (!have_sentinel)
+				break;
+		}
+		if (proclist_is_empty(&cv->wakeup))
+			have_sentinel = false;
 		SpinLockRelease(&cv->mutex);
 
-		if (proc != NULL && proc != MyProc)
-			SetLatch(&proc->procLatch);
+		for (i = 0; i < nprocs; i++)
+			SetLatch(&procs[i]->procLatch);
 	}
 }
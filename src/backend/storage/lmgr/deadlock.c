@@ -555,12 +555,11 @@ FindLockCycleRecurseMember(PGPROC *checkProc,
 				lm;
 
 	/*
-	 * The relation extension or page lock can never participate in actual
-	 * deadlock cycle.  See Asserts in LockAcquireExtended.  So, there is no
-	 * advantage in checking wait edges from them.
+	 * The page lock can never participate in actual deadlock cycle.  See
+	 * Asserts in LockAcquireExtended.  So, there is no advantage in checking
+	 * wait edges from it.
 	 */
-	if (LOCK_LOCKTAG(*lock) == LOCKTAG_RELATION_EXTEND ||
-		(LOCK_LOCKTAG(*lock) == LOCKTAG_PAGE))
+	if (LOCK_LOCKTAG(*lock) == LOCKTAG_PAGE)
 		return false;
 
 	lockMethodTable = GetLocksMethodTable(lock);
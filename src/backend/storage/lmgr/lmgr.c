@@ -20,15 +20,64 @@
 #include "access/xact.h"
 #include "catalog/catalog.h"
 #include "commands/progress.h"
+#include "common/hashfn.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/lmgr.h"
 #include "storage/proc.h"
 #include "storage/procarray.h"
+#include "storage/shmem.h"
 #include "storage/sinvaladt.h"
 #include "utils/inval.h"
 
 
+/*
+ * Relation extension locks.
+ *
+ * These don't go through the heavyweight lock manager.  They are taken very
+ * frequently by bulk loads, are held only briefly, and never participate in
+ * deadlocks (we don't acquire any other heavyweight lock while holding one),
+ * so the cost of the shared lock table, its partition locks and the local
+ * lock table is pure overhead.  Instead, each relation hashes to one of a
+ * fixed number of LWLocks.  Unrelated relations that share a slot will
+ * occasionally wait for each other; that is harmless, since no backend ever
+ * holds extension locks on more than one relation at a time.
+ *
+ * A backend may however acquire the lock on the same relation again while
+ * it already holds it, e.g. when adding the new pages of a heap to the free
+ * space map requires extending the FSM fork, so we count nested
+ * acquisitions locally.
+ *
+ * Unlike a heavyweight lock wait, an LWLock wait can't be interrupted by a
+ * query cancel or statement_timeout.  That's acceptable here because the
+ * holder only ever extends the relation by a bounded number of blocks and
+ * updates the free space map before releasing the lock; it never waits for
+ * another lock or for a client meanwhile.  So a waiter is only ever delayed
+ * by the I/O of a concurrent extension, as it would be while holding the
+ * buffer mapping or WAL insertion locks.
+ */
+#define N_RELEXTLOCK_ENTS 1024
+
+typedef struct RelExtLock
+{
+	LWLock		lock;
+	pg_atomic_uint32 nwaiters;	/* # of backends waiting to acquire lock */
+} RelExtLock;
+
+typedef union RelExtLockPadded
+{
+	RelExtLock	rel_ext_lock;
+	char		pad[PG_CACHE_LINE_SIZE];
+} RelExtLockPadded;
+
+static RelExtLockPadded *RelExtLockArray;
+
+/* The relation extension lock this backend holds, if any */
+static RelExtLock *held_rel_ext_lock = NULL;
+static LockRelId held_rel_ext_relid;
+static int	held_rel_ext_count = 0;
+
+
 /*
  * Per-backend counter for generating speculative insertion tokens.
  *
@@ -389,12 +438,135 @@ UnlockRelationIdForSession(LockRelId *relid, LOCKMODE lockmode)
 	LockRelease(&tag, lockmode, true);
 }
 
+/*
+ * RelExtLockShmemSize
+ *		Compute shared memory space needed for relation extension locks
+ */
+Size
+RelExtLockShmemSize(void)
+{
+	return mul_size(N_RELEXTLOCK_ENTS, sizeof(RelExtLockPadded));
+}
+
+/*
+ * RelExtLockShmemInit
+ *		Allocate and initialize shared memory for relation extension locks
+ */
+void
+RelExtLockShmemInit(void)
+{
+	bool		found;
+
+	RelExtLockArray = (RelExtLockPadded *)
+		ShmemInitStruct("Relation Extension Locks",
+						RelExtLockShmemSize(), &found);
+
+	if (!found)
+	{
+		for (int i = 0; i < N_RELEXTLOCK_ENTS; i++)
+		{
+			RelExtLock *extlock = &RelExtLockArray[i].rel_ext_lock;
+
+			LWLockInitialize(&extlock->lock, LWTRANCHE_RELATION_EXTENSION);
+			pg_atomic_init_u32(&extlock->nwaiters, 0);
+		}
+	}
+}
+
+/*
+ * Find the slot of the relation extension lock for the given relation.
+ */
+static inline RelExtLock *
+RelExtLockForRelation(Relation relation)
+{
+	LockRelId  *relid = &relation->rd_lockInfo.lockRelId;
+	uint32		hashcode;
+
+	hashcode = hash_combine(murmurhash32(relid->dbId),
+							murmurhash32(relid->relId));
+
+	return &RelExtLockArray[hashcode % N_RELEXTLOCK_ENTS].rel_ext_lock;
+}
+
+/*
+ * Do we already hold the extension lock on this relation?  As a side effect,
+ * forget about a lock that was released by LWLockReleaseAll() during error
+ * recovery.
+ */
+static bool
+RelExtLockHeldByMe(Relation relation)
+{
+	if (held_rel_ext_count == 0)
+		return false;
+
+	if (!LWLockHeldByMe(&held_rel_ext_lock->lock))
+	{
+		held_rel_ext_lock = NULL;
+		held_rel_ext_count = 0;
+		return false;
+	}
+
+	return (held_rel_ext_relid.dbId == relation->rd_lockInfo.lockRelId.dbId &&
+			held_rel_ext_relid.relId == relation->rd_lockInfo.lockRelId.relId);
+}
+
+/*
+ * Common code for LockRelationForExtension and its conditional variant.
+ */
+static bool
+RelExtLockAcquire(Relation relation, LOCKMODE lockmode, bool dontWait)
+{
+	RelExtLock *extlock;
+	LWLockMode	mode;
+
+	Assert(lockmode == ExclusiveLock || lockmode == ShareLock);
+
+	if (RelExtLockHeldByMe(relation))
+	{
+		/* a nested shared acquisition can't upgrade us to exclusive */
+		Assert(lockmode == ShareLock ||
+			   LWLockHeldByMeInMode(&held_rel_ext_lock->lock, LW_EXCLUSIVE));
+		held_rel_ext_count++;
+		return true;
+	}
+
+	/*
+	 * We never hold extension locks on two relations at once.  Doing so could
+	 * self-deadlock on a shared slot, or deadlock undetected against another
+	 * backend, so refuse rather than wait.
+	 */
+	if (held_rel_ext_count > 0)
+		elog(ERROR, "cannot lock relation %u for extension while holding the extension lock of relation %u",
+			 relation->rd_lockInfo.lockRelId.relId, held_rel_ext_relid.relId);
+
+	extlock = RelExtLockForRelation(relation);
+	mode = (lockmode == ExclusiveLock) ? LW_EXCLUSIVE : LW_SHARED;
+
+	if (!LWLockConditionalAcquire(&extlock->lock, mode))
+	{
+		if (dontWait)
+			return false;
+
+		/* advertise that we're waiting, see RelationExtensionLockWaiterCount */
+		pg_atomic_fetch_add_u32(&extlock->nwaiters, 1);
+		LWLockAcquire(&extlock->lock, mode);
+		pg_atomic_fetch_sub_u32(&extlock->nwaiters, 1);
+	}
+
+	held_rel_ext_lock = extlock;
+	held_rel_ext_relid = relation->rd_lockInfo.lockRelId;
+	held_rel_ext_count = 1;
+
+	return true;
+}
+
 /*
  *		LockRelationForExtension
  *
- * This lock tag is used to interlock addition of pages to relations.
+ * This lock is used to interlock addition of pages to relations.
  * We need such locking because bufmgr/smgr definition of P_NEW is not
- * race-condition-proof.
+ * race-condition-proof.  ExclusiveLock is normally used; ShareLock only
+ * waits for a concurrent extension to finish.
  *
  * We assume the caller is already holding some type of regular lock on
  * the relation, so no AcceptInvalidationMessages call is needed here.
@@ -402,13 +574,7 @@ UnlockRelationIdForSession(LockRelId *relid, LOCKMODE lockmode)
 void
 LockRelationForExtension(Relation relation, LOCKMODE lockmode)
 {
-	LOCKTAG		tag;
-
-	SET_LOCKTAG_RELATION_EXTEND(tag,
-								relation->rd_lockInfo.lockRelId.dbId,
-								relation->rd_lockInfo.lockRelId.relId);
-
-	(void) LockAcquire(&tag, lockmode, false, false);
+	(void) RelExtLockAcquire(relation, lockmode, false);
 }
 
 /*
@@ -420,30 +586,21 @@ LockRelationForExtension(Relation relation, LOCKMODE lockmode)
 bool
 ConditionalLockRelationForExtension(Relation relation, LOCKMODE lockmode)
 {
-	LOCKTAG		tag;
-
-	SET_LOCKTAG_RELATION_EXTEND(tag,
-								relation->rd_lockInfo.lockRelId.dbId,
-								relation->rd_lockInfo.lockRelId.relId);
-
-	return (LockAcquire(&tag, lockmode, false, true) != LOCKACQUIRE_NOT_AVAIL);
+	return RelExtLockAcquire(relation, lockmode, true);
 }
 
 /*
  *		RelationExtensionLockWaiterCount
  *
  * Count the number of processes waiting for the given relation extension lock.
+ * This includes waiters for other relations that happen to share the lock.
  */
 int
 RelationExtensionLockWaiterCount(Relation relation)
 {
-	LOCKTAG		tag;
-
-	SET_LOCKTAG_RELATION_EXTEND(tag,
-								relation->rd_lockInfo.lockRelId.dbId,
-								relation->rd_lockInfo.lockRelId.relId);
+	RelExtLock *extlock = RelExtLockForRelation(relation);
 
-	return LockWaiterCount(&tag);
+	return (int) pg_atomic_read_u32(&extlock->nwaiters);
 }
 
 /*
@@ -452,13 +609,15 @@ RelationExtensionLockWaiterCount(Relation relation)
 void
 UnlockRelationForExtension(Relation relation, LOCKMODE lockmode)
 {
-	LOCKTAG		tag;
-
-	SET_LOCKTAG_RELATION_EXTEND(tag,
-								relation->rd_lockInfo.lockRelId.dbId,
-								relation->rd_lockInfo.lockRelId.relId);
+	if (!RelExtLockHeldByMe(relation))
+		elog(ERROR, "relation extension lock for relation %u is not held",
+			 relation->rd_lockInfo.lockRelId.relId);
 
-	LockRelease(&tag, lockmode, false);
+	if (--held_rel_ext_count == 0)
+	{
+		LWLockRelease(&held_rel_ext_lock->lock);
+		held_rel_ext_lock = NULL;
+	}
 }
 
 /*
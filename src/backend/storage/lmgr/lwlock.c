@@ -175,7 +175,9 @@ static const char *const BuiltinTrancheNames[] = {
 	/* LWTRANCHE_PARALLEL_APPEND: */
 	"ParallelAppend",
 	/* LWTRANCHE_PER_XACT_PREDICATE_LIST: */
-	"PerXactPredicateList"
+	"PerXactPredicateList",
+	/* LWTRANCHE_RELATION_EXTENSION: */
+	"RelationExtension"
 };
 
 StaticAssertDecl(lengthof(BuiltinTrancheNames) ==
@@ -215,6 +217,16 @@ typedef struct LWLockHandle
 static int	num_held_lwlocks = 0;
 static LWLockHandle held_lwlocks[MAX_SIMUL_LWLOCKS];
 
+/*
+ * How many times LWLockAcquire polls a busy lock before going to sleep; see
+ * LWLockSpinAttemptLock.  This is adjusted on the fly, within these bounds.
+ */
+#define MIN_LWLOCK_SPINS		8
+#define MAX_LWLOCK_SPINS		512
+#define DEFAULT_LWLOCK_SPINS	64
+
+static int	lwlock_spins = DEFAULT_LWLOCK_SPINS;
+
 /* struct representing the LWLock tranche request for named tranche */
 typedef struct NamedLWLockTrancheRequest
 {
@@ -261,6 +273,7 @@ typedef struct lwlock_stats
 	int			block_count;
 	int			dequeue_self_count;
 	int			spin_delay_count;
+	int			spin_acquire_count;
 }			lwlock_stats;
 
 static HTAB *lwlock_stats_htab;
@@ -366,11 +379,12 @@ print_lwlock_stats(int code, Datum arg)
 	while ((lwstats = (lwlock_stats *) hash_seq_search(&scan)) != NULL)
 	{
 		fprintf(stderr,
-				"PID %d lwlock %s %p: shacq %u exacq %u blk %u spindelay %u dequeue self %u\n",
+				"PID %d lwlock %s %p: shacq %u exacq %u blk %u spinacq %u spindelay %u dequeue self %u\n",
 				MyProcPid, GetLWTrancheName(lwstats->key.tranche),
 				lwstats->key.instance, lwstats->sh_acquire_count,
 				lwstats->ex_acquire_count, lwstats->block_count,
-				lwstats->spin_delay_count, lwstats->dequeue_self_count);
+				lwstats->spin_acquire_count, lwstats->spin_delay_count,
+				lwstats->dequeue_self_count);
 	}
 
 	LWLockRelease(&MainLWLockArray[0].lock);
@@ -403,6 +417,7 @@ get_lwlock_stats_entry(LWLock *lock)
 		lwstats->block_count = 0;
 		lwstats->dequeue_self_count = 0;
 		lwstats->spin_delay_count = 0;
+		lwstats->spin_acquire_count = 0;
 	}
 	return lwstats;
 }
@@ -880,6 +895,55 @@ LWLockAttemptLock(LWLock *lock, LWLockMode mode)
 	pg_unreachable();
 }
 
+/*
+ * Poll a busy lock for a little while before LWLockAcquire resorts to
+ * sleeping on its semaphore.
+ *
+ * Returns true if the lock isn't free and we need to wait, like
+ * LWLockAttemptLock.
+ *
+ * Sleeping and being woken up again costs a couple of context switches,
+ * which is much more than most LWLock critical sections take, so while the
+ * holder is running on another CPU it usually pays to wait for it to let go.
+ * How long we are willing to poll adapts the same way spins_per_delay does
+ * for spinlocks (see s_lock.c): it grows whenever polling gets us the lock,
+ * and slowly shrinks whenever it doesn't, so on a uniprocessor, or for locks
+ * that are held for a long time, we soon stop wasting many cycles on it.
+ *
+ * We give up at once if anyone is queued on the lock.  Pollers can get in
+ * ahead of sleeping waiters, and on a lock contended enough for a queue to
+ * form, the waiters would otherwise be starved.
+ */
+static bool
+LWLockSpinAttemptLock(LWLock *lock, LWLockMode mode)
+{
+	uint32		conflicts;
+	int			spins;
+
+	conflicts = (mode == LW_EXCLUSIVE) ? LW_LOCK_MASK : LW_VAL_EXCLUSIVE;
+
+	for (spins = 0; spins < lwlock_spins; spins++)
+	{
+		uint32		state;
+
+		pg_spin_delay();
+
+		state = pg_atomic_read_u32(&lock->state);
+		if (state & LW_FLAG_HAS_WAITERS)
+			return true;
+
+		/* Only try the (expensive) atomic operation if it can succeed */
+		if ((state & conflicts) == 0 && !LWLockAttemptLock(lock, mode))
+		{
+			lwlock_spins = Min(lwlock_spins * 2, MAX_LWLOCK_SPINS);
+			return false;
+		}
+	}
+
+	lwlock_spins = Max(lwlock_spins - 1, MIN_LWLOCK_SPINS);
+	return true;
+}
+
 /*
  * Lock the LWLock's wait list against concurrent activity.
  *
@@ -1273,6 +1337,18 @@ LWLockAcquire(LWLock *lock, LWLockMode mode)
 			break;				/* got the lock */
 		}
 
+		/* The holder may be about to release it, so wait a bit and retry. */
+		mustwait = LWLockSpinAttemptLock(lock, mode);
+
+		if (!mustwait)
+		{
+			LOG_LWDEBUG("LWLockAcquire", lock, "acquired lock after spinning");
+#ifdef LWLOCK_STATS
+			lwstats->spin_acquire_count++;
+#endif
+			break;				/* got the lock */
+		}
+
 		/*
 		 * Ok, at this point we couldn't grab the lock on the first try. We
 		 * cannot simply queue ourselves to the end of the list and wait to be
@@ -93,6 +93,7 @@ static void RemoveProcFromArray(int code, Datum arg);
 static void ProcKill(int code, Datum arg);
 static void AuxiliaryProcKill(int code, Datum arg);
 static void CheckDeadLock(void);
+static Size FastPathLockShmemSize(void);
 
 
 /*
@@ -114,9 +115,24 @@ ProcGlobalShmemSize(void)
 	size = add_size(size, mul_size(TotalProcs, sizeof(*ProcGlobal->subxidStates)));
 	size = add_size(size, mul_size(TotalProcs, sizeof(*ProcGlobal->statusFlags)));
 
+	/* fast-path lock arrays, for all PGPROCs except prepared xact dummies */
+	size = add_size(size,
+					mul_size(add_size(MaxBackends, NUM_AUXILIARY_PROCS),
+							 FastPathLockShmemSize()));
+
 	return size;
 }
 
+/*
+ * Report shared-memory space needed for one PGPROC's fast-path lock arrays.
+ */
+static Size
+FastPathLockShmemSize(void)
+{
+	return add_size(MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64)),
+					MAXALIGN(FastPathLockSlotsPerBackend() * sizeof(Oid)));
+}
+
 /*
  * Report number of semaphores needed by InitProcGlobal.
  */
@@ -163,6 +179,7 @@ InitProcGlobal(void)
 				j;
 	bool		found;
 	uint32		TotalProcs = MaxBackends + NUM_AUXILIARY_PROCS + max_prepared_xacts;
+	char	   *fpPtr;
 
 	/* Create the ProcGlobal shared structure */
 	ProcGlobal = (PROC_HDR *)
@@ -214,6 +231,16 @@ InitProcGlobal(void)
 	ProcGlobal->statusFlags = (uint8 *) ShmemAlloc(TotalProcs * sizeof(*ProcGlobal->statusFlags));
 	MemSet(ProcGlobal->statusFlags, 0, TotalProcs * sizeof(*ProcGlobal->statusFlags));
 
+	/*
+	 * Allocate the fast-path lock arrays, whose size depends on
+	 * max_locks_per_transaction (see InitializeFastPathLocks).  Prepared
+	 * xact dummy PGPROCs never hold fast-path locks, so they don't get any.
+	 */
+	fpPtr = ShmemAlloc((MaxBackends + NUM_AUXILIARY_PROCS) *
+					   FastPathLockShmemSize());
+	MemSet(fpPtr, 0, (MaxBackends + NUM_AUXILIARY_PROCS) *
+		   FastPathLockShmemSize());
+
 	for (i = 0; i < TotalProcs; i++)
 	{
 		/* Common initialization for all PGPROCs, regardless of type. */
@@ -228,6 +255,11 @@ InitProcGlobal(void)
 			procs[i].sem = PGSemaphoreCreate();
 			InitSharedLatch(&(procs[i].procLatch));
 			LWLockInitialize(&(procs[i].fpInfoLock), LWTRANCHE_LOCK_FASTPATH);
+
+			procs[i].fpLockBits = (uint64 *) fpPtr;
+			fpPtr += MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64));
+			procs[i].fpRelId = (Oid *) fpPtr;
+			fpPtr += MAXALIGN(FastPathLockSlotsPerBackend() * sizeof(Oid));
 		}
 		procs[i].pgprocno = i;
 
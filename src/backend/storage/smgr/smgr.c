@@ -50,10 +50,16 @@ typedef struct f_smgr
 								bool isRedo);
 	void		(*smgr_extend) (SMgrRelation reln, ForkNumber forknum,
 								BlockNumber blocknum, char *buffer, bool skipFsync);
+	void		(*smgr_zeroextend) (SMgrRelation reln, ForkNumber forknum,
+									BlockNumber blocknum, int nblocks,
+									bool skipFsync);
 	bool		(*smgr_prefetch) (SMgrRelation reln, ForkNumber forknum,
 								  BlockNumber blocknum);
 	void		(*smgr_read) (SMgrRelation reln, ForkNumber forknum,
 							  BlockNumber blocknum, char *buffer);
+	void		(*smgr_readv) (SMgrRelation reln, ForkNumber forknum,
+							   BlockNumber blocknum, char **buffers,
+							   BlockNumber nblocks);
 	void		(*smgr_write) (SMgrRelation reln, ForkNumber forknum,
 							   BlockNumber blocknum, char *buffer, bool skipFsync);
 	void		(*smgr_writeback) (SMgrRelation reln, ForkNumber forknum,
@@ -75,8 +81,10 @@ static const f_smgr smgrsw[] = {
 		.smgr_exists = mdexists,
 		.smgr_unlink = mdunlink,
 		.smgr_extend = mdextend,
+		.smgr_zeroextend = mdzeroextend,
 		.smgr_prefetch = mdprefetch,
 		.smgr_read = mdread,
+		.smgr_readv = mdreadv,
 		.smgr_write = mdwrite,
 		.smgr_writeback = mdwriteback,
 		.smgr_nblocks = mdnblocks,
@@ -95,6 +103,13 @@ static HTAB *SMgrRelationHash = NULL;
 
 static dlist_head unowned_relns;
 
+/*
+ * Number of transactions ended so far, as counted by AtEOXact_SMgr().  A
+ * relation whose smgr_create_xact equals this was created by the current
+ * transaction.  Starts at 1 so that zero means "not created by us".
+ */
+static uint64 smgr_xact_count = 1;
+
 /* local function prototypes */
 static void smgrshutdown(int code, Datum arg);
 
@@ -176,6 +191,7 @@ smgropen(RelFileNode rnode, BackendId backend)
 		reln->smgr_targblock = InvalidBlockNumber;
 		for (int i = 0; i <= MAX_FORKNUM; ++i)
 			reln->smgr_cached_nblocks[i] = InvalidBlockNumber;
+		reln->smgr_create_xact = 0;
 		reln->smgr_which = 0;	/* we only have md.c at present */
 
 		/* implementation-specific initialization */
@@ -333,6 +349,19 @@ void
 smgrcreate(SMgrRelation reln, ForkNumber forknum, bool isRedo)
 {
 	smgrsw[reln->smgr_which].smgr_create(reln, forknum, isRedo);
+
+	/*
+	 * Outside redo, smgr_create fails if the file already exists, so the
+	 * fork is known to be empty.  If this is a new relation, remember that
+	 * no other backend can extend it until our transaction commits, which
+	 * lets smgrnblocks_cached() trust the sizes we cache meanwhile.
+	 */
+	if (!isRedo)
+	{
+		if (forknum == MAIN_FORKNUM)
+			reln->smgr_create_xact = smgr_xact_count;
+		reln->smgr_cached_nblocks[forknum] = 0;
+	}
 }
 
 /*
@@ -476,6 +505,28 @@ smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
 }
 
+/*
+ *	smgrzeroextend() -- Add new zeroed out blocks to a file.
+ *
+ *		Similar to smgrextend(), except the relation can be extended by
+ *		multiple blocks at once, which is much cheaper than extending it
+ *		block by block, and the added blocks are filled with zeroes.
+ *		The caller must not have any of the new blocks in the buffer pool.
+ */
+void
+smgrzeroextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+			   int nblocks, bool skipFsync)
+{
+	smgrsw[reln->smgr_which].smgr_zeroextend(reln, forknum, blocknum,
+											 nblocks, skipFsync);
+
+	/* As in smgrextend(), keep the cached size up to date if we can */
+	if (reln->smgr_cached_nblocks[forknum] == blocknum)
+		reln->smgr_cached_nblocks[forknum] = blocknum + nblocks;
+	else
+		reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+}
+
 /*
  *	smgrprefetch() -- Initiate asynchronous read of the specified block of a relation.
  *
@@ -504,6 +555,21 @@ smgrread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	smgrsw[reln->smgr_which].smgr_read(reln, forknum, blocknum, buffer);
 }
 
+/*
+ *	smgrreadv() -- read a run of consecutive blocks from a relation into the
+ *				   supplied buffers, one block per buffer.
+ *
+ *		This is equivalent to calling smgrread() for each block in turn, but
+ *		lets the storage manager combine the reads into fewer system calls.
+ */
+void
+smgrreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		  char **buffers, BlockNumber nblocks)
+{
+	smgrsw[reln->smgr_which].smgr_readv(reln, forknum, blocknum, buffers,
+										nblocks);
+}
+
 /*
  *	smgrwrite() -- Write the supplied buffer out.
  *
@@ -565,17 +631,23 @@ smgrnblocks(SMgrRelation reln, ForkNumber forknum)
  *	smgrnblocks_cached() -- Get the cached number of blocks in the supplied
  *							relation.
  *
- * Returns an InvalidBlockNumber when not in recovery and when the relation
- * fork size is not cached.
+ * Returns an InvalidBlockNumber when the relation fork size is not cached, or
+ * when the cached size can't be trusted: when not in recovery, unless the
+ * relation was created in the current transaction.
  */
 BlockNumber
 smgrnblocks_cached(SMgrRelation reln, ForkNumber forknum)
 {
 	/*
-	 * For now, we only use cached values in recovery due to lack of a shared
-	 * invalidation mechanism for changes in file size.
+	 * For now, we mostly only use cached values in recovery due to lack of a
+	 * shared invalidation mechanism for changes in file size.  A relation
+	 * created by our own transaction isn't visible to anyone else yet, so
+	 * only we can have extended it, and every extension went through our
+	 * cache.  That covers truncating or dropping a relation in the
+	 * transaction that created it, notably on abort of a bulk load.
 	 */
-	if (InRecovery && reln->smgr_cached_nblocks[forknum] != InvalidBlockNumber)
+	if (reln->smgr_cached_nblocks[forknum] != InvalidBlockNumber &&
+		(InRecovery || reln->smgr_create_xact == smgr_xact_count))
 		return reln->smgr_cached_nblocks[forknum];
 
 	return InvalidBlockNumber;
@@ -692,4 +764,11 @@ AtEOXact_SMgr(void)
 
 		smgrclose(rel);
 	}
+
+	/*
+	 * Relations created by the transaction that just ended may be visible to
+	 * others from now on.  This runs after smgrDoPendingDeletes(), which
+	 * still relies on the cached sizes of the relations we created.
+	 */
+	smgr_xact_count++;
 }
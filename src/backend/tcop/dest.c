@@ -39,6 +39,7 @@
 #include "executor/tstoreReceiver.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
+#include "tcop/tcopprot.h"
 #include "utils/portal.h"
 
 
@@ -282,8 +283,17 @@ ReadyForQuery(CommandDest dest)
 				pq_sendbyte(&buf, TransactionBlockStatusCode());
 				pq_endmessage(&buf);
 			}
-			/* Flush output at end of cycle in any case. */
-			pq_flush();
+
+			/*
+			 * Flush output at end of cycle, unless we were asked to hold it
+			 * back while the client has already sent us the next message.
+			 * A pipelining client isn't waiting for this reply then, and the
+			 * results of several statements can go out in one write.  The
+			 * output is still flushed once the queued input runs out, or
+			 * whenever the send buffer fills up.
+			 */
+			if (!coalesce_pipelined_results || !pq_buffer_has_complete_msg())
+				pq_flush();
 			break;
 
 		case DestNone:
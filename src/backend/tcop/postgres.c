@@ -41,7 +41,9 @@
 #include "access/xact.h"
 #include "catalog/pg_type.h"
 #include "commands/async.h"
+#include "commands/explain.h"
 #include "commands/prepare.h"
+#include "common/hashfn.h"
 #include "executor/spi.h"
 #include "jit/jit.h"
 #include "libpq/libpq.h"
@@ -105,6 +107,12 @@ int			PostAuthDelay = 0;
 /* Time between checks that the client is still connected. */
 int			client_connection_check_interval = 0;
 
+/* Skip flushing at ReadyForQuery while the client has more messages queued? */
+bool		coalesce_pipelined_results = false;
+
+/* Max number of unnamed statements to keep for reuse; 0 disables caching */
+int			unnamed_statement_cache_size = 0;
+
 /* ----------------
  *		private typedefs etc
  * ----------------
@@ -168,6 +176,27 @@ static bool ignore_till_sync = false;
  */
 static CachedPlanSource *unnamed_stmt_psrc = NULL;
 
+/*
+ * If unnamed_statement_cache_size is set, recently parsed unnamed statements
+ * are not dropped when they're replaced, but kept in a small LRU list, from
+ * which a later Parse of the same query text with the same parameter types
+ * can take the CachedPlanSource instead of parsing and analyzing the query
+ * again.  The plancache takes care of revalidating the entries when needed.
+ * unnamed_stmt_is_cached says whether unnamed_stmt_psrc is in the list.
+ */
+typedef struct UnnamedStmtCacheEntry
+{
+	dlist_node	node;			/* list link, most recently used first */
+	uint32		hash;			/* hash of query string and param types */
+	int			num_params;		/* param types as sent by the client */
+	Oid		   *param_types;
+	CachedPlanSource *psrc;		/* the entry is allocated in psrc->context */
+} UnnamedStmtCacheEntry;
+
+static dlist_head unnamed_stmt_cache = DLIST_STATIC_INIT(unnamed_stmt_cache);
+static int	unnamed_stmt_cache_count = 0;
+static bool unnamed_stmt_is_cached = false;
+
 /* assorted command-line switches */
 static const char *userDoption = NULL;	/* -D switch */
 static bool EchoQuery = false;	/* -E switch */
@@ -203,7 +232,17 @@ static bool IsTransactionExitStmt(Node *parsetree);
 static bool IsTransactionExitStmtList(List *pstmts);
 static bool IsTransactionStmtList(List *pstmts);
 static void drop_unnamed_stmt(void);
+static uint32 unnamed_stmt_cache_hash(const char *query_string,
+									  Oid *paramTypes, int numParams);
+static CachedPlanSource *unnamed_stmt_cache_lookup(const char *query_string,
+												   Oid *paramTypes,
+												   int numParams,
+												   uint32 hash);
+static void unnamed_stmt_cache_insert(CachedPlanSource *psrc, uint32 hash,
+									  Oid *paramTypes, int numParams);
+static void unnamed_stmt_cache_trim(int max_entries);
 static void log_disconnections(int code, Datum arg);
+static void log_connection_setup(void);
 static void enable_statement_timeout(void);
 static void disable_statement_timeout(void);
 
@@ -1315,6 +1354,10 @@ exec_parse_message(const char *query_string,	/* string to execute */
 	List	   *querytree_list;
 	CachedPlanSource *psrc;
 	bool		is_named;
+	bool		use_cache = false;
+	uint32		cache_hash = 0;
+	Oid		   *client_param_types = NULL;
+	int			client_num_params = numParams;
 	bool		save_log_statement_stats = log_statement_stats;
 	char		msec_str[32];
 
@@ -1357,15 +1400,57 @@ exec_parse_message(const char *query_string,	/* string to execute */
 	 * query_context here, and do all the parsing work therein.
 	 */
 	is_named = (stmt_name[0] != '\0');
-	if (is_named)
+	if (!is_named)
+	{
+		/* Unnamed prepared statement --- release any prior unnamed stmt */
+		drop_unnamed_stmt();
+
+		/*
+		 * If we have the same statement cached, just make it the unnamed
+		 * statement again.  We don't use the cache in an aborted transaction,
+		 * to leave the check for that below in charge.
+		 */
+		unnamed_stmt_cache_trim(unnamed_statement_cache_size);
+		if (unnamed_statement_cache_size > 0 &&
+			!IsAbortedTransactionBlockState())
+		{
+			cache_hash = unnamed_stmt_cache_hash(query_string,
+												 paramTypes, numParams);
+			psrc = unnamed_stmt_cache_lookup(query_string,
+											 paramTypes, numParams,
+											 cache_hash);
+			if (psrc != NULL)
+			{
+				unnamed_stmt_psrc = psrc;
+				unnamed_stmt_is_cached = true;
+				oldcontext = CurrentMemoryContext;
+				goto parse_complete;
+			}
+
+			/*
+			 * Not found, so parse it like a named statement, whose parse
+			 * trees are built in MessageContext and then copied.  Remember
+			 * the parameter types the client sent, since parse analysis may
+			 * change the array.
+			 */
+			use_cache = true;
+			if (numParams > 0)
+			{
+				client_param_types = (Oid *)
+					palloc(numParams * sizeof(Oid));
+				memcpy(client_param_types, paramTypes,
+					   numParams * sizeof(Oid));
+			}
+		}
+	}
+
+	if (is_named || use_cache)
 	{
 		/* Named prepared statement --- parse in MessageContext */
 		oldcontext = MemoryContextSwitchTo(MessageContext);
 	}
 	else
 	{
-		/* Unnamed prepared statement --- release any prior unnamed stmt */
-		drop_unnamed_stmt();
 		/* Create context for parsing */
 		unnamed_stmt_context =
 			AllocSetContextCreate(MessageContext,
@@ -1511,8 +1596,17 @@ exec_parse_message(const char *query_string,	/* string to execute */
 		 */
 		SaveCachedPlan(psrc);
 		unnamed_stmt_psrc = psrc;
+
+		/* Keep it for reuse, unless it's the empty query */
+		if (use_cache && psrc->raw_parse_tree != NULL)
+		{
+			unnamed_stmt_cache_insert(psrc, cache_hash,
+									  client_param_types, client_num_params);
+			unnamed_stmt_is_cached = true;
+		}
 	}
 
+parse_complete:
 	MemoryContextSwitchTo(oldcontext);
 
 	/*
@@ -2770,7 +2864,11 @@ IsTransactionStmtList(List *pstmts)
 	return false;
 }
 
-/* Release any existing unnamed prepared statement */
+/*
+ * Release any existing unnamed prepared statement
+ *
+ * If it's in the unnamed statement cache, it stays there.
+ */
 static void
 drop_unnamed_stmt(void)
 {
@@ -2780,10 +2878,129 @@ drop_unnamed_stmt(void)
 		CachedPlanSource *psrc = unnamed_stmt_psrc;
 
 		unnamed_stmt_psrc = NULL;
-		DropCachedPlan(psrc);
+		if (unnamed_stmt_is_cached)
+			unnamed_stmt_is_cached = false;
+		else
+			DropCachedPlan(psrc);
+	}
+}
+
+/*
+ * Compute the unnamed statement cache hash key for a Parse message
+ */
+static uint32
+unnamed_stmt_cache_hash(const char *query_string, Oid *paramTypes,
+						int numParams)
+{
+	uint32		hash;
+
+	hash = hash_bytes((const unsigned char *) query_string,
+					  strlen(query_string));
+	if (numParams > 0)
+		hash = hash_combine(hash,
+							hash_bytes((const unsigned char *) paramTypes,
+									   numParams * sizeof(Oid)));
+	return hash;
+}
+
+/*
+ * Look for a cached unnamed statement matching a Parse message
+ *
+ * On success, the entry is moved to the front of the LRU list.
+ */
+static CachedPlanSource *
+unnamed_stmt_cache_lookup(const char *query_string, Oid *paramTypes,
+						  int numParams, uint32 hash)
+{
+	dlist_iter	iter;
+
+	dlist_foreach(iter, &unnamed_stmt_cache)
+	{
+		UnnamedStmtCacheEntry *entry =
+		dlist_container(UnnamedStmtCacheEntry, node, iter.cur);
+
+		if (entry->hash != hash ||
+			entry->num_params != numParams ||
+			(numParams > 0 &&
+			 memcmp(entry->param_types, paramTypes,
+					numParams * sizeof(Oid)) != 0) ||
+			strcmp(entry->psrc->query_string, query_string) != 0)
+			continue;
+
+		dlist_move_head(&unnamed_stmt_cache, &entry->node);
+		return entry->psrc;
+	}
+
+	return NULL;
+}
+
+/*
+ * Add a just-saved unnamed statement to the cache, evicting the least
+ * recently used entry if the cache is full
+ */
+static void
+unnamed_stmt_cache_insert(CachedPlanSource *psrc, uint32 hash,
+						  Oid *paramTypes, int numParams)
+{
+	UnnamedStmtCacheEntry *entry;
+
+	Assert(psrc->is_saved);
+
+	unnamed_stmt_cache_trim(unnamed_statement_cache_size - 1);
+
+	entry = (UnnamedStmtCacheEntry *)
+		MemoryContextAlloc(psrc->context, sizeof(UnnamedStmtCacheEntry));
+	entry->hash = hash;
+	entry->num_params = numParams;
+	entry->param_types = NULL;
+	if (numParams > 0)
+	{
+		entry->param_types = (Oid *)
+			MemoryContextAlloc(psrc->context, numParams * sizeof(Oid));
+		memcpy(entry->param_types, paramTypes, numParams * sizeof(Oid));
+	}
+	entry->psrc = psrc;
+
+	dlist_push_head(&unnamed_stmt_cache, &entry->node);
+	unnamed_stmt_cache_count++;
+}
+
+/*
+ * Drop least recently used cache entries until at most max_entries remain
+ *
+ * The current unnamed statement is never dropped here; if it's evicted, it
+ * just stops being cached, and is dropped when it gets replaced.
+ */
+static void
+unnamed_stmt_cache_trim(int max_entries)
+{
+	while (unnamed_stmt_cache_count > Max(max_entries, 0))
+	{
+		UnnamedStmtCacheEntry *entry;
+		CachedPlanSource *psrc;
+
+		entry = dlist_container(UnnamedStmtCacheEntry, node,
+								dlist_tail_node(&unnamed_stmt_cache));
+		psrc = entry->psrc;
+		dlist_delete(&entry->node);
+		unnamed_stmt_cache_count--;
+
+		if (psrc == unnamed_stmt_psrc)
+			unnamed_stmt_is_cached = false;
+		else
+			DropCachedPlan(psrc);
 	}
 }
 
+/*
+ * Discard all cached unnamed statements, as DISCARD ALL does
+ */
+void
+DropUnnamedStatementCache(void)
+{
+	unnamed_stmt_cache_trim(0);
+}
+
 
 /* --------------------------------
  *		signal handler routines used in PostgresMain()
@@ -3338,6 +3555,9 @@ ProcessInterrupts(void)
 
 	if (LogMemoryContextPending)
 		ProcessLogMemoryContextInterrupt();
+
+	if (LogQueryPlanPending)
+		ProcessLogQueryPlanInterrupt();
 }
 
 
@@ -4022,6 +4242,7 @@ PostgresMain(int argc, char *argv[],
 
 		/* Initialize MaxBackends (if under postmaster, was done already) */
 		InitializeMaxBackends();
+		InitializeFastPathLocks();
 	}
 
 	/* Early initialization */
@@ -4372,6 +4593,10 @@ PostgresMain(int argc, char *argv[],
 			/* Report any recently-changed GUC options */
 			ReportChangedGUCOptions();
 
+			/* Report how long it took to get here, the first time through */
+			if (Log_connections && conn_timing.fork_start != 0)
+				log_connection_setup();
+
 			ReadyForQuery(whereToSendOutput);
 			send_ready_for_query = false;
 		}
@@ -4894,6 +5119,26 @@ log_disconnections(int code, Datum arg)
 					port->remote_port[0] ? " port=" : "", port->remote_port)));
 }
 
+/*
+ * Log how long setting up the connection took, broken down into the time
+ * spent forking the backend and authenticating the client.  This helps to
+ * judge how much a connection pooler would save.  Only done once per
+ * session.
+ */
+static void
+log_connection_setup(void)
+{
+	TimestampTz now = GetCurrentTimestamp();
+
+	ereport(LOG,
+			(errmsg("connection ready: setup total=%.3f ms, fork=%.3f ms, authentication=%.3f ms",
+					(double) (now - conn_timing.fork_start) / 1000.0,
+					(double) (MyStartTimestamp - conn_timing.fork_start) / 1000.0,
+					(double) (conn_timing.auth_end - conn_timing.auth_start) / 1000.0)));
+
+	conn_timing.fork_start = 0;
+}
+
 /*
  * Start statement timeout timer, if enabled.
  *
@@ -445,6 +445,10 @@ pgstat_bestart(void)
 
 	PGSTAT_END_WRITE_ACTIVITY(vbeentry);
 
+	/* From now on, account for our memory usage in the shared entry */
+	SetBackendAllocatedBytesLocation(unvolatize(uint64 *,
+												&vbeentry->st_allocated_bytes));
+
 	/* Update app name to current GUC setting */
 	if (application_name)
 		pgstat_report_appname(application_name);
@@ -458,6 +462,9 @@ pgstat_beshutdown_hook(int code, Datum arg)
 {
 	volatile PgBackendStatus *beentry = MyBEEntry;
 
+	/* Stop updating the entry's memory usage */
+	SetBackendAllocatedBytesLocation(NULL);
+
 	/*
 	 * Clear my status entry, following the protocol of bumping st_changecount
 	 * before and after.  We use a volatile pointer here to ensure the
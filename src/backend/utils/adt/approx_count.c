@@ -0,0 +1,200 @@
+/*-------------------------------------------------------------------------
+ *
+ * approx_count.c
+ *	  Approximate count of distinct values, using HyperLogLog.
+ *
+ * approx_count_distinct(anyelement) estimates the number of distinct
+ * non-null input values in a fixed amount of memory per group.  Unlike
+ * count(DISTINCT ...), it needs neither a sort nor a hash table of the
+ * values seen, and its transition states can be combined, so it can be
+ * computed by parallel workers and by partial aggregation.
+ *
+ * Values are hashed with the type's default hash opclass, so two values
+ * are counted as the same if that opclass considers them equal.
+ *
+ * Portions Copyright (c) 1996-2021, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/adt/approx_count.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "fmgr.h"
+#include "lib/hyperloglog.h"
+#include "utils/builtins.h"
+#include "utils/typcache.h"
+
+/*
+ * Bit width of the HyperLogLog estimator.  2^12 one-byte registers give a
+ * standard error of about 1.6%, while keeping the state small enough for
+ * hash aggregation over many groups.
+ */
+#define APPROX_COUNT_BWIDTH		12
+
+static hyperLogLogState *
+make_approx_count_state(MemoryContext aggcontext)
+{
+	MemoryContext oldcontext;
+	hyperLogLogState *state;
+
+	oldcontext = MemoryContextSwitchTo(aggcontext);
+	state = (hyperLogLogState *) palloc(sizeof(hyperLogLogState));
+	initHyperLogLog(state, APPROX_COUNT_BWIDTH);
+	MemoryContextSwitchTo(oldcontext);
+
+	return state;
+}
+
+/*
+ * approx_count_distinct_transfn
+ *		Add the hash of a non-null input value to the estimator.
+ */
+Datum
+approx_count_distinct_transfn(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	hyperLogLogState *state;
+	TypeCacheEntry *typentry;
+	uint32		hash;
+
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state = PG_ARGISNULL(0) ? NULL : (hyperLogLogState *) PG_GETARG_POINTER(0);
+	if (state == NULL)
+		state = make_approx_count_state(aggcontext);
+
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(state);
+
+	/* Look up the input type's hash function once per query */
+	typentry = (TypeCacheEntry *) fcinfo->flinfo->fn_extra;
+	if (typentry == NULL)
+	{
+		Oid			argtype = get_fn_expr_argtype(fcinfo->flinfo, 1);
+
+		typentry = lookup_type_cache(argtype, TYPECACHE_HASH_PROC_FINFO);
+		if (!OidIsValid(typentry->hash_proc_finfo.fn_oid))
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FUNCTION),
+					 errmsg("could not identify a hash function for type %s",
+							format_type_be(argtype))));
+		fcinfo->flinfo->fn_extra = (void *) typentry;
+	}
+
+	hash = DatumGetUInt32(FunctionCall1Coll(&typentry->hash_proc_finfo,
+											PG_GET_COLLATION(),
+											PG_GETARG_DATUM(1)));
+	addHyperLogLog(state, hash);
+
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * approx_count_distinct_combine
+ *		Merge two estimators; the result covers the union of their inputs.
+ */
+Datum
+approx_count_distinct_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	hyperLogLogState *state1;
+	hyperLogLogState *state2;
+
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state1 = PG_ARGISNULL(0) ? NULL : (hyperLogLogState *) PG_GETARG_POINTER(0);
+	state2 = PG_ARGISNULL(1) ? NULL : (hyperLogLogState *) PG_GETARG_POINTER(1);
+
+	if (state2 == NULL)
+		PG_RETURN_POINTER(state1);
+
+	if (state1 == NULL)
+		state1 = make_approx_count_state(aggcontext);
+
+	mergeHyperLogLog(state1, state2);
+
+	PG_RETURN_POINTER(state1);
+}
+
+/*
+ * approx_count_distinct_serialize
+ *		Serialize the estimator as its bit width followed by its registers.
+ */
+Datum
+approx_count_distinct_serialize(PG_FUNCTION_ARGS)
+{
+	hyperLogLogState *state;
+	bytea	   *result;
+
+	/* Ensure we disallow calling when not in aggregate context */
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state = (hyperLogLogState *) PG_GETARG_POINTER(0);
+
+	result = (bytea *) palloc(VARHDRSZ + 1 + state->nRegisters);
+	SET_VARSIZE(result, VARHDRSZ + 1 + state->nRegisters);
+	*((uint8 *) VARDATA(result)) = state->registerWidth;
+	memcpy(VARDATA(result) + 1, state->hashesArr, state->nRegisters);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+/*
+ * approx_count_distinct_deserialize
+ *		Deserialize bytea back into an estimator.
+ */
+Datum
+approx_count_distinct_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea	   *sstate;
+	hyperLogLogState *result;
+	uint8		bwidth;
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	sstate = PG_GETARG_BYTEA_PP(0);
+
+	if (VARSIZE_ANY_EXHDR(sstate) < 1)
+		elog(ERROR, "invalid approx_count_distinct state");
+	bwidth = *((uint8 *) VARDATA_ANY(sstate));
+
+	result = (hyperLogLogState *) palloc(sizeof(hyperLogLogState));
+	initHyperLogLog(result, bwidth);
+
+	if (VARSIZE_ANY_EXHDR(sstate) != 1 + result->nRegisters)
+		elog(ERROR, "invalid approx_count_distinct state");
+	memcpy(result->hashesArr, VARDATA_ANY(sstate) + 1, result->nRegisters);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * approx_count_distinct_finalfn
+ *		Return the estimated number of distinct values.
+ */
+Datum
+approx_count_distinct_finalfn(PG_FUNCTION_ARGS)
+{
+	hyperLogLogState *state;
+
+	/* cannot be called directly because of internal-type argument */
+	Assert(AggCheckCallContext(fcinfo, NULL));
+
+	state = PG_ARGISNULL(0) ? NULL : (hyperLogLogState *) PG_GETARG_POINTER(0);
+
+	/* No rows at all, or only nulls before the state was created */
+	if (state == NULL)
+		PG_RETURN_INT64(0);
+
+	PG_RETURN_INT64((int64) rint(estimateHyperLogLog(state)));
+}
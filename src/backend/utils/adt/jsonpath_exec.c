@@ -176,6 +176,8 @@ typedef Numeric (*BinaryArithmFunc) (Numeric num1, Numeric num2, bool *error);
 static JsonPathExecResult executeJsonPath(JsonPath *path, Jsonb *vars,
 										  Jsonb *json, bool throwErrors,
 										  JsonValueList *result, bool useTz);
+static bool executeKeyChain(JsonPathItem *jsp, JsonbValue *root, bool laxMode,
+							JsonValueList *result, JsonPathExecResult *res);
 static JsonPathExecResult executeItem(JsonPathExecContext *cxt,
 									  JsonPathItem *jsp, JsonbValue *jb, JsonValueList *found);
 static JsonPathExecResult executeItemOptUnwrapTarget(JsonPathExecContext *cxt,
@@ -557,6 +559,11 @@ executeJsonPath(JsonPath *path, Jsonb *vars, Jsonb *json, bool throwErrors,
 				 errdetail("Jsonpath parameters should be encoded as key-value pairs of \"vars\" object.")));
 	}
 
+	/* Simple chains of member accessors don't need the full executor */
+	if (executeKeyChain(&jsp, &jbv, (path->header & JSONPATH_LAX) != 0,
+						result, &res))
+		return res;
+
 	cxt.vars = vars;
 	cxt.laxMode = (path->header & JSONPATH_LAX) != 0;
 	cxt.ignoreStructuralErrors = cxt.laxMode;
@@ -592,6 +599,68 @@ executeJsonPath(JsonPath *path, Jsonb *vars, Jsonb *json, bool throwErrors,
 	return res;
 }
 
+/*
+ * Try to evaluate a path of the form $.key1.key2... directly.
+ *
+ * Such paths are very common in filters, and walking them with
+ * findJsonbValueFromContainer() avoids all the bookkeeping of the general
+ * executor.  We only handle the cases that can't raise an error or involve
+ * lax-mode array unwrapping: every step must be applied to an object, and in
+ * strict mode every key must be present.  Returns false, leaving the work to
+ * executeItem(), if the path or the document doesn't qualify.
+ */
+static bool
+executeKeyChain(JsonPathItem *jsp, JsonbValue *root, bool laxMode,
+				JsonValueList *result, JsonPathExecResult *res)
+{
+	JsonPathItem item;
+	JsonbValue *cur = root;
+
+	if (jsp->type != jpiRoot || !jspHasNext(jsp))
+		return false;
+
+	/* Check the shape of the path before doing any work */
+	item = *jsp;
+	while (jspGetNext(&item, &item))
+	{
+		if (item.type != jpiKey)
+			return false;
+	}
+
+	item = *jsp;
+	while (jspGetNext(&item, &item))
+	{
+		JsonbValue	key;
+		JsonbValue *v;
+
+		if (JsonbType(cur) != jbvObject)
+			return false;
+
+		key.type = jbvString;
+		key.val.string.val = jspGetString(&item, &key.val.string.len);
+
+		v = findJsonbValueFromContainer(cur->val.binary.data,
+										JB_FOBJECT, &key);
+		if (v == NULL)
+		{
+			/* lax mode ignores missing keys, strict mode reports them */
+			if (!laxMode)
+				return false;
+			*res = jperNotFound;
+			return true;
+		}
+
+		if (cur != root)
+			pfree(cur);
+		cur = v;
+	}
+
+	if (result)
+		JsonValueListAppend(result, cur);
+	*res = jperOk;
+	return true;
+}
+
 /*
  * Execute jsonpath with automatic unwrapping of current item in lax mode.
  */
@@ -15,6 +15,9 @@
  * MatchText - to name of function wanted
  * do_like_escape - name of function if wanted - needs CHAREQ and CopyAdvChar
  * MATCH_LOWER - define for case (4) to specify case folding for 1-byte chars
+ * MATCH_MEMCHR - define if a byte that can start a pattern character is
+ *		always the start of a text character too, so that % can search for
+ *		the next candidate position with memchr()
  *
  * Copyright (c) 1996-2021, PostgreSQL Global Development Group
  *
@@ -173,14 +176,26 @@ MatchText(const char *t, int tlen, const char *p, int plen,
 
 			while (tlen > 0)
 			{
-				if (GETCHAR(*t) == firstpat)
-				{
-					int			matched = MatchText(t, tlen, p, plen,
-													locale, locale_is_c);
+				int			matched;
+
+#ifdef MATCH_MEMCHR
+				const char *next = memchr(t, (unsigned char) firstpat, tlen);
 
-					if (matched != LIKE_FALSE)
-						return matched; /* TRUE or ABORT */
+				if (next == NULL)
+					break;
+				tlen -= next - t;
+				t = next;
+#else
+				if (GETCHAR(*t) != firstpat)
+				{
+					NextChar(t, tlen);
+					continue;
 				}
+#endif
+
+				matched = MatchText(t, tlen, p, plen, locale, locale_is_c);
+				if (matched != LIKE_FALSE)
+					return matched; /* TRUE or ABORT */
 
 				NextChar(t, tlen);
 			}
@@ -356,5 +371,8 @@ do_like_escape(text *pat, text *esc)
 
 #ifdef MATCH_LOWER
 #undef MATCH_LOWER
+#endif
 
+#ifdef MATCH_MEMCHR
+#undef MATCH_MEMCHR
 #endif
@@ -103,6 +103,13 @@ typedef signed char NumericDigit;
 typedef int16 NumericDigit;
 #endif
 
+/*
+ * If the two inputs of a multiplication have at most this many digits
+ * between them, the product of their digit strings fits in a uint64, and
+ * mul_var can use native arithmetic (NBASE^MUL_SHORT_MAX_DIGITS <= 10^19).
+ */
+#define MUL_SHORT_MAX_DIGITS	(19 / DEC_DIGITS)
+
 /*
  * The Numeric type as stored on disk.
  *
@@ -8259,6 +8266,50 @@ mul_var(const NumericVar *var1, const NumericVar *var2, NumericVar *result,
 	res_ndigits = var1ndigits + var2ndigits + 1;
 	maxdigits = res_weight + 1 + (rscale + DEC_DIGITS - 1) / DEC_DIGITS +
 		MUL_GUARD_DIGITS;
+
+	/*
+	 * If both inputs are short and we need the exact product anyway, treat
+	 * their digit strings as integers and multiply them natively.  This is
+	 * the common case for things like price * quantity, and avoids the
+	 * accumulator array and carry propagation of the general algorithm.  It
+	 * computes exactly the same digits the general algorithm would.
+	 */
+	if (var1ndigits + var2ndigits <= MUL_SHORT_MAX_DIGITS &&
+		res_ndigits <= maxdigits)
+	{
+		uint64		prod1 = 0;
+		uint64		prod2 = 0;
+		uint64		product;
+
+		for (i = 0; i < var1ndigits; i++)
+			prod1 = prod1 * NBASE + var1digits[i];
+		for (i = 0; i < var2ndigits; i++)
+			prod2 = prod2 * NBASE + var2digits[i];
+		product = prod1 * prod2;
+
+		/* Only now is it safe to overwrite result, which may be an input */
+		alloc_var(result, res_ndigits);
+		res_digits = result->digits;
+		for (i = res_ndigits - 1; i >= 0; i--)
+		{
+			uint64		newproduct = product / NBASE;
+
+			res_digits[i] = (NumericDigit) (product - newproduct * NBASE);
+			product = newproduct;
+		}
+		Assert(product == 0);
+
+		result->weight = res_weight;
+		result->sign = res_sign;
+
+		/* Round to target rscale (and set result->dscale) */
+		round_var(result, rscale);
+
+		/* Strip leading and trailing zeroes */
+		strip_var(result);
+		return;
+	}
+
 	res_ndigits = Min(res_ndigits, maxdigits);
 
 	if (res_ndigits < 3)
@@ -40,6 +40,7 @@
 #include "parser/parse_coerce.h"
 #include "parser/parse_relation.h"
 #include "storage/bufmgr.h"
+#include "storage/proc.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
@@ -163,12 +164,40 @@ typedef struct RI_CompareHashEntry
 } RI_CompareHashEntry;
 
 
+/*
+ * RI_LastCheckEntry
+ *
+ * The FK key most recently found in the PK table by RI_FKey_check(), per
+ * constraint.  Bulk inserts into a referencing table typically reference the
+ * same PK row many times in a row; once a check has found and KEY SHARE
+ * locked that row, nobody else can delete it or change its key until our
+ * (sub)transaction ends.  Our own transaction can, though, so the entry is
+ * only trusted as long as no command has run since the check (which is what
+ * the command ID tells us; each RI query and each trigger query runs as a
+ * command of its own) and no PK-side RI trigger has fired.
+ */
+typedef struct RI_LastCheckEntry
+{
+	Oid			constraint_id;	/* OID of pg_constraint entry (hash key) */
+	LocalTransactionId lxid;	/* transaction that did the check */
+	SubTransactionId subxid;	/* ... and subtransaction holding the lock */
+	CommandId	cid;			/* ... and the command current after it */
+	uint64		pk_change_count;	/* ri_pk_change_count at the time */
+	int			nkeys;			/* number of valid entries in keys[] */
+	Datum		keys[RI_MAX_NUMKEYS];	/* FK values, copied into
+										 * TopMemoryContext */
+	bool		keybyval[RI_MAX_NUMKEYS];
+} RI_LastCheckEntry;
+
+
 /*
  * Local data
  */
 static HTAB *ri_constraint_cache = NULL;
 static HTAB *ri_query_cache = NULL;
 static HTAB *ri_compare_cache = NULL;
+static HTAB *ri_lastcheck_cache = NULL;
+static uint64 ri_pk_change_count = 0;	/* # of PK-side RI trigger calls */
 static dlist_head ri_constraint_cache_valid_list;
 static int	ri_constraint_cache_valid_count = 0;
 
@@ -198,6 +227,10 @@ static bool ri_KeysEqual(Relation rel, TupleTableSlot *oldslot, TupleTableSlot *
 						 const RI_ConstraintInfo *riinfo, bool rel_is_pk);
 static bool ri_AttributesEqual(Oid eq_opr, Oid typeid,
 							   Datum oldvalue, Datum newvalue);
+static bool ri_LastCheckMatches(Relation fk_rel, TupleTableSlot *newslot,
+								const RI_ConstraintInfo *riinfo);
+static void ri_RememberLastCheck(Relation fk_rel, TupleTableSlot *newslot,
+								 const RI_ConstraintInfo *riinfo);
 
 static void ri_InitHashTables(void);
 static void InvalidateConstraintCacheCallBack(Datum arg, int cacheid, uint32 hashvalue);
@@ -337,6 +370,13 @@ RI_FKey_check(TriggerData *trigdata)
 			break;
 	}
 
+	/* Nothing to do if we just checked and locked the same key */
+	if (ri_LastCheckMatches(fk_rel, newslot, riinfo))
+	{
+		table_close(pk_rel, RowShareLock);
+		return PointerGetDatum(NULL);
+	}
+
 	if (SPI_connect() != SPI_OK_CONNECT)
 		elog(ERROR, "SPI_connect failed");
 
@@ -406,6 +446,8 @@ RI_FKey_check(TriggerData *trigdata)
 	if (SPI_finish() != SPI_OK_FINISH)
 		elog(ERROR, "SPI_finish failed");
 
+	ri_RememberLastCheck(fk_rel, newslot, riinfo);
+
 	table_close(pk_rel, RowShareLock);
 
 	return PointerGetDatum(NULL);
@@ -630,6 +672,9 @@ ri_restrict(TriggerData *trigdata, bool is_no_action)
 	riinfo = ri_FetchConstraintInfo(trigdata->tg_trigger,
 									trigdata->tg_relation, true);
 
+	/* The PK table is being modified; forget all remembered checks */
+	ri_pk_change_count++;
+
 	/*
 	 * Get the relation descriptors of the FK and PK tables and the old tuple.
 	 *
@@ -753,6 +798,9 @@ RI_FKey_cascade_del(PG_FUNCTION_ARGS)
 	riinfo = ri_FetchConstraintInfo(trigdata->tg_trigger,
 									trigdata->tg_relation, true);
 
+	/* The PK table is being modified; forget all remembered checks */
+	ri_pk_change_count++;
+
 	/*
 	 * Get the relation descriptors of the FK and PK tables and the old tuple.
 	 *
@@ -860,6 +908,9 @@ RI_FKey_cascade_upd(PG_FUNCTION_ARGS)
 	riinfo = ri_FetchConstraintInfo(trigdata->tg_trigger,
 									trigdata->tg_relation, true);
 
+	/* The PK table is being modified; forget all remembered checks */
+	ri_pk_change_count++;
+
 	/*
 	 * Get the relation descriptors of the FK and PK tables and the new and
 	 * old tuple.
@@ -1037,6 +1088,9 @@ ri_set(TriggerData *trigdata, bool is_set_null)
 	riinfo = ri_FetchConstraintInfo(trigdata->tg_trigger,
 									trigdata->tg_relation, true);
 
+	/* The PK table is being modified; forget all remembered checks */
+	ri_pk_change_count++;
+
 	/*
 	 * Get the relation descriptors of the FK and PK tables and the old tuple.
 	 *
@@ -2625,6 +2679,12 @@ ri_InitHashTables(void)
 	ri_compare_cache = hash_create("RI compare cache",
 								   RI_INIT_QUERYHASHSIZE,
 								   &ctl, HASH_ELEM | HASH_BLOBS);
+
+	ctl.keysize = sizeof(Oid);
+	ctl.entrysize = sizeof(RI_LastCheckEntry);
+	ri_lastcheck_cache = hash_create("RI last check cache",
+									 RI_INIT_CONSTRAINTHASHSIZE,
+									 &ctl, HASH_ELEM | HASH_BLOBS);
 }
 
 
@@ -2827,6 +2887,105 @@ ri_AttributesEqual(Oid eq_opr, Oid typeid,
 										  oldvalue, newvalue));
 }
 
+/*
+ * ri_LastCheckMatches -
+ *
+ * Is the FK key in newslot equal to the one most recently found by
+ * RI_FKey_check() for this constraint, with nothing having run since that
+ * could have removed the PK row?  See RI_LastCheckEntry.
+ *
+ * NB: we have already checked that no key value is null.
+ */
+static bool
+ri_LastCheckMatches(Relation fk_rel, TupleTableSlot *newslot,
+					const RI_ConstraintInfo *riinfo)
+{
+	RI_LastCheckEntry *entry;
+
+	/* ri_LoadConstraintInfo has initialized the hashtables */
+	entry = (RI_LastCheckEntry *) hash_search(ri_lastcheck_cache,
+											  (void *) &riinfo->constraint_id,
+											  HASH_FIND, NULL);
+	if (entry == NULL ||
+		entry->lxid != MyProc->lxid ||
+		entry->subxid != GetCurrentSubTransactionId() ||
+		entry->cid != GetCurrentCommandId(false) ||
+		entry->pk_change_count != ri_pk_change_count ||
+		entry->nkeys != riinfo->nkeys)
+		return false;
+
+	for (int i = 0; i < riinfo->nkeys; i++)
+	{
+		Datum		newvalue;
+		bool		isnull;
+
+		newvalue = slot_getattr(newslot, riinfo->fk_attnums[i], &isnull);
+		Assert(!isnull);
+
+		if (!ri_AttributesEqual(riinfo->ff_eq_oprs[i],
+								RIAttType(fk_rel, riinfo->fk_attnums[i]),
+								entry->keys[i], newvalue))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * ri_RememberLastCheck -
+ *
+ * Remember the FK key in newslot as successfully checked, see
+ * RI_LastCheckEntry.
+ */
+static void
+ri_RememberLastCheck(Relation fk_rel, TupleTableSlot *newslot,
+					 const RI_ConstraintInfo *riinfo)
+{
+	RI_LastCheckEntry *entry;
+	bool		found;
+	MemoryContext oldcxt;
+
+	entry = (RI_LastCheckEntry *) hash_search(ri_lastcheck_cache,
+											  (void *) &riinfo->constraint_id,
+											  HASH_ENTER, &found);
+
+	/* Release the previous key's storage, if any */
+	if (!found)
+		entry->nkeys = 0;
+	for (int i = 0; i < entry->nkeys; i++)
+	{
+		if (!entry->keybyval[i])
+			pfree(DatumGetPointer(entry->keys[i]));
+	}
+	entry->nkeys = 0;
+
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	for (int i = 0; i < riinfo->nkeys; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(RelationGetDescr(fk_rel),
+											  riinfo->fk_attnums[i] - 1);
+		Datum		value;
+		bool		isnull;
+
+		value = slot_getattr(newslot, riinfo->fk_attnums[i], &isnull);
+		Assert(!isnull);
+
+		/* Don't keep pointers to toasted values around */
+		if (att->attlen == -1)
+			entry->keys[i] = PointerGetDatum(PG_DETOAST_DATUM_COPY(value));
+		else
+			entry->keys[i] = datumCopy(value, att->attbyval, att->attlen);
+		entry->keybyval[i] = att->attbyval;
+		entry->nkeys = i + 1;
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	entry->lxid = MyProc->lxid;
+	entry->subxid = GetCurrentSubTransactionId();
+	entry->cid = GetCurrentCommandId(false);
+	entry->pk_change_count = ri_pk_change_count;
+}
+
 /*
  * ri_HashCompareOp -
  *
@@ -127,7 +127,6 @@ static int	namefastcmp_c(Datum x, Datum y, SortSupport ssup);
 static int	varlenafastcmp_locale(Datum x, Datum y, SortSupport ssup);
 static int	namefastcmp_locale(Datum x, Datum y, SortSupport ssup);
 static int	varstrfastcmp_locale(char *a1p, int len1, char *a2p, int len2, SortSupport ssup);
-static int	varstrcmp_abbrev(Datum x, Datum y, SortSupport ssup);
 static Datum varstr_abbrev_convert(Datum original, SortSupport ssup);
 static bool varstr_abbrev_abort(int memtupcount, SortSupport ssup);
 static int32 text_length(Datum str);
@@ -1525,6 +1524,42 @@ check_collation_set(Oid collid)
 	}
 }
 
+/*
+ * Look up what varstr_cmp() and friends need to know about a collation.
+ *
+ * These functions are called once per comparison, for example during B-tree
+ * index searches, and lc_collate_is_c() and pg_newlocale_from_collation()
+ * each cost a hash table lookup for anything but the default collation.  So
+ * remember the answer for the collation we saw last, which is nearly always
+ * the one we're asked about next.  The pg_locale_t objects are never freed,
+ * so it's safe to hang on to one.
+ */
+static void
+varstr_lookup_collation(Oid collid, bool *collate_c, pg_locale_t *locale)
+{
+	static Oid	cached_collid = InvalidOid;
+	static bool cached_collate_c = false;
+	static pg_locale_t cached_locale = 0;
+
+	check_collation_set(collid);
+
+	if (collid != cached_collid)
+	{
+		bool		is_c = lc_collate_is_c(collid);
+		pg_locale_t mylocale = 0;
+
+		if (!is_c && collid != DEFAULT_COLLATION_OID)
+			mylocale = pg_newlocale_from_collation(collid);
+
+		cached_collate_c = is_c;
+		cached_locale = mylocale;
+		cached_collid = collid;
+	}
+
+	*collate_c = cached_collate_c;
+	*locale = cached_locale;
+}
+
 /* varstr_cmp()
  * Comparison function for text strings with given lengths.
  * Includes locale support, but must copy strings to temporary memory
@@ -1542,16 +1577,19 @@ int
 varstr_cmp(const char *arg1, int len1, const char *arg2, int len2, Oid collid)
 {
 	int			result;
+	bool		collate_c;
+	pg_locale_t mylocale;
 
-	check_collation_set(collid);
+	varstr_lookup_collation(collid, &collate_c, &mylocale);
 
 	/*
 	 * Unfortunately, there is no strncoll(), so in the non-C locale case we
 	 * have to do some memory copying.  This turns out to be significantly
 	 * slower, so we optimize the case where LC_COLLATE is C.  We also try to
 	 * optimize relatively-short strings by avoiding palloc/pfree overhead.
+	 * ICU takes string lengths, so it doesn't need the copies.
 	 */
-	if (lc_collate_is_c(collid))
+	if (collate_c)
 	{
 		result = memcmp(arg1, arg2, Min(len1, len2));
 		if ((result == 0) && (len1 != len2))
@@ -1563,10 +1601,6 @@ varstr_cmp(const char *arg1, int len1, const char *arg2, int len2, Oid collid)
 		char		a2buf[TEXTBUFLEN];
 		char	   *a1p,
 				   *a2p;
-		pg_locale_t mylocale = 0;
-
-		if (collid != DEFAULT_COLLATION_OID)
-			mylocale = pg_newlocale_from_collation(collid);
 
 		/*
 		 * memcmp() can't tell us which of two unequal strings sorts first,
@@ -1667,63 +1701,63 @@ varstr_cmp(const char *arg1, int len1, const char *arg2, int len2, Oid collid)
 		}
 #endif							/* WIN32 */
 
-		if (len1 >= TEXTBUFLEN)
-			a1p = (char *) palloc(len1 + 1);
-		else
-			a1p = a1buf;
-		if (len2 >= TEXTBUFLEN)
-			a2p = (char *) palloc(len2 + 1);
-		else
-			a2p = a2buf;
-
-		memcpy(a1p, arg1, len1);
-		a1p[len1] = '\0';
-		memcpy(a2p, arg2, len2);
-		a2p[len2] = '\0';
-
-		if (mylocale)
+		if (mylocale && mylocale->provider == COLLPROVIDER_ICU)
 		{
-			if (mylocale->provider == COLLPROVIDER_ICU)
-			{
 #ifdef USE_ICU
 #ifdef HAVE_UCOL_STRCOLLUTF8
-				if (GetDatabaseEncoding() == PG_UTF8)
-				{
-					UErrorCode	status;
+			if (GetDatabaseEncoding() == PG_UTF8)
+			{
+				UErrorCode	status;
 
-					status = U_ZERO_ERROR;
-					result = ucol_strcollUTF8(mylocale->info.icu.ucol,
-											  arg1, len1,
-											  arg2, len2,
-											  &status);
-					if (U_FAILURE(status))
-						ereport(ERROR,
-								(errmsg("collation failed: %s", u_errorName(status))));
-				}
-				else
+				status = U_ZERO_ERROR;
+				result = ucol_strcollUTF8(mylocale->info.icu.ucol,
+										  arg1, len1,
+										  arg2, len2,
+										  &status);
+				if (U_FAILURE(status))
+					ereport(ERROR,
+							(errmsg("collation failed: %s", u_errorName(status))));
+			}
+			else
 #endif
-				{
-					int32_t		ulen1,
-								ulen2;
-					UChar	   *uchar1,
-							   *uchar2;
+			{
+				int32_t		ulen1,
+							ulen2;
+				UChar	   *uchar1,
+						   *uchar2;
 
-					ulen1 = icu_to_uchar(&uchar1, arg1, len1);
-					ulen2 = icu_to_uchar(&uchar2, arg2, len2);
+				ulen1 = icu_to_uchar(&uchar1, arg1, len1);
+				ulen2 = icu_to_uchar(&uchar2, arg2, len2);
 
-					result = ucol_strcoll(mylocale->info.icu.ucol,
-										  uchar1, ulen1,
-										  uchar2, ulen2);
+				result = ucol_strcoll(mylocale->info.icu.ucol,
+									  uchar1, ulen1,
+									  uchar2, ulen2);
 
-					pfree(uchar1);
-					pfree(uchar2);
-				}
+				pfree(uchar1);
+				pfree(uchar2);
+			}
 #else							/* not USE_ICU */
-				/* shouldn't happen */
-				elog(ERROR, "unsupported collprovider: %c", mylocale->provider);
+			/* shouldn't happen */
+			elog(ERROR, "unsupported collprovider: %c", mylocale->provider);
 #endif							/* not USE_ICU */
-			}
+		}
+		else
+		{
+			if (len1 >= TEXTBUFLEN)
+				a1p = (char *) palloc(len1 + 1);
+			else
+				a1p = a1buf;
+			if (len2 >= TEXTBUFLEN)
+				a2p = (char *) palloc(len2 + 1);
 			else
+				a2p = a2buf;
+
+			memcpy(a1p, arg1, len1);
+			a1p[len1] = '\0';
+			memcpy(a2p, arg2, len2);
+			a2p[len2] = '\0';
+
+			if (mylocale)
 			{
 #ifdef HAVE_LOCALE_T
 				result = strcoll_l(a1p, a2p, mylocale->info.lt);
@@ -1732,19 +1766,26 @@ varstr_cmp(const char *arg1, int len1, const char *arg2, int len2, Oid collid)
 				elog(ERROR, "unsupported collprovider: %c", mylocale->provider);
 #endif
 			}
+			else
+				result = strcoll(a1p, a2p);
+
+			if (a1p != a1buf)
+				pfree(a1p);
+			if (a2p != a2buf)
+				pfree(a2p);
 		}
-		else
-			result = strcoll(a1p, a2p);
 
-		/* Break tie if necessary. */
+		/*
+		 * Break tie if necessary.  Text can't contain NULs, so this gives the
+		 * same answer as strcmp() on the terminated copies.
+		 */
 		if (result == 0 &&
 			(!mylocale || mylocale->deterministic))
-			result = strcmp(a1p, a2p);
-
-		if (a1p != a1buf)
-			pfree(a1p);
-		if (a2p != a2buf)
-			pfree(a2p);
+		{
+			result = memcmp(arg1, arg2, Min(len1, len2));
+			if ((result == 0) && (len1 != len2))
+				result = (len1 < len2) ? -1 : 1;
+		}
 	}
 
 	return result;
@@ -1784,12 +1825,12 @@ texteq(PG_FUNCTION_ARGS)
 {
 	Oid			collid = PG_GET_COLLATION();
 	bool		result;
+	bool		collate_c;
+	pg_locale_t mylocale;
 
-	check_collation_set(collid);
+	varstr_lookup_collation(collid, &collate_c, &mylocale);
 
-	if (lc_collate_is_c(collid) ||
-		collid == DEFAULT_COLLATION_OID ||
-		pg_newlocale_from_collation(collid)->deterministic)
+	if (collate_c || !mylocale || mylocale->deterministic)
 	{
 		Datum		arg1 = PG_GETARG_DATUM(0);
 		Datum		arg2 = PG_GETARG_DATUM(1);
@@ -1838,12 +1879,12 @@ textne(PG_FUNCTION_ARGS)
 {
 	Oid			collid = PG_GET_COLLATION();
 	bool		result;
+	bool		collate_c;
+	pg_locale_t mylocale;
 
-	check_collation_set(collid);
+	varstr_lookup_collation(collid, &collate_c, &mylocale);
 
-	if (lc_collate_is_c(collid) ||
-		collid == DEFAULT_COLLATION_OID ||
-		pg_newlocale_from_collation(collid)->deterministic)
+	if (collate_c || !mylocale || mylocale->deterministic)
 	{
 		Datum		arg1 = PG_GETARG_DATUM(0);
 		Datum		arg2 = PG_GETARG_DATUM(1);
@@ -2175,7 +2216,17 @@ varstr_sortsupport(SortSupport ssup, Oid typid, Oid collid)
 			initHyperLogLog(&sss->abbr_card, 10);
 			initHyperLogLog(&sss->full_card, 10);
 			ssup->abbrev_full_comparator = ssup->comparator;
-			ssup->comparator = varstrcmp_abbrev;
+
+			/*
+			 * Abbreviated keys are compared as unsigned integers.  When they
+			 * compare equal, the core system will call varstrfastcmp_c()
+			 * (bpcharfastcmp_c() in BpChar case) or varlenafastcmp_locale().
+			 * Even a strcmp() on two non-truncated strxfrm() blobs cannot
+			 * indicate *equality* authoritatively, for the same reason that
+			 * there is a strcoll() tie-breaker call to strcmp() in
+			 * varstr_cmp().
+			 */
+			ssup->comparator = ssup_datum_unsigned_cmp;
 			ssup->abbrev_converter = varstr_abbrev_convert;
 			ssup->abbrev_abort = varstr_abbrev_abort;
 		}
@@ -2461,27 +2512,6 @@ varstrfastcmp_locale(char *a1p, int len1, char *a2p, int len2, SortSupport ssup)
 	return result;
 }
 
-/*
- * Abbreviated key comparison func
- */
-static int
-varstrcmp_abbrev(Datum x, Datum y, SortSupport ssup)
-{
-	/*
-	 * When 0 is returned, the core system will call varstrfastcmp_c()
-	 * (bpcharfastcmp_c() in BpChar case) or varlenafastcmp_locale().  Even a
-	 * strcmp() on two non-truncated strxfrm() blobs cannot indicate *equality*
-	 * authoritatively, for the same reason that there is a strcoll()
-	 * tie-breaker call to strcmp() in varstr_cmp().
-	 */
-	if (x > y)
-		return 1;
-	else if (x == y)
-		return 0;
-	else
-		return -1;
-}
-
 /*
  * Conversion routine for sortsupport.  Converts original to abbreviated key
  * representation.  Our encoding strategy is simple -- pack the first 8 bytes
@@ -2520,9 +2550,9 @@ varstr_abbrev_convert(Datum original, SortSupport ssup)
 	 * strings may contain NUL bytes.  Besides, this should be faster, too.
 	 *
 	 * More generally, it's okay that bytea callers can have NUL bytes in
-	 * strings because varstrcmp_abbrev() need not make a distinction between
-	 * terminating NUL bytes, and NUL bytes representing actual NULs in the
-	 * authoritative representation.  Hopefully a comparison at or past one
+	 * strings because ssup_datum_unsigned_cmp() need not make a distinction
+	 * between terminating NUL bytes, and NUL bytes representing actual NULs
+	 * in the authoritative representation.  Hopefully a comparison at or past one
 	 * abbreviated key's terminating NUL byte will resolve the comparison
 	 * without consulting the authoritative representation; specifically, some
 	 * later non-NUL byte in the longer string can resolve the comparison
@@ -2710,8 +2740,8 @@ done:
 	/*
 	 * Byteswap on little-endian machines.
 	 *
-	 * This is needed so that varstrcmp_abbrev() (an unsigned integer 3-way
-	 * comparator) works correctly on all platforms.  If we didn't do this,
+	 * This is needed so that ssup_datum_unsigned_cmp() (an unsigned integer
+	 * 3-way comparator) works correctly on all platforms.  If we didn't do this,
 	 * the comparator would have to call memcmp() with a pair of pointers to
 	 * the first byte of each abbreviated key, which is slower.
 	 */
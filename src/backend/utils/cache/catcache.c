@@ -63,6 +63,18 @@
 /* Cache management header --- pointer is NULL until created */
 static CatCacheHeader *CacheHdr = NULL;
 
+/*
+ * Entries not accessed for this many seconds may be removed instead of
+ * enlarging a catcache's hash table; -1 disables pruning.
+ */
+int			catalog_cache_prune_min_age = 300;
+
+/*
+ * Timestamp used to record entry accesses.  It is advanced once per
+ * statement rather than reading the clock on every cache hit.
+ */
+static TimestampTz catcacheclock = 0;
+
 static inline HeapTuple SearchCatCacheInternal(CatCache *cache,
 											   int nkeys,
 											   Datum v1, Datum v2,
@@ -853,6 +865,73 @@ InitCatCache(int id,
 	return cp;
 }
 
+/*
+ * SetCatCacheClock
+ *		Advance the clock used to track catcache entry accesses.
+ */
+void
+SetCatCacheClock(TimestampTz ts)
+{
+	catcacheclock = ts;
+}
+
+/*
+ * Remove entries that have not been used for catalog_cache_prune_min_age
+ * seconds.  This is called when a catcache is about to be enlarged, so that
+ * a backend that once touched a large number of objects (e.g. thousands of
+ * partitions) does not keep all of their catalog data around forever.
+ *
+ * Returns true if enough entries were removed that the hash table need not
+ * be enlarged after all.
+ */
+static bool
+CatCacheCleanupOldEntries(CatCache *cp)
+{
+	TimestampTz threshold;
+	int			nremoved = 0;
+	int			i;
+
+	if (catalog_cache_prune_min_age < 0)
+		return false;
+
+	threshold = catcacheclock -
+		(TimestampTz) catalog_cache_prune_min_age * USECS_PER_SEC;
+
+	for (i = 0; i < cp->cc_nbuckets; i++)
+	{
+		dlist_mutable_iter iter;
+
+		dlist_foreach_modify(iter, &cp->cc_bucket[i])
+		{
+			CatCTup    *ct = dlist_container(CatCTup, cache_elem, iter.cur);
+
+			/*
+			 * Don't remove entries that are in use, nor members of a list;
+			 * removing the latter would throw away the whole list.
+			 */
+			if (ct->refcount > 0 || ct->c_list != NULL)
+				continue;
+
+			if (ct->lastaccess < threshold)
+			{
+				CatCacheRemoveCTup(cp, ct);
+				nremoved++;
+			}
+		}
+	}
+
+	if (nremoved > 0)
+		elog(DEBUG1, "pruned %d entries from catalog cache id %d for %s; %d tups, %d buckets",
+			 nremoved, cp->id, cp->cc_relname, cp->cc_ntup, cp->cc_nbuckets);
+
+	/*
+	 * Only skip enlarging the table if that brought the fill factor well
+	 * below the enlargement threshold; otherwise we might end up scanning
+	 * the whole cache again for every new entry.
+	 */
+	return cp->cc_ntup <= cp->cc_nbuckets;
+}
+
 /*
  * Enlarge a catcache, doubling the number of buckets.
  */
@@ -1265,6 +1344,7 @@ SearchCatCacheInternal(CatCache *cache,
 		 * near the front of the hashbucket's list.)
 		 */
 		dlist_move_head(bucket, &ct->cache_elem);
+		ct->lastaccess = catcacheclock;
 
 		/*
 		 * If it's a positive entry, bump its refcount and return it. If it's
@@ -1889,6 +1969,7 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 	ct->refcount = 0;			/* for the moment */
 	ct->dead = false;
 	ct->negative = negative;
+	ct->lastaccess = catcacheclock;
 	ct->hash_value = hashValue;
 
 	dlist_push_head(&cache->cc_bucket[hashIndex], &ct->cache_elem);
@@ -1897,10 +1978,13 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 	CacheHdr->ch_ntup++;
 
 	/*
-	 * If the hash table has become too full, enlarge the buckets array. Quite
-	 * arbitrarily, we enlarge when fill factor > 2.
+	 * If the hash table has become too full, enlarge the buckets array, unless
+	 * we can make enough room by removing entries that have not been used for
+	 * a long time.  Quite arbitrarily, we enlarge when fill factor > 2.  The
+	 * new entry itself cannot be removed, as it was just accessed.
 	 */
-	if (cache->cc_ntup > cache->cc_nbuckets * 2)
+	if (cache->cc_ntup > cache->cc_nbuckets * 2 &&
+		!CatCacheCleanupOldEntries(cache))
 		RehashCatCache(cache);
 
 	return ct;
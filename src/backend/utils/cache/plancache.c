@@ -62,6 +62,7 @@
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/planmain.h"
 #include "parser/analyze.h"
 #include "parser/parsetree.h"
 #include "storage/lmgr.h"
@@ -1101,6 +1102,15 @@ cached_plan_cost(CachedPlan *plan, bool include_planner)
 			 * considerable work to arrive at a less crude estimate, and for
 			 * now it's not clear that's worth doing.
 			 *
+			 * We do at least account for join search separately: for each
+			 * pair of relations the query mentions in FROM (which excludes
+			 * inheritance children), up to join_collapse_limit of them, we
+			 * charge the same amount again.  That is roughly how the
+			 * dynamic-programming join search grows for typical join graphs,
+			 * and it makes it much more likely that statements with many
+			 * joins settle on a generic plan instead of being replanned on
+			 * every execution.  Queries without joins are not affected.
+			 *
 			 * The other big difficulty here is that we don't have any very
 			 * good model of how planning cost compares to execution costs.
 			 * The current multiplier of 1000 * cpu_operator_cost is probably
@@ -1111,8 +1121,20 @@ cached_plan_cost(CachedPlan *plan, bool include_planner)
 			 * probably live in src/backend/optimizer/ not here.
 			 */
 			int			nrelations = list_length(plannedstmt->rtable);
+			int			njoinrels = 0;
+			ListCell   *lc2;
+
+			foreach(lc2, plannedstmt->rtable)
+			{
+				RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc2);
+
+				if (rte->inFromCl && rte->rtekind != RTE_JOIN)
+					njoinrels++;
+			}
+			njoinrels = Min(njoinrels, join_collapse_limit);
 
-			result += 1000.0 * cpu_operator_cost * (nrelations + 1);
+			result += 1000.0 * cpu_operator_cost *
+				(nrelations + 1 + njoinrels * (njoinrels - 1) / 2);
 		}
 	}
 
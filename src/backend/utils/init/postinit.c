@@ -238,7 +238,11 @@ PerformAuthentication(Port *port)
 	 * Now perform authentication exchange.
 	 */
 	set_ps_display("authentication");
+	if (Log_connections)
+		conn_timing.auth_start = GetCurrentTimestamp();
 	ClientAuthentication(port); /* might not return, if failure */
+	if (Log_connections)
+		conn_timing.auth_end = GetCurrentTimestamp();
 
 	/*
 	 * Done with authentication.  Disable the timeout, and log if needed.
@@ -525,6 +529,30 @@ InitializeMaxBackends(void)
 		elog(ERROR, "too many backends configured");
 }
 
+/*
+ * Initialize the number of fast-path lock groups per backend.
+ *
+ * We size the fast-path array so that it can hold max_locks_per_transaction
+ * relation locks, rounded up to a power-of-two number of groups and capped at
+ * FP_LOCK_GROUPS_PER_BACKEND_MAX.  The PGPROC arrays are allocated in shared
+ * memory, so this must be called before shared memory size is determined.
+ *
+ * As with MaxBackends, in EXEC_BACKEND environment the value is passed down
+ * from postmaster to subprocesses via BackendParameters.
+ */
+void
+InitializeFastPathLocks(void)
+{
+	Assert(FastPathLockGroupsPerBackend == 0);
+
+	/* we need at least one group */
+	FastPathLockGroupsPerBackend = 1;
+
+	while (FastPathLockGroupsPerBackend < FP_LOCK_GROUPS_PER_BACKEND_MAX &&
+		   FastPathLockSlotsPerBackend() < max_locks_per_xact)
+		FastPathLockGroupsPerBackend *= 2;
+}
+
 /*
  * Early initialization of a backend (either standalone or under postmaster).
  * This happens even before InitPostgres.
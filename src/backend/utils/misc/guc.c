@@ -34,7 +34,10 @@
 
 #include "access/commit_ts.h"
 #include "access/gin.h"
+#include "access/multixact.h"
 #include "access/rmgr.h"
+#include "access/slru.h"
+#include "access/subtrans.h"
 #include "access/tableam.h"
 #include "access/toast_compression.h"
 #include "access/transam.h"
@@ -52,6 +55,7 @@
 #include "commands/vacuum.h"
 #include "commands/variable.h"
 #include "common/string.h"
+#include "executor/executor.h"
 #include "funcapi.h"
 #include "jit/jit.h"
 #include "libpq/auth.h"
@@ -80,6 +84,7 @@
 #include "replication/syncrep.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
+#include "storage/buffile.h"
 #include "storage/bufmgr.h"
 #include "storage/dsm_impl.h"
 #include "storage/fd.h"
@@ -94,6 +99,7 @@
 #include "utils/backend_status.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
+#include "utils/catcache.h"
 #include "utils/float.h"
 #include "utils/guc_tables.h"
 #include "utils/memutils.h"
@@ -524,6 +530,37 @@ static struct config_enum_entry default_toast_compression_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry geqo_strategy_options[] = {
+	{"genetic", GEQO_STRATEGY_GENETIC, false},
+	{"greedy", GEQO_STRATEGY_GREEDY, false},
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry wal_compression_options[] = {
+	{"pglz", WAL_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", WAL_COMPRESSION_LZ4, false},
+#endif
+	{"on", WAL_COMPRESSION_PGLZ, false},
+	{"off", WAL_COMPRESSION_NONE, false},
+	{"true", WAL_COMPRESSION_PGLZ, true},
+	{"false", WAL_COMPRESSION_NONE, true},
+	{"yes", WAL_COMPRESSION_PGLZ, true},
+	{"no", WAL_COMPRESSION_NONE, true},
+	{"1", WAL_COMPRESSION_PGLZ, true},
+	{"0", WAL_COMPRESSION_NONE, true},
+	{NULL, 0, false}
+};
+
+static struct config_enum_entry temp_file_compression_options[] = {
+	{"none", TEMP_FILE_COMPRESSION_NONE, false},
+	{"pglz", TEMP_FILE_COMPRESSION_PGLZ, false},
+#ifdef  USE_LZ4
+	{"lz4", TEMP_FILE_COMPRESSION_LZ4, false},
+#endif
+	{NULL, 0, false}
+};
+
 /*
  * Options for enum values stored in other modules
  */
@@ -608,6 +645,7 @@ int			ssl_renegotiation_limit;
  */
 int			huge_pages;
 int			huge_page_size;
+bool		transparent_huge_pages = false;
 
 /*
  * These variables are all dummies that don't do anything, except in some
@@ -1302,7 +1340,7 @@ static struct config_bool ConfigureNamesBool[] =
 			gettext_noop("Read ahead of the current replay position to find uncached blocks.")
 		},
 		&recovery_prefetch,
-		false,
+		DEFAULT_RECOVERY_PREFETCH,
 		NULL, assign_recovery_prefetch, NULL
 	},
 	{
@@ -1328,16 +1366,6 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
-	{
-		{"wal_compression", PGC_SUSET, WAL_SETTINGS,
-			gettext_noop("Compresses full-page writes written in WAL file."),
-			NULL
-		},
-		&wal_compression,
-		false,
-		NULL, NULL, NULL
-	},
-
 	{
 		{"wal_init_zero", PGC_SUSET, WAL_SETTINGS,
 			gettext_noop("Writes zeroes to new WAL files before first use."),
@@ -1757,6 +1785,17 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"coalesce_pipelined_results", PGC_USERSET, CLIENT_CONN_OTHER,
+			gettext_noop("Delays sending results to the client while it has further messages queued."),
+			gettext_noop("With this enabled, ReadyForQuery does not flush output if "
+						 "the next message has already been received, so that "
+						 "the results of pipelined statements are sent together.")
+		},
+		&coalesce_pipelined_results,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"check_function_bodies", PGC_USERSET, CLIENT_CONN_STATEMENT,
 			gettext_noop("Check routine bodies during CREATE FUNCTION and CREATE PROCEDURE."),
@@ -1766,6 +1805,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"vacuum_freeze_eager", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Freezes all rows of a page that VACUUM is modifying anyway, if it can."),
+			gettext_noop("This avoids rewriting the page later when its rows reach the freeze age.")
+		},
+		&vacuum_freeze_eager,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"array_nulls", PGC_USERSET, COMPAT_OPTIONS_PREVIOUS,
 			gettext_noop("Enable input of NULL elements in arrays."),
@@ -2035,6 +2083,17 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"transparent_huge_pages", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Advises the kernel to use transparent huge pages for large allocations."),
+			gettext_noop("This applies to large dynamic shared memory segments "
+						 "and large blocks of backend-private memory.")
+		},
+		&transparent_huge_pages,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"parallel_leader_participation", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
 			gettext_noop("Controls whether Gather and Gather Merge also run subplans."),
@@ -2133,6 +2192,16 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_sender_allow_compression", PGC_SIGHUP, REPLICATION_SENDING,
+			gettext_noop("Allows WAL senders to compress streamed WAL when the receiver asks for it."),
+			NULL
+		},
+		&wal_sender_allow_compression,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_receiver_create_temp_slot", PGC_SIGHUP, REPLICATION_STANDBY,
 			gettext_noop("Sets whether a WAL receiver should create a temporary replication slot if no permanent slot is configured."),
@@ -2195,6 +2264,28 @@ static struct config_int ConfigureNamesInt[] =
 		8, 1, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"expression_cse_limit", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of candidate subexpressions beyond which "
+						 "repeated subexpressions are not shared."),
+			gettext_noop("Zero disables sharing of repeated subexpressions."),
+			GUC_EXPLAIN
+		},
+		&expression_cse_limit,
+		64, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+	{
+		{"jit_interpret_calls", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of evaluations of a JIT-compiled expression "
+						 "to perform with the interpreter before emitting machine code."),
+			gettext_noop("Zero emits machine code on the first evaluation."),
+			GUC_EXPLAIN
+		},
+		&jit_interpret_calls,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
 	{
 		{"join_collapse_limit", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Sets the FROM-list size beyond which JOIN "
@@ -2363,6 +2454,61 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"multixact_offset_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the MultiXact offset cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&multixact_offset_buffers,
+		8, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"multixact_member_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the MultiXact member cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&multixact_member_buffers,
+		16, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"subtransaction_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the subtransaction cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&subtransaction_buffers,
+		32, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"notify_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the LISTEN/NOTIFY message cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&notify_buffers,
+		8, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"serial_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the serializable transaction cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&serial_buffers,
+		16, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"temp_buffers", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the maximum number of temporary buffers used by each session."),
@@ -2452,6 +2598,19 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"catalog_cache_prune_min_age", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the minimum unused duration of catalog cache entries before removal."),
+			gettext_noop("Catalog cache entries not used for this long may be "
+						 "removed instead of enlarging the cache. -1 disables "
+						 "removal."),
+			GUC_UNIT_S
+		},
+		&catalog_cache_prune_min_age,
+		300, -1, INT_MAX / 1000,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"logical_decoding_work_mem", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the maximum memory to be used for logical decoding."),
@@ -2480,6 +2639,18 @@ static struct config_int ConfigureNamesInt[] =
 		check_max_stack_depth, assign_max_stack_depth, NULL
 	},
 
+	{
+		{"max_backend_memory", PGC_SUSET, RESOURCES_MEM,
+			gettext_noop("Sets the maximum memory a backend may allocate."),
+			gettext_noop("Allocations that would exceed this fail with an "
+						 "out-of-memory error. 0 means no limit."),
+			GUC_UNIT_MB
+		},
+		&max_backend_memory,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"temp_file_limit", PGC_SUSET, RESOURCES_DISK,
 			gettext_noop("Limits the total size of all temporary files used by each process."),
@@ -2864,6 +3035,16 @@ static struct config_int ConfigureNamesInt[] =
 		check_wal_buffers, NULL, NULL
 	},
 
+	{
+		{"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+			gettext_noop("Sets the number of locks used for concurrent WAL insertion."),
+			NULL
+		},
+		&NumXLogInsertLocks,
+		8, 1, 1024,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -2946,11 +3127,11 @@ static struct config_int ConfigureNamesInt[] =
 		{"commit_delay", PGC_SUSET, WAL_SETTINGS,
 			gettext_noop("Sets the delay in microseconds between transaction commit and "
 						 "flushing WAL to disk."),
-			NULL
+			gettext_noop("-1 means to derive the delay from the time recent WAL flushes took.")
 			/* we have no microseconds designation, so can't supply units here */
 		},
 		&CommitDelay,
-		0, 0, 100000,
+		0, -1, 100000,
 		NULL, NULL, NULL
 	},
 
@@ -3583,6 +3764,18 @@ static struct config_int ConfigureNamesInt[] =
 		check_client_connection_check_interval, NULL, NULL
 	},
 
+	{
+		{"unnamed_statement_cache_size", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of unnamed prepared statements kept for reuse."),
+			gettext_noop("A Parse message for an unnamed statement whose query text "
+						 "and parameter types match a kept statement reuses it "
+						 "instead of parsing the query again. Zero disables this.")
+		},
+		&unnamed_statement_cache_size,
+		0, 0, 10000,
+		NULL, NULL, NULL
+	},
+
 	/* End-of-list marker */
 	{
 		{NULL, 0, 0, NULL, NULL}, NULL, 0, 0, 0, NULL, NULL, NULL
@@ -3672,7 +3865,7 @@ static struct config_real ConfigureNamesReal[] =
 
 	{
 		{"jit_above_cost", PGC_USERSET, QUERY_TUNING_COST,
-			gettext_noop("Perform JIT compilation if query is more expensive."),
+			gettext_noop("Perform JIT compilation of plan nodes more expensive than this."),
 			gettext_noop("-1 disables JIT compilation."),
 			GUC_EXPLAIN
 		},
@@ -4054,6 +4247,17 @@ static struct config_string ConfigureNamesString[] =
 		check_default_tablespace, NULL, NULL
 	},
 
+	{
+		{"io_direct", PGC_POSTMASTER, RESOURCES_DISK,
+			gettext_noop("Uses direct I/O for the given kinds of files."),
+			gettext_noop("Valid values are \"data\" and \"wal\".  An empty string disables direct I/O."),
+			GUC_LIST_INPUT
+		},
+		&io_direct_string,
+		"",
+		check_io_direct, assign_io_direct, NULL
+	},
+
 	{
 		{"temp_tablespaces", PGC_USERSET, CLIENT_CONN_STATEMENT,
 			gettext_noop("Sets the tablespace(s) to use for temporary tables and sort files."),
@@ -4880,6 +5084,36 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"temp_file_compression", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Sets the compression method for hash join temporary files."),
+			NULL
+		},
+		&temp_file_compression,
+		TEMP_FILE_COMPRESSION_NONE, temp_file_compression_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"wal_compression", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Compresses full-page writes written in WAL file with specified method."),
+			NULL
+		},
+		&wal_compression,
+		WAL_COMPRESSION_NONE, wal_compression_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"wal_receiver_compression", PGC_SIGHUP, REPLICATION_STANDBY,
+			gettext_noop("Asks the sending server to compress streamed WAL with specified method."),
+			NULL
+		},
+		&wal_receiver_compression,
+		WAL_COMPRESSION_NONE, wal_compression_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_sync_method", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Selects the method used for forcing WAL updates to disk."),
@@ -4942,6 +5176,19 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"geqo_strategy", PGC_USERSET, QUERY_TUNING_GEQO,
+			gettext_noop("GEQO: search strategy used to find join orders."),
+			gettext_noop("The genetic algorithm explores more join orders, while "
+						 "the greedy search takes less time and its result "
+						 "does not depend on geqo_seed."),
+			GUC_EXPLAIN
+		},
+		&Geqo_strategy,
+		GEQO_STRATEGY_GENETIC, geqo_strategy_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"plan_cache_mode", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Controls the planner's selection of custom or generic plan."),
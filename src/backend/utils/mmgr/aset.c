@@ -46,7 +46,12 @@
 
 #include "postgres.h"
 
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
 #include "port/pg_bitutils.h"
+#include "storage/pg_shmem.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
 
@@ -97,6 +102,16 @@
  *--------------------
  */
 
+/*
+ * Blocks of at least ALLOC_HUGE_PAGE_MIN_SIZE are advised to use transparent
+ * huge pages, if the kernel supports that and transparent_huge_pages is on.
+ * Only the part of the block covering whole ALLOC_HUGE_PAGE_SIZE pages is
+ * advised; malloc() returns such blocks from mmap() with 4kB alignment at
+ * best.
+ */
+#define ALLOC_HUGE_PAGE_SIZE		(2 * 1024 * 1024)
+#define ALLOC_HUGE_PAGE_MIN_SIZE	(2 * ALLOC_HUGE_PAGE_SIZE)
+
 #define ALLOC_BLOCKHDRSZ	MAXALIGN(sizeof(AllocBlockData))
 #define ALLOC_CHUNKHDRSZ	sizeof(struct AllocChunkData)
 
@@ -279,6 +294,8 @@ static void AllocSetStats(MemoryContext context,
 static void AllocSetCheck(MemoryContext context);
 #endif
 
+static void AllocSetAdviseHugePages(AllocBlock block, Size blksize);
+
 /*
  * This is the virtual function table for AllocSet contexts.
  */
@@ -539,6 +556,7 @@ AllocSetContextCreateInternal(MemoryContext parent,
 						name);
 
 	((MemoryContext) set)->mem_allocated = firstBlockSize;
+	BackendMemoryAllocated(firstBlockSize);
 
 	return (MemoryContext) set;
 }
@@ -601,6 +619,7 @@ AllocSetReset(MemoryContext context)
 		{
 			/* Normal case, release the block */
 			context->mem_allocated -= block->endptr - ((char *) block);
+			BackendMemoryFreed(block->endptr - ((char *) block));
 
 #ifdef CLOBBER_FREED_MEMORY
 			wipe_mem(block, block->freeptr - ((char *) block));
@@ -628,8 +647,7 @@ AllocSetDelete(MemoryContext context)
 {
 	AllocSet	set = (AllocSet) context;
 	AllocBlock	block = set->blocks;
-	Size		keepersize PG_USED_FOR_ASSERTS_ONLY
-	= set->keeper->endptr - ((char *) set);
+	Size		keepersize = set->keeper->endptr - ((char *) set);
 
 	AssertArg(AllocSetIsValid(set));
 
@@ -667,6 +685,7 @@ AllocSetDelete(MemoryContext context)
 				freelist->num_free--;
 
 				/* All that remains is to free the header/initial block */
+				BackendMemoryFreed(oldset->keeper->endptr - ((char *) oldset));
 				free(oldset);
 			}
 			Assert(freelist->num_free == 0);
@@ -686,7 +705,10 @@ AllocSetDelete(MemoryContext context)
 		AllocBlock	next = block->next;
 
 		if (block != set->keeper)
+		{
 			context->mem_allocated -= block->endptr - ((char *) block);
+			BackendMemoryFreed(block->endptr - ((char *) block));
+		}
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->freeptr - ((char *) block));
@@ -701,9 +723,37 @@ AllocSetDelete(MemoryContext context)
 	Assert(context->mem_allocated == keepersize);
 
 	/* Finally, free the context header, including the keeper block */
+	BackendMemoryFreed(keepersize);
 	free(set);
 }
 
+/*
+ * AllocSetAdviseHugePages
+ *		Ask the kernel to back a large block with transparent huge pages.
+ *
+ * This is purely advisory: if the kernel has THP disabled, or can't find a
+ * free huge page, the block just stays on normal pages.  Blocks this large
+ * are typically hash tables or sort arrays that are accessed randomly, which
+ * is where TLB misses hurt most.
+ */
+static void
+AllocSetAdviseHugePages(AllocBlock block, Size blksize)
+{
+#ifdef MADV_HUGEPAGE
+	char	   *start;
+	char	   *end;
+
+	if (!transparent_huge_pages || blksize < ALLOC_HUGE_PAGE_MIN_SIZE)
+		return;
+
+	start = (char *) TYPEALIGN(ALLOC_HUGE_PAGE_SIZE, block);
+	end = (char *) TYPEALIGN_DOWN(ALLOC_HUGE_PAGE_SIZE,
+								  (char *) block + blksize);
+	if (start < end)
+		(void) madvise(start, end - start, MADV_HUGEPAGE);
+#endif
+}
+
 /*
  * AllocSetAlloc
  *		Returns pointer to allocated memory of given size or NULL if
@@ -737,11 +787,15 @@ AllocSetAlloc(MemoryContext context, Size size)
 	{
 		chunk_size = MAXALIGN(size);
 		blksize = chunk_size + ALLOC_BLOCKHDRSZ + ALLOC_CHUNKHDRSZ;
+		if (!MemoryContextBackendLimitAllows(context, blksize))
+			return NULL;
 		block = (AllocBlock) malloc(blksize);
 		if (block == NULL)
 			return NULL;
 
 		context->mem_allocated += blksize;
+		BackendMemoryAllocated(blksize);
+		AllocSetAdviseHugePages(block, blksize);
 
 		block->aset = set;
 		block->freeptr = block->endptr = ((char *) block) + blksize;
@@ -917,24 +971,30 @@ AllocSetAlloc(MemoryContext context, Size size)
 			blksize <<= 1;
 
 		/* Try to allocate it */
-		block = (AllocBlock) malloc(blksize);
+		block = NULL;
+		if (MemoryContextBackendLimitAllows(context, blksize))
+			block = (AllocBlock) malloc(blksize);
 
 		/*
 		 * We could be asking for pretty big blocks here, so cope if malloc
-		 * fails.  But give up if there's less than 1 MB or so available...
+		 * fails, or the block would exceed the backend's memory limit.  But
+		 * give up if there's less than 1 MB or so available...
 		 */
 		while (block == NULL && blksize > 1024 * 1024)
 		{
 			blksize >>= 1;
 			if (blksize < required_size)
 				break;
-			block = (AllocBlock) malloc(blksize);
+			if (MemoryContextBackendLimitAllows(context, blksize))
+				block = (AllocBlock) malloc(blksize);
 		}
 
 		if (block == NULL)
 			return NULL;
 
 		context->mem_allocated += blksize;
+		BackendMemoryAllocated(blksize);
+		AllocSetAdviseHugePages(block, blksize);
 
 		block->aset = set;
 		block->freeptr = ((char *) block) + ALLOC_BLOCKHDRSZ;
@@ -1034,6 +1094,7 @@ AllocSetFree(MemoryContext context, void *pointer)
 			block->next->prev = block->prev;
 
 		context->mem_allocated -= block->endptr - ((char *) block);
+		BackendMemoryFreed(block->endptr - ((char *) block));
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->freeptr - ((char *) block));
@@ -1127,7 +1188,11 @@ AllocSetRealloc(MemoryContext context, void *pointer, Size size)
 		blksize = chksize + ALLOC_BLOCKHDRSZ + ALLOC_CHUNKHDRSZ;
 		oldblksize = block->endptr - ((char *) block);
 
-		block = (AllocBlock) realloc(block, blksize);
+		if (blksize > oldblksize &&
+			!MemoryContextBackendLimitAllows(context, blksize - oldblksize))
+			block = NULL;
+		else
+			block = (AllocBlock) realloc(block, blksize);
 		if (block == NULL)
 		{
 			/* Disallow external access to private part of chunk header. */
@@ -1138,6 +1203,9 @@ AllocSetRealloc(MemoryContext context, void *pointer, Size size)
 		/* updated separately, not to underflow when (oldblksize > blksize) */
 		context->mem_allocated -= oldblksize;
 		context->mem_allocated += blksize;
+		BackendMemoryFreed(oldblksize);
+		BackendMemoryAllocated(blksize);
+		AllocSetAdviseHugePages(block, blksize);
 
 		block->freeptr = block->endptr = ((char *) block) + blksize;
 
@@ -283,6 +283,7 @@ GenerationReset(MemoryContext context)
 		dlist_delete(miter.cur);
 
 		context->mem_allocated -= block->blksize;
+		BackendMemoryFreed(block->blksize);
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->blksize);
@@ -335,11 +336,14 @@ GenerationAlloc(MemoryContext context, Size size)
 	{
 		Size		blksize = chunk_size + Generation_BLOCKHDRSZ + Generation_CHUNKHDRSZ;
 
+		if (!MemoryContextBackendLimitAllows(context, blksize))
+			return NULL;
 		block = (GenerationBlock *) malloc(blksize);
 		if (block == NULL)
 			return NULL;
 
 		context->mem_allocated += blksize;
+		BackendMemoryAllocated(blksize);
 
 		/* block with a single (used) chunk */
 		block->blksize = blksize;
@@ -389,12 +393,15 @@ GenerationAlloc(MemoryContext context, Size size)
 	{
 		Size		blksize = set->blockSize;
 
+		if (!MemoryContextBackendLimitAllows(context, blksize))
+			return NULL;
 		block = (GenerationBlock *) malloc(blksize);
 
 		if (block == NULL)
 			return NULL;
 
 		context->mem_allocated += blksize;
+		BackendMemoryAllocated(blksize);
 
 		block->blksize = blksize;
 		block->nchunks = 0;
@@ -510,6 +517,7 @@ GenerationFree(MemoryContext context, void *pointer)
 		set->block = NULL;
 
 	context->mem_allocated -= block->blksize;
+	BackendMemoryFreed(block->blksize);
 	free(block);
 }
 
@@ -56,7 +56,28 @@ MemoryContext CurTransactionContext = NULL;
 /* This is a transient link to the active portal's memory context: */
 MemoryContext PortalContext = NULL;
 
+/*
+ * Total size of the blocks malloc'd by this backend's memory contexts.  Once
+ * the backend has a PgBackendStatus entry, this points into it so that
+ * pg_stat_activity can show the value; before that, and after the entry is
+ * released, it points to a local variable.
+ */
+static uint64 local_allocated_bytes = 0;
+uint64	   *backend_allocated_bytes = &local_allocated_bytes;
+
+/* GUC variable: limit on backend_allocated_bytes, in MB, or 0 for none */
+int			max_backend_memory = 0;
+
+/*
+ * Set when max_backend_memory refused the last block we checked, so that the
+ * out-of-memory error can say so.  backend_limit_block_size is the size of
+ * that block.
+ */
+static bool backend_limit_refused = false;
+static Size backend_limit_block_size = 0;
+
 static void MemoryContextCallResetCallbacks(MemoryContext context);
+static int	errdetail_alloc_failure(MemoryContext context, Size size);
 static void MemoryContextStatsInternal(MemoryContext context, int level,
 									   bool print, int max_children,
 									   MemoryContextCounters *totals,
@@ -553,6 +574,20 @@ MemoryContextStatsDetail(MemoryContext context, int max_children,
 								 grand_totals.totalspace - grand_totals.freespace)));
 }
 
+/*
+ * MemoryContextMemConsumed
+ *		Return the memory consumption statistics of the given context and
+ *		all its descendants, without printing anything.
+ */
+void
+MemoryContextMemConsumed(MemoryContext context,
+						 MemoryContextCounters *consumed)
+{
+	memset(consumed, 0, sizeof(*consumed));
+
+	MemoryContextStatsInternal(context, 0, false, 0, consumed, false);
+}
+
 /*
  * MemoryContextStatsInternal
  *		One recursion level for MemoryContextStats
@@ -886,8 +921,7 @@ MemoryContextAlloc(MemoryContext context, Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_ALLOC(context, ret, size);
@@ -922,8 +956,7 @@ MemoryContextAllocZero(MemoryContext context, Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_ALLOC(context, ret, size);
@@ -960,8 +993,7 @@ MemoryContextAllocZeroAligned(MemoryContext context, Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_ALLOC(context, ret, size);
@@ -998,8 +1030,7 @@ MemoryContextAllocExtended(MemoryContext context, Size size, int flags)
 			ereport(ERROR,
 					(errcode(ERRCODE_OUT_OF_MEMORY),
 					 errmsg("out of memory"),
-					 errdetail("Failed on request of size %zu in memory context \"%s\".",
-							   size, context->name)));
+					 errdetail_alloc_failure(context, size)));
 		}
 		return NULL;
 	}
@@ -1012,6 +1043,76 @@ MemoryContextAllocExtended(MemoryContext context, Size size, int flags)
 	return ret;
 }
 
+/*
+ * SetBackendAllocatedBytesLocation
+ *		Make memory accounting use the given variable, carrying over the
+ *		current total.  NULL means a backend-local variable.
+ */
+void
+SetBackendAllocatedBytesLocation(uint64 *location)
+{
+	if (location == NULL)
+		location = &local_allocated_bytes;
+
+	*location = *backend_allocated_bytes;
+	backend_allocated_bytes = location;
+}
+
+/*
+ * MemoryContextExceedsBackendLimit
+ *		Would malloc'ing another "size" bytes for the given context take this
+ *		backend over max_backend_memory?
+ *
+ * The limit only applies to regular backends and background workers,
+ * including parallel workers.  Allocations in ErrorContext, and within
+ * critical sections, are always allowed, lest reporting the failure fail
+ * too or the failure be promoted to a PANIC.
+ */
+bool
+MemoryContextExceedsBackendLimit(MemoryContext context, Size size)
+{
+	if (max_backend_memory == 0)
+		return false;
+
+	if (MyBackendType != B_BACKEND && MyBackendType != B_BG_WORKER)
+		return false;
+
+	if (context == ErrorContext || CritSectionCount > 0)
+		return false;
+
+	backend_limit_refused = *backend_allocated_bytes + size >
+		(uint64) max_backend_memory * 1024 * 1024;
+	backend_limit_block_size = size;
+
+	return backend_limit_refused;
+}
+
+/*
+ * errdetail_alloc_failure
+ *		Add the detail message of an out-of-memory error for a request of
+ *		"size" bytes in the given context.
+ *
+ * If it was max_backend_memory rather than malloc() that refused the memory,
+ * say so, so that the user knows which setting to look at.
+ */
+static int
+errdetail_alloc_failure(MemoryContext context, Size size)
+{
+	if (backend_limit_refused)
+	{
+		backend_limit_refused = false;
+		return errdetail("Failed on request of size %zu in memory context \"%s\": "
+						 "allocating %zu more bytes would exceed max_backend_memory (%dMB) "
+						 "with %llu bytes already allocated by this backend.",
+						 size, context->name, backend_limit_block_size,
+						 max_backend_memory,
+						 (unsigned long long) *backend_allocated_bytes);
+	}
+
+	return errdetail("Failed on request of size %zu in memory context \"%s\".",
+					 size, context->name);
+}
+
 /*
  * HandleLogMemoryContextInterrupt
  *		Handle receipt of an interrupt indicating logging of memory
@@ -1080,8 +1181,7 @@ palloc(Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_ALLOC(context, ret, size);
@@ -1111,8 +1211,7 @@ palloc0(Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_ALLOC(context, ret, size);
@@ -1147,8 +1246,7 @@ palloc_extended(Size size, int flags)
 			ereport(ERROR,
 					(errcode(ERRCODE_OUT_OF_MEMORY),
 					 errmsg("out of memory"),
-					 errdetail("Failed on request of size %zu in memory context \"%s\".",
-							   size, context->name)));
+					 errdetail_alloc_failure(context, size)));
 		}
 		return NULL;
 	}
@@ -1199,8 +1297,7 @@ repalloc(void *pointer, Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_CHANGE(context, pointer, ret, size);
@@ -1234,8 +1331,7 @@ MemoryContextAllocHuge(MemoryContext context, Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_ALLOC(context, ret, size);
@@ -1269,8 +1365,7 @@ repalloc_huge(void *pointer, Size size)
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory"),
-				 errdetail("Failed on request of size %zu in memory context \"%s\".",
-						   size, context->name)));
+				 errdetail_alloc_failure(context, size)));
 	}
 
 	VALGRIND_MEMPOOL_CHANGE(context, pointer, ret, size);
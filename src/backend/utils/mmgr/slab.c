@@ -309,6 +309,7 @@ SlabReset(MemoryContext context)
 			free(block);
 			slab->nblocks--;
 			context->mem_allocated -= slab->blockSize;
+			BackendMemoryFreed(slab->blockSize);
 		}
 	}
 
@@ -363,6 +364,8 @@ SlabAlloc(MemoryContext context, Size size)
 	 */
 	if (slab->minFreeChunks == 0)
 	{
+		if (!MemoryContextBackendLimitAllows(context, slab->blockSize))
+			return NULL;
 		block = (SlabBlock *) malloc(slab->blockSize);
 
 		if (block == NULL)
@@ -394,6 +397,7 @@ SlabAlloc(MemoryContext context, Size size)
 		slab->minFreeChunks = slab->chunksPerBlock;
 		slab->nblocks += 1;
 		context->mem_allocated += slab->blockSize;
+		BackendMemoryAllocated(slab->blockSize);
 	}
 
 	/* grab the block from the freelist (even the new block is there) */
@@ -561,6 +565,7 @@ SlabFree(MemoryContext context, void *pointer)
 		free(block);
 		slab->nblocks--;
 		context->mem_allocated -= slab->blockSize;
+		BackendMemoryFreed(slab->blockSize);
 	}
 	else
 		dlist_push_head(&slab->freelist[block->nfree], &block->node);
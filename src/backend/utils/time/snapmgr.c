@@ -543,6 +543,7 @@ SetTransactionSnapshot(Snapshot sourcesnap, VirtualTransactionId *sourcevxid,
 	memcpy(CurrentSnapshot->subxip, sourcesnap->subxip,
 		   sourcesnap->subxcnt * sizeof(TransactionId));
 	CurrentSnapshot->suboverflowed = sourcesnap->suboverflowed;
+	CurrentSnapshot->xip_sorted = false;
 	CurrentSnapshot->takenDuringRecovery = sourcesnap->takenDuringRecovery;
 	/* NB: curcid should NOT be copied, it's a local matter */
 
@@ -2185,6 +2186,7 @@ RestoreSnapshot(char *start_address)
 	snapshot->subxip = NULL;
 	snapshot->subxcnt = serialized_snapshot.subxcnt;
 	snapshot->suboverflowed = serialized_snapshot.suboverflowed;
+	snapshot->xip_sorted = false;
 	snapshot->takenDuringRecovery = serialized_snapshot.takenDuringRecovery;
 	snapshot->curcid = serialized_snapshot.curcid;
 	snapshot->whenTaken = serialized_snapshot.whenTaken;
@@ -2228,6 +2230,39 @@ RestoreTransactionSnapshot(Snapshot snapshot, void *source_pgproc)
 	SetTransactionSnapshot(snapshot, NULL, InvalidPid, source_pgproc);
 }
 
+/*
+ * Snapshots with more than this many xids in xip[] and subxip[] combined are
+ * searched with bsearch() rather than linearly.  Such snapshots are common
+ * with thousands of connections, and a heap scan may need to check many
+ * tuple xmins and xmaxes against them.
+ */
+#define XIP_BSEARCH_THRESHOLD	64
+
+/*
+ * Search an xid array of a snapshot, which is sorted if 'sorted' is true.
+ *
+ * Any total order over the xids works for this purpose, so the arrays are
+ * simply sorted as unsigned integers with xidComparator, even though that
+ * does not match the wraparound-aware xid ordering.
+ */
+static inline bool
+XidInSnapshotArray(TransactionId xid, TransactionId *xids, int32 nxids,
+				   bool sorted)
+{
+	int32		i;
+
+	if (sorted)
+		return bsearch(&xid, xids, nxids, sizeof(TransactionId),
+					   xidComparator) != NULL;
+
+	for (i = 0; i < nxids; i++)
+	{
+		if (TransactionIdEquals(xid, xids[i]))
+			return true;
+	}
+	return false;
+}
+
 /*
  * XidInMVCCSnapshot
  *		Is the given XID still-in-progress according to the snapshot?
@@ -2241,8 +2276,6 @@ RestoreTransactionSnapshot(Snapshot snapshot, void *source_pgproc)
 bool
 XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 {
-	uint32		i;
-
 	/*
 	 * Make a quick range check to eliminate most XIDs without looking at the
 	 * xip arrays.  Note that this is OK even if we convert a subxact XID to
@@ -2258,6 +2291,22 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 	if (TransactionIdFollowsOrEquals(xid, snapshot->xmax))
 		return true;
 
+	/*
+	 * If the snapshot holds many xids, sort its arrays on first use so that
+	 * this and all later checks against it can use binary search.  The order
+	 * of the xids in a snapshot is not significant otherwise, and copies of
+	 * the snapshot inherit the sorted arrays.
+	 */
+	if (!snapshot->xip_sorted &&
+		snapshot->xcnt + snapshot->subxcnt > XIP_BSEARCH_THRESHOLD)
+	{
+		qsort(snapshot->xip, snapshot->xcnt, sizeof(TransactionId),
+			  xidComparator);
+		qsort(snapshot->subxip, snapshot->subxcnt, sizeof(TransactionId),
+			  xidComparator);
+		snapshot->xip_sorted = true;
+	}
+
 	/*
 	 * Snapshot information is stored slightly differently in snapshots taken
 	 * during recovery.
@@ -2274,13 +2323,9 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 		if (!snapshot->suboverflowed)
 		{
 			/* we have full data, so search subxip */
-			int32		j;
-
-			for (j = 0; j < snapshot->subxcnt; j++)
-			{
-				if (TransactionIdEquals(xid, snapshot->subxip[j]))
-					return true;
-			}
+			if (XidInSnapshotArray(xid, snapshot->subxip, snapshot->subxcnt,
+								   snapshot->xip_sorted))
+				return true;
 
 			/* not there, fall through to search xip[] */
 		}
@@ -2301,16 +2346,12 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 				return false;
 		}
 
-		for (i = 0; i < snapshot->xcnt; i++)
-		{
-			if (TransactionIdEquals(xid, snapshot->xip[i]))
-				return true;
-		}
+		if (XidInSnapshotArray(xid, snapshot->xip, snapshot->xcnt,
+							   snapshot->xip_sorted))
+			return true;
 	}
 	else
 	{
-		int32		j;
-
 		/*
 		 * In recovery we store all xids in the subxact array because it is by
 		 * far the bigger array, and we mostly don't know which xids are
@@ -2340,11 +2381,9 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 		 * indeterminate xid. We don't know whether it's top level or subxact
 		 * but it doesn't matter. If it's present, the xid is visible.
 		 */
-		for (j = 0; j < snapshot->subxcnt; j++)
-		{
-			if (TransactionIdEquals(xid, snapshot->subxip[j]))
-				return true;
-		}
+		if (XidInSnapshotArray(xid, snapshot->subxip, snapshot->subxcnt,
+							   snapshot->xip_sorted))
+			return true;
 	}
 
 	return false;
@@ -129,6 +129,7 @@ typedef struct _restoreOptions
 	int			suppressDumpWarnings;	/* Suppress output of WARNING entries
 										 * to stderr */
 	bool		single_txn;
+	int			txn_size;		/* commit after this many TOC entries, if > 0 */
 
 	bool	   *idWanted;		/* array showing which dump IDs to emit */
 	int			enable_row_security;
@@ -149,6 +150,7 @@ typedef struct _dumpOptions
 	bool		aclsSkip;
 	const char *lockWaitTimeout;
 	int			dump_inserts;	/* 0 = COPY, otherwise rows per INSERT */
+	int			split_table_data;	/* 0 = off, otherwise MB per piece */
 
 	/* flags for various command-line long options */
 	int			disable_dollar_quoting;
@@ -104,6 +104,8 @@ static OutputContext SaveOutput(ArchiveHandle *AH);
 static void RestoreOutput(ArchiveHandle *AH, OutputContext savedContext);
 
 static int	restore_toc_entry(ArchiveHandle *AH, TocEntry *te, bool is_parallel);
+static void _beginTxnBatch(ArchiveHandle *AH);
+static void _endTxnBatch(ArchiveHandle *AH);
 static void restore_toc_entries_prefork(ArchiveHandle *AH,
 										TocEntry *pending_list);
 static void restore_toc_entries_parallel(ArchiveHandle *AH,
@@ -729,6 +731,9 @@ RestoreArchive(Archive *AHX)
 			ahprintf(AH, "COMMIT;\n\n");
 	}
 
+	/* Commit any partial --transaction-size batch */
+	_endTxnBatch(AH);
+
 	if (AH->public.verbose)
 		dumpTimestamp(AH, "Completed on", time(NULL));
 
@@ -775,6 +780,26 @@ restore_toc_entry(ArchiveHandle *AH, TocEntry *te, bool is_parallel)
 	/* Work out what, if anything, we want from this entry */
 	reqs = te->reqs;
 
+	/*
+	 * In --transaction-size mode, restore entries in batches of that many
+	 * per transaction, rather than paying for a commit after every single
+	 * DDL command.  A database can't be created inside a transaction block,
+	 * though, so close the batch for that.
+	 *
+	 * In a parallel restore, this applies to the entries the leader restores
+	 * itself, which is mainly the pre-data section: those are many and
+	 * small, whereas the items given to workers are mostly large data loads
+	 * and index builds, where a commit per item costs nothing noticeable.
+	 */
+	if (ropt->txn_size > 0 && !is_parallel &&
+		(reqs & (REQ_SCHEMA | REQ_DATA)) != 0)
+	{
+		if (strcmp(te->desc, "DATABASE") == 0)
+			_endTxnBatch(AH);
+		else
+			_beginTxnBatch(AH);
+	}
+
 	defnDumped = false;
 
 	/*
@@ -954,9 +979,49 @@ restore_toc_entry(ArchiveHandle *AH, TocEntry *te, bool is_parallel)
 	if (AH->public.n_errors > 0 && status == WORKER_OK)
 		status = WORKER_IGNORED_ERRORS;
 
+	/* Commit the current batch if it is full */
+	if (AH->txnBatchOpen && ++AH->txnCount >= ropt->txn_size)
+		_endTxnBatch(AH);
+
 	return status;
 }
 
+/*
+ * Start a transaction for the next batch of TOC entries in --transaction-size
+ * mode, unless one is open already.
+ */
+static void
+_beginTxnBatch(ArchiveHandle *AH)
+{
+	if (AH->txnBatchOpen)
+		return;
+
+	if (AH->connection)
+		StartTransaction(&AH->public);
+	else
+		ahprintf(AH, "BEGIN;\n\n");
+
+	AH->txnBatchOpen = true;
+	AH->txnCount = 0;
+}
+
+/*
+ * Commit the current batch of TOC entries in --transaction-size mode, if any.
+ */
+static void
+_endTxnBatch(ArchiveHandle *AH)
+{
+	if (!AH->txnBatchOpen)
+		return;
+
+	if (AH->connection)
+		CommitTransaction(&AH->public);
+	else
+		ahprintf(AH, "COMMIT;\n\n");
+
+	AH->txnBatchOpen = false;
+}
+
 /*
  * Allocate a new RestoreOptions block.
  * This is mainly so we can initialize it, but also for future expansion,
@@ -1253,7 +1318,11 @@ StartRestoreBlobs(ArchiveHandle *AH)
 {
 	RestoreOptions *ropt = AH->public.ropt;
 
-	if (!ropt->single_txn)
+	/*
+	 * Restore the blobs in one transaction, unless we're already in one for
+	 * --single-transaction or a --transaction-size batch.
+	 */
+	if (!ropt->single_txn && !AH->txnBatchOpen)
 	{
 		if (AH->connection)
 			StartTransaction(&AH->public);
@@ -1272,7 +1341,8 @@ EndRestoreBlobs(ArchiveHandle *AH)
 {
 	RestoreOptions *ropt = AH->public.ropt;
 
-	if (!ropt->single_txn)
+	/* Commit only the transaction StartRestoreBlobs started, if any */
+	if (!ropt->single_txn && !AH->txnBatchOpen)
 	{
 		if (AH->connection)
 			CommitTransaction(&AH->public);
@@ -1836,8 +1906,10 @@ buildTocEntryArrays(ArchiveHandle *AH)
 		/*
 		 * tableDataId provides the TABLE DATA item's dump ID for each TABLE
 		 * TOC entry that has a DATA item.  We compute this by reversing the
-		 * TABLE DATA item's dependency, knowing that a TABLE DATA item has
-		 * just one dependency and it is the TABLE item.
+		 * TABLE DATA item's dependency, knowing that the first dependency of
+		 * a TABLE DATA item is the TABLE item.  If the table's data was split
+		 * into several pieces, the piece that depends on all the others comes
+		 * last in the TOC and so is the one remembered here.
 		 */
 		if (strcmp(te->desc, "TABLE DATA") == 0 && te->nDeps > 0)
 		{
@@ -3179,6 +3251,9 @@ _doSetSessionAuth(ArchiveHandle *AH, const char *user)
 static void
 _reconnectToDB(ArchiveHandle *AH, const char *dbname)
 {
+	/* The batch's work has to be committed before we leave the session */
+	_endTxnBatch(AH);
+
 	if (RestoringToDB(AH))
 		ReconnectToServer(AH, dbname);
 	else
@@ -3963,8 +4038,10 @@ restore_toc_entries_prefork(ArchiveHandle *AH, TocEntry *pending_list)
 	/*
 	 * Now close parent connection in prep for parallel steps.  We do this
 	 * mainly to ensure that we don't exceed the specified number of parallel
-	 * connections.
+	 * connections.  The workers must be able to see everything restored so
+	 * far, so commit any open --transaction-size batch first.
 	 */
+	_endTxnBatch(AH);
 	DisconnectDatabase(&AH->public);
 
 	/* blow away any transient state from the old connection */
@@ -4727,7 +4804,13 @@ mark_create_done(ArchiveHandle *AH, TocEntry *te)
 	{
 		TocEntry   *ted = AH->tocsByDumpId[AH->tableDataId[te->dumpId]];
 
-		ted->created = true;
+		/*
+		 * Don't do this if the data was split into pieces: the TRUNCATE that
+		 * restore_toc_entry issues for a created table would throw away the
+		 * pieces restored before this one.
+		 */
+		if (ted->nDeps <= 1)
+			ted->created = true;
 	}
 }
 
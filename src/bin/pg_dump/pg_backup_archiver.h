@@ -363,6 +363,10 @@ struct _archiveHandle
 	RestorePass restorePass;	/* used only during parallel restore */
 	struct _tocEntry *currentTE;
 	struct _tocEntry *lastErrorTE;
+
+	/* State of --transaction-size batching */
+	bool		txnBatchOpen;	/* is a batch transaction open? */
+	int			txnCount;		/* TOC entries restored in current batch */
 };
 
 struct _tocEntry
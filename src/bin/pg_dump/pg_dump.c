@@ -248,6 +248,7 @@ static void addConstrChildIdxDeps(DumpableObject *dobj, const IndxInfo *refidx);
 static void getDomainConstraints(Archive *fout, TypeInfo *tyinfo);
 static void getTableData(DumpOptions *dopt, TableInfo *tblinfo, int numTables, char relkind);
 static void makeTableDataInfo(DumpOptions *dopt, TableInfo *tbinfo);
+static void splitTableData(Archive *fout, TableInfo *tblinfo, int numTables);
 static void buildMatViewRefreshDependencies(Archive *fout);
 static void getTableDataFKConstraints(void);
 static char *format_function_arguments(const FuncInfo *finfo, const char *funcargs,
@@ -327,6 +328,7 @@ main(int argc, char **argv)
 	const char *dumpsnapshot = NULL;
 	char	   *use_role = NULL;
 	long		rowsPerInsert;
+	long		splitTableMB;
 	int			numWorkers = 1;
 	int			compressLevel = -1;
 	int			plainText = 0;
@@ -386,6 +388,7 @@ main(int argc, char **argv)
 		{"load-via-partition-root", no_argument, &dopt.load_via_partition_root, 1},
 		{"role", required_argument, NULL, 3},
 		{"section", required_argument, NULL, 5},
+		{"split-table-data", required_argument, NULL, 12},
 		{"serializable-deferrable", no_argument, &dopt.serializable_deferrable, 1},
 		{"snapshot", required_argument, NULL, 6},
 		{"strict-names", no_argument, &strict_names, 1},
@@ -624,6 +627,21 @@ main(int argc, char **argv)
 										  optarg);
 				break;
 
+			case 12:			/* split table data */
+				errno = 0;
+				splitTableMB = strtol(optarg, &endptr, 10);
+
+				if (endptr == optarg || *endptr != '\0' ||
+					splitTableMB <= 0 || splitTableMB > INT_MAX / 1024 ||
+					errno == ERANGE)
+				{
+					pg_log_error("split-table-data must be in range %d..%d",
+								 1, INT_MAX / 1024);
+					exit_nicely(1);
+				}
+				dopt.split_table_data = (int) splitTableMB;
+				break;
+
 			default:
 				fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
 				exit_nicely(1);
@@ -680,6 +698,9 @@ main(int argc, char **argv)
 	if (dopt.if_exists && !dopt.outputClean)
 		fatal("option --if-exists requires option -c/--clean");
 
+	if (dopt.dataOnly && dopt.split_table_data)
+		fatal("options -a/--data-only and --split-table-data cannot be used together");
+
 	/*
 	 * --inserts are already implied above if --column-inserts or
 	 * --rows-per-insert were specified.
@@ -881,6 +902,8 @@ main(int argc, char **argv)
 	if (!dopt.schemaOnly)
 	{
 		getTableData(&dopt, tblinfo, numTables, 0);
+		if (dopt.split_table_data)
+			splitTableData(fout, tblinfo, numTables);
 		buildMatViewRefreshDependencies(fout);
 		if (dopt.dataOnly)
 			getTableDataFKConstraints();
@@ -1087,6 +1110,8 @@ help(const char *progname)
 	printf(_("  --section=SECTION            dump named section (pre-data, data, or post-data)\n"));
 	printf(_("  --serializable-deferrable    wait until the dump can run without anomalies\n"));
 	printf(_("  --snapshot=SNAPSHOT          use given snapshot for the dump\n"));
+	printf(_("  --split-table-data=SIZE      split table data into pieces of about SIZE\n"
+			 "                               megabytes\n"));
 	printf(_("  --strict-names               require table and/or schema include patterns to\n"
 			 "                               match at least one entity each\n"));
 	printf(_("  --use-set-session-authorization\n"
@@ -1970,10 +1995,26 @@ dumpTableData_copy(Archive *fout, const void *dcontext)
 
 	/*
 	 * Use COPY (SELECT ...) TO when dumping a foreign table's data, and when
-	 * a filter condition was specified.  For other cases a simple COPY
-	 * suffices.
+	 * a filter condition was specified or we are dumping only a piece of the
+	 * table.  For other cases a simple COPY suffices.
 	 */
-	if (tdinfo->filtercond || tbinfo->relkind == RELKIND_FOREIGN_TABLE)
+	if (tdinfo->ctidcond)
+	{
+		appendPQExpBufferStr(q, "COPY (SELECT ");
+		/* klugery to get rid of parens in column list */
+		if (strlen(column_list) > 2)
+		{
+			appendPQExpBufferStr(q, column_list + 1);
+			q->data[q->len - 1] = ' ';
+		}
+		else
+			appendPQExpBufferStr(q, "* ");
+
+		appendPQExpBuffer(q, "FROM ONLY %s %s) TO stdout;",
+						  fmtQualifiedDumpable(tbinfo),
+						  tdinfo->ctidcond);
+	}
+	else if (tdinfo->filtercond || tbinfo->relkind == RELKIND_FOREIGN_TABLE)
 	{
 		/* Note: this syntax is only supported in 8.2 and up */
 		appendPQExpBufferStr(q, "COPY (SELECT ");
@@ -2116,6 +2157,8 @@ dumpTableData_insert(Archive *fout, const void *dcontext)
 					  fmtQualifiedDumpable(tbinfo));
 	if (tdinfo->filtercond)
 		appendPQExpBuffer(q, " %s", tdinfo->filtercond);
+	else if (tdinfo->ctidcond)
+		appendPQExpBuffer(q, " %s", tdinfo->ctidcond);
 
 	ExecuteSqlStatement(fout, q->data);
 
@@ -2402,6 +2445,22 @@ dumpTableData(Archive *fout, const TableDataInfo *tdinfo)
 	if (tdinfo->dobj.dump & DUMP_COMPONENT_DATA)
 	{
 		TocEntry   *te;
+		DumpId	   *deps = &(tbinfo->dobj.dumpId);
+		int			nDeps = 1;
+
+		/*
+		 * The first piece of a split table also depends on the other pieces.
+		 * The table must remain the first dependency, since that is how
+		 * pg_restore matches the data to its table.
+		 */
+		if (tdinfo->npieces > 0)
+		{
+			nDeps = tdinfo->npieces + 1;
+			deps = (DumpId *) pg_malloc(nDeps * sizeof(DumpId));
+			deps[0] = tbinfo->dobj.dumpId;
+			memcpy(deps + 1, tdinfo->pieceIds,
+				   tdinfo->npieces * sizeof(DumpId));
+		}
 
 		te = ArchiveEntry(fout, tdinfo->dobj.catId, tdinfo->dobj.dumpId,
 						  ARCHIVE_OPTS(.tag = tbinfo->dobj.name,
@@ -2410,8 +2469,8 @@ dumpTableData(Archive *fout, const TableDataInfo *tdinfo)
 									   .description = "TABLE DATA",
 									   .section = SECTION_DATA,
 									   .copyStmt = copyStmt,
-									   .deps = &(tbinfo->dobj.dumpId),
-									   .nDeps = 1,
+									   .deps = deps,
+									   .nDeps = nDeps,
 									   .dumpFn = dumpFn,
 									   .dumpArg = tdinfo));
 
@@ -2422,9 +2481,13 @@ dumpTableData(Archive *fout, const TableDataInfo *tdinfo)
 		 * However, relpages is declared as "integer" in pg_class, and hence
 		 * also in TableInfo, but it's really BlockNumber a/k/a unsigned int.
 		 * Cast so that we get the right interpretation of table sizes
-		 * exceeding INT_MAX pages.
+		 * exceeding INT_MAX pages.  For a split table, each piece reports its
+		 * own share.
 		 */
-		te->dataLength = (BlockNumber) tbinfo->relpages;
+		te->dataLength = (BlockNumber) tdinfo->npages;
+
+		if (deps != &(tbinfo->dobj.dumpId))
+			free(deps);
 	}
 
 	destroyPQExpBuffer(copyBuf);
@@ -2548,6 +2611,10 @@ makeTableDataInfo(DumpOptions *dopt, TableInfo *tbinfo)
 	tdinfo->dobj.namespace = tbinfo->dobj.namespace;
 	tdinfo->tdtable = tbinfo;
 	tdinfo->filtercond = NULL;	/* might get set later */
+	tdinfo->ctidcond = NULL;
+	tdinfo->npages = tbinfo->relpages;
+	tdinfo->pieceIds = NULL;
+	tdinfo->npieces = 0;
 	addObjectDependency(&tdinfo->dobj, tbinfo->dobj.dumpId);
 
 	tbinfo->dataObj = tdinfo;
@@ -2556,6 +2623,96 @@ makeTableDataInfo(DumpOptions *dopt, TableInfo *tbinfo)
 	tbinfo->interesting = true;
 }
 
+/*
+ * splitTableData -
+ *	  divide the data of large tables into pieces that can be dumped and
+ *	  restored in parallel
+ *
+ * Each piece covers a range of ctids, which the server can fetch using a
+ * TID Range Scan, so a large table no longer has to be dumped by a single
+ * worker while the others sit idle.  The table's original TableDataInfo
+ * becomes the first piece; it depends on all the others, so that it is the
+ * last to be dumped or restored and thus a safe thing for indexes and
+ * constraints on the table to wait for.
+ *
+ * Pieces are sized from relpages, which is only an estimate; the last piece
+ * has no upper bound so that rows beyond the estimate are not lost.
+ */
+static void
+splitTableData(Archive *fout, TableInfo *tblinfo, int numTables)
+{
+	BlockNumber piecepages;
+	int			i;
+
+	/* TID Range Scans appeared in 14; without them, this would be slow */
+	if (fout->remoteVersion < 140000)
+	{
+		pg_log_warning("--split-table-data requires server version 14 or later; ignoring");
+		return;
+	}
+
+	piecepages = (BlockNumber) (((uint64) fout->dopt->split_table_data *
+								 1024 * 1024) / BLCKSZ);
+	if (piecepages == 0)
+		piecepages = 1;
+
+	for (i = 0; i < numTables; i++)
+	{
+		TableInfo  *tbinfo = &tblinfo[i];
+		TableDataInfo *tdinfo = tbinfo->dataObj;
+		BlockNumber relpages = (BlockNumber) tbinfo->relpages;
+		int			npieces;
+		int			j;
+
+		/* Only plain tables dumped in full are worth splitting */
+		if (tdinfo == NULL ||
+			tdinfo->dobj.objType != DO_TABLE_DATA ||
+			tbinfo->relkind != RELKIND_RELATION ||
+			tdinfo->filtercond != NULL ||
+			relpages <= piecepages)
+			continue;
+
+		npieces = (relpages + piecepages - 1) / piecepages;
+		tdinfo->pieceIds = (DumpId *) pg_malloc((npieces - 1) * sizeof(DumpId));
+		tdinfo->npieces = npieces - 1;
+		tdinfo->ctidcond = psprintf("WHERE ctid < '(%u,0)'", piecepages);
+		tdinfo->npages = piecepages;
+
+		for (j = 1; j < npieces; j++)
+		{
+			TableDataInfo *piece;
+			BlockNumber start = j * piecepages;
+
+			piece = (TableDataInfo *) pg_malloc(sizeof(TableDataInfo));
+			piece->dobj.objType = DO_TABLE_DATA;
+			piece->dobj.catId = tdinfo->dobj.catId;
+			AssignDumpId(&piece->dobj);
+			piece->dobj.name = tdinfo->dobj.name;
+			piece->dobj.namespace = tdinfo->dobj.namespace;
+			piece->dobj.dump = tdinfo->dobj.dump;
+			piece->tdtable = tbinfo;
+			piece->filtercond = NULL;
+			if (j < npieces - 1)
+			{
+				piece->ctidcond = psprintf("WHERE ctid >= '(%u,0)' AND ctid < '(%u,0)'",
+										   start, start + piecepages);
+				piece->npages = piecepages;
+			}
+			else
+			{
+				piece->ctidcond = psprintf("WHERE ctid >= '(%u,0)'", start);
+				piece->npages = relpages - start;
+			}
+			piece->pieceIds = NULL;
+			piece->npieces = 0;
+			addObjectDependency(&piece->dobj, tbinfo->dobj.dumpId);
+
+			tdinfo->pieceIds[j - 1] = piece->dobj.dumpId;
+			addObjectDependency(&tdinfo->dobj, piece->dobj.dumpId);
+		}
+	}
+}
+
 /*
  * The refresh for a materialized view must be dependent on the refresh for
  * any materialized view that this one is dependent on.
@@ -361,6 +361,10 @@ typedef struct _tableDataInfo
 	DumpableObject dobj;
 	TableInfo  *tdtable;		/* link to table to dump */
 	char	   *filtercond;		/* WHERE condition to limit rows dumped */
+	char	   *ctidcond;		/* ctid range of this piece of a split table */
+	int			npages;			/* estimated size of this piece, in pages */
+	DumpId	   *pieceIds;		/* in the first piece, IDs of the others */
+	int			npieces;		/* number of entries in pieceIds */
 } TableDataInfo;
 
 typedef struct _indxInfo
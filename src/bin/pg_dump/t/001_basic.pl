@@ -4,7 +4,7 @@ use warnings;
 use Config;
 use PostgresNode;
 use TestLib;
-use Test::More tests => 82;
+use Test::More tests => 86;
 
 my $tempdir       = TestLib::tempdir;
 my $tempdir_short = TestLib::tempdir_short;
@@ -133,6 +133,17 @@ command_fails_like(
 	qr/\Qpg_dump: error: rows-per-insert must be in range 1..2147483647\E/,
 	'pg_dump: rows-per-insert must be in range 1..2147483647');
 
+command_fails_like(
+	[ 'pg_dump', '--split-table-data', '0' ],
+	qr/\Qpg_dump: error: split-table-data must be in range 1..2097151\E/,
+	'pg_dump: split-table-data must be in range 1..2097151');
+
+command_fails_like(
+	[ 'pg_dump', '-a', '--split-table-data', '1' ],
+	qr/\Qpg_dump: error: options -a\/--data-only and --split-table-data cannot be used together\E/,
+	'pg_dump: options -a/--data-only and --split-table-data cannot be used together'
+);
+
 command_fails_like(
 	[ 'pg_restore', '--if-exists', '-f -' ],
 	qr/\Qpg_restore: error: option --if-exists requires option -c\/--clean\E/,
@@ -0,0 +1,95 @@
+use strict;
+use warnings;
+
+use PostgresNode;
+use TestLib;
+use Test::More tests => 9;
+
+my $tempdir = TestLib::tempdir;
+
+my $node = get_new_node('main');
+my $port = $node->port;
+
+$node->init;
+$node->start;
+
+#########################################
+# Verify that large objects restored with --transaction-size are restored
+# in the current batch, without opening or closing transactions of their own
+
+$node->safe_psql(
+	'postgres', q{
+	CREATE TABLE tab (a int);
+	INSERT INTO tab VALUES (1), (2);
+	SELECT lo_from_bytea(100001, 'one');
+	SELECT lo_from_bytea(100002, 'two');
+	SELECT lo_from_bytea(100003, 'three');
+	COMMENT ON LARGE OBJECT 100001 IS 'first';
+});
+
+my $dump = "$tempdir/blobs.dump";
+
+command_ok([ 'pg_dump', '-p', $port, '-Fc', '-f', $dump, 'postgres' ],
+	'dump database with large objects');
+
+$node->safe_psql('postgres', 'CREATE DATABASE restored');
+
+my ($stdout, $stderr) = run_command(
+	[
+		'pg_restore', '-p', $port, '-v', '--transaction-size=2',
+		'-d', 'restored', $dump
+	]);
+like($stderr, qr/restored 3 large objects/,
+	'large objects restored with --transaction-size');
+unlike(
+	$stderr,
+	qr/transaction in progress/,
+	'no nested or missing transaction blocks when restoring large objects');
+
+is( $node->safe_psql(
+		'restored',
+		"SELECT string_agg(convert_from(lo_get(oid), 'UTF8'), ',' ORDER BY oid)
+		 FROM pg_largeobject_metadata"),
+	'one,two,three',
+	'large object contents restored');
+
+my $script = "$tempdir/blobs.sql";
+
+command_ok(
+	[ 'pg_restore', '--transaction-size=2', '-f', $script, $dump ],
+	'write restore script with --transaction-size');
+
+my $depth = 0;
+my $nested = 0;
+foreach my $stmt (slurp_file($script) =~ /^(BEGIN|COMMIT);$/mg)
+{
+	$depth += ($stmt eq 'BEGIN') ? 1 : -1;
+	$nested = 1 if $depth < 0 || $depth > 1;
+}
+ok(!$nested && $depth == 0,
+	'restore script has no nested transaction blocks');
+
+#########################################
+# A parallel restore with --transaction-size must give the same result
+
+$node->safe_psql('postgres', 'CREATE DATABASE restored_parallel');
+
+command_ok(
+	[
+		'pg_restore', '-p', $port, '-j', '2', '--transaction-size=2',
+		'-d', 'restored_parallel', $dump
+	],
+	'parallel restore with --transaction-size');
+
+my $check_query = q{
+	SELECT (SELECT string_agg(a::text, ',' ORDER BY a) FROM tab),
+	       (SELECT string_agg(convert_from(lo_get(oid), 'UTF8'), ',' ORDER BY oid)
+	        FROM pg_largeobject_metadata),
+	       obj_description(100001, 'pg_largeobject')};
+
+is($node->safe_psql('restored_parallel', $check_query),
+	'1,2|one,two,three|first',
+	'parallel restore with --transaction-size restores all objects');
+is( $node->safe_psql('restored_parallel', $check_query),
+	$node->safe_psql('restored', $check_query),
+	'parallel and serial restores with --transaction-size match');
@@ -0,0 +1,64 @@
+use strict;
+use warnings;
+
+use PostgresNode;
+use TestLib;
+use Test::More tests => 7;
+
+my $tempdir = TestLib::tempdir;
+
+my $node = get_new_node('main');
+my $port = $node->port;
+
+$node->init;
+$node->start;
+
+#########################################
+# Verify that --split-table-data dumps a large table as several TABLE DATA
+# entries, and that restoring them in parallel brings back every row once
+
+$node->safe_psql(
+	'postgres', q{
+	CREATE TABLE big (id int PRIMARY KEY, pad text);
+	INSERT INTO big SELECT i, repeat('x', 100) FROM generate_series(1, 30000) i;
+	CREATE TABLE small (id int);
+	INSERT INTO small VALUES (1), (2);
+	VACUUM ANALYZE big, small;
+});
+
+my $checksum_query =
+  "SELECT count(*), sum(id), md5(string_agg(id::text || pad, ',' ORDER BY id)) FROM big";
+my $expected = $node->safe_psql('postgres', $checksum_query);
+
+my $dump = "$tempdir/split";
+
+command_ok(
+	[
+		'pg_dump', '-p', $port, '-Fd', '-j2',
+		'--split-table-data=1', '-f', $dump, 'postgres'
+	],
+	'parallel dump with --split-table-data');
+
+my ($stdout, $stderr) = run_command([ 'pg_restore', '-l', $dump ]);
+my $npieces = () = $stdout =~ /TABLE DATA public big /g;
+cmp_ok($npieces, '>', 1, 'data of large table is dumped in pieces');
+my $nsmall = () = $stdout =~ /TABLE DATA public small /g;
+is($nsmall, 1, 'data of small table is dumped in one piece');
+
+$node->safe_psql('postgres', 'CREATE DATABASE restored');
+
+command_ok([ 'pg_restore', '-p', $port, '-j2', '-d', 'restored', $dump ],
+	'parallel restore of split table data');
+
+is($node->safe_psql('restored', $checksum_query),
+	$expected, 'all rows of split table restored exactly once');
+is($node->safe_psql('restored', 'SELECT count(*) FROM small'),
+	'2', 'small table restored');
+
+# The primary key must have been built after all the pieces were loaded
+is( $node->safe_psql(
+		'restored',
+		"SELECT count(*) FROM pg_index WHERE indrelid = 'big'::regclass AND indisvalid"
+	),
+	'1',
+	'primary key restored');
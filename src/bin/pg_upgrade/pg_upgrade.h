@@ -20,6 +20,15 @@
 
 #define MESSAGE_WIDTH		60
 
+/*
+ * Number of objects pg_restore creates per transaction.  Committing after
+ * every object is a large part of the schema restore time for databases with
+ * many objects, but a batch holds locks on all the objects it creates, and
+ * several databases may be restored in parallel, so don't make this so large
+ * as to risk exhausting the lock table.
+ */
+#define RESTORE_TRANSACTION_SIZE	100
+
 #define GET_MAJOR_VERSION(v)	((v) / 100)
 
 /* contains both global db information and CREATE DATABASE commands */
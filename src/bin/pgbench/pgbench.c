@@ -273,6 +273,7 @@ int			nclients = 1;		/* number of clients */
 int			nthreads = 1;		/* number of threads */
 bool		is_connect;			/* establish connection for each transaction */
 bool		report_per_command; /* report per-command latencies */
+bool		latency_percentiles = false;	/* report latency percentiles */
 int			main_pid;			/* main process id used in log filename */
 
 const char *pghost = NULL;
@@ -340,8 +341,21 @@ typedef struct StatsData
 								 * and --latency-limit */
 	SimpleStats latency;
 	SimpleStats lag;
+	int64	   *latency_hist;	/* latency histogram, or NULL if not kept */
 } StatsData;
 
+/*
+ * Latencies (in microseconds) are counted in a log-linear histogram, as in
+ * HdrHistogram: values below 2^LATENCY_HIST_SUB_BITS each get a bucket, and
+ * each higher power-of-2 range is split into 2^LATENCY_HIST_SUB_BITS equal
+ * buckets.  That bounds the relative error of a percentile to below 1%,
+ * for latencies up to 2^LATENCY_HIST_MAX_BITS us (about 12 days).
+ */
+#define LATENCY_HIST_SUB_BITS	7
+#define LATENCY_HIST_MAX_BITS	40
+#define LATENCY_HIST_BUCKETS \
+	((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+
 /*
  * Struct to keep random state.
  */
@@ -737,6 +751,7 @@ usage(void)
 		   "  -T, --time=NUM           duration of benchmark test in seconds\n"
 		   "  -v, --vacuum-all         vacuum all four standard tables before tests\n"
 		   "  --aggregate-interval=NUM aggregate data over NUM seconds\n"
+		   "  --latency-percentiles    report latency percentiles\n"
 		   "  --log-prefix=PREFIX      prefix for transaction time log file\n"
 		   "                           (default: \"pgbench_log\")\n"
 		   "  --progress-timestamp     use Unix epoch timestamps for progress\n"
@@ -1286,6 +1301,71 @@ initStats(StatsData *sd, pg_time_usec_t start)
 	sd->skipped = 0;
 	initSimpleStats(&sd->latency);
 	initSimpleStats(&sd->lag);
+	sd->latency_hist = NULL;
+}
+
+/*
+ * Make a StatsData keep a latency histogram, if percentiles are wanted.
+ */
+static void
+allocLatencyHist(StatsData *sd)
+{
+	if (latency_percentiles && sd->latency_hist == NULL)
+		sd->latency_hist = (int64 *) pg_malloc0(LATENCY_HIST_BUCKETS * sizeof(int64));
+}
+
+/*
+ * Map a latency in microseconds to its histogram bucket, and back.
+ */
+static int
+latencyHistBucket(double lat)
+{
+	uint64		v;
+	int			msb;
+
+	if (lat <= 0)
+		return 0;
+	if (lat >= (double) (UINT64CONST(1) << LATENCY_HIST_MAX_BITS))
+		return LATENCY_HIST_BUCKETS - 1;
+
+	v = (uint64) lat;
+	if (v < (1 << LATENCY_HIST_SUB_BITS))
+		return (int) v;
+
+	msb = pg_leftmost_one_pos64(v);
+	return ((msb - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS) +
+		(int) ((v >> (msb - LATENCY_HIST_SUB_BITS)) &
+			   ((1 << LATENCY_HIST_SUB_BITS) - 1));
+}
+
+static double
+latencyHistValue(int bucket)
+{
+	int			group = bucket >> LATENCY_HIST_SUB_BITS;
+	uint64		sub = bucket & ((1 << LATENCY_HIST_SUB_BITS) - 1);
+	uint64		low;
+	uint64		width;
+
+	if (group == 0)
+		return (double) bucket;
+
+	/* report the middle of the bucket's range */
+	low = ((UINT64CONST(1) << LATENCY_HIST_SUB_BITS) + sub) << (group - 1);
+	width = UINT64CONST(1) << (group - 1);
+	return (double) low + (width - 1) / 2.0;
+}
+
+/*
+ * Merge the latency histogram of one StatsData into another
+ */
+static void
+mergeLatencyHist(StatsData *acc, StatsData *sd)
+{
+	if (acc->latency_hist == NULL || sd->latency_hist == NULL)
+		return;
+
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+		acc->latency_hist[i] += sd->latency_hist[i];
 }
 
 /*
@@ -1304,6 +1384,8 @@ accumStats(StatsData *stats, bool skipped, double lat, double lag)
 	else
 	{
 		addToSimpleStats(&stats->latency, lat);
+		if (stats->latency_hist)
+			stats->latency_hist[latencyHistBucket(lat)]++;
 
 		/* and possibly the same for schedule lag */
 		if (throttle_delay)
@@ -3858,7 +3940,8 @@ processXactStats(TState *thread, CState *st, pg_time_usec_t *now,
 {
 	double		latency = 0.0,
 				lag = 0.0;
-	bool		thread_details = progress || throttle_delay || latency_limit,
+	bool		thread_details = progress || throttle_delay || latency_limit ||
+		latency_percentiles,
 				detailed = thread_details || use_log || per_script_stats;
 
 	if (detailed && !skipped)
@@ -5493,6 +5576,51 @@ printSimpleStats(const char *prefix, SimpleStats *ss)
 	}
 }
 
+/*
+ * Print latency percentiles from the histogram in a StatsData, if it has one.
+ */
+static void
+printLatencyPercentiles(const char *prefix, StatsData *sd)
+{
+	static const double percentiles[] = {50, 90, 99, 99.9, 99.99};
+	int64		count = 0;
+	int64		seen = 0;
+	int			bucket = 0;
+
+	if (sd->latency_hist == NULL)
+		return;
+
+	/*
+	 * Per-script stats are updated without locking, so don't assume that the
+	 * histogram agrees exactly with latency.count.
+	 */
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+		count += sd->latency_hist[i];
+	if (count <= 0)
+		return;
+
+	for (int i = 0; i < lengthof(percentiles); i++)
+	{
+		/* the rank of the latency at this percentile, counting from 1 */
+		int64		rank = (int64) ceil(percentiles[i] / 100.0 * count);
+		double		lat;
+
+		if (rank < 1)
+			rank = 1;
+		while (seen + sd->latency_hist[bucket] < rank)
+			seen += sd->latency_hist[bucket++];
+
+		/* the histogram can't do better than the exact extremes */
+		lat = latencyHistValue(bucket);
+		lat = Max(lat, sd->latency.min);
+		lat = Min(lat, sd->latency.max);
+
+		printf("%s %gth percentile = %.3f ms\n", prefix, percentiles[i],
+			   0.001 * lat);
+	}
+	printf("%s maximum = %.3f ms\n", prefix, 0.001 * sd->latency.max);
+}
+
 /* print out results */
 static void
 printResults(StatsData *total,
@@ -5544,8 +5672,11 @@ printResults(StatsData *total,
 			   latency_limit / 1000.0, latency_late, ntx,
 			   (ntx > 0) ? 100.0 * latency_late / ntx : 0.0);
 
-	if (throttle_delay || progress || latency_limit)
+	if (throttle_delay || progress || latency_limit || latency_percentiles)
+	{
 		printSimpleStats("latency", &total->latency);
+		printLatencyPercentiles("latency", total);
+	}
 	else
 	{
 		/* no measurement, show average latency computed from run time */
@@ -5612,6 +5743,7 @@ printResults(StatsData *total,
 						   100.0 * sstats->skipped / sstats->cnt);
 
 				printSimpleStats(" - latency", &sstats->latency);
+				printLatencyPercentiles(" - latency", sstats);
 			}
 
 			/* Report per-command latencies */
@@ -5736,6 +5868,7 @@ main(int argc, char **argv)
 		{"show-script", required_argument, NULL, 10},
 		{"partitions", required_argument, NULL, 11},
 		{"partition-method", required_argument, NULL, 12},
+		{"latency-percentiles", no_argument, NULL, 13},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -6104,6 +6237,10 @@ main(int argc, char **argv)
 					exit(1);
 				}
 				break;
+			case 13:			/* latency-percentiles */
+				benchmarking_option_set = true;
+				latency_percentiles = true;
+				break;
 			default:
 				fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
 				exit(1);
@@ -6142,6 +6279,9 @@ main(int argc, char **argv)
 	if (num_scripts > 1)
 		per_script_stats = true;
 
+	for (i = 0; i < num_scripts; i++)
+		allocLatencyHist(&sql_script[i].stats);
+
 	/*
 	 * Don't need more threads than there are clients.  (This is not merely an
 	 * optimization; throttle_delay is calculated incorrectly below if some
@@ -6421,6 +6561,7 @@ main(int argc, char **argv)
 		thread->logfile = NULL; /* filled in later */
 		thread->latency_late = 0;
 		initStats(&thread->stats, 0);
+		allocLatencyHist(&thread->stats);
 
 		nclients_dealt += thread->nstate;
 	}
@@ -6468,6 +6609,7 @@ main(int argc, char **argv)
 
 	/* wait for other threads and accumulate results */
 	initStats(&stats, 0);
+	allocLatencyHist(&stats);
 	conn_total_duration = 0;
 
 	for (i = 0; i < nthreads; i++)
@@ -6486,6 +6628,7 @@ main(int argc, char **argv)
 		/* aggregate thread level stats */
 		mergeSimpleStats(&stats.latency, &thread->stats.latency);
 		mergeSimpleStats(&stats.lag, &thread->stats.lag);
+		mergeLatencyHist(&stats, &thread->stats);
 		stats.cnt += thread->stats.cnt;
 		stats.skipped += thread->stats.skipped;
 		latency_late += thread->latency_late;
@@ -1168,6 +1168,20 @@ pgbench(
 	'pgbench late throttling',
 	{ '001_pgbench_sleep' => q{\sleep 2ms} });
 
+# latency percentiles, overall and per script
+pgbench(
+	'-t 20 -c 2 -n -b select-only@2 -b simple-update@1 --latency-percentiles',
+	0,
+	[
+		qr{processed: 40/40},
+		qr{\nlatency 50th percentile = \d+\.\d+ ms},
+		qr{\nlatency 99\.9th percentile = \d+\.\d+ ms},
+		qr{\nlatency maximum = \d+\.\d+ ms},
+		qr{ - latency 99th percentile = \d+\.\d+ ms}
+	],
+	[qr{^$}],
+	'pgbench latency percentiles');
+
 # return a list of files from directory $dir matching regexpr $re
 # this works around glob portability and escaping issues
 sub list_files
@@ -38,15 +38,28 @@ int
 ScanKeywordLookup(const char *str,
 				  const ScanKeywordList *keywords)
 {
-	size_t		len;
+	return ScanKeywordLookupLength(str, strlen(str), keywords);
+}
+
+/*
+ * ScanKeywordLookupLength - as above, for a word of known length
+ *
+ * This saves a strlen() call in lexers, which already know the length of
+ * each token.  str must still be null-terminated at str[len].
+ */
+int
+ScanKeywordLookupLength(const char *str, size_t len,
+						const ScanKeywordList *keywords)
+{
 	int			h;
 	const char *kw;
 
+	Assert(str[len] == '\0');
+
 	/*
 	 * Reject immediately if too long to be any keyword.  This saves useless
 	 * hashing and downcasing work on long strings.
 	 */
-	len = strlen(str);
 	if (len > keywords->max_kw_len)
 		return -1;
 
@@ -457,7 +457,8 @@ typedef struct GinTupleCollector
 } GinTupleCollector;
 
 extern void ginHeapTupleFastInsert(GinState *ginstate,
-								   GinTupleCollector *collector);
+								   GinTupleCollector *collector,
+								   Relation heapRel);
 extern void ginHeapTupleFastCollect(GinState *ginstate,
 									GinTupleCollector *collector,
 									OffsetNumber attnum, Datum value, bool isNull,
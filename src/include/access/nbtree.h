@@ -1027,6 +1027,13 @@ typedef struct BTArrayKeyInfo
 	Datum	   *elem_values;	/* array of num_elems Datums */
 } BTArrayKeyInfo;
 
+/*
+ * Number of recently prefetched heap blocks a plain index scan remembers, so
+ * as not to prefetch the same block again when several nearby items point
+ * into it
+ */
+#define BT_PREFETCH_RECENT	8
+
 typedef struct BTScanOpaqueData
 {
 	/* these fields are set by _bt_preprocess_keys(): */
@@ -1064,6 +1071,22 @@ typedef struct BTScanOpaqueData
 	 */
 	int			markItemIndex;	/* itemIndex, or -1 if not valid */
 
+	/*
+	 * State for prefetching the heap blocks of the items in currPos that the
+	 * scan will return next.  prefetchDistance is the number of items to
+	 * look ahead, 0 if we don't prefetch, or -1 if not yet determined.
+	 * prefetchItem is the next currPos item to consider, valid only while
+	 * currPos is on prefetchPage; prefetchPage is reset whenever currPos is
+	 * (re)loaded.  prefetchRecent is a ring of the heap blocks most recently
+	 * prefetched (or read) on that page, and prefetchNext is the slot to
+	 * overwrite next.
+	 */
+	int			prefetchDistance;
+	BlockNumber prefetchPage;
+	int			prefetchItem;
+	int			prefetchNext;
+	BlockNumber prefetchRecent[BT_PREFETCH_RECENT];
+
 	/* keep these last in struct for efficiency */
 	BTScanPosData currPos;		/* current position data */
 	BTScanPosData markPos;		/* marked position, if any */
@@ -33,6 +33,17 @@
  */
 #define SLRU_PAGES_PER_SEGMENT	32
 
+/*
+ * The buffer slots of an SLRU are divided into banks of about SLRU_BANK_SIZE
+ * slots each, and a given page can only be stored in the bank selected by its
+ * page number.  That keeps buffer lookup and victim selection cheap even when
+ * an SLRU is configured with thousands of buffers.
+ */
+#define SLRU_BANK_SIZE			16
+
+/* Upper limit for configurable SLRU buffer counts (1GB worth of pages) */
+#define SLRU_MAX_ALLOWED_BUFFERS ((1024 * 1024 * 1024) / BLCKSZ)
+
 /*
  * Page status codes.  Note that these do not include the "dirty" bit.
  * page_dirty can be true only in the VALID or WRITE_IN_PROGRESS states;
@@ -57,6 +68,9 @@ typedef struct SlruSharedData
 	/* Number of buffers managed by this SLRU structure */
 	int			num_slots;
 
+	/* Number of banks the buffers are divided into, see SlruBankRange() */
+	int			num_banks;
+
 	/*
 	 * Arrays holding info for each buffer slot.  Page number is undefined
 	 * when status is EMPTY, as is page_lru_count.
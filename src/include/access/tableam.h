@@ -102,6 +102,22 @@ typedef enum TM_Result
 	TM_WouldBlock
 } TM_Result;
 
+/*
+ * Result codes for table_update(..., update_indexes*..).
+ * Used to determine which indexes to update.
+ */
+typedef enum TU_UpdateIndexes
+{
+	/* No indexed columns were updated (incl. TID addressing of tuple) */
+	TU_None,
+
+	/* A non-summarizing indexed column was updated, or the TID has changed */
+	TU_All,
+
+	/* Only summarized columns were updated, TID is unchanged */
+	TU_Summarizing
+} TU_UpdateIndexes;
+
 /*
  * When table_tuple_update, table_tuple_delete, or table_tuple_lock fail
  * because the target tuple is already outdated, they fill in this struct to
@@ -355,6 +371,22 @@ typedef struct TableAmRoutine
 											  ScanDirection direction,
 											  TupleTableSlot *slot);
 
+	/*
+	 * Optional callback to tell a scan which columns its caller will access.
+	 * `attrs` holds attribute numbers offset by
+	 * FirstLowInvalidHeapAttributeNumber, as computed by pull_varattnos(); if
+	 * it contains InvalidAttrNumber (a whole-row reference), all columns are
+	 * needed.  AMs that store columns separately can use this to avoid
+	 * reading columns nobody asked for, and may return those as NULL in the
+	 * slot.  AMs that gain nothing from it can leave it NULL.
+	 *
+	 * This is called after scan_begin and before the first call to
+	 * scan_getnextslot; the set remains valid, and in effect, for the
+	 * lifetime of the scan, including across rescans.
+	 */
+	void		(*scan_set_column_projection) (TableScanDesc scan,
+											   Bitmapset *attrs);
+
 	/* ------------------------------------------------------------------------
 	 * Parallel table scan related functions.
 	 * ------------------------------------------------------------------------
@@ -524,7 +556,7 @@ typedef struct TableAmRoutine
 								 bool wait,
 								 TM_FailureData *tmfd,
 								 LockTupleMode *lockmode,
-								 bool *update_indexes);
+								 TU_UpdateIndexes *update_indexes);
 
 	/* see table_tuple_lock() for reference about parameters */
 	TM_Result	(*tuple_lock) (Relation rel,
@@ -1044,6 +1076,17 @@ table_scan_getnextslot(TableScanDesc sscan, ScanDirection direction, TupleTableS
 	return sscan->rs_rd->rd_tableam->scan_getnextslot(sscan, direction, slot);
 }
 
+/*
+ * Tell the scan which columns its caller needs, if the AM is interested; see
+ * the description of scan_set_column_projection in TableAmRoutine.
+ */
+static inline void
+table_scan_set_column_projection(TableScanDesc sscan, Bitmapset *attrs)
+{
+	if (sscan->rs_rd->rd_tableam->scan_set_column_projection != NULL)
+		sscan->rs_rd->rd_tableam->scan_set_column_projection(sscan, attrs);
+}
+
 /* ----------------------------------------------------------------------------
  * TID Range scanning related functions.
  * ----------------------------------------------------------------------------
@@ -1483,8 +1526,9 @@ table_tuple_delete(Relation rel, ItemPointer tid, CommandId cid,
  * Output parameters:
  *	tmfd - filled in failure cases (see below)
  *	lockmode - filled with lock mode acquired on tuple
- *  update_indexes - in success cases this is set to true if new index entries
- *		are required for this tuple
+ *	update_indexes - in success cases this is set to TU_All if new entries
+ *		are required in all indexes, to TU_Summarizing if they are required
+ *		only in summarizing indexes (such as BRIN), or to TU_None otherwise
  *
  * Normal, successful return value is TM_Ok, which means we did actually
  * update it.  Failure return codes are TM_SelfModified, TM_Updated, and
@@ -1504,7 +1548,7 @@ static inline TM_Result
 table_tuple_update(Relation rel, ItemPointer otid, TupleTableSlot *slot,
 				   CommandId cid, Snapshot snapshot, Snapshot crosscheck,
 				   bool wait, TM_FailureData *tmfd, LockTupleMode *lockmode,
-				   bool *update_indexes)
+				   TU_UpdateIndexes *update_indexes)
 {
 	return rel->rd_tableam->tuple_update(rel, otid, slot,
 										 cid, snapshot, crosscheck,
@@ -2027,7 +2071,7 @@ extern void simple_table_tuple_delete(Relation rel, ItemPointer tid,
 									  Snapshot snapshot);
 extern void simple_table_tuple_update(Relation rel, ItemPointer otid,
 									  TupleTableSlot *slot, Snapshot snapshot,
-									  bool *update_indexes);
+									  TU_UpdateIndexes *update_indexes);
 
 
 /* ----------------------------------------------------------------------------
@@ -76,6 +76,8 @@ extern struct varlena *lz4_compress_datum(const struct varlena *value);
 extern struct varlena *lz4_decompress_datum(const struct varlena *value);
 extern struct varlena *lz4_decompress_datum_slice(const struct varlena *value,
 												  int32 slicelength);
+extern int32 lz4_maximum_compressed_size(int32 slicelimit, int32 rawsize,
+										 int32 total_compressed_size);
 
 /* other stuff */
 extern ToastCompressionId toast_get_compression_id(struct varlena *attr);
@@ -15,6 +15,16 @@
 
 #include "access/xlogreader.h"
 
+/*
+ * Prefetching hides the I/O stalls that otherwise dominate single-process
+ * replay, so enable it by default wherever we can issue prefetch hints.
+ */
+#ifdef USE_PREFETCH
+#define DEFAULT_RECOVERY_PREFETCH true
+#else
+#define DEFAULT_RECOVERY_PREFETCH false
+#endif
+
 /* GUCs */
 extern bool recovery_prefetch;
 extern bool recovery_prefetch_fpw;
@@ -273,6 +273,19 @@
 #define unlikely(x) ((x) != 0)
 #endif
 
+/*
+ * pg_prefetch_mem
+ *		Hint that the memory at the given address will be read soon.
+ *
+ * This is only a hint; it has no effect on the program's behavior, and may
+ * do nothing at all.
+ */
+#if __GNUC__ >= 3
+#define pg_prefetch_mem(a)	__builtin_prefetch(a)
+#else
+#define pg_prefetch_mem(a)	((void) (a))
+#endif
+
 /*
  * CppAsString
  *		Convert the argument to a string, using the C preprocessor.
@@ -1143,6 +1156,22 @@ typedef union PGAlignedBlock
 	int64		force_align_i64;
 } PGAlignedBlock;
 
+/*
+ * Same, but aligned suitably for direct I/O (see PG_IO_ALIGN_SIZE).  Use
+ * this for buffers that are passed directly to smgr routines.  If the
+ * compiler can't guarantee the alignment, this is no better than
+ * PGAlignedBlock.
+ */
+typedef union PGIOAlignedBlock
+{
+#ifdef pg_attribute_aligned
+	pg_attribute_aligned(PG_IO_ALIGN_SIZE)
+#endif
+	char		data[BLCKSZ];
+	double		force_align_d;
+	int64		force_align_i64;
+} PGIOAlignedBlock;
+
 /* Same, but for an XLOG_BLCKSZ-sized buffer */
 typedef union PGAlignedXLogBlock
 {
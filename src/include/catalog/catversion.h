@@ -53,6 +53,6 @@
  */
 
 /*							yyyymmddN */
-#define CATALOG_VERSION_NO	202104081
+#define CATALOG_VERSION_NO	202104096
 
 #endif
@@ -172,6 +172,9 @@ typedef struct VacAttrStats
 	Datum	   *exprvals;		/* access info for index fetch function */
 	bool	   *exprnulls;
 	int			rowstride;
+	double		seendistinct;	/* lower bound on # of distinct non-null
+								 * values, from all rows visited while
+								 * sampling; 0 if not known */
 } VacAttrStats;
 
 /* flag bits for VacuumParams->options */
@@ -237,6 +240,7 @@ extern int	vacuum_multixact_freeze_min_age;
 extern int	vacuum_multixact_freeze_table_age;
 extern int	vacuum_failsafe_age;
 extern int	vacuum_multixact_failsafe_age;
+extern bool vacuum_freeze_eager;
 
 /* Variables for cost-based parallel vacuum */
 extern pg_atomic_uint32 *VacuumSharedCostBalance;
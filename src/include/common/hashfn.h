@@ -25,6 +25,7 @@ extern uint64 hash_bytes_extended(const unsigned char *k,
 								  int keylen, uint64 seed);
 extern uint32 hash_bytes_uint32(uint32 k);
 extern uint64 hash_bytes_uint32_extended(uint32 k, uint64 seed);
+extern uint32 hash_bytes_fast(const unsigned char *k, int keylen);
 
 #ifndef FRONTEND
 static inline Datum
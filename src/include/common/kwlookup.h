@@ -33,6 +33,8 @@ typedef struct ScanKeywordList
 
 
 extern int	ScanKeywordLookup(const char *text, const ScanKeywordList *keywords);
+extern int	ScanKeywordLookupLength(const char *text, size_t len,
+									const ScanKeywordList *keywords);
 
 /* Code that wants to retrieve the text of the N'th keyword should use this. */
 static inline const char *
@@ -72,6 +72,9 @@ typedef void (*ExecutorRun_hook_type) (QueryDesc *queryDesc,
 									   bool execute_once);
 extern PGDLLIMPORT ExecutorRun_hook_type ExecutorRun_hook;
 
+/* the innermost query currently inside ExecutorRun, if any */
+extern PGDLLIMPORT QueryDesc *ActiveQueryDesc;
+
 /* Hook for plugins to get control in ExecutorFinish() */
 typedef void (*ExecutorFinish_hook_type) (QueryDesc *queryDesc);
 extern PGDLLIMPORT ExecutorFinish_hook_type ExecutorFinish_hook;
@@ -118,6 +121,9 @@ extern void execTuplesHashPrepare(int numCols,
 								  const Oid *eqOperators,
 								  Oid **eqFuncOids,
 								  FmgrInfo **hashFunctions);
+extern bool ExecHashKeyBytesOK(Oid collation);
+extern uint32 ExecHashKeyValue(FmgrInfo *hashfunction, Oid collation,
+							   bool bytes_ok, Datum value);
 extern TupleHashTable BuildTupleHashTable(PlanState *parent,
 										  TupleDesc inputDesc,
 										  int numCols, AttrNumber *keyColIdx,
@@ -142,6 +148,7 @@ extern TupleHashEntry LookupTupleHashEntry(TupleHashTable hashtable,
 										   bool *isnew, uint32 *hash);
 extern uint32 TupleHashTableHash(TupleHashTable hashtable,
 								 TupleTableSlot *slot);
+extern void TupleHashTablePrefetch(TupleHashTable hashtable, uint32 hash);
 extern TupleHashEntry LookupTupleHashEntryHash(TupleHashTable hashtable,
 											   TupleTableSlot *slot,
 											   bool *isnew, uint32 hash);
@@ -261,6 +268,8 @@ ExecProcNode(PlanState *node)
 /*
  * prototypes from functions in execExpr.c
  */
+extern int	expression_cse_limit;
+
 extern ExprState *ExecInitExpr(Expr *node, PlanState *parent);
 extern ExprState *ExecInitExprWithParams(Expr *node, ParamListInfo ext_params);
 extern ExprState *ExecInitQual(List *qual, PlanState *parent);
@@ -612,7 +621,8 @@ extern List *ExecInsertIndexTuples(ResultRelInfo *resultRelInfo,
 								   TupleTableSlot *slot, EState *estate,
 								   bool update,
 								   bool noDupErr,
-								   bool *specConflict, List *arbiterIndexes);
+								   bool *specConflict, List *arbiterIndexes,
+								   bool onlySummarizing);
 extern bool ExecCheckIndexConstraints(ResultRelInfo *resultRelInfo,
 									  TupleTableSlot *slot,
 									  EState *estate, ItemPointer conflictTid,
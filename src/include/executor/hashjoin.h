@@ -14,6 +14,7 @@
 #ifndef HASHJOIN_H
 #define HASHJOIN_H
 
+#include "lib/bloomfilter.h"
 #include "nodes/execnodes.h"
 #include "port/atomics.h"
 #include "storage/barrier.h"
@@ -110,6 +111,22 @@ typedef struct HashSkewBucket
 #define SKEW_HASH_MEM_PERCENT  2
 #define SKEW_MIN_OUTER_FRACTION  0.01
 
+/*
+ * Doubling the number of batches should move about half of the tuples of a
+ * batch out of it.  If it moves less than this fraction of them, the batch is
+ * dominated by tuples with identical hash values, which no amount of further
+ * splitting can break up, so we stop increasing the number of batches rather
+ * than creating ever more nearly-empty batches and temporary files.
+ */
+#define MIN_BATCH_SPLIT_FRACTION  0.05
+
+/*
+ * Tag bit recording a hash value in HashJoinTableData.bucketTags.  It is
+ * taken from the top bits of the hash value, which are the last ones to be
+ * used for the bucket and batch numbers.
+ */
+#define HJ_BUCKET_TAG(hashvalue)	((uint8) (1 << ((hashvalue) >> 29)))
+
 /*
  * To reduce palloc overhead, the HashJoinTuples for the current batch are
  * packed in 32kB buffers instead of pallocing each tuple individually.
@@ -299,6 +316,14 @@ typedef struct HashJoinTableData
 		dsa_pointer_atomic *shared;
 	}			buckets;
 
+	/*
+	 * For an unshared hash table, bucketTags[i] has the HJ_BUCKET_TAG() bit
+	 * of every tuple in the i'th bucket set.  It is much denser than the
+	 * bucket array, so probes that find no tag bit for their hash value can
+	 * skip touching the bucket array and the tuples it points to.
+	 */
+	uint8	   *bucketTags;
+
 	bool		keepNulls;		/* true to store unmatchable NULL tuples */
 
 	bool		skewEnabled;	/* are we using skew optimization? */
@@ -329,6 +354,18 @@ typedef struct HashJoinTableData
 	BufFile   **innerBatchFile; /* buffered virtual temp file per batch */
 	BufFile   **outerBatchFile; /* buffered virtual temp file per batch */
 
+	/*
+	 * Bloom filter over the hash values of all inner tuples, or NULL.  It is
+	 * only built when the join is expected to need several batches and outer
+	 * tuples without a match can be thrown away, so that such tuples need
+	 * not be written to the outer batch files.  Its memory is counted in
+	 * spaceUsed while it exists.  See ExecHashTableCreateBloomFilter().
+	 */
+	bloom_filter *bloomFilter;
+	Size		bloomSize;		/* size of filter, even after it's freed */
+	uint64		bloomTested;	/* # outer tuples checked against filter */
+	uint64		bloomRejected;	/* # of those found not to match */
+
 	/*
 	 * Info about the datatype-specific hash functions for the datatypes being
 	 * hashed. These are arrays of the same length as the number of hash join
@@ -338,6 +375,7 @@ typedef struct HashJoinTableData
 	FmgrInfo   *inner_hashfunctions;	/* lookup data for hash functions */
 	bool	   *hashStrict;		/* is each hash join operator strict? */
 	Oid		   *collations;
+	bool	   *hashBytes;		/* hash string keys by bytes? (per key) */
 
 	Size		spaceUsed;		/* memory space currently used by tuples */
 	Size		spaceAllowed;	/* upper limit for space used */
@@ -53,6 +53,9 @@ extern void ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 									  uint32 hashvalue,
 									  int *bucketno,
 									  int *batchno);
+extern void ExecHashTableCreateBloomFilter(HashJoinTable hashtable,
+										   double ntuples);
+extern bool ExecHashBloomMayMatch(HashJoinTable hashtable, uint32 hashvalue);
 extern bool ExecScanHashBucket(HashJoinState *hjstate, ExprContext *econtext);
 extern bool ExecParallelScanHashBucket(HashJoinState *hjstate, ExprContext *econtext);
 extern void ExecPrepHashTableForUnmatched(HashJoinState *hjstate);
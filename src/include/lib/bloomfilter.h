@@ -22,6 +22,7 @@ extern void bloom_add_element(bloom_filter *filter, unsigned char *elem,
 							  size_t len);
 extern bool bloom_lacks_element(bloom_filter *filter, unsigned char *elem,
 								size_t len);
+extern Size bloom_size(bloom_filter *filter);
 extern double bloom_prop_bits_set(bloom_filter *filter);
 
 #endif							/* BLOOMFILTER_H */
@@ -114,6 +114,7 @@
 #define SH_DELETE SH_MAKE_NAME(delete)
 #define SH_LOOKUP SH_MAKE_NAME(lookup)
 #define SH_LOOKUP_HASH SH_MAKE_NAME(lookup_hash)
+#define SH_PREFETCH_HASH SH_MAKE_NAME(prefetch_hash)
 #define SH_GROW SH_MAKE_NAME(grow)
 #define SH_START_ITERATE SH_MAKE_NAME(start_iterate)
 #define SH_START_ITERATE_AT SH_MAKE_NAME(start_iterate_at)
@@ -218,6 +219,9 @@ SH_SCOPE	SH_ELEMENT_TYPE *SH_LOOKUP(SH_TYPE * tb, SH_KEY_TYPE key);
 SH_SCOPE	SH_ELEMENT_TYPE *SH_LOOKUP_HASH(SH_TYPE * tb, SH_KEY_TYPE key,
 											uint32 hash);
 
+/* void <prefix>_prefetch_hash(<prefix>_hash *tb, uint32 hash) */
+SH_SCOPE void SH_PREFETCH_HASH(SH_TYPE * tb, uint32 hash);
+
 /* void <prefix>_delete_item(<prefix>_hash *tb, <element> *entry) */
 SH_SCOPE void SH_DELETE_ITEM(SH_TYPE * tb, SH_ELEMENT_TYPE * entry);
 
@@ -832,6 +836,17 @@ SH_LOOKUP_HASH(SH_TYPE * tb, SH_KEY_TYPE key, uint32 hash)
 	return SH_LOOKUP_HASH_INTERNAL(tb, key, hash);
 }
 
+/*
+ * Prefetch the bucket that a lookup or insertion with the given hash would
+ * start at.  Callers that can compute the hashes of several keys ahead of
+ * looking them up use this to overlap the resulting cache misses.
+ */
+SH_SCOPE void
+SH_PREFETCH_HASH(SH_TYPE * tb, uint32 hash)
+{
+	pg_prefetch_mem(&tb->data[SH_INITIAL_BUCKET(tb, hash)]);
+}
+
 /*
  * Delete entry from hash table by key.  Returns whether to-be-deleted key was
  * present.
@@ -1165,6 +1180,7 @@ SH_STAT(SH_TYPE * tb)
 #undef SH_DELETE
 #undef SH_LOOKUP
 #undef SH_LOOKUP_HASH
+#undef SH_PREFETCH_HASH
 #undef SH_GROW
 #undef SH_START_ITERATE
 #undef SH_START_ITERATE_AT
@@ -113,6 +113,8 @@ typedef struct ExprState
 
 	Datum	   *innermost_domainval;
 	bool	   *innermost_domainnull;
+
+	List	   *cse_entries;	/* common subexpressions, see execExpr.c */
 } ExprState;
 
 
@@ -741,6 +743,7 @@ typedef struct TupleHashTableData
 	FmgrInfo   *tab_hash_funcs; /* hash functions for table datatype(s) */
 	ExprState  *tab_eq_func;	/* comparator for table datatype(s) */
 	Oid		   *tab_collations; /* collations for hash and comparison */
+	bool	   *tab_hash_bytes; /* hash string keys by bytes? (per column) */
 	MemoryContext tablecxt;		/* memory context containing table */
 	MemoryContext tempcxt;		/* context for function evaluations */
 	Size		entrysize;		/* actual size to make each hash entry */
@@ -1384,6 +1387,7 @@ typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+	Bitmapset  *scan_attrs;		/* columns needed, if the table AM cares */
 } SeqScanState;
 
 /* ----------------
@@ -2092,6 +2096,7 @@ typedef struct ResultCacheState
 								 * node */
 	FmgrInfo   *hashfunctions;	/* lookup data for hash funcs nkeys in size */
 	Oid		   *collations;		/* collation for comparisons nkeys in size */
+	bool	   *hash_bytes;		/* hash string keys by bytes? nkeys in size */
 	uint64		mem_used;		/* bytes of memory used by cache */
 	uint64		mem_limit;		/* memory limit in bytes for the cache */
 	MemoryContext tableContext; /* memory context to store cache data */
@@ -2320,6 +2325,18 @@ typedef struct AggState
 	bool		hash_ever_spilled;	/* ever spilled during this execution? */
 	bool		hash_spill_mode;	/* we hit a limit during the current batch
 									 * and we must not create new groups */
+	bool		hash_emit_early;	/* partial aggregation: emit groups when
+									 * hitting a limit, instead of spilling */
+	bool		hash_flush_pending; /* hit a limit in early emission mode;
+									 * emit groups before reading more input */
+	bool		hash_ever_flushed;	/* ever emitted early during this
+									 * execution? */
+	TupleTableSlot **hash_readahead_slots;	/* input tuples read ahead in
+											 * AGG_HASHED mode */
+	uint32	   *hash_readahead_hashes;	/* their hash values, per set */
+	int			hash_readahead_count;	/* # of tuples read ahead */
+	int			hash_readahead_next;	/* next one to be processed */
+	bool		hash_input_done;	/* outer plan is exhausted */
 	Size		hash_mem_limit; /* limit before spilling hash table */
 	uint64		hash_ngroups_limit; /* limit before spilling hash table */
 	int			hash_planned_partitions;	/* number of partitions planned
@@ -2343,6 +2360,18 @@ typedef struct AggState
 	SharedAggInfo *shared_info; /* one entry per worker */
 } AggState;
 
+/*
+ * WindowAggStatus -- Used to track the status of WindowAggState
+ */
+typedef enum WindowAggStatus
+{
+	WINDOWAGG_DONE,				/* No more processing to do */
+	WINDOWAGG_RUN,				/* Normal processing of window funcs */
+	WINDOWAGG_PASSTHROUGH,		/* Don't eval window funcs */
+	WINDOWAGG_PASSTHROUGH_STRICT	/* Pass-through plus don't store new
+									 * tuples during spool */
+} WindowAggStatus;
+
 /* ----------------
  *	WindowAggState information
  * ----------------
@@ -2403,8 +2432,18 @@ typedef struct WindowAggState
 	MemoryContext curaggcontext;	/* current aggregate's working data */
 	ExprContext *tmpcontext;	/* short-term evaluation context */
 
+	ExprState  *runcondition;	/* Condition which must remain true otherwise
+								 * execution of the WindowAgg will finish or
+								 * go into pass-through mode.  NULL when there
+								 * is no such condition. */
+
+	bool		use_pass_through;	/* When false, stop execution when
+									 * runcondition is no longer true.  Else
+									 * just stop evaluating window funcs. */
+	bool		top_window;		/* true if this is the top-most WindowAgg or
+								 * the only WindowAgg in this query level */
+	WindowAggStatus status;		/* run status of WindowAggState */
 	bool		all_first;		/* true if the scan is starting */
-	bool		all_done;		/* true if the scan is finished */
 	bool		partition_spooled;	/* true if all tuples in current partition
 									 * have been spooled into tuplestore */
 	bool		more_partitions;	/* true if there's more partitions after
@@ -2510,6 +2549,10 @@ typedef struct HashInstrumentation
 	int			nbatch;			/* number of batches at end of execution */
 	int			nbatch_original;	/* planned number of batches */
 	Size		space_peak;		/* peak memory usage in bytes */
+	bool		growth_disabled;	/* did skew stop nbatch increases? */
+	Size		bloom_size;		/* Bloom filter size in bytes, or 0 */
+	uint64		bloom_tested;	/* # outer tuples checked against filter */
+	uint64		bloom_rejected; /* # of those rejected by the filter */
 } HashInstrumentation;
 
 /* ----------------
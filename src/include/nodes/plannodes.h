@@ -134,6 +134,11 @@ typedef struct Plan
 	 */
 	bool		async_capable; 	/* engage asynchronous-capable logic? */
 
+	/*
+	 * information needed for JIT compilation
+	 */
+	bool		jit;			/* JIT-compile this node's expressions? */
+
 	/*
 	 * Common structural data for all Plan types.
 	 */
@@ -895,6 +900,17 @@ typedef struct WindowAgg
 	Oid			inRangeColl;	/* collation for in_range tests */
 	bool		inRangeAsc;		/* use ASC sort order for in_range tests? */
 	bool		inRangeNullsFirst;	/* nulls sort first for in_range tests? */
+
+	/*
+	 * runCondition is a qual which, once false for a row, will stay false
+	 * for the rest of the partition (see SupportRequestWFuncMonotonic).  It
+	 * has its WindowFuncs replaced by references to the node's own output,
+	 * so runConditionOrig keeps the original form for EXPLAIN.
+	 */
+	List	   *runCondition;
+	List	   *runConditionOrig;
+	bool		topWindow;		/* false for all apart from the WindowAgg
+								 * that's closest to the root of the plan */
 } WindowAgg;
 
 /* ----------------
@@ -38,6 +38,7 @@
 struct PlannerInfo;				/* avoid including pathnodes.h here */
 struct IndexOptInfo;
 struct SpecialJoinInfo;
+struct WindowClause;
 
 
 /*
@@ -239,4 +240,43 @@ typedef struct SupportRequestIndexCondition
 								 * equivalent of the function call */
 } SupportRequestIndexCondition;
 
+/*
+ * The WFuncMonotonic request allows the planner to ask a window function (or
+ * an aggregate used as one) whether its result can only go up, or only go
+ * down, as execution proceeds through a window partition.  For example,
+ * row_number() can only increase, so once "row_number() OVER (...) <= 10"
+ * has become false for a row, it will stay false for the rest of the
+ * partition.  The planner uses such quals from an outer query level as a
+ * "run condition" that lets the WindowAgg stop evaluating the partition
+ * early.
+ *
+ * "window_func" is the WindowFunc being asked about and "window_clause" is
+ * the WindowClause it is evaluated over; the answer commonly depends on
+ * the clause's ORDER BY and frame options.
+ *
+ * The support function should set "monotonic" to MONOTONICFUNC_INCREASING
+ * if the function's result never decreases from one row of a partition to
+ * the next, MONOTONICFUNC_DECREASING if it never increases, or
+ * MONOTONICFUNC_BOTH if it is the same for every row of a partition.
+ */
+typedef enum MonotonicFunction
+{
+	MONOTONICFUNC_NONE = 0,
+	MONOTONICFUNC_INCREASING = (1 << 0),
+	MONOTONICFUNC_DECREASING = (1 << 1),
+	MONOTONICFUNC_BOTH = MONOTONICFUNC_INCREASING | MONOTONICFUNC_DECREASING
+} MonotonicFunction;
+
+typedef struct SupportRequestWFuncMonotonic
+{
+	NodeTag		type;
+
+	/* Input fields: */
+	WindowFunc *window_func;	/* window function being inquired about */
+	struct WindowClause *window_clause; /* the window it is evaluated over */
+
+	/* Output fields: */
+	MonotonicFunction monotonic;
+} SupportRequestWFuncMonotonic;
+
 #endif							/* SUPPORTNODES_H */
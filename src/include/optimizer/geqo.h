@@ -66,6 +66,14 @@ extern double Geqo_selection_bias;
 
 extern double Geqo_seed;		/* 0 .. 1 */
 
+typedef enum
+{
+	GEQO_STRATEGY_GENETIC,		/* genetic algorithm */
+	GEQO_STRATEGY_GREEDY		/* greedy search, see geqo_greedy.c */
+} GeqoStrategy;
+
+extern int	Geqo_strategy;
+
 
 /*
  * Private state for a GEQO run --- accessible via root->join_search_private
@@ -81,6 +89,10 @@ typedef struct
 extern RelOptInfo *geqo(PlannerInfo *root,
 						int number_of_rels, List *initial_rels);
 
+/* routines in geqo_greedy.c */
+extern RelOptInfo *geqo_greedy(PlannerInfo *root,
+							   int number_of_rels, List *initial_rels);
+
 /* routines in geqo_eval.c */
 extern Cost geqo_eval(PlannerInfo *root, Gene *tour, int num_gene);
 extern RelOptInfo *gimme_tree(PlannerInfo *root, Gene *tour, int num_gene);
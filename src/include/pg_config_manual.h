@@ -122,6 +122,13 @@
  */
 #define ALIGNOF_BUFFER	32
 
+/*
+ * Assumed minimum alignment, for both memory addresses and file offsets, of
+ * I/O done with direct I/O (see the io_direct setting).  4K is enough for
+ * the common case of Linux on local file systems.
+ */
+#define PG_IO_ALIGN_SIZE	4096
+
 /*
  * If EXEC_BACKEND is defined, the postmaster uses an alternative method for
  * starting subprocesses: Instead of simply using fork(), as is standard on
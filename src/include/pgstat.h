@@ -289,11 +289,12 @@ typedef struct PgStat_TableEntry
 
 /* ----------
  * PgStat_MsgTabstat			Sent by the backend to report table
- *								and buffer access statistics.
+ *								and buffer access statistics, and the
+ *								temporary files it created.
  * ----------
  */
 #define PGSTAT_NUM_TABENTRIES  \
-	((PGSTAT_MSG_PAYLOAD - sizeof(Oid) - 3 * sizeof(int) - 2 * sizeof(PgStat_Counter))	\
+	((PGSTAT_MSG_PAYLOAD - sizeof(Oid) - 3 * sizeof(int) - 4 * sizeof(PgStat_Counter))	\
 	 / sizeof(PgStat_TableEntry))
 
 typedef struct PgStat_MsgTabstat
@@ -305,6 +306,8 @@ typedef struct PgStat_MsgTabstat
 	int			m_xact_rollback;
 	PgStat_Counter m_block_read_time;	/* times in microseconds */
 	PgStat_Counter m_block_write_time;
+	PgStat_Counter m_temp_files;
+	PgStat_Counter m_temp_bytes;
 	PgStat_TableEntry m_entry[PGSTAT_NUM_TABENTRIES];
 } PgStat_MsgTabstat;
 
@@ -573,7 +576,9 @@ typedef struct PgStat_MsgRecoveryConflict
 } PgStat_MsgRecoveryConflict;
 
 /* ----------
- * PgStat_MsgTempFile	Sent by the backend upon creating a temp file
+ * PgStat_MsgTempFile	Sent by a process not connected to a database
+ *						upon creating a temp file; backends report them
+ *						in their tabstat messages
  * ----------
  */
 typedef struct PgStat_MsgTempFile
@@ -13,6 +13,21 @@
 #ifndef _POSTMASTER_H
 #define _POSTMASTER_H
 
+#include "datatype/timestamp.h"
+
+/*
+ * Timestamps of the phases of setting up a client connection, reported by
+ * log_connections once the backend is ready for its first query.  The fork
+ * start time is inherited from the postmaster; it is left zero when it is
+ * not known, e.g. in EXEC_BACKEND builds.
+ */
+typedef struct ConnectionTiming
+{
+	TimestampTz fork_start;		/* postmaster is about to fork */
+	TimestampTz auth_start;		/* client authentication starts */
+	TimestampTz auth_end;		/* client authentication finished */
+} ConnectionTiming;
+
 /* GUC options */
 extern bool EnableSSL;
 extern int	ReservedBackends;
@@ -31,6 +46,8 @@ extern char *bonjour_name;
 extern bool restart_after_crash;
 extern bool remove_temp_files_after_crash;
 
+extern ConnectionTiming conn_timing;
+
 #ifdef WIN32
 extern HANDLE PostmasterHandle;
 #else
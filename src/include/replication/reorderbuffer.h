@@ -600,6 +600,10 @@ struct ReorderBuffer
 	char	   *outbuf;
 	Size		outbufsize;
 
+	/* changes serialized but not yet written to the current spill file */
+	char	   *spillbuf;
+	Size		spillbuflen;
+
 	/* memory accounting */
 	Size		size;
 
@@ -27,6 +27,7 @@
 /* user-settable parameters */
 extern int	wal_receiver_status_interval;
 extern int	wal_receiver_timeout;
+extern int	wal_receiver_compression;
 extern bool hot_standby_feedback;
 
 /*
@@ -174,6 +175,7 @@ typedef struct
 		struct
 		{
 			TimeLineID	startpointTLI;	/* Starting timeline */
+			int			compression;	/* WalCompression to ask for */
 		}			physical;
 		struct
 		{
@@ -32,11 +32,29 @@
 
 typedef struct BufFile BufFile;
 
+/*
+ * Compression methods for temporary files created with
+ * BufFileCreateCompressTemp().
+ *
+ * temp_file_compression is an integer for purposes of the GUC machinery,
+ * but it is always one of these values.
+ */
+typedef enum TempFileCompression
+{
+	TEMP_FILE_COMPRESSION_NONE,
+	TEMP_FILE_COMPRESSION_PGLZ,
+	TEMP_FILE_COMPRESSION_LZ4
+} TempFileCompression;
+
+/* GUC variable */
+extern int	temp_file_compression;
+
 /*
  * prototypes for functions in buffile.c
  */
 
 extern BufFile *BufFileCreateTemp(bool interXact);
+extern BufFile *BufFileCreateCompressTemp(bool interXact);
 extern void BufFileClose(BufFile *file);
 extern size_t BufFileRead(BufFile *file, void *ptr, size_t size);
 extern void BufFileWrite(BufFile *file, void *ptr, size_t size);
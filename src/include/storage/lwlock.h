@@ -189,6 +189,7 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_SHARED_TIDBITMAP,
 	LWTRANCHE_PARALLEL_APPEND,
 	LWTRANCHE_PER_XACT_PREDICATE_LIST,
+	LWTRANCHE_RELATION_EXTENSION,
 	LWTRANCHE_FIRST_USER_DEFINED
 }			BuiltinTrancheIds;
 
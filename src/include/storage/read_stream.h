@@ -0,0 +1,47 @@
+/*-------------------------------------------------------------------------
+ *
+ * read_stream.h
+ *	  Mechanism for reading a sequence of relation blocks with look-ahead.
+ *
+ *
+ * Portions Copyright (c) 1996-2021, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/read_stream.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef READ_STREAM_H
+#define READ_STREAM_H
+
+#include "storage/bufmgr.h"
+
+/*
+ * Flags for read_stream_begin_relation().
+ *
+ * READ_STREAM_MAINTENANCE: the stream is used by a maintenance operation
+ * (VACUUM, prewarming, ...), so size the look-ahead window using
+ * maintenance_io_concurrency instead of effective_io_concurrency.
+ */
+#define READ_STREAM_MAINTENANCE		0x01
+
+typedef struct ReadStream ReadStream;
+
+/*
+ * Callback that returns the next block number to read, or
+ * InvalidBlockNumber once the stream is exhausted.
+ */
+typedef BlockNumber (*ReadStreamBlockNumberCB) (ReadStream *stream,
+												void *callback_private_data);
+
+extern ReadStream *read_stream_begin_relation(int flags,
+											  BufferAccessStrategy strategy,
+											  Relation rel,
+											  ForkNumber forknum,
+											  ReadStreamBlockNumberCB callback,
+											  void *callback_private_data);
+extern Buffer read_stream_next_buffer(ReadStream *stream);
+extern void read_stream_reset(ReadStream *stream);
+extern void read_stream_end(ReadStream *stream);
+
+#endif							/* READ_STREAM_H */
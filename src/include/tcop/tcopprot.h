@@ -30,6 +30,8 @@ extern PGDLLIMPORT const char *debug_query_string;
 extern int	max_stack_depth;
 extern int	PostAuthDelay;
 extern int	client_connection_check_interval;
+extern PGDLLIMPORT bool coalesce_pipelined_results;
+extern int	unnamed_statement_cache_size;
 
 /* GUC-configurable parameters */
 
@@ -81,6 +83,7 @@ extern void PostgresMain(int argc, char *argv[],
 extern long get_stack_depth_rlimit(void);
 extern void ResetUsage(void);
 extern void ShowUsage(const char *title);
+extern void DropUnnamedStatementCache(void);
 extern int	check_log_duration(char *msec_str, bool was_logged);
 extern void set_debug_options(int debug_flag,
 							  GucContext context, GucSource source);
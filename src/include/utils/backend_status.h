@@ -168,6 +168,15 @@ typedef struct PgBackendStatus
 
 	/* query identifier, optionally computed using post_parse_analyze_hook */
 	uint64		st_queryid;
+
+	/*
+	 * Memory obtained from malloc() by the backend's memory contexts.  The
+	 * backend updates this directly through backend_allocated_bytes, without
+	 * following the st_changecount protocol, so readers may see a slightly
+	 * stale value (or, on platforms without atomic 8-byte stores, a torn
+	 * one).
+	 */
+	uint64		st_allocated_bytes;
 } PgBackendStatus;
 
 
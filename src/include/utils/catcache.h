@@ -22,6 +22,7 @@
 
 #include "access/htup.h"
 #include "access/skey.h"
+#include "datatype/timestamp.h"
 #include "lib/ilist.h"
 #include "utils/relcache.h"
 
@@ -118,6 +119,7 @@ typedef struct catctup
 	int			refcount;		/* number of active references */
 	bool		dead;			/* dead but not yet removed? */
 	bool		negative;		/* negative cache entry? */
+	TimestampTz lastaccess;		/* catcache clock at last access */
 	HeapTupleData tuple;		/* tuple management header */
 
 	/*
@@ -189,7 +191,11 @@ typedef struct catcacheheader
 /* this extern duplicates utils/memutils.h... */
 extern PGDLLIMPORT MemoryContext CacheMemoryContext;
 
+/* GUC variable */
+extern int	catalog_cache_prune_min_age;
+
 extern void CreateCacheMemoryContext(void);
+extern void SetCatCacheClock(TimestampTz ts);
 
 extern CatCache *InitCatCache(int id, Oid reloid, Oid indexoid,
 							  int nkeys, const int *key,
@@ -442,6 +442,10 @@ extern void assign_search_path(const char *newval, void *extra);
 extern bool check_wal_buffers(int *newval, void **extra, GucSource source);
 extern void assign_xlog_sync_method(int new_sync_method, void *extra);
 
+/* in storage/file/fd.c */
+extern bool check_io_direct(char **newval, void **extra, GucSource source);
+extern void assign_io_direct(const char *newval, void *extra);
+
 /* in access/transam/xlogprefetch.c */
 extern void assign_recovery_prefetch(bool new_value, void *extra);
 extern void assign_recovery_prefetch_fpw(bool new_value, void *extra);
@@ -83,6 +83,8 @@ extern Size GetMemoryChunkSpace(void *pointer);
 extern MemoryContext MemoryContextGetParent(MemoryContext context);
 extern bool MemoryContextIsEmpty(MemoryContext context);
 extern Size MemoryContextMemAllocated(MemoryContext context, bool recurse);
+extern void MemoryContextMemConsumed(MemoryContext context,
+									 MemoryContextCounters *consumed);
 extern void MemoryContextStats(MemoryContext context);
 extern void MemoryContextStatsDetail(MemoryContext context, int max_children,
 									 bool print_to_stderr);
@@ -148,6 +150,38 @@ extern void MemoryContextCreate(MemoryContext node,
 extern void HandleLogMemoryContextInterrupt(void);
 extern void ProcessLogMemoryContextInterrupt(void);
 
+/*
+ * Accounting of the memory obtained from malloc() by all of this backend's
+ * memory contexts, i.e. the sum of their mem_allocated.  Context types report
+ * each block they malloc() or free(), and check with
+ * MemoryContextBackendLimitAllows() before malloc'ing a block, treating
+ * refusal like malloc() failure.
+ */
+extern PGDLLIMPORT int max_backend_memory;
+extern PGDLLIMPORT uint64 *backend_allocated_bytes;
+
+extern void SetBackendAllocatedBytesLocation(uint64 *location);
+extern bool MemoryContextExceedsBackendLimit(MemoryContext context, Size size);
+
+static inline bool
+MemoryContextBackendLimitAllows(MemoryContext context, Size size)
+{
+	return max_backend_memory == 0 ||
+		!MemoryContextExceedsBackendLimit(context, size);
+}
+
+static inline void
+BackendMemoryAllocated(Size size)
+{
+	*backend_allocated_bytes += size;
+}
+
+static inline void
+BackendMemoryFreed(Size size)
+{
+	*backend_allocated_bytes -= size;
+}
+
 /*
  * Memory-context-type-specific functions
  */
@@ -185,6 +219,12 @@ extern MemoryContext GenerationContextCreate(MemoryContext parent,
 											 const char *name,
 											 Size blockSize);
 
+/* bump.c */
+extern MemoryContext BumpContextCreate(MemoryContext parent,
+									   const char *name,
+									   Size initBlockSize,
+									   Size maxBlockSize);
+
 /*
  * Recommended default alloc parameters, suitable for "ordinary" contexts
  * that might hold quite a lot of data.
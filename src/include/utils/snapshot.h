@@ -181,6 +181,13 @@ typedef struct SnapshotData
 	int32		subxcnt;		/* # of xact ids in subxip[] */
 	bool		suboverflowed;	/* has the subxip array overflowed? */
 
+	/*
+	 * For non-historic MVCC snapshots, true if xip[] and subxip[] have been
+	 * sorted by XidInMVCCSnapshot() so that they can be binary searched.
+	 * Whoever fills in the arrays must reset this.
+	 */
+	bool		xip_sorted;
+
 	bool		takenDuringRecovery;	/* recovery-shaped snapshot? */
 	bool		copied;			/* false if it's a static snapshot */
 
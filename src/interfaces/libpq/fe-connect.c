@@ -462,6 +462,7 @@ pqDropConnection(PGconn *conn, bool flushInput)
 
 	/* Always discard any unsent data */
 	conn->outCount = 0;
+	conn->outCopyMsgStart = -1;
 
 	/* Free authentication/encryption state */
 #ifdef ENABLE_GSS
@@ -3973,6 +3974,7 @@ makeEmptyPGconn(void)
 	conn->inBuffer = (char *) malloc(conn->inBufSize);
 	conn->outBufSize = 16 * 1024;
 	conn->outBuffer = (char *) malloc(conn->outBufSize);
+	conn->outCopyMsgStart = -1;
 	conn->rowBufLen = 32;
 	conn->rowBuf = (PGdataValue *) malloc(conn->rowBufLen * sizeof(PGdataValue));
 	initPQExpBuffer(&conn->errorMessage);
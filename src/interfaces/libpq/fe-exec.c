@@ -2529,9 +2529,29 @@ PQputCopyData(PGconn *conn, const char *buffer, int nbytes)
 									  conn))
 				return pqIsnonblocking(conn) ? 0 : -1;
 		}
+
+		/*
+		 * If the CopyData message built by the previous call is still the
+		 * last thing in the output buffer, append to it rather than starting
+		 * a new one.  COPY FROM STDIN attaches no meaning to message
+		 * boundaries, and applications that send one row per call would
+		 * otherwise make the server process a message per row.  That isn't
+		 * true in COPY_BOTH mode, where each message stands alone; and we
+		 * keep messages as sent when tracing, so the trace doesn't lie.
+		 */
+		if (conn->outCopyMsgStart >= 0 &&
+			conn->asyncStatus == PGASYNC_COPY_IN &&
+			conn->Pfdebug == NULL)
+		{
+			conn->outMsgStart = conn->outCopyMsgStart;
+			conn->outMsgEnd = conn->outCount;
+		}
+		else if (pqPutMsgStart('d', conn) < 0)
+			return -1;
+		conn->outCopyMsgStart = conn->outMsgStart;
+
 		/* Send the data (too simple to delegate to fe-protocol files) */
-		if (pqPutMsgStart('d', conn) < 0 ||
-			pqPutnchar(buffer, nbytes, conn) < 0 ||
+		if (pqPutnchar(buffer, nbytes, conn) < 0 ||
 			pqPutMsgEnd(conn) < 0)
 			return -1;
 	}
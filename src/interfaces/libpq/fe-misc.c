@@ -483,6 +483,8 @@ pqPutMsgStart(char msg_type, PGconn *conn)
 	/* set up the message pointers */
 	conn->outMsgStart = lenPos;
 	conn->outMsgEnd = endPos;
+	/* a CopyData message before this one can no longer be extended */
+	conn->outCopyMsgStart = -1;
 	/* length word, if needed, will be filled in by pqPutMsgEnd */
 
 	return 0;
@@ -792,6 +794,12 @@ pqSendSome(PGconn *conn, int len)
 	int			oldmsglen = conn->errorMessage.len;
 	int			result = 0;
 
+	/*
+	 * Once any of the buffer is handed to the kernel, PQputCopyData must not
+	 * touch a CopyData message that's already in it.
+	 */
+	conn->outCopyMsgStart = -1;
+
 	/*
 	 * If we already had a write failure, we will never again try to send data
 	 * on that connection.  Even if the kernel would let us, we've probably
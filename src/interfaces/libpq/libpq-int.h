@@ -490,6 +490,8 @@ struct pg_conn
 	int			outMsgStart;	/* offset to msg start (length word); if -1,
 								 * msg has no length word */
 	int			outMsgEnd;		/* offset to msg end (so far) */
+	int			outCopyMsgStart;	/* offset to length word of a CopyData
+									 * msg that may still be extended, or -1 */
 
 	/* Row processor interface workspace */
 	PGdataValue *rowBuf;		/* array for passing values to rowProcessor */
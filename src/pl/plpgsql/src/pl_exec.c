@@ -104,6 +104,17 @@ static SimpleEcontextStackEntry *simple_econtext_stack = NULL;
  */
 static ResourceOwner shared_simple_eval_resowner = NULL;
 
+/*
+ * Number of rows fetched at a time by a FOR-over-query loop when
+ * prefetching is allowed.  We start small, since many such loops exit early
+ * or touch only a few rows, and double the batch size on each fetch up to
+ * the maximum, so that long loops make fewer trips through the executor.
+ * The batch stops growing, and shrinks again, if a batch's tuple table
+ * takes more than work_mem, so wide rows don't cost a lot of memory.
+ */
+#define FOR_QUERY_INITIAL_FETCH		10
+#define FOR_QUERY_MAX_FETCH			1000
+
 /*
  * Memory management within a plpgsql function generally works with three
  * contexts:
@@ -5816,6 +5827,7 @@ exec_for_query(PLpgSQL_execstate *estate, PLpgSQL_stmt_forq *stmt,
 	uint64		previous_id = INVALID_TUPLEDESC_IDENTIFIER;
 	bool		tupdescs_match = true;
 	uint64		n;
+	long		fetch_count;
 
 	/* Fetch loop variable's datum entry */
 	var = (PLpgSQL_variable *) estate->datums[stmt->var->dno];
@@ -5831,7 +5843,8 @@ exec_for_query(PLpgSQL_execstate *estate, PLpgSQL_stmt_forq *stmt,
 	 * few more rows to avoid multiple trips through executor startup
 	 * overhead.
 	 */
-	SPI_cursor_fetch(portal, true, prefetch_ok ? 10 : 1);
+	fetch_count = prefetch_ok ? FOR_QUERY_INITIAL_FETCH : 1;
+	SPI_cursor_fetch(portal, true, fetch_count);
 	tuptab = SPI_tuptable;
 	n = SPI_processed;
 
@@ -5918,12 +5931,28 @@ exec_for_query(PLpgSQL_execstate *estate, PLpgSQL_stmt_forq *stmt,
 			LOOP_RC_PROCESSING(stmt->label, goto loop_exit);
 		}
 
-		SPI_freetuptable(tuptab);
-
 		/*
-		 * Fetch more tuples.  If prefetching is allowed, grab 50 at a time.
+		 * Pick the size of the next batch.  If prefetching is allowed, grow
+		 * it geometrically up to FOR_QUERY_MAX_FETCH, as long as the batch
+		 * we just processed fit comfortably in work_mem; if it didn't fit,
+		 * back off instead.
 		 */
-		SPI_cursor_fetch(portal, true, prefetch_ok ? 50 : 1);
+		if (prefetch_ok)
+		{
+			Size		batch_mem;
+			Size		limit = (Size) work_mem * 1024;
+
+			batch_mem = MemoryContextMemAllocated(tuptab->tuptabcxt, true);
+			if (batch_mem > limit)
+				fetch_count = Max(fetch_count / 2, FOR_QUERY_INITIAL_FETCH);
+			else if (batch_mem <= limit / 2)
+				fetch_count = Min(fetch_count * 2, FOR_QUERY_MAX_FETCH);
+		}
+
+		SPI_freetuptable(tuptab);
+
+		/* Fetch more tuples */
+		SPI_cursor_fetch(portal, true, fetch_count);
 		tuptab = SPI_tuptable;
 		n = SPI_processed;
 	}
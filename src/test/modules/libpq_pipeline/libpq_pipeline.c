@@ -84,6 +84,106 @@ pg_fatal_impl(int line, const char *fmt,...)
 	exit(1);
 }
 
+/*
+ * With coalesce_pipelined_results enabled, the server holds back the results
+ * of a pipeline while the next one is already queued.  Verify that we still
+ * get every result, in order, and that the results of the last pipeline are
+ * sent without waiting for more input from us.
+ */
+static void
+test_coalesce_results(PGconn *conn, int n_pipelines)
+{
+	PGresult   *res = NULL;
+	const char *paramValues[1];
+	Oid			paramTypes[1] = {INT4OID};
+	char		paramValue[MAXINTLEN];
+	int			i;
+
+	fprintf(stderr, "coalesced results... ");
+
+	res = PQexec(conn, "SET coalesce_pipelined_results = on");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("failed to set coalesce_pipelined_results: %s",
+				 PQerrorMessage(conn));
+	PQclear(res);
+
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+
+	/* Queue up a lot of one-statement pipelines before reading anything */
+	paramValues[0] = paramValue;
+	for (i = 0; i < n_pipelines; i++)
+	{
+		snprintf(paramValue, MAXINTLEN, "%d", i);
+		if (PQsendQueryParams(conn, "SELECT $1", 1, paramTypes,
+							  paramValues, NULL, NULL, 0) != 1)
+			pg_fatal("dispatching SELECT %d failed: %s", i,
+					 PQerrorMessage(conn));
+		if (PQpipelineSync(conn) != 1)
+			pg_fatal("pipeline sync %d failed: %s", i, PQerrorMessage(conn));
+	}
+
+	for (i = 0; i < n_pipelines; i++)
+	{
+		res = PQgetResult(conn);
+		if (res == NULL)
+			pg_fatal("PQgetResult returned null for pipeline %d: %s", i,
+					 PQerrorMessage(conn));
+		if (PQresultStatus(res) != PGRES_TUPLES_OK)
+			pg_fatal("Unexpected result code %s from pipeline %d",
+					 PQresStatus(PQresultStatus(res)), i);
+		if (atoi(PQgetvalue(res, 0, 0)) != i)
+			pg_fatal("pipeline %d returned %s", i, PQgetvalue(res, 0, 0));
+		PQclear(res);
+
+		if (PQgetResult(conn) != NULL)
+			pg_fatal("PQgetResult returned something extra after result of pipeline %d",
+					 i);
+
+		res = PQgetResult(conn);
+		if (res == NULL)
+			pg_fatal("PQgetResult returned null when sync result expected: %s",
+					 PQerrorMessage(conn));
+		if (PQresultStatus(res) != PGRES_PIPELINE_SYNC)
+			pg_fatal("Unexpected result code %s instead of sync result for pipeline %d",
+					 PQresStatus(PQresultStatus(res)), i);
+		PQclear(res);
+	}
+
+	/*
+	 * Now wait for each result before sending the next pipeline.  Nothing is
+	 * queued behind the sync, so the server must flush right away, or we'd
+	 * both be waiting forever.
+	 */
+	for (i = 0; i < 3; i++)
+	{
+		snprintf(paramValue, MAXINTLEN, "%d", i);
+		if (PQsendQueryParams(conn, "SELECT $1", 1, paramTypes,
+							  paramValues, NULL, NULL, 0) != 1)
+			pg_fatal("dispatching SELECT failed: %s", PQerrorMessage(conn));
+		if (PQpipelineSync(conn) != 1)
+			pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+		res = PQgetResult(conn);
+		if (res == NULL || PQresultStatus(res) != PGRES_TUPLES_OK)
+			pg_fatal("Unexpected result from lock-step pipeline %d: %s", i,
+					 PQerrorMessage(conn));
+		PQclear(res);
+		if (PQgetResult(conn) != NULL)
+			pg_fatal("PQgetResult returned something extra after result");
+		res = PQgetResult(conn);
+		if (res == NULL || PQresultStatus(res) != PGRES_PIPELINE_SYNC)
+			pg_fatal("expected sync result after lock-step pipeline %d", i);
+		PQclear(res);
+	}
+
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("attempt to exit pipeline mode failed when it should've succeeded: %s",
+				 PQerrorMessage(conn));
+
+	fprintf(stderr, "ok\n");
+}
+
 static void
 test_disallowed_in_pipeline(PGconn *conn)
 {
@@ -1220,6 +1320,89 @@ test_transaction(PGconn *conn)
 	fprintf(stderr, "ok\n");
 }
 
+/*
+ * Run "SELECT pq_pipeline_counter()" as an unnamed statement and return the
+ * result.  The function is marked immutable, so the planner evaluates it and
+ * the value only changes when the statement is planned again.
+ */
+static int
+exec_unnamed_counter(PGconn *conn)
+{
+	PGresult   *res;
+	int			value;
+
+	res = PQexecParams(conn, "SELECT pq_pipeline_counter()",
+					   0, NULL, NULL, NULL, NULL, 0);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("failed to execute unnamed statement: %s",
+				 PQerrorMessage(conn));
+	value = atoi(PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	return value;
+}
+
+/*
+ * With unnamed_statement_cache_size set, parsing the same unnamed statement
+ * again must reuse its CachedPlanSource, and with it the generic plan.
+ */
+static void
+test_unnamed_statement_cache(PGconn *conn)
+{
+	PGresult   *res;
+	int			first;
+	int			value;
+	int			i;
+
+	fprintf(stderr, "unnamed statement cache... ");
+
+	res = PQexec(conn, "DROP FUNCTION IF EXISTS pq_pipeline_counter();"
+				 "DROP SEQUENCE IF EXISTS pq_pipeline_seq;"
+				 "CREATE SEQUENCE pq_pipeline_seq;"
+				 "CREATE FUNCTION pq_pipeline_counter() RETURNS bigint "
+				 "IMMUTABLE LANGUAGE sql AS $$SELECT nextval('pq_pipeline_seq')$$");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("failed to create test function: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	res = PQexec(conn, "SET unnamed_statement_cache_size = 8");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("failed to set unnamed_statement_cache_size: %s",
+				 PQerrorMessage(conn));
+	PQclear(res);
+
+	/* The statement is planned once, and the plan is reused after that */
+	first = exec_unnamed_counter(conn);
+	for (i = 0; i < 3; i++)
+	{
+		value = exec_unnamed_counter(conn);
+		if (value != first)
+			pg_fatal("cached unnamed statement was planned again: got %d, expected %d",
+					 value, first);
+	}
+
+	/* Without the cache, each Parse starts over */
+	res = PQexec(conn, "SET unnamed_statement_cache_size = 0");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("failed to reset unnamed_statement_cache_size: %s",
+				 PQerrorMessage(conn));
+	PQclear(res);
+
+	first = exec_unnamed_counter(conn);
+	value = exec_unnamed_counter(conn);
+	if (value == first)
+		pg_fatal("unnamed statement was not planned again: got %d twice",
+				 value);
+
+	res = PQexec(conn, "DROP FUNCTION pq_pipeline_counter();"
+				 "DROP SEQUENCE pq_pipeline_seq");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("failed to drop test function: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	fprintf(stderr, "ok\n");
+}
+
 static void
 usage(const char *progname)
 {
@@ -1235,6 +1418,7 @@ usage(const char *progname)
 static void
 print_test_list(void)
 {
+	printf("coalesce_results\n");
 	printf("disallowed_in_pipeline\n");
 	printf("multi_pipelines\n");
 	printf("pipeline_abort\n");
@@ -1243,6 +1427,7 @@ print_test_list(void)
 	printf("simple_pipeline\n");
 	printf("singlerow\n");
 	printf("transaction\n");
+	printf("unnamed_statement_cache\n");
 }
 
 int
@@ -1330,7 +1515,9 @@ main(int argc, char **argv)
 						PQTRACE_SUPPRESS_TIMESTAMPS | PQTRACE_REGRESS_MODE);
 	}
 
-	if (strcmp(testname, "disallowed_in_pipeline") == 0)
+	if (strcmp(testname, "coalesce_results") == 0)
+		test_coalesce_results(conn, numrows);
+	else if (strcmp(testname, "disallowed_in_pipeline") == 0)
 		test_disallowed_in_pipeline(conn);
 	else if (strcmp(testname, "multi_pipelines") == 0)
 		test_multi_pipelines(conn);
@@ -1346,6 +1533,8 @@ main(int argc, char **argv)
 		test_singlerowmode(conn);
 	else if (strcmp(testname, "transaction") == 0)
 		test_transaction(conn);
+	else if (strcmp(testname, "unnamed_statement_cache") == 0)
+		test_unnamed_statement_cache(conn);
 	else
 	{
 		fprintf(stderr, "\"%s\" is not a recognized test name\n", testname);
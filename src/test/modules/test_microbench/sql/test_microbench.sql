@@ -0,0 +1,11 @@
+CREATE EXTENSION test_microbench;
+
+-- Run every benchmark briefly.  Timings vary, so only check that they ran.
+SELECT benchmark, total_ms >= 0 AS total_ok, ns_per_loop >= 0 AS per_loop_ok
+  FROM test_microbench(loops => 1000);
+
+SELECT benchmark FROM test_microbench('tuplesort', 100);
+
+-- Error cases
+SELECT * FROM test_microbench('no_such_benchmark', 1);
+SELECT * FROM test_microbench(NULL, 0);
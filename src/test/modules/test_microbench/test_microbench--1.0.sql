@@ -0,0 +1,9 @@
+/* src/test/modules/test_microbench/test_microbench--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_microbench" to load this file. \quit
+
+CREATE FUNCTION test_microbench(name text DEFAULT NULL,
+    loops bigint DEFAULT 1000000)
+RETURNS TABLE (benchmark text, total_ms float8, ns_per_loop float8)
+AS 'MODULE_PATHNAME' LANGUAGE C;
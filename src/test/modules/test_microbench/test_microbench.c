@@ -0,0 +1,458 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_microbench.c
+ *		Micro-benchmarks for hot code paths in the backend.
+ *
+ * Each benchmark sets up its data structures, then times "loops" repetitions
+ * of one basic operation, such as a hash table insertion plus a lookup, or
+ * deforming one tuple.  Setup and teardown are not included in the timing.
+ *
+ * Copyright (c) 2021, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_microbench/test_microbench.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_operator_d.h"
+#include "catalog/pg_type_d.h"
+#include "common/hashfn.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "lib/dshash.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "portability/instr_time.h"
+#include "storage/lwlock.h"
+#include "utils/builtins.h"
+#include "utils/dsa.h"
+#include "utils/fmgroids.h"
+#include "utils/memutils.h"
+#include "utils/tuplesort.h"
+#include "utils/tuplestore.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_microbench);
+
+/* A benchmark returns the time taken by "loops" operations */
+typedef void (*microbench_function) (int64 loops, instr_time *elapsed);
+
+typedef struct microbench
+{
+	const char *name;
+	microbench_function function;
+} microbench;
+
+static void bench_simplehash(int64 loops, instr_time *elapsed);
+static void bench_dshash(int64 loops, instr_time *elapsed);
+static void bench_tuplesort(int64 loops, instr_time *elapsed);
+static void bench_lwlock_exclusive(int64 loops, instr_time *elapsed);
+static void bench_lwlock_shared(int64 loops, instr_time *elapsed);
+static void bench_expr_eval(int64 loops, instr_time *elapsed);
+static void bench_slot_deform(int64 loops, instr_time *elapsed);
+
+static const microbench benchmarks[] = {
+	{"simplehash", bench_simplehash},
+	{"dshash", bench_dshash},
+	{"tuplesort", bench_tuplesort},
+	{"lwlock_exclusive", bench_lwlock_exclusive},
+	{"lwlock_shared", bench_lwlock_shared},
+	{"expr_eval", bench_expr_eval},
+	{"slot_deform", bench_slot_deform}
+};
+
+/*
+ * Keys for the hash table and sort benchmarks: a deterministic, well-mixed
+ * sequence, so that runs are repeatable.
+ */
+static inline uint32
+bench_key(int64 i)
+{
+	return murmurhash32((uint32) i);
+}
+
+/*
+ * SQL-callable entry point.  With a NULL name, runs all benchmarks.
+ */
+Datum
+test_microbench(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	const char *name = PG_ARGISNULL(0) ? NULL : text_to_cstring(PG_GETARG_TEXT_PP(0));
+	int64		loops = PG_ARGISNULL(1) ? 1000000 : PG_GETARG_INT64(1);
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	bool		found = false;
+
+	if (loops <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of loops must be positive")));
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	for (int i = 0; i < lengthof(benchmarks); i++)
+	{
+		const microbench *bench = &benchmarks[i];
+		MemoryContext bench_ctx;
+		instr_time	elapsed;
+		double		total_ms;
+		Datum		values[3];
+		bool		nulls[3] = {false, false, false};
+
+		if (name != NULL && strcmp(name, bench->name) != 0)
+			continue;
+		found = true;
+
+		/* Give each benchmark a clean context to allocate in */
+		bench_ctx = AllocSetContextCreate(CurrentMemoryContext,
+										  "microbenchmark",
+										  ALLOCSET_DEFAULT_SIZES);
+		oldcontext = MemoryContextSwitchTo(bench_ctx);
+
+		INSTR_TIME_SET_ZERO(elapsed);
+		bench->function(loops, &elapsed);
+
+		MemoryContextSwitchTo(oldcontext);
+		MemoryContextDelete(bench_ctx);
+
+		total_ms = INSTR_TIME_GET_MILLISEC(elapsed);
+		values[0] = CStringGetTextDatum(bench->name);
+		values[1] = Float8GetDatum(total_ms);
+		values[2] = Float8GetDatum(total_ms * 1000000.0 / loops);
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("unrecognized benchmark \"%s\"", name)));
+
+	return (Datum) 0;
+}
+
+/*
+ * simplehash: one insertion and one successful lookup per loop.
+ */
+typedef struct bench_hash_entry
+{
+	uint32		key;
+	char		status;
+	int64		value;
+} bench_hash_entry;
+
+#define SH_PREFIX benchhash
+#define SH_ELEMENT_TYPE bench_hash_entry
+#define SH_KEY_TYPE uint32
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) murmurhash32(key)
+#define SH_EQUAL(tb, a, b) (a) == (b)
+#define SH_SCOPE static inline
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+static void
+bench_simplehash(int64 loops, instr_time *elapsed)
+{
+	benchhash_hash *tab;
+	instr_time	start;
+	int64		sum = 0;
+
+	tab = benchhash_create(CurrentMemoryContext, 256, NULL);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < loops; i++)
+	{
+		bench_hash_entry *entry;
+		bool		found;
+
+		entry = benchhash_insert(tab, bench_key(i), &found);
+		entry->value = i;
+	}
+	for (int64 i = 0; i < loops; i++)
+	{
+		bench_hash_entry *entry = benchhash_lookup(tab, bench_key(i));
+
+		if (entry)
+			sum += entry->value;
+	}
+	INSTR_TIME_SET_CURRENT(*elapsed);
+	INSTR_TIME_SUBTRACT(*elapsed, start);
+
+	/* keep the compiler from optimizing the lookups away */
+	if (sum < 0)
+		elog(ERROR, "unexpected simplehash result");
+
+	benchhash_destroy(tab);
+}
+
+/*
+ * dshash: one insertion and one successful lookup per loop.
+ */
+typedef struct bench_dshash_entry
+{
+	uint32		key;
+	int64		value;
+} bench_dshash_entry;
+
+static void
+bench_dshash(int64 loops, instr_time *elapsed)
+{
+	dshash_parameters params = {
+		sizeof(uint32),
+		sizeof(bench_dshash_entry),
+		dshash_memcmp,
+		dshash_memhash,
+		LWTRANCHE_FIRST_USER_DEFINED
+	};
+	dsa_area   *area;
+	dshash_table *tab;
+	instr_time	start;
+	int64		sum = 0;
+
+	area = dsa_create(LWTRANCHE_FIRST_USER_DEFINED);
+	tab = dshash_create(area, &params, NULL);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < loops; i++)
+	{
+		uint32		key = bench_key(i);
+		bench_dshash_entry *entry;
+		bool		found;
+
+		entry = dshash_find_or_insert(tab, &key, &found);
+		entry->value = i;
+		dshash_release_lock(tab, entry);
+	}
+	for (int64 i = 0; i < loops; i++)
+	{
+		uint32		key = bench_key(i);
+		bench_dshash_entry *entry;
+
+		entry = dshash_find(tab, &key, false);
+		if (entry)
+		{
+			sum += entry->value;
+			dshash_release_lock(tab, entry);
+		}
+	}
+	INSTR_TIME_SET_CURRENT(*elapsed);
+	INSTR_TIME_SUBTRACT(*elapsed, start);
+
+	if (sum < 0)
+		elog(ERROR, "unexpected dshash result");
+
+	dshash_destroy(tab);
+	dsa_detach(area);
+}
+
+/*
+ * tuplesort: sorting "loops" int4 datums, including loading and reading them
+ * back.
+ */
+static void
+bench_tuplesort(int64 loops, instr_time *elapsed)
+{
+	Tuplesortstate *state;
+	instr_time	start;
+	Datum		val;
+	bool		isnull;
+	int64		prev = PG_INT64_MIN;
+
+	INSTR_TIME_SET_CURRENT(start);
+	state = tuplesort_begin_datum(INT4OID, Int4LessOperator, InvalidOid,
+								  false, work_mem, NULL, false);
+	for (int64 i = 0; i < loops; i++)
+		tuplesort_putdatum(state, Int32GetDatum((int32) bench_key(i)), false);
+	tuplesort_performsort(state);
+	while (tuplesort_getdatum(state, true, &val, &isnull, NULL))
+	{
+		if (DatumGetInt32(val) < prev)
+			elog(ERROR, "tuplesort returned values out of order");
+		prev = DatumGetInt32(val);
+	}
+	tuplesort_end(state);
+	INSTR_TIME_SET_CURRENT(*elapsed);
+	INSTR_TIME_SUBTRACT(*elapsed, start);
+}
+
+/*
+ * LWLocks: one uncontended acquire and release per loop.
+ */
+static void
+bench_lwlock(int64 loops, instr_time *elapsed, LWLockMode mode)
+{
+	LWLock	   *lock = palloc(sizeof(LWLock));
+	instr_time	start;
+
+	LWLockInitialize(lock, LWTRANCHE_FIRST_USER_DEFINED);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < loops; i++)
+	{
+		LWLockAcquire(lock, mode);
+		LWLockRelease(lock);
+	}
+	INSTR_TIME_SET_CURRENT(*elapsed);
+	INSTR_TIME_SUBTRACT(*elapsed, start);
+}
+
+static void
+bench_lwlock_exclusive(int64 loops, instr_time *elapsed)
+{
+	bench_lwlock(loops, elapsed, LW_EXCLUSIVE);
+}
+
+static void
+bench_lwlock_shared(int64 loops, instr_time *elapsed)
+{
+	bench_lwlock(loops, elapsed, LW_SHARED);
+}
+
+/*
+ * Expression evaluation: "(a + b) * 2 > c" over int4 columns of a scan
+ * tuple, per loop.
+ */
+static void
+bench_expr_eval(int64 loops, instr_time *elapsed)
+{
+	TupleDesc	tupdesc;
+	TupleTableSlot *slot;
+	ExprContext *econtext;
+	ExprState  *exprstate;
+	Expr	   *expr;
+	instr_time	start;
+	int64		ntrue = 0;
+
+	tupdesc = CreateTemplateTupleDesc(3);
+	TupleDescInitEntry(tupdesc, 1, "a", INT4OID, -1, 0);
+	TupleDescInitEntry(tupdesc, 2, "b", INT4OID, -1, 0);
+	TupleDescInitEntry(tupdesc, 3, "c", INT4OID, -1, 0);
+
+	slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+	slot->tts_values[0] = Int32GetDatum(1);
+	slot->tts_values[1] = Int32GetDatum(2);
+	slot->tts_values[2] = Int32GetDatum(5);
+	memset(slot->tts_isnull, 0, 3 * sizeof(bool));
+	ExecStoreVirtualTuple(slot);
+
+	expr = (Expr *) makeFuncExpr(F_INT4PL, INT4OID,
+								 list_make2(makeVar(1, 1, INT4OID, -1, InvalidOid, 0),
+											makeVar(1, 2, INT4OID, -1, InvalidOid, 0)),
+								 InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+	expr = (Expr *) makeFuncExpr(F_INT4MUL, INT4OID,
+								 list_make2(expr,
+											makeConst(INT4OID, -1, InvalidOid,
+													  sizeof(int32), Int32GetDatum(2),
+													  false, true)),
+								 InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+	expr = (Expr *) makeFuncExpr(F_INT4GT, BOOLOID,
+								 list_make2(expr,
+											makeVar(1, 3, INT4OID, -1, InvalidOid, 0)),
+								 InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+	econtext = CreateStandaloneExprContext();
+	econtext->ecxt_scantuple = slot;
+	exprstate = ExecInitExpr(expr, NULL);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < loops; i++)
+	{
+		bool		isnull;
+
+		if (DatumGetBool(ExecEvalExpr(exprstate, econtext, &isnull)))
+			ntrue++;
+	}
+	INSTR_TIME_SET_CURRENT(*elapsed);
+	INSTR_TIME_SUBTRACT(*elapsed, start);
+
+	if (ntrue != loops)
+		elog(ERROR, "unexpected expression result");
+
+	FreeExprContext(econtext, true);
+	ExecDropSingleTupleTableSlot(slot);
+}
+
+/*
+ * Slot deforming: extracting all ten columns of a heap tuple per loop.
+ */
+#define BENCH_DEFORM_NATTS	10
+
+static void
+bench_slot_deform(int64 loops, instr_time *elapsed)
+{
+	TupleDesc	tupdesc;
+	TupleTableSlot *slot;
+	HeapTuple	tuple;
+	Datum		values[BENCH_DEFORM_NATTS];
+	bool		nulls[BENCH_DEFORM_NATTS];
+	instr_time	start;
+
+	/* a mix of fixed-width and variable-width columns, and one NULL */
+	tupdesc = CreateTemplateTupleDesc(BENCH_DEFORM_NATTS);
+	for (int i = 0; i < BENCH_DEFORM_NATTS; i++)
+	{
+		switch (i % 3)
+		{
+			case 0:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, INT4OID, -1, 0);
+				values[i] = Int32GetDatum(i);
+				break;
+			case 1:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, INT8OID, -1, 0);
+				values[i] = Int64GetDatum(i);
+				break;
+			case 2:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, TEXTOID, -1, 0);
+				values[i] = CStringGetTextDatum("microbenchmark");
+				break;
+		}
+		nulls[i] = (i == BENCH_DEFORM_NATTS / 2);
+	}
+	tuple = heap_form_tuple(tupdesc, values, nulls);
+	slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsHeapTuple);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < loops; i++)
+	{
+		ExecStoreHeapTuple(tuple, slot, false);
+		slot_getallattrs(slot);
+		ExecClearTuple(slot);
+	}
+	INSTR_TIME_SET_CURRENT(*elapsed);
+	INSTR_TIME_SUBTRACT(*elapsed, start);
+
+	ExecDropSingleTupleTableSlot(slot);
+}
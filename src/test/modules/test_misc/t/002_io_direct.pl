@@ -0,0 +1,67 @@
+# Very simple exercise of the io_direct setting
+
+use strict;
+use warnings;
+use Fcntl;
+use IO::File;
+use PostgresNode;
+use TestLib;
+use Test::More;
+
+# macOS uses F_NOCACHE rather than O_DIRECT, and its usual file systems
+# accept that.  Everywhere else, check that O_DIRECT exists and that the file
+# system holding tmp_check accepts it (tmpfs, for example, does not).
+if ($^O ne 'darwin')
+{
+	if (!defined &O_DIRECT)
+	{
+		plan skip_all => 'no O_DIRECT';
+	}
+
+	my $f = IO::File->new("${TestLib::tmp_check}/test_o_direct_file",
+		O_RDWR | O_DIRECT | O_CREAT);
+	if (!$f)
+	{
+		plan skip_all =>
+		  "pre-flight test if we can open a file with O_DIRECT failed: $!";
+	}
+	$f->close;
+}
+
+plan tests => 3;
+
+my $node = get_new_node('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq{
+io_direct = 'data,wal'
+# tiny buffer pools, to force reads and writes
+shared_buffers = '256kB'
+temp_buffers = '800kB'
+});
+$node->start;
+
+# Do some work that is bound to write and read both shared and local buffers.
+$node->safe_psql('postgres',
+	'create table t1 as select 1 as i from generate_series(1, 10000)');
+$node->safe_psql('postgres', 'create table t2count (i int)');
+$node->safe_psql(
+	'postgres', qq{
+begin;
+create temporary table t2 as select 1 as i from generate_series(1, 100000);
+update t2 set i = i;
+insert into t2count select count(*) from t2;
+commit;
+});
+$node->safe_psql('postgres', 'update t1 set i = i');
+is($node->safe_psql('postgres', 'select count(*) from t1'),
+	'10000', 'read back from shared buffers');
+is($node->safe_psql('postgres', 'select * from t2count'),
+	'100000', 'read back from local buffers');
+
+# WAL written with O_DIRECT must be replayable
+$node->stop('immediate');
+$node->start;
+is($node->safe_psql('postgres', 'select count(*) from t1'),
+	'10000', 'read back from shared buffers after crash recovery');
+$node->stop;
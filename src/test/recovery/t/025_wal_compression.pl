@@ -0,0 +1,96 @@
+# Test compression of the WAL streamed to a standby
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+my $node_primary = get_new_node('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->append_conf('postgresql.conf', 'log_replication_commands = on');
+$node_primary->start;
+
+my $backup_name = 'my_backup';
+$node_primary->backup($backup_name);
+
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_primary, $backup_name,
+	has_streaming => 1);
+$node_standby->append_conf('postgresql.conf',
+	'wal_receiver_compression = pglz');
+
+my $log_offset = -s $node_primary->logfile;
+$node_standby->start;
+
+# Generate WAL that compresses well, and check that it arrives intact.
+$node_primary->safe_psql('postgres',
+	"CREATE TABLE tab_int AS SELECT g AS a, repeat('x', 500) AS b FROM generate_series(1, 1000) g"
+);
+$node_primary->wait_for_catchup($node_standby, 'replay',
+	$node_primary->lsn('insert'));
+
+my $result = $node_standby->safe_psql('postgres',
+	"SELECT count(*), sum(length(b)) FROM tab_int");
+is($result, "1000|500000", 'standby replays WAL streamed with pglz');
+
+my $log = substr(slurp_file($node_primary->logfile), $log_offset);
+like(
+	$log,
+	qr/received replication command: START_REPLICATION .* \(compression 'pglz'\)/,
+	'standby asks for pglz compression');
+
+# Repeat with lz4, if this build supports it.
+SKIP:
+{
+	skip "lz4 not supported by this build", 2
+	  unless check_pg_config("#define USE_LZ4 1");
+
+	$node_standby->append_conf('postgresql.conf',
+		'wal_receiver_compression = lz4');
+	$log_offset = -s $node_primary->logfile;
+	$node_standby->restart;
+
+	$node_primary->safe_psql('postgres',
+		"INSERT INTO tab_int SELECT g, repeat('y', 500) FROM generate_series(1001, 2000) g"
+	);
+	$node_primary->wait_for_catchup($node_standby, 'replay',
+		$node_primary->lsn('insert'));
+
+	$result = $node_standby->safe_psql('postgres',
+		"SELECT count(*) FROM tab_int WHERE b = repeat('y', 500)");
+	is($result, "1000", 'standby replays WAL streamed with lz4');
+
+	$log = substr(slurp_file($node_primary->logfile), $log_offset);
+	like(
+		$log,
+		qr/received replication command: START_REPLICATION .* \(compression 'lz4'\)/,
+		'standby asks for lz4 compression');
+}
+
+# If the primary won't compress, the standby still asks for compression, but
+# streaming falls back to uncompressed WAL.
+$node_primary->append_conf('postgresql.conf',
+	'wal_sender_allow_compression = off');
+$node_primary->reload;
+$node_primary->poll_query_until('postgres',
+	"SELECT current_setting('wal_sender_allow_compression') = 'off'")
+  or die "Timed out while waiting for wal_sender_allow_compression to be off";
+
+$log_offset = -s $node_primary->logfile;
+$node_standby->restart;
+
+$node_primary->safe_psql('postgres',
+	"INSERT INTO tab_int SELECT g, repeat('z', 500) FROM generate_series(2001, 3000) g"
+);
+$node_primary->wait_for_catchup($node_standby, 'replay',
+	$node_primary->lsn('insert'));
+
+$result = $node_standby->safe_psql('postgres',
+	"SELECT count(*) FROM tab_int WHERE b = repeat('z', 500)");
+is($result, "1000", 'standby replays WAL streamed without compression');
+
+$log = substr(slurp_file($node_primary->logfile), $log_offset);
+like(
+	$log,
+	qr/not compressing streamed WAL because wal_sender_allow_compression is off/,
+	'primary falls back to uncompressed WAL');
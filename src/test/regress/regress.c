@@ -21,6 +21,8 @@
 
 #include "access/detoast.h"
 #include "access/htup_details.h"
+#include "access/sysattr.h"
+#include "access/tableam.h"
 #include "access/transam.h"
 #include "access/xact.h"
 #include "catalog/namespace.h"
@@ -984,6 +986,42 @@ test_fdw_handler(PG_FUNCTION_ARGS)
 	PG_RETURN_NULL();
 }
 
+/*
+ * A table AM that behaves exactly like heap, except that it reports the
+ * column projection each scan is given.
+ */
+static TableAmRoutine test_tableam_routine;
+
+static void
+test_tableam_set_column_projection(TableScanDesc scan, Bitmapset *attrs)
+{
+	StringInfoData buf;
+	int			i = -1;
+
+	initStringInfo(&buf);
+	while ((i = bms_next_member(attrs, i)) >= 0)
+		appendStringInfo(&buf, " %d", i + FirstLowInvalidHeapAttributeNumber);
+
+	elog(NOTICE, "scan of \"%s\" needs columns:%s",
+		 RelationGetRelationName(scan->rs_rd), buf.data);
+	pfree(buf.data);
+}
+
+PG_FUNCTION_INFO_V1(test_tableam_handler);
+Datum
+test_tableam_handler(PG_FUNCTION_ARGS)
+{
+	if (test_tableam_routine.type != T_TableAmRoutine)
+	{
+		memcpy(&test_tableam_routine, GetHeapamTableAmRoutine(),
+			   sizeof(TableAmRoutine));
+		test_tableam_routine.scan_set_column_projection =
+			test_tableam_set_column_projection;
+	}
+
+	PG_RETURN_POINTER(&test_tableam_routine);
+}
+
 PG_FUNCTION_INFO_V1(test_support_func);
 Datum
 test_support_func(PG_FUNCTION_ARGS)
@@ -1075,8 +1075,40 @@ FROM (SELECT * FROM tenk1
       UNION ALL SELECT * FROM tenk1
       UNION ALL SELECT * FROM tenk1) u;
 
+-- approx_count_distinct covers approx_count_distinct_combine, _serialize
+-- and _deserialize; each value is seen by several workers
+EXPLAIN (COSTS OFF, VERBOSE)
+SELECT approx_count_distinct(unique1)
+FROM (SELECT * FROM tenk1
+      UNION ALL SELECT * FROM tenk1
+      UNION ALL SELECT * FROM tenk1
+      UNION ALL SELECT * FROM tenk1) u;
+
+SELECT approx_count_distinct(unique1) BETWEEN 9500 AND 10500 AS ok
+FROM (SELECT * FROM tenk1
+      UNION ALL SELECT * FROM tenk1
+      UNION ALL SELECT * FROM tenk1
+      UNION ALL SELECT * FROM tenk1) u;
+
 ROLLBACK;
 
+-- approx_count_distinct: estimates should be within a few standard errors
+-- (about 1.6%) of the true number of distinct values, and nulls are ignored
+SELECT approx_count_distinct(unique1) BETWEEN 9500 AND 10500 AS ok1,
+       approx_count_distinct(hundred) BETWEEN 95 AND 105 AS ok2,
+       approx_count_distinct(stringu1) BETWEEN 9500 AND 10500 AS ok3
+FROM tenk1;
+
+SELECT ten, approx_count_distinct(unique1) BETWEEN 950 AND 1050 AS ok
+FROM tenk1 GROUP BY ten ORDER BY ten;
+
+SELECT approx_count_distinct(x) FROM (VALUES (1), (NULL), (1), (2)) v(x);
+SELECT approx_count_distinct(x) FROM (VALUES (NULL::text), (NULL)) v(x);
+SELECT approx_count_distinct(unique1) FROM tenk1 WHERE false;
+
+-- types without a hash opclass can't be counted
+SELECT approx_count_distinct(p) FROM (VALUES (point '(1,1)')) v(p);
+
 -- test coverage for dense_rank
 SELECT dense_rank(x) WITHIN GROUP (ORDER BY x) FROM (VALUES (1),(1),(2),(2),(3),(3)) v(x) GROUP BY (x) ORDER BY 1;
 
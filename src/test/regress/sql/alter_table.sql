@@ -2640,6 +2640,45 @@ ALTER TABLE hash_parted ATTACH PARTITION fail_part FOR VALUES WITH (MODULUS 8, R
 ALTER TABLE hash_parted ATTACH PARTITION fail_part FOR VALUES WITH (MODULUS 3, REMAINDER 2);
 DROP TABLE fail_part;
 
+-- check validation of a partition constraint calling a function that isn't
+-- in the search path, including that of a default partition
+CREATE SCHEMA attach_qual_schema;
+CREATE FUNCTION attach_qual_schema.plus1(int) RETURNS int
+	LANGUAGE sql IMMUTABLE AS 'SELECT $1 + 1';
+CREATE TABLE attach_qual_parted (a int)
+	PARTITION BY RANGE (attach_qual_schema.plus1(a));
+CREATE TABLE attach_qual_part (a int);
+INSERT INTO attach_qual_part VALUES (4), (5);
+SET search_path TO pg_catalog;
+ALTER TABLE public.attach_qual_parted ATTACH PARTITION public.attach_qual_part FOR VALUES FROM (0) TO (6);
+ALTER TABLE public.attach_qual_parted ATTACH PARTITION public.attach_qual_part FOR VALUES FROM (0) TO (7);
+RESET search_path;
+CREATE TABLE attach_qual_def PARTITION OF attach_qual_parted DEFAULT;
+INSERT INTO attach_qual_def VALUES (10);
+CREATE TABLE attach_qual_part2 (a int);
+ALTER TABLE attach_qual_parted ATTACH PARTITION attach_qual_part2 FOR VALUES FROM (10) TO (20);
+ALTER TABLE attach_qual_parted ATTACH PARTITION attach_qual_part2 FOR VALUES FROM (20) TO (30);
+DROP TABLE attach_qual_parted;
+DROP FUNCTION attach_qual_schema.plus1(int);
+DROP SCHEMA attach_qual_schema;
+
+-- row level security must not hide violating rows
+CREATE ROLE regress_attach_rls_owner;
+CREATE TABLE attach_rls_parted (a int) PARTITION BY RANGE (a);
+CREATE TABLE attach_rls_part (a int);
+INSERT INTO attach_rls_part VALUES (100);
+ALTER TABLE attach_rls_part ENABLE ROW LEVEL SECURITY;
+ALTER TABLE attach_rls_part FORCE ROW LEVEL SECURITY;
+CREATE POLICY attach_rls_hide ON attach_rls_part USING (false);
+ALTER TABLE attach_rls_parted OWNER TO regress_attach_rls_owner;
+ALTER TABLE attach_rls_part OWNER TO regress_attach_rls_owner;
+SET ROLE regress_attach_rls_owner;
+SELECT count(*) FROM attach_rls_part;
+ALTER TABLE attach_rls_parted ATTACH PARTITION attach_rls_part FOR VALUES FROM (0) TO (10);
+RESET ROLE;
+DROP TABLE attach_rls_parted, attach_rls_part;
+DROP ROLE regress_attach_rls_owner;
+
 --
 -- DETACH PARTITION
 --
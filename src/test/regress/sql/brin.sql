@@ -509,3 +509,32 @@ SELECT * FROM brintest_3 WHERE b < '0';
 
 DROP TABLE brintest_3;
 RESET enable_seqscan;
+
+-- A change to a column that only BRIN indexes cover doesn't prevent a HOT
+-- update, but the BRIN index must still learn about the new value
+CREATE TABLE brin_hot (
+  id  integer PRIMARY KEY,
+  val integer NOT NULL
+) WITH (autovacuum_enabled = off, fillfactor = 70);
+INSERT INTO brin_hot SELECT *, 0 FROM generate_series(1, 235);
+CREATE INDEX val_brin ON brin_hot USING brin (val);
+
+BEGIN;
+UPDATE brin_hot SET val = -3 WHERE id = 42;
+SELECT pg_stat_get_xact_tuples_hot_updated('brin_hot'::regclass::oid);
+
+-- changing the primary key still requires a non-HOT update
+UPDATE brin_hot SET id = 1000 WHERE id = 43;
+SELECT pg_stat_get_xact_tuples_hot_updated('brin_hot'::regclass::oid);
+
+COMMIT;
+
+SET enable_seqscan = off;
+
+EXPLAIN (COSTS OFF)
+SELECT id FROM brin_hot WHERE val = -3;
+
+SELECT id FROM brin_hot WHERE val = -3;
+
+DROP TABLE brin_hot;
+RESET enable_seqscan;
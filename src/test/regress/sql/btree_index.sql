@@ -172,3 +172,30 @@ INSERT INTO delete_test_table SELECT i, 1, 2, 3 FROM generate_series(1,1000) i;
 
 -- Test unsupported btree opclass parameters
 create index on btree_tall_tbl (id int4_ops(foo=1));
+
+--
+-- Test heap prefetching in plain index scans, which must return the same
+-- rows in the same order.  The heap order is unrelated to the index order.
+--
+create table btree_prefetch_tbl (k int4, i int4);
+insert into btree_prefetch_tbl
+  select (i * 7919) % 10000, i from generate_series(1, 10000) i;
+create index btree_prefetch_idx on btree_prefetch_tbl (k);
+vacuum analyze btree_prefetch_tbl;
+DO $$
+BEGIN
+ SET effective_io_concurrency = 10;
+EXCEPTION WHEN invalid_parameter_value THEN
+END $$;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+explain (costs off)
+select count(*), sum(i), sum(k) from btree_prefetch_tbl where k < 5000;
+select count(*), sum(i), sum(k) from btree_prefetch_tbl where k < 5000;
+explain (costs off)
+select k, i from btree_prefetch_tbl where k < 5000 order by k desc limit 5;
+select k, i from btree_prefetch_tbl where k < 5000 order by k desc limit 5;
+reset enable_seqscan;
+reset enable_bitmapscan;
+reset effective_io_concurrency;
+drop table btree_prefetch_tbl;
@@ -208,6 +208,16 @@ CREATE TABLE i_am_a_failure() USING i_do_not_exist_am;
 CREATE TABLE i_am_a_failure() USING "I do not exist AM";
 CREATE TABLE i_am_a_failure() USING "btree";
 
+-- A table AM can ask which columns a sequential scan needs
+CREATE ACCESS METHOD heap_projection TYPE TABLE HANDLER test_tableam_handler;
+CREATE TABLE tableam_tbl_projection (a int, b text, c int) USING heap_projection;
+INSERT INTO tableam_tbl_projection VALUES (1, 'one', 10), (2, 'two', 20);
+SELECT b FROM tableam_tbl_projection WHERE c > 10;
+-- a whole-row reference shows up as column 0
+SELECT t FROM tableam_tbl_projection t WHERE a = 1;
+DROP TABLE tableam_tbl_projection;
+DROP ACCESS METHOD heap_projection;
+
 -- Drop table access method, which fails as objects depends on it
 DROP ACCESS METHOD heap2;
 
@@ -62,6 +62,8 @@ select explain_filter('explain (analyze, buffers, format xml) select * from int8
 select explain_filter('explain (analyze, buffers, format yaml) select * from int8_tbl i8');
 select explain_filter('explain (buffers, format text) select * from int8_tbl i8');
 select explain_filter('explain (buffers, format json) select * from int8_tbl i8');
+select explain_filter('explain (memory) select * from int8_tbl i8');
+select explain_filter('explain (memory, format json) select * from int8_tbl i8');
 
 -- SETTINGS option
 -- We have to ignore other settings that might be imposed by the environment,
@@ -150,3 +150,56 @@ select * from inttest where a in (1::myint,2::myint,3::myint,4::myint,5::myint,6
 select * from inttest where a in (1::myint,2::myint,3::myint,4::myint,5::myint, null);
 
 rollback;
+
+--
+-- Tests for evaluating repeated subexpressions only once
+--
+
+create function cse_notice(int) returns int as $$
+begin
+  raise notice 'cse_notice(%)', $1;
+  return $1 * 10;
+end;
+$$ language plpgsql stable;
+create temp table cse_tab (x int);
+insert into cse_tab values (1), (2);
+
+-- each row should call cse_notice() only once
+select cse_notice(x) + 1 as a, cse_notice(x) * 2 as b from cse_tab;
+
+select x from cse_tab where cse_notice(x) > 10 and cse_notice(x) < 30;
+
+-- a call that might be skipped mustn't provide the value for later ones
+select case when x > 1 then cse_notice(x) end as a, cse_notice(x) as b from cse_tab;
+
+select cse_notice(x) as a, case when x > 1 then cse_notice(x) end as b from cse_tab;
+
+select coalesce(x, cse_notice(x)) as a, cse_notice(x) + 0 as b from cse_tab;
+
+-- a shared expanded datum must be passed read-only, else the first
+-- cse_bump() call would modify it in place for the second
+create function cse_arr(int) returns int[] as $$
+declare
+  a int[];
+begin
+  a[1] := $1;
+  return a;
+end;
+$$ language plpgsql stable;
+create function cse_bump(a int[]) returns int[] as $$
+begin
+  a[1] := a[1] + 100;
+  return a;
+end;
+$$ language plpgsql;
+select cse_bump(cse_arr(x)) as a, cse_bump(cse_arr(x)) as b from cse_tab;
+
+-- expression_cse_limit = 0 disables the optimization
+set expression_cse_limit = 0;
+select cse_notice(x) + 1 as a, cse_notice(x) * 2 as b from cse_tab;
+
+reset expression_cse_limit;
+drop table cse_tab;
+drop function cse_notice(int);
+drop function cse_arr(int);
+drop function cse_bump(int[]);
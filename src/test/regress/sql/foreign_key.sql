@@ -1754,3 +1754,22 @@ UPDATE fkpart10.tbl1 SET f1 = 2 WHERE f1 = 1;
 INSERT INTO fkpart10.tbl1 VALUES (0), (1);
 COMMIT;
 DROP SCHEMA fkpart10 CASCADE;
+
+-- repeated checks of the same key must notice that our own transaction
+-- removed the referenced row in between
+CREATE TABLE fk_lastcheck_pk (a int PRIMARY KEY);
+CREATE TABLE fk_lastcheck_fk (a int REFERENCES fk_lastcheck_pk ON DELETE CASCADE);
+INSERT INTO fk_lastcheck_pk VALUES (1), (2);
+BEGIN;
+INSERT INTO fk_lastcheck_fk VALUES (1), (1), (2);
+DELETE FROM fk_lastcheck_pk WHERE a = 1;
+INSERT INTO fk_lastcheck_fk VALUES (1);
+ROLLBACK;
+BEGIN;
+INSERT INTO fk_lastcheck_fk VALUES (2), (2);
+DELETE FROM fk_lastcheck_fk;
+DELETE FROM fk_lastcheck_pk WHERE a = 2;
+INSERT INTO fk_lastcheck_fk VALUES (2);
+ROLLBACK;
+SELECT * FROM fk_lastcheck_fk;
+DROP TABLE fk_lastcheck_fk, fk_lastcheck_pk;
@@ -142,6 +142,32 @@ and p <@ box(point(5,5), point(6, 6));
 
 drop index gist_tbl_multi_index;
 
+-- Box, circle and range keys have sortsupport, so their indexes are built
+-- by sorting, which packs the leaf pages.  A buffered build doesn't sort, and
+-- with this ordered input leaves its pages much less full.
+create index gist_tbl_box_sorted on gist_tbl using gist (b);
+create index gist_tbl_box_buffered on gist_tbl using gist (b) with (buffering = on);
+create index gist_tbl_circle_sorted on gist_tbl using gist (c);
+create index gist_tbl_circle_buffered on gist_tbl using gist (c) with (buffering = on);
+
+select pg_relation_size('gist_tbl_box_sorted') * 1.25 <
+         pg_relation_size('gist_tbl_box_buffered') as box_sorted,
+       pg_relation_size('gist_tbl_circle_sorted') * 1.25 <
+         pg_relation_size('gist_tbl_circle_buffered') as circle_sorted;
+
+drop index gist_tbl_box_sorted, gist_tbl_box_buffered,
+  gist_tbl_circle_sorted, gist_tbl_circle_buffered;
+
+create table gist_range_tbl as
+select int4range(i, i + 10) as r from generate_series(1, 10000) i;
+create index gist_range_sorted on gist_range_tbl using gist (r);
+create index gist_range_buffered on gist_range_tbl using gist (r) with (buffering = on);
+
+select pg_relation_size('gist_range_sorted') * 1.25 <
+         pg_relation_size('gist_range_buffered') as range_sorted;
+
+drop table gist_range_tbl;
+
 -- Clean up
 reset enable_seqscan;
 reset enable_bitmapscan;
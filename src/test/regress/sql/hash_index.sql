@@ -191,6 +191,30 @@ INSERT INTO hash_temp_heap VALUES (1,1);
 CREATE INDEX hash_idx ON hash_temp_heap USING hash (x);
 DROP TABLE hash_temp_heap CASCADE;
 
+-- Bottom-up deletion.  UPDATEs that change only another indexed column add
+-- duplicates of the same hash key; deleting the old versions should keep the
+-- bucket from growing overflow pages.  Use a temp table, so that the old
+-- versions are dead as soon as each UPDATE has committed.
+CREATE TEMP TABLE hash_bottomup_heap (x int, y int);
+INSERT INTO hash_bottomup_heap VALUES (1, 0);
+CREATE INDEX hash_bottomup_index ON hash_bottomup_heap USING hash (x);
+CREATE INDEX hash_bottomup_y ON hash_bottomup_heap (y);
+SELECT pg_relation_size('hash_bottomup_index') AS size_before \gset
+
+DO $$
+BEGIN
+  FOR i IN 1..2000 LOOP
+    UPDATE hash_bottomup_heap SET y = y + 1;
+    COMMIT;
+  END LOOP;
+END
+$$;
+
+SELECT pg_relation_size('hash_bottomup_index') - :size_before
+  <= current_setting('block_size')::int AS bounded;
+
+DROP TABLE hash_bottomup_heap;
+
 -- Float4 type.
 CREATE TABLE hash_heap_float4 (x float4, y int);
 INSERT INTO hash_heap_float4 VALUES (1.1,1);
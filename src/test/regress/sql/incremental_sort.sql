@@ -276,3 +276,24 @@ from tenk1, lateral (select tenk1.unique1 from generate_series(1, 1000)) as sub
 order by 1, 2;
 -- Disallow pushing down sort when pathkey is an SRF.
 explain (costs off) select unique1 from tenk1 order by unnest('{1,2}'::int[]);
+
+-- A merge join whose outer input is already sorted by a prefix of the merge
+-- keys uses an incremental sort for it.  The inner input needs mark and
+-- restore, so it still gets a full sort.
+begin;
+set local enable_hashjoin = off;
+set local enable_nestloop = off;
+set local enable_seqscan = off;
+set local enable_incremental_sort = on;
+set local max_parallel_workers_per_gather = 0;
+create table mj_outer (a int, b int);
+create table mj_inner (a int, b int);
+insert into mj_outer select i / 1000, i % 1000 from generate_series(0, 9999) i;
+insert into mj_inner select i / 1000, i % 1000 from generate_series(0, 9999) i;
+create index on mj_outer (a);
+analyze mj_outer;
+analyze mj_inner;
+explain (costs off)
+select count(*) from mj_outer o join mj_inner i on o.a = i.a and o.b = i.b;
+select count(*) from mj_outer o join mj_inner i on o.a = i.a and o.b = i.b;
+rollback;
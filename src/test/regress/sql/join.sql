@@ -386,6 +386,20 @@ select count(*) from tenk1 x where
   x.unique1 in (select aa.f1 from int4_tbl aa,float8_tbl bb where aa.f1=bb.f1);
 rollback;
 
+-- and with GEQO's greedy join search, for a five-way join
+begin;
+set geqo = on;
+set geqo_threshold = 2;
+set geqo_strategy = greedy;
+select count(*), sum(a.unique1), sum(e.unique1)
+  from tenk1 a
+  join tenk1 b on a.unique1 = b.unique1
+  join tenk1 c on b.unique2 = c.unique2
+  join tenk1 d on c.tenthous = d.unique1
+  join onek e on d.unique1 = e.unique1
+  where a.unique1 < 100;
+rollback;
+
 --
 -- regression test: be sure we cope with proven-dummy append rels
 --
@@ -56,6 +56,20 @@ select jsonb_path_query('{}', 'lax $.a');
 select jsonb_path_query('{}', 'strict $.a');
 select jsonb_path_query('{}', 'strict $.a', silent => true);
 
+-- chains of member accessors, which are evaluated by a fast path
+select jsonb_path_query('{"a": {"b": {"c": 1}}}', '$.a.b.c');
+select jsonb_path_query('{"a": {"b": {"c": [1, {"d": 2}]}}}', '$.a.b.c');
+select jsonb_path_query('{"a": {"b": "x\"y"}}', '$."a"."b"');
+select jsonb_path_query('{"a": {"b": {"c": 1}}}', 'lax $.a.x.c');
+select jsonb_path_query('{"a": {"b": {"c": 1}}}', 'strict $.a.x.c');
+select jsonb_path_query('{"a": {"b": {"c": 1}}}', 'strict $.a.x.c', silent => true);
+select jsonb_path_query('{"a": {"b": 1}}', 'lax $.a.b.c');
+select jsonb_path_query('{"a": {"b": 1}}', 'strict $.a.b.c');
+select jsonb_path_query('{"a": [{"b": 1}, {"b": 2}]}', 'lax $.a.b');
+select jsonb_path_query('[{"a": {"b": 1}}]', 'lax $.a.b');
+select jsonb_path_exists('{"a": {"b": null}}', 'strict $.a.b');
+select jsonb '{"a": {"b": true}}' @@ '$.a.b';
+
 select jsonb_path_query('1', 'strict $[1]');
 select jsonb_path_query('1', 'strict $[*]');
 select jsonb_path_query('[]', 'strict $[1]');
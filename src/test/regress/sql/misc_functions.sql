@@ -39,6 +39,13 @@ SELECT num_nulls();
 --
 SELECT * FROM pg_log_backend_memory_contexts(pg_backend_pid());
 
+--
+-- pg_log_query_plan()
+--
+-- As above, the plan is only logged, but check that requesting it works.
+--
+SELECT * FROM pg_log_query_plan(pg_backend_pid());
+
 --
 -- Test some built-in SRFs
 --
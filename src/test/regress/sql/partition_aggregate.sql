@@ -331,3 +331,42 @@ RESET parallel_setup_cost;
 EXPLAIN (COSTS OFF)
 SELECT x, sum(y), avg(y), count(*) FROM pagg_tab_para GROUP BY x HAVING avg(y) < 7 ORDER BY 1, 2, 3;
 SELECT x, sum(y), avg(y), count(*) FROM pagg_tab_para GROUP BY x HAVING avg(y) < 7 ORDER BY 1, 2, 3;
+
+-- A partial hash aggregate that runs out of memory emits the groups it has
+-- so far rather than spilling; the finalize step combines the duplicates.
+SET max_parallel_workers_per_gather TO 0;
+SET enable_sort TO off;
+SET work_mem TO '64kB';
+CREATE TABLE pagg_tab_emit (a int, b int) PARTITION BY RANGE(a);
+CREATE TABLE pagg_tab_emit_p1 PARTITION OF pagg_tab_emit FOR VALUES FROM (0) TO (10000);
+CREATE TABLE pagg_tab_emit_p2 PARTITION OF pagg_tab_emit FOR VALUES FROM (10000) TO (30000);
+INSERT INTO pagg_tab_emit SELECT i, i % 2000 FROM generate_series(0, 29999) i;
+ANALYZE pagg_tab_emit;
+
+CREATE FUNCTION partial_hashagg_disk_usage(query text) RETURNS SETOF jsonb
+LANGUAGE plpgsql AS
+$$
+DECLARE
+  result jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF, FORMAT JSON) ' || query
+    INTO result;
+  RETURN QUERY SELECT jsonb_path_query(result,
+    'strict $.** ? (@."Partial Mode" == "Partial" && @."Strategy" == "Hashed")."Disk Usage"');
+END;
+$$;
+
+EXPLAIN (COSTS OFF)
+SELECT b, count(*) FROM pagg_tab_emit GROUP BY b;
+
+SELECT d AS disk_usage
+  FROM partial_hashagg_disk_usage('SELECT b, count(*) FROM pagg_tab_emit GROUP BY b') d;
+
+SELECT count(*), sum(c), min(c), max(c)
+  FROM (SELECT b, count(*) c FROM pagg_tab_emit GROUP BY b) s;
+
+DROP FUNCTION partial_hashagg_disk_usage(text);
+DROP TABLE pagg_tab_emit;
+RESET work_mem;
+RESET enable_sort;
+RESET max_parallel_workers_per_gather;
@@ -406,3 +406,50 @@ SELECT nextval('test_seq1');
 SELECT nextval('test_seq1');
 
 DROP SEQUENCE test_seq1;
+
+-- nextval_range
+CREATE SEQUENCE seq_range;
+SELECT nextval_range('seq_range', 5);
+SELECT currval('seq_range');
+SELECT nextval('seq_range');
+SELECT nextval_range('seq_range', 1000000);
+SELECT nextval('seq_range');
+SELECT nextval_range('seq_range', 0);
+DROP SEQUENCE seq_range;
+-- values cached by the backend are used if there are enough of them
+CREATE SEQUENCE seq_range CACHE 10;
+SELECT nextval('seq_range');
+SELECT nextval_range('seq_range', 3);
+SELECT nextval_range('seq_range', 10);
+SELECT currval('seq_range');
+DROP SEQUENCE seq_range;
+-- the whole range must fit below MAXVALUE
+CREATE SEQUENCE seq_range MAXVALUE 10;
+SELECT nextval_range('seq_range', 11);
+SELECT nextval_range('seq_range', 9223372036854775807);
+SELECT nextval_range('seq_range', 10);
+SELECT nextval('seq_range');
+DROP SEQUENCE seq_range;
+CREATE SEQUENCE seq_range START 9223372036854775800;
+SELECT nextval_range('seq_range', 9);
+SELECT nextval_range('seq_range', 8);
+SELECT currval('seq_range');
+SELECT nextval('seq_range');
+DROP SEQUENCE seq_range;
+-- a range spanning nearly all of a descending sequence
+CREATE SEQUENCE seq_range INCREMENT -1;
+SELECT nextval_range('seq_range', 9223372036854775807);
+SELECT currval('seq_range');
+SELECT nextval('seq_range');
+SELECT nextval('seq_range');
+DROP SEQUENCE seq_range;
+-- a cycling sequence can wrap around before a range, but not within it
+CREATE SEQUENCE seq_range MAXVALUE 5 CYCLE;
+SELECT nextval_range('seq_range', 5);
+SELECT nextval_range('seq_range', 3);
+SELECT nextval_range('seq_range', 3);
+SELECT nextval('seq_range');
+SELECT nextval_range('seq_range', 2);
+SELECT nextval_range('seq_range', 1);
+SELECT nextval_range('seq_range', 2);
+DROP SEQUENCE seq_range;
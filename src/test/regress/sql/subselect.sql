@@ -805,6 +805,38 @@ select * from (select pk,c2 from sq_limit order by c1,pk) as x limit 3;
 
 drop function explain_sq_limit();
 
+-- The bound can also be passed through the outer side of a left join, since
+-- every outer row yields at least one join row
+create function explain_sq_limit_join() returns setof text language plpgsql as
+$$
+declare ln text;
+begin
+    for ln in
+        explain (analyze, summary off, timing off, costs off)
+        select * from (select pk,c2 from sq_limit order by c1,pk) as x
+          left join sq_limit y on y.pk = x.c2 limit 3
+    loop
+        ln := regexp_replace(ln, 'Memory: \S*',  'Memory: xxx');
+        return next ln;
+    end loop;
+end;
+$$;
+
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+set enable_resultcache = off;
+
+select * from explain_sq_limit_join();
+
+select * from (select pk,c2 from sq_limit order by c1,pk) as x
+  left join sq_limit y on y.pk = x.c2 limit 3;
+
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_resultcache;
+
+drop function explain_sq_limit_join();
+
 drop table sq_limit;
 
 --
@@ -60,3 +60,19 @@ set timezone_abbreviations = 'Australia';
 select count(distinct utc_offset) >= 24 as ok from pg_timezone_abbrevs;
 set timezone_abbreviations = 'India';
 select count(distinct utc_offset) >= 24 as ok from pg_timezone_abbrevs;
+
+-- Memory allocated by this backend is tracked, and can be limited
+select allocated_bytes > 0 as ok from pg_stat_activity where pid = pg_backend_pid();
+set max_backend_memory = '64MB';
+do $$
+declare
+  detail text;
+begin
+  perform repeat('x', 100 * 1024 * 1024);
+  raise notice 'allocation succeeded';
+exception when out_of_memory then
+  get stacked diagnostics detail = pg_exception_detail;
+  raise notice 'out of memory, detail names the limit: %',
+    detail like '%max_backend_memory (64MB)%';
+end $$;
+reset max_backend_memory;
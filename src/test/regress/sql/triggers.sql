@@ -2535,3 +2535,20 @@ for each statement execute function trigger_function1();
 delete from convslot_test_parent;
 
 drop table convslot_test_child, convslot_test_parent;
+
+-- Several AFTER row triggers on one row each see its old and new versions
+create table trig_reuse (a int, b text);
+insert into trig_reuse values (1, 'one'), (2, 'two');
+create function trig_reuse_show() returns trigger language plpgsql as $$
+begin
+  raise notice '% % old = %, new = %', tg_name, tg_op, old, new;
+  return null;
+end $$;
+create trigger trig_reuse_1 after update or delete on trig_reuse
+  for each row execute function trig_reuse_show();
+create trigger trig_reuse_2 after update or delete on trig_reuse
+  for each row execute function trig_reuse_show();
+update trig_reuse set b = b || '!';
+delete from trig_reuse;
+drop table trig_reuse;
+drop function trig_reuse_show();
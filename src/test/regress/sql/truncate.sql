@@ -327,3 +327,20 @@ SELECT a as "from table ref_c" FROM ref_c;
 SELECT a as "from table trunc_a" FROM trunc_a ORDER BY a;
 
 DROP TABLE trunc_a, ref_c;
+
+-- truncate and abort a bulk load into a table created in the same transaction
+BEGIN;
+CREATE TABLE trunc_new (a int, b text);
+INSERT INTO trunc_new SELECT g, repeat('x', 100) FROM generate_series(1, 2000) g;
+TRUNCATE trunc_new;
+INSERT INTO trunc_new SELECT g, repeat('y', 100) FROM generate_series(1, 10) g;
+SELECT count(*), min(b) = repeat('y', 100) AS only_new FROM trunc_new;
+SAVEPOINT sp;
+INSERT INTO trunc_new SELECT g, repeat('z', 100) FROM generate_series(1, 2000) g;
+ROLLBACK TO sp;
+SELECT count(*) FROM trunc_new;
+INSERT INTO trunc_new SELECT g, repeat('x', 100) FROM generate_series(1, 2000) g;
+ROLLBACK;
+-- the buffers of the aborted relation must be gone
+CHECKPOINT;
+SELECT to_regclass('trunc_new');
@@ -300,3 +300,14 @@ RESET ROLE;
 DROP TABLE vacowned;
 DROP TABLE vacowned_parted;
 DROP ROLE regress_vacuum;
+
+-- n_distinct can't be less than the values seen in the rows read while
+-- sampling, even when most of the sample is one value
+CREATE TABLE vac_ndistinct (a int);
+ALTER TABLE vac_ndistinct ALTER COLUMN a SET STATISTICS 1;
+INSERT INTO vac_ndistinct
+  SELECT CASE WHEN g % 2 = 0 THEN 0 ELSE g END FROM generate_series(1, 30000) g;
+ANALYZE vac_ndistinct;
+SELECT n_distinct > 1000 AS bounded FROM pg_stats
+  WHERE tablename = 'vac_ndistinct' AND attname = 'a';
+DROP TABLE vac_ndistinct;
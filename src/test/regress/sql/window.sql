@@ -960,6 +960,183 @@ SELECT * FROM
    FROM empsalary) emp
 WHERE first_emp = 1 OR last_emp = 1;
 
+-- Test window run conditions
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn
+   FROM empsalary) emp
+WHERE rn < 3;
+
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn
+   FROM empsalary) emp
+WHERE rn < 3;
+
+-- The window function may also appear on the right-hand side
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn
+   FROM empsalary) emp
+WHERE 3 > rn;
+
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn
+   FROM empsalary) emp
+WHERE 3 > rn;
+
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          rank() OVER (ORDER BY salary DESC) r
+   FROM empsalary) emp
+WHERE r <= 3;
+
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          rank() OVER (ORDER BY salary DESC) r
+   FROM empsalary) emp
+WHERE r <= 3
+ORDER BY empno;
+
+-- An equality qual is kept, but still gives a run condition
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          dense_rank() OVER (ORDER BY salary DESC) dr
+   FROM empsalary) emp
+WHERE dr = 2;
+
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          dense_rank() OVER (ORDER BY salary DESC) dr
+   FROM empsalary) emp
+WHERE dr = 2
+ORDER BY empno;
+
+-- count(*) is monotonically decreasing with an UNBOUNDED FOLLOWING frame end
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          count(*) OVER (ORDER BY salary ROWS BETWEEN CURRENT ROW AND UNBOUNDED FOLLOWING) c
+   FROM empsalary) emp
+WHERE c > 8;
+
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          count(*) OVER (ORDER BY salary ROWS BETWEEN CURRENT ROW AND UNBOUNDED FOLLOWING) c
+   FROM empsalary) emp
+WHERE c > 8
+ORDER BY empno;
+
+-- ... and monotonically increasing with an UNBOUNDED PRECEDING frame start
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          count(*) OVER (ORDER BY salary) c
+   FROM empsalary) emp
+WHERE 3 >= c;
+
+SELECT * FROM
+  (SELECT empno,
+          salary,
+          count(*) OVER (ORDER BY salary) c
+   FROM empsalary) emp
+WHERE 3 >= c
+ORDER BY empno;
+
+-- Ensure the run condition is used in pass-through mode with PARTITION BY
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          depname,
+          count(*) OVER (PARTITION BY depname) c
+   FROM empsalary) emp
+WHERE c = 5;
+
+SELECT * FROM
+  (SELECT empno,
+          depname,
+          count(*) OVER (PARTITION BY depname) c
+   FROM empsalary) emp
+WHERE c = 5
+ORDER BY empno;
+
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT depname,
+          empno,
+          salary,
+          row_number() OVER (PARTITION BY depname ORDER BY salary DESC, empno) rn
+   FROM empsalary) emp
+WHERE rn <= 2;
+
+SELECT * FROM
+  (SELECT depname,
+          empno,
+          salary,
+          row_number() OVER (PARTITION BY depname ORDER BY salary DESC, empno) rn
+   FROM empsalary) emp
+WHERE rn <= 2;
+
+-- A lower WindowAgg with a run condition must keep feeding the upper one
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn,
+          count(*) OVER () c
+   FROM empsalary) emp
+WHERE rn < 3;
+
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn,
+          count(*) OVER () c
+   FROM empsalary) emp
+WHERE rn < 3;
+
+-- No run condition when count(*) is decreasing but the qual needs it increasing
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          count(*) OVER (ORDER BY salary ROWS BETWEEN CURRENT ROW AND UNBOUNDED FOLLOWING) c
+   FROM empsalary) emp
+WHERE c <= 3;
+
+-- ... nor when the frame makes count(*) non-monotonic
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          count(*) OVER (ORDER BY salary ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING) c
+   FROM empsalary) emp
+WHERE c <= 3;
+
+-- ... nor for a ROWS frame without ORDER BY that doesn't cover the partition
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          count(*) OVER (ROWS BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW) c
+   FROM empsalary) emp
+WHERE c >= 5;
+
+-- ... nor when the value compared against is volatile
+EXPLAIN (COSTS OFF)
+SELECT * FROM
+  (SELECT empno,
+          row_number() OVER (ORDER BY empno) rn
+   FROM empsalary) emp
+WHERE rn < (random() * 10)::bigint;
+
 -- cleanup
 DROP TABLE empsalary;
 